@@ -11,6 +11,8 @@
 #include <rte_per_lcore.h>
 #include <rte_lcore.h>
 #include <rte_ip.h>
+#include <rte_malloc.h>
+#include <rte_rcu_qsbr.h>
 
 #define	PRINT_USAGE_START	"%s [EAL options] --\n"
 
@@ -41,6 +43,9 @@
 #define	OPT_ITER_NUM		"iter"
 #define	OPT_VERBOSE		"verbose"
 #define	OPT_IPV6		"ipv6"
+#define	OPT_UPDATE_NUM		"updnum"
+#define	OPT_BLD_THREADS		"bldthreads"
+#define	OPT_MAX_TRANS		"maxtrans"
 
 #define	TRACE_DEFAULT_NUM	0x10000
 #define	TRACE_STEP_MAX		0x1000
@@ -107,10 +112,17 @@ static struct {
 	uint32_t            iter_num;
 	uint32_t            verbose;
 	uint32_t            ipv6;
+	uint32_t            upd_num;
+	uint32_t            bld_threads;
+	uint32_t            max_trans;
 	struct acl_alg      alg;
 	uint32_t            used_traces;
 	void               *traces;
 	struct rte_acl_ctx *acx;
+	struct acl_rule    *rules;
+	uint32_t            num_rules;
+	uint32_t            upd_run;
+	struct rte_rcu_qsbr *qsv;
 } config = {
 	.bld_categories = 3,
 	.run_categories = 1,
@@ -789,17 +801,54 @@ add_cb_rules(FILE *f, struct rte_acl_ctx *ctx)
 				i, rc, strerror(-rc));
 			return rc;
 		}
+
+		/* keep a copy of the rules to update them later. */
+		if (config.rules != NULL)
+			config.rules[config.num_rules++] = v;
 	}
 
 	return 0;
 }
 
+/*
+ * Build with 1 up to config.bld_threads threads,
+ * reporting the time each build takes.
+ */
+static int
+acx_build_mt(const struct rte_acl_config *cfg)
+{
+	int ret;
+	uint32_t i;
+	uint64_t tm;
+	struct rte_acl_build_param bprm;
+
+	memset(&bprm, 0, sizeof(bprm));
+	bprm.max_trans = config.max_trans;
+
+	ret = 0;
+	for (i = 1; i <= config.bld_threads && ret == 0; i++) {
+		bprm.num_threads = i;
+		tm = rte_rdtsc_precise();
+		ret = rte_acl_build_ext(config.acx, cfg, &bprm);
+		tm = rte_rdtsc_precise() - tm;
+
+		dump_verbose(DUMP_NONE, stdout,
+			"rte_acl_build_ext(%u, %u threads) finished with %d, "
+			"%" PRIu64 " cycles (%.2Lf sec)\n",
+			config.bld_categories, i, ret, tm,
+			(long double)tm / rte_get_timer_hz());
+	}
+
+	return ret;
+}
+
 static void
 acx_init(void)
 {
 	int ret;
 	FILE *f;
 	struct rte_acl_config cfg;
+	struct rte_acl_build_param bprm;
 
 	memset(&cfg, 0, sizeof(cfg));
 
@@ -822,6 +871,14 @@ acx_init(void)
 	if (config.acx == NULL)
 		rte_exit(rte_errno, "failed to create ACL context\n");
 
+	if (config.upd_num != 0) {
+		config.rules = rte_malloc(APP_NAME,
+			config.nb_rules * sizeof(config.rules[0]), 0);
+		if (config.rules == NULL)
+			rte_exit(-ENOMEM, "failed to allocate %u rules\n",
+				config.nb_rules);
+	}
+
 	/* set default classify method for this context. */
 	if (config.alg.alg != RTE_ACL_CLASSIFY_DEFAULT) {
 		ret = rte_acl_set_ctx_classify(config.acx, config.alg.alg);
@@ -843,16 +900,59 @@ acx_init(void)
 	fclose(f);
 
 	/* perform build. */
-	ret = rte_acl_build(config.acx, &cfg);
+	if (config.bld_threads != 0) {
+		ret = acx_build_mt(&cfg);
+	} else if (config.max_trans != 0) {
+		memset(&bprm, 0, sizeof(bprm));
+		bprm.max_trans = config.max_trans;
+		ret = rte_acl_build_ext(config.acx, &cfg, &bprm);
+
+		dump_verbose(DUMP_NONE, stdout,
+			"rte_acl_build_ext(%u, %u transitions) finished with %d\n",
+			config.bld_categories, config.max_trans, ret);
+	} else {
+		ret = rte_acl_build(config.acx, &cfg);
 
-	dump_verbose(DUMP_NONE, stdout,
-		"rte_acl_build(%u) finished with %d\n",
-		config.bld_categories, ret);
+		dump_verbose(DUMP_NONE, stdout,
+			"rte_acl_build(%u) finished with %d\n",
+			config.bld_categories, ret);
+	}
 
 	rte_acl_dump(config.acx);
 
 	if (ret != 0)
 		rte_exit(ret, "failed to build search context\n");
+
+	if (config.upd_num != 0 && config.num_rules < 2)
+		rte_exit(-EINVAL, "at least 2 rules are required for %s\n",
+			OPT_UPDATE_NUM);
+}
+
+/*
+ * Setup RCU QSBR, so that the runtime structures replaced by
+ * the updates can be freed while lookups are running.
+ */
+static void
+rcu_init(void)
+{
+	int ret;
+	size_t sz;
+	struct rte_acl_rcu_config rcu_cfg = {0};
+
+	sz = rte_rcu_qsbr_get_memsize(RTE_MAX_LCORE);
+	config.qsv = rte_zmalloc(APP_NAME, sz, RTE_CACHE_LINE_SIZE);
+	if (config.qsv == NULL)
+		rte_exit(-ENOMEM, "failed to allocate RCU QSBR variable\n");
+
+	ret = rte_rcu_qsbr_init(config.qsv, RTE_MAX_LCORE);
+	if (ret != 0)
+		rte_exit(ret, "failed to init RCU QSBR variable\n");
+
+	rcu_cfg.v = config.qsv;
+	rcu_cfg.mode = RTE_ACL_QSBR_MODE_SYNC;
+	ret = rte_acl_rcu_qsbr_add(config.acx, &rcu_cfg);
+	if (ret != 0)
+		rte_exit(ret, "failed to attach RCU QSBR to ACL context\n");
 }
 
 static uint32_t
@@ -880,6 +980,9 @@ search_ip5tuples_once(uint32_t categories, uint32_t step, const char *alg)
 			rte_exit(ret, "classify for ipv%c_5tuples returns %d\n",
 				config.ipv6 ? '6' : '4', ret);
 
+		if (config.qsv != NULL)
+			rte_rcu_qsbr_quiescent(config.qsv, rte_lcore_id());
+
 		for (r = 0, j = 0; j != n; j++) {
 			for (k = 0; k != categories; k++, r++) {
 				dump_verbose(DUMP_PKT, stdout,
@@ -906,16 +1009,30 @@ search_ip5tuples(__rte_unused void *arg)
 	long double st;
 
 	lcore = rte_lcore_id();
+
+	if (config.qsv != NULL) {
+		rte_rcu_qsbr_thread_register(config.qsv, lcore);
+		rte_rcu_qsbr_thread_online(config.qsv, lcore);
+	}
+
 	start = rte_rdtsc_precise();
 	pkt = 0;
 
-	for (i = 0; i != config.iter_num; i++) {
+	/* keep searching while the rules are updated. */
+	for (i = 0; i < config.iter_num ||
+			__atomic_load_n(&config.upd_run, __ATOMIC_ACQUIRE) != 0;
+			i++) {
 		pkt += search_ip5tuples_once(config.run_categories,
 			config.trace_step, config.alg.name);
 	}
 
 	tm = rte_rdtsc_precise() - start;
 
+	if (config.qsv != NULL) {
+		rte_rcu_qsbr_thread_offline(config.qsv, lcore);
+		rte_rcu_qsbr_thread_unregister(config.qsv, lcore);
+	}
+
 	st = (long double)tm / rte_get_timer_hz();
 	dump_verbose(DUMP_NONE, stdout,
 		"%s  @lcore %u: %" PRIu32 " iterations, %" PRIu64 " pkts, %"
@@ -928,6 +1045,43 @@ search_ip5tuples(__rte_unused void *arg)
 	return 0;
 }
 
+/*
+ * Delete a rule and add it back, config.upd_num times.
+ */
+static void
+update_ip5tuples(void)
+{
+	int ret;
+	uint64_t start, tm;
+	uint32_t i, lcore;
+	const struct rte_acl_rule *r;
+	long double st;
+
+	lcore = rte_lcore_id();
+	start = rte_rdtsc_precise();
+
+	for (i = 0; i != config.upd_num; i++) {
+		r = (const struct rte_acl_rule *)
+			(config.rules + i % config.num_rules);
+		ret = rte_acl_update_rules(config.acx, NULL, 0, r, 1);
+		if (ret == 0)
+			ret = rte_acl_update_rules(config.acx, r, 1, NULL, 0);
+		if (ret != 0)
+			rte_exit(ret, "update of rule %u returns %d\n",
+				i % config.num_rules + 1, ret);
+	}
+
+	tm = rte_rdtsc_precise() - start;
+	__atomic_store_n(&config.upd_run, 0, __ATOMIC_RELEASE);
+
+	st = (long double)tm / rte_get_timer_hz();
+	dump_verbose(DUMP_NONE, stdout,
+		"%s  @lcore %u: %" PRIu32 " updates, %" PRIu64 " cycles "
+		"(%.2Lf sec), %.2Lf cycles/update, %.2Lf updates/sec\n",
+		__func__, lcore, 2 * i, tm, st,
+		(long double)tm / (2 * i), 2 * i / st);
+}
+
 static unsigned long
 get_ulong_opt(const char *opt, const char *name, size_t min, size_t max)
 {
@@ -999,7 +1153,17 @@ print_usage(const char *prgname)
 		"[--" OPT_ITER_NUM "=<number of iterations to perform>]\n"
 		"[--" OPT_VERBOSE "=<verbose level>]\n"
 		"[--" OPT_SEARCH_ALG "=%s]\n"
-		"[--" OPT_IPV6 "=<IPv6 rules and trace files>]\n",
+		"[--" OPT_IPV6 "=<IPv6 rules and trace files>]\n"
+		"[--" OPT_UPDATE_NUM
+			"=<number of rules to delete and add back "
+			"while searching>]\n"
+		"[--" OPT_BLD_THREADS
+			"=<build with 1 up to that number of threads, "
+			"reporting build times>]\n"
+		"[--" OPT_MAX_TRANS
+			"=<node transitions per packet limit for runtime ACL "
+			"structures, the trie splits being searched within it "
+			"and " OPT_MAX_SIZE "> leave 0 for default behaviour]\n",
 		prgname, RTE_ACL_RESULTS_MULTIPLIER,
 		(uint32_t)RTE_ACL_MAX_CATEGORIES,
 		buf);
@@ -1022,6 +1186,9 @@ dump_config(FILE *f)
 	fprintf(f, "%s:%u(%s)\n", OPT_SEARCH_ALG, config.alg.alg,
 		config.alg.name);
 	fprintf(f, "%s:%u\n", OPT_IPV6, config.ipv6);
+	fprintf(f, "%s:%u\n", OPT_UPDATE_NUM, config.upd_num);
+	fprintf(f, "%s:%u\n", OPT_BLD_THREADS, config.bld_threads);
+	fprintf(f, "%s:%u\n", OPT_MAX_TRANS, config.max_trans);
 }
 
 static void
@@ -1051,6 +1218,9 @@ get_input_opts(int argc, char **argv)
 		{OPT_VERBOSE, 1, 0, 0},
 		{OPT_SEARCH_ALG, 1, 0, 0},
 		{OPT_IPV6, 0, 0, 0},
+		{OPT_UPDATE_NUM, 1, 0, 0},
+		{OPT_BLD_THREADS, 1, 0, 0},
+		{OPT_MAX_TRANS, 1, 0, 0},
 		{NULL, 0, 0, 0}
 	};
 
@@ -1100,6 +1270,15 @@ get_input_opts(int argc, char **argv)
 			get_alg_opt(optarg, lgopts[opt_idx].name);
 		} else if (strcmp(lgopts[opt_idx].name, OPT_IPV6) == 0) {
 			config.ipv6 = 1;
+		} else if (strcmp(lgopts[opt_idx].name, OPT_UPDATE_NUM) == 0) {
+			config.upd_num = get_ulong_opt(optarg,
+				lgopts[opt_idx].name, 0, INT32_MAX);
+		} else if (strcmp(lgopts[opt_idx].name, OPT_BLD_THREADS) == 0) {
+			config.bld_threads = get_ulong_opt(optarg,
+				lgopts[opt_idx].name, 1, RTE_MAX_LCORE);
+		} else if (strcmp(lgopts[opt_idx].name, OPT_MAX_TRANS) == 0) {
+			config.max_trans = get_ulong_opt(optarg,
+				lgopts[opt_idx].name, 0, UINT32_MAX);
 		}
 	}
 	config.trace_sz = config.ipv6 ? sizeof(struct ipv6_5tuple) :
@@ -1131,13 +1310,24 @@ main(int argc, char **argv)
 	if (config.trace_file != NULL)
 		tracef_init();
 
+	if (config.upd_num != 0) {
+		rcu_init();
+		config.upd_run = 1;
+	}
+
 	RTE_LCORE_FOREACH_WORKER(lcore)
 		 rte_eal_remote_launch(search_ip5tuples, NULL, lcore);
 
-	search_ip5tuples(NULL);
+	/* main lcore updates the rules while the workers search. */
+	if (config.upd_num != 0)
+		update_ip5tuples();
+	else
+		search_ip5tuples(NULL);
 
 	rte_eal_mp_wait_lcore();
 
 	rte_acl_free(config.acx);
+	rte_free(config.qsv);
+	rte_free(config.rules);
 	return 0;
 }
@@ -12,10 +12,14 @@
 #include <rte_ip.h>
 #include <rte_random.h>
 #include <rte_malloc.h>
+#include <rte_lcore.h>
+#include <rte_launch.h>
 #include <rte_lpm.h>
 #include <rte_lpm6.h>
 #include <rte_fib.h>
 #include <rte_fib6.h>
+#include <rte_rib.h>
+#include <rte_rib6.h>
 
 #define	PRINT_USAGE_START	"%s [EAL options] --\n"
 
@@ -34,6 +38,8 @@
 #define	DEF_LOOKUP_IPS_NUM	0x100000
 #define BURST_SZ		64
 #define DEFAULT_LPM_TBL8	100000U
+/* number of Poptrie leaves allocated per node */
+#define POPTRIE_LEAVES_PER_NODE	16
 
 #define CMP_FLAG		(1 << 0)
 #define CMP_ALL_FLAG		(1 << 1)
@@ -41,11 +47,18 @@
 #define FIB_RIB_TYPE		(1 << 3)
 #define FIB_V4_DIR_TYPE		(1 << 4)
 #define FIB_V6_TRIE_TYPE	(1 << 4)
-#define FIB_TYPE_MASK		(FIB_RIB_TYPE|FIB_V4_DIR_TYPE|FIB_V6_TRIE_TYPE)
+#define FIB_V4_POPTRIE_TYPE	(1 << 5)
+#define FIB_TYPE_MASK		(FIB_RIB_TYPE|FIB_V4_DIR_TYPE|FIB_V6_TRIE_TYPE|\
+				FIB_V4_POPTRIE_TYPE)
 #define SHUFFLE_FLAG		(1 << 7)
 #define DRY_RUN_FLAG		(1 << 8)
+#define BATCH_FLAG		(1 << 9)
+#define RIB_BENCH_FLAG		(1 << 10)
 
 static char *distrib_string;
+/* prefix length distribution of a global BGP table */
+static char bgp_distrib[] =
+	"16:2%,17:1%,18:2%,19:3%,20:4%,21:5%,22:12%,23:10%,24:61%";
 static char line[LINE_MAX];
 
 enum {
@@ -161,6 +174,8 @@ get_fib_type(void)
 	} else {
 		if ((config.flags & FIB_TYPE_MASK) == FIB_V4_DIR_TYPE)
 			return RTE_FIB_DIR24_8;
+		if ((config.flags & FIB_TYPE_MASK) == FIB_V4_POPTRIE_TYPE)
+			return RTE_FIB_POPTRIE;
 		if ((config.flags & FIB_TYPE_MASK) == FIB_RIB_TYPE)
 			return RTE_FIB_DUMMY;
 	}
@@ -621,6 +636,7 @@ print_usage(void)
 		"[-n <number of routes (if -f is not specified)>]\n"
 		"[-l <number of ip's for lookup (if -t is not specified)>]\n"
 		"[-d <\",\" separated \"depth:n%%\"routes depth distribution"
+		" or bgp for a global BGP table distribution"
 		"(if -f is not specified)>]\n"
 		"[-r <percentage ratio of random ip's to lookup"
 		"(if -t is not specified)>]\n"
@@ -629,22 +645,28 @@ print_usage(void)
 		"[-s <shuffle randomly generated routes>]\n"
 		"[-a <check nexthops for all ipv4 address space"
 		"(only valid with -c)>]\n"
+		"[-x <measure full table load and flap recovery with batched "
+		"updates applied by all lcores (only valid for dir)>]\n"
+		"[-R <measure insert, lookup and delete rates of the RIB "
+		"alone>]\n"
 		"[-b <fib algorithm>]\n\tavailable options for ipv4\n"
 		"\t\trib - RIB based FIB\n"
 		"\t\tdir - DIR24_8 based FIB\n"
+		"\t\tpoptrie - Poptrie based FIB\n"
 		"\tavailable options for ipv6:\n"
 		"\t\trib - RIB based FIB\n"
 		"\t\ttrie - TRIE based FIB\n"
 		"defaults are: dir for ipv4 and trie for ipv6\n"
 		"[-e <entry size (valid only for dir and trie fib types): "
 		"1/2/4/8 (default 4)>]\n"
-		"[-g <number of tbl8's for dir24_8 or trie FIBs>]\n"
+		"[-g <number of tbl8's for dir24_8 or trie FIBs, "
+		"number of nodes for poptrie FIB>]\n"
 		"[-w <path to the file to dump routing table>]\n"
 		"[-u <path to the file to dump ip's for lookup>]\n"
 		"[-v <type of loookup function:"
 		"\ts1, s2, s3 (3 types of scalar), v (vector) -"
 		" for DIR24_8 based FIB\n"
-		"\ts, v - for TRIE based ipv6 FIB>]\n",
+		"\ts, v - for TRIE based ipv6 FIB and Poptrie based FIB>]\n",
 		config.prgname);
 }
 
@@ -674,6 +696,25 @@ check_config(void)
 		return -1;
 	}
 
+	if ((config.flags & BATCH_FLAG) && ((config.flags & IPV6_FLAG) ||
+			((config.flags & FIB_TYPE_MASK) != FIB_V4_DIR_TYPE))) {
+		printf("-x flag is only valid for ipv4 dir FIB\n");
+		return -1;
+	}
+
+	if ((config.flags & RIB_BENCH_FLAG) &&
+			(config.flags & (CMP_FLAG | BATCH_FLAG))) {
+		printf("-c and -x flags are not valid with -R\n");
+		return -1;
+	}
+
+	if ((config.flags & IPV6_FLAG) && ((distrib_string == bgp_distrib) ||
+			((config.flags & FIB_TYPE_MASK) ==
+			FIB_V4_POPTRIE_TYPE))) {
+		printf("-d bgp and -b poptrie are only valid for ipv4\n");
+		return -1;
+	}
+
 	if ((config.ent_sz == 1) && (config.flags & IPV6_FLAG)) {
 		printf("-e 1 is valid only for ipv4\n");
 		return -1;
@@ -687,7 +728,7 @@ parse_opts(int argc, char **argv)
 	int opt;
 	char *endptr;
 
-	while ((opt = getopt(argc, argv, "f:t:n:d:l:r:c6ab:e:g:w:u:sv:")) !=
+	while ((opt = getopt(argc, argv, "f:t:n:d:l:r:c6ab:e:g:w:u:sv:xR")) !=
 			-1) {
 		switch (opt) {
 		case 'f':
@@ -713,7 +754,10 @@ parse_opts(int argc, char **argv)
 			}
 			break;
 		case 'd':
-			distrib_string = optarg;
+			if (strcmp(optarg, "bgp") == 0)
+				distrib_string = bgp_distrib;
+			else
+				distrib_string = optarg;
 			break;
 		case 'l':
 			errno = 0;
@@ -746,6 +790,12 @@ parse_opts(int argc, char **argv)
 		case 'a':
 			config.flags |= CMP_ALL_FLAG;
 			break;
+		case 'x':
+			config.flags |= BATCH_FLAG;
+			break;
+		case 'R':
+			config.flags |= RIB_BENCH_FLAG;
+			break;
 		case 'b':
 			if (strcmp(optarg, "rib") == 0) {
 				config.flags &= ~FIB_TYPE_MASK;
@@ -756,6 +806,9 @@ parse_opts(int argc, char **argv)
 			} else if (strcmp(optarg, "trie") == 0) {
 				config.flags &= ~FIB_TYPE_MASK;
 				config.flags |= FIB_V6_TRIE_TYPE;
+			} else if (strcmp(optarg, "poptrie") == 0) {
+				config.flags &= ~FIB_TYPE_MASK;
+				config.flags |= FIB_V4_POPTRIE_TYPE;
 			} else
 				rte_exit(-EINVAL, "Invalid option -b\n");
 			break;
@@ -826,6 +879,142 @@ print_depth_err(void)
 		"-d 0:0 option or remove /0 prefix from routes file\n");
 }
 
+static int
+batch_apply(void *arg)
+{
+	struct rte_fib *fib = arg;
+	unsigned int part = rte_lcore_index(rte_lcore_id());
+
+	return rte_fib_txn_apply(fib, part,
+		RTE_MIN(rte_lcore_count(), RTE_FIB_TXN_MAX_PARTS));
+}
+
+/* Apply the batch on all lcores, each one on its own /8 ranges */
+static int
+batch_commit(struct rte_fib *fib)
+{
+	unsigned int lcore_id;
+	int ret;
+
+	RTE_LCORE_FOREACH_WORKER(lcore_id) {
+		if ((unsigned int)rte_lcore_index(lcore_id) <
+				RTE_FIB_TXN_MAX_PARTS)
+			rte_eal_remote_launch(batch_apply, fib, lcore_id);
+	}
+	ret = batch_apply(fib);
+	RTE_LCORE_FOREACH_WORKER(lcore_id) {
+		if (rte_eal_wait_lcore(lcore_id) != 0)
+			ret = -1;
+	}
+	if (ret != 0) {
+		printf("Can not apply batched updates, err %d\n", ret);
+		return ret;
+	}
+
+	return rte_fib_txn_commit(fib);
+}
+
+static int
+flap_v4(struct rte_fib *fib, struct rt_rule_4 *rt, int batch)
+{
+	uint32_t i;
+	int ret;
+
+	if (batch) {
+		ret = rte_fib_txn_begin(fib);
+		if (ret != 0)
+			return ret;
+	}
+
+	/* A peer announcing every second route goes down and up again */
+	for (i = 0; i < config.nb_routes; i += 2)
+		rte_fib_delete(fib, rt[i].addr, rt[i].depth);
+	for (i = 0; i < config.nb_routes; i += 2) {
+		ret = rte_fib_add(fib, rt[i].addr, rt[i].depth, rt[i].nh);
+		if (ret != 0)
+			return ret;
+	}
+
+	return batch ? batch_commit(fib) : 0;
+}
+
+static int
+run_v4_batch(struct rte_fib_conf *conf)
+{
+	uint64_t start, load_tm, flap_tm, hz = rte_get_tsc_hz();
+	struct rte_fib *fib;
+	struct rt_rule_4 *rt;
+	uint32_t i;
+	int ret;
+
+	rt = (struct rt_rule_4 *)config.rt;
+
+	fib = rte_fib_create("test_batch", -1, conf);
+	if (fib == NULL) {
+		printf("Can not alloc FIB, err %d\n", rte_errno);
+		return -rte_errno;
+	}
+
+	start = rte_rdtsc_precise();
+	ret = rte_fib_txn_begin(fib);
+	for (i = 0; (ret == 0) && (i < config.nb_routes); i++)
+		ret = rte_fib_add(fib, rt[i].addr, rt[i].depth, rt[i].nh);
+	if (ret == 0)
+		ret = batch_commit(fib);
+	load_tm = rte_rdtsc_precise() - start;
+	if (ret != 0) {
+		printf("Can not load routes with batched updates, err %d\n",
+			ret);
+		rte_fib_free(fib);
+		return -ret;
+	}
+	printf("Batched full table load on %u lcores: %.1f ms, "
+		"AVG %"PRIu64" per route\n", rte_lcore_count(),
+		(double)load_tm * 1000 / hz, load_tm / config.nb_routes);
+
+	start = rte_rdtsc_precise();
+	ret = flap_v4(fib, rt, 0);
+	flap_tm = rte_rdtsc_precise() - start;
+	if (ret != 0) {
+		printf("Can not recover from flap, err %d\n", ret);
+		rte_fib_free(fib);
+		return -ret;
+	}
+	printf("Flap recovery: %.1f ms\n", (double)flap_tm * 1000 / hz);
+
+	start = rte_rdtsc_precise();
+	ret = flap_v4(fib, rt, 1);
+	flap_tm = rte_rdtsc_precise() - start;
+	if (ret != 0) {
+		printf("Can not recover from flap with batched updates, "
+			"err %d\n", ret);
+		rte_fib_free(fib);
+		return -ret;
+	}
+	printf("Batched flap recovery: %.1f ms\n",
+		(double)flap_tm * 1000 / hz);
+
+	rte_fib_free(fib);
+	return 0;
+}
+
+/* Sum of the memory allocated from the heaps of all the sockets */
+static size_t
+get_heap_alloc_sz(void)
+{
+	struct rte_malloc_socket_stats stats;
+	size_t sz = 0;
+	unsigned int i;
+
+	for (i = 0; i < rte_socket_count(); i++) {
+		if (rte_malloc_get_socket_stats(rte_socket_id_by_idx(i),
+				&stats) == 0)
+			sz += stats.heap_allocsz_bytes;
+	}
+
+	return sz;
+}
+
 static int
 run_v4(void)
 {
@@ -833,6 +1022,7 @@ run_v4(void)
 	uint64_t def_nh = 0;
 	struct rte_fib *fib;
 	struct rte_fib_conf conf = {0};
+	size_t mem;
 	struct rt_rule_4 *rt;
 	uint32_t i, j, k;
 	int ret = 0;
@@ -862,15 +1052,34 @@ run_v4(void)
 		conf.dir24_8.nh_sz = __builtin_ctz(config.ent_sz);
 		conf.dir24_8.num_tbl8 = RTE_MIN(config.tbl8,
 			get_max_nh(conf.dir24_8.nh_sz));
+	} else if (conf.type == RTE_FIB_POPTRIE) {
+		conf.poptrie.num_nodes = config.tbl8;
+		conf.poptrie.num_leaves = config.tbl8 *
+			POPTRIE_LEAVES_PER_NODE;
 	}
 
+	mem = get_heap_alloc_sz();
 	fib = rte_fib_create("test", -1, &conf);
 	if (fib == NULL) {
 		printf("Can not alloc FIB, err %d\n", rte_errno);
 		return -rte_errno;
 	}
+	printf("FIB memory %zu KB\n", (get_heap_alloc_sz() - mem) >> 10);
 
-	if (config.lookup_fn != 0) {
+	if ((config.lookup_fn != 0) && (conf.type == RTE_FIB_POPTRIE)) {
+		if (config.lookup_fn == 1)
+			ret = rte_fib_select_lookup(fib,
+				RTE_FIB_LOOKUP_POPTRIE_SCALAR);
+		else if (config.lookup_fn == 2)
+			ret = rte_fib_select_lookup(fib,
+				RTE_FIB_LOOKUP_POPTRIE_VECTOR_AVX512);
+		else
+			ret = -EINVAL;
+		if (ret != 0) {
+			printf("Can not init lookup function\n");
+			return ret;
+		}
+	} else if (config.lookup_fn != 0) {
 		if (config.lookup_fn == 1)
 			ret = rte_fib_select_lookup(fib,
 				RTE_FIB_LOOKUP_DIR24_8_SCALAR_MACRO);
@@ -891,7 +1100,7 @@ run_v4(void)
 		}
 	}
 
-	for (k = config.print_fract, i = 0; k > 0; k--) {
+	for (k = config.print_fract, i = 0, acc = 0; k > 0; k--) {
 		start = rte_rdtsc_precise();
 		for (j = 0; j < (config.nb_routes - i) / k; j++) {
 			ret = rte_fib_add(fib, rt[i + j].addr, rt[i + j].depth,
@@ -902,15 +1111,18 @@ run_v4(void)
 				return -ret;
 			}
 		}
-		printf("AVG FIB add %"PRIu64"\n",
-			(rte_rdtsc_precise() - start) / j);
+		start = rte_rdtsc_precise() - start;
+		acc += start;
+		printf("AVG FIB add %"PRIu64"\n", start / j);
 		i += j;
 	}
+	if (config.flags & BATCH_FLAG)
+		printf("Full table load: %.1f ms\n",
+			(double)acc * 1000 / rte_get_tsc_hz());
 
 	if (config.flags & CMP_FLAG) {
 		lpm_conf.max_rules = config.nb_routes * 2;
-		lpm_conf.number_tbl8s = RTE_MAX(conf.dir24_8.num_tbl8,
-			config.tbl8);
+		lpm_conf.number_tbl8s = config.tbl8;
 
 		lpm = rte_lpm_create("test_lpm", -1, &lpm_conf);
 		if (lpm == NULL) {
@@ -1002,6 +1214,9 @@ run_v4(void)
 		}
 	}
 
+	if (config.flags & BATCH_FLAG)
+		return run_v4_batch(&conf);
+
 	return 0;
 }
 
@@ -1203,6 +1418,127 @@ run_v6(void)
 	return 0;
 }
 
+static void
+print_rate(const char *op, uint32_t n, uint64_t tm)
+{
+	printf("%s: %.1f cycles, %.2f M/s\n", op, (double)tm / n,
+		(double)n * rte_get_tsc_hz() / tm / 1E6);
+}
+
+static int
+run_rib_v4(void)
+{
+	struct rte_rib_conf conf;
+	struct rte_rib *rib;
+	struct rte_rib_node *node;
+	struct rt_rule_4 *rt;
+	uint32_t *tbl4;
+	uint64_t start, acc;
+	size_t mem;
+	uint32_t i;
+
+	rt = (struct rt_rule_4 *)config.rt;
+	tbl4 = config.lookup_tbl;
+
+	conf.ext_sz = 0;
+	conf.max_nodes = config.nb_routes * 2;
+
+	mem = get_heap_alloc_sz();
+	rib = rte_rib_create("test", -1, &conf);
+	if (rib == NULL) {
+		printf("Can not alloc RIB, err %d\n", rte_errno);
+		return -rte_errno;
+	}
+	printf("RIB memory %zu KB\n", (get_heap_alloc_sz() - mem) >> 10);
+
+	start = rte_rdtsc_precise();
+	for (i = 0; i < config.nb_routes; i++) {
+		node = rte_rib_insert(rib, rt[i].addr, rt[i].depth);
+		if ((node == NULL) && (rte_errno != EEXIST)) {
+			printf("Can not insert a route to RIB, err %d\n",
+				rte_errno);
+			return -rte_errno;
+		}
+	}
+	print_rate("RIB insert", config.nb_routes,
+		rte_rdtsc_precise() - start);
+
+	acc = 0;
+	start = rte_rdtsc_precise();
+	for (i = 0; i < config.nb_lookup_ips; i++)
+		acc += (rte_rib_lookup(rib, tbl4[i]) != NULL);
+	print_rate("RIB lookup", config.nb_lookup_ips,
+		rte_rdtsc_precise() - start);
+	printf("RIB lookup hits %"PRIu64"\n", acc);
+
+	start = rte_rdtsc_precise();
+	for (i = 0; i < config.nb_routes; i++)
+		rte_rib_remove(rib, rt[i].addr, rt[i].depth);
+	print_rate("RIB delete", config.nb_routes,
+		rte_rdtsc_precise() - start);
+
+	rte_rib_free(rib);
+
+	return 0;
+}
+
+static int
+run_rib_v6(void)
+{
+	struct rte_rib6_conf conf;
+	struct rte_rib6 *rib;
+	struct rte_rib6_node *node;
+	struct rt_rule_6 *rt;
+	uint8_t *tbl6;
+	uint64_t start, acc;
+	size_t mem;
+	uint32_t i;
+
+	rt = (struct rt_rule_6 *)config.rt;
+	tbl6 = config.lookup_tbl;
+
+	conf.ext_sz = 0;
+	conf.max_nodes = config.nb_routes * 2;
+
+	mem = get_heap_alloc_sz();
+	rib = rte_rib6_create("test", -1, &conf);
+	if (rib == NULL) {
+		printf("Can not alloc RIB, err %d\n", rte_errno);
+		return -rte_errno;
+	}
+	printf("RIB memory %zu KB\n", (get_heap_alloc_sz() - mem) >> 10);
+
+	start = rte_rdtsc_precise();
+	for (i = 0; i < config.nb_routes; i++) {
+		node = rte_rib6_insert(rib, rt[i].addr, rt[i].depth);
+		if ((node == NULL) && (rte_errno != EEXIST)) {
+			printf("Can not insert a route to RIB, err %d\n",
+				rte_errno);
+			return -rte_errno;
+		}
+	}
+	print_rate("RIB insert", config.nb_routes,
+		rte_rdtsc_precise() - start);
+
+	acc = 0;
+	start = rte_rdtsc_precise();
+	for (i = 0; i < config.nb_lookup_ips; i++)
+		acc += (rte_rib6_lookup(rib, tbl6 + i * 16) != NULL);
+	print_rate("RIB lookup", config.nb_lookup_ips,
+		rte_rdtsc_precise() - start);
+	printf("RIB lookup hits %"PRIu64"\n", acc);
+
+	start = rte_rdtsc_precise();
+	for (i = 0; i < config.nb_routes; i++)
+		rte_rib6_remove(rib, rt[i].addr, rt[i].depth);
+	print_rate("RIB delete", config.nb_routes,
+		rte_rdtsc_precise() - start);
+
+	rte_rib6_free(rib);
+
+	return 0;
+}
+
 int
 main(int argc, char **argv)
 {
@@ -1316,7 +1652,10 @@ main(int argc, char **argv)
 
 	print_config();
 
-	if (af == AF_INET)
+	if ((config.flags & RIB_BENCH_FLAG) &&
+			((config.flags & DRY_RUN_FLAG) == 0))
+		ret = (af == AF_INET) ? run_rib_v4() : run_rib_v6();
+	else if (af == AF_INET)
 		ret = run_v4();
 	else
 		ret = run_v6();
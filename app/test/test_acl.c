@@ -13,6 +13,7 @@
 #include <rte_ip.h>
 #include <rte_acl.h>
 #include <rte_common.h>
+#include <rte_random.h>
 
 #include "test_acl.h"
 
@@ -1716,6 +1717,402 @@ test_u32_range(void)
 	return rc;
 }
 
+#define	UPDATE_NB_RULES		0x1000U
+#define	UPDATE_NB_DEL		0x200U
+#define	UPDATE_NB_TRACES	0x100
+
+static uint32_t
+get_host_mask(uint32_t mask_len)
+{
+	return (uint32_t)((uint64_t)UINT32_MAX >> mask_len);
+}
+
+static void
+gen_update_rule(struct rte_acl_ipv4vlan_rule *r, uint32_t n,
+	uint32_t min_mask_len)
+{
+	uint64_t v;
+
+	memset(r, 0, sizeof(*r));
+	v = rte_rand();
+
+	r->data.userdata = n + 1;
+	r->data.priority = n + 1;
+	r->data.category_mask = (v & UINT16_MAX) | 1;
+	v >>= 16;
+
+	if ((v & 1) != 0) {
+		r->proto = (v & 2) ? IPPROTO_TCP : IPPROTO_UDP;
+		r->proto_mask = UINT8_MAX;
+	}
+	r->src_mask_len = min_mask_len + (v >> 2) % (33 - min_mask_len);
+	r->dst_mask_len = min_mask_len + (v >> 8) % (33 - min_mask_len);
+	r->src_addr = rte_rand() & ~get_host_mask(r->src_mask_len);
+	r->dst_addr = rte_rand() & ~get_host_mask(r->dst_mask_len);
+
+	v = rte_rand();
+	r->src_port_low = v & 0x3ff;
+	r->src_port_high = r->src_port_low + ((v >> 16) & UINT8_MAX);
+	r->dst_port_low = (v >> 32) & 0x3ff;
+	r->dst_port_high = (v & (1ULL << 63)) ? UINT16_MAX :
+		r->dst_port_low + ((v >> 48) & UINT8_MAX);
+}
+
+static int
+update_rules(struct rte_acl_ctx *acx,
+	const struct rte_acl_ipv4vlan_rule *add, uint32_t num_add,
+	const struct rte_acl_ipv4vlan_rule *del, uint32_t num_del)
+{
+	uint32_t i;
+	struct acl_ipv4vlan_rule ra[num_add + 1], rd[num_del + 1];
+
+	for (i = 0; i != num_add; i++)
+		acl_ipv4vlan_convert_rule(add + i, ra + i);
+	for (i = 0; i != num_del; i++)
+		acl_ipv4vlan_convert_rule(del + i, rd + i);
+
+	return rte_acl_update_rules(acx, (struct rte_acl_rule *)ra, num_add,
+		(struct rte_acl_rule *)rd, num_del);
+}
+
+/*
+ * Compare lookups into two contexts holding the same rules.
+ */
+static int
+test_classify_cmp(struct rte_acl_ctx *acx, struct rte_acl_ctx *ref,
+	const struct rte_acl_ipv4vlan_rule *rules, uint32_t num)
+{
+	int32_t rc;
+	uint32_t i;
+	const struct rte_acl_ipv4vlan_rule *r;
+	struct ipv4_7tuple tdata[UPDATE_NB_TRACES];
+	const uint8_t *data[UPDATE_NB_TRACES];
+	uint32_t res[UPDATE_NB_TRACES * RTE_ACL_MAX_CATEGORIES];
+	uint32_t res_ref[UPDATE_NB_TRACES * RTE_ACL_MAX_CATEGORIES];
+
+	/* traces within the rules, so that they match */
+	memset(tdata, 0, sizeof(tdata));
+	for (i = 0; i != RTE_DIM(tdata); i++) {
+		r = rules + rte_rand_max(num);
+		tdata[i].proto = (r->proto_mask != 0) ? r->proto : IPPROTO_TCP;
+		tdata[i].ip_src = r->src_addr |
+			(rte_rand() & get_host_mask(r->src_mask_len));
+		tdata[i].ip_dst = r->dst_addr |
+			(rte_rand() & get_host_mask(r->dst_mask_len));
+		tdata[i].port_src = r->src_port_low;
+		tdata[i].port_dst = r->dst_port_high;
+		data[i] = (uint8_t *)&tdata[i];
+	}
+	bswap_test_data(tdata, RTE_DIM(tdata), 1);
+
+	rc = rte_acl_classify(acx, data, res, RTE_DIM(tdata),
+		RTE_ACL_MAX_CATEGORIES);
+	if (rc == 0)
+		rc = rte_acl_classify(ref, data, res_ref, RTE_DIM(tdata),
+			RTE_ACL_MAX_CATEGORIES);
+	if (rc != 0) {
+		printf("%s#%i: classify failed with error code: %d\n",
+			__func__, __LINE__, rc);
+		return rc;
+	}
+
+	for (i = 0; i != RTE_DIM(res); i++) {
+		if (res[i] != res_ref[i]) {
+			printf("%s#%i: trace %u category %u: "
+				"expected %u got %u\n", __func__, __LINE__,
+				i / RTE_ACL_MAX_CATEGORIES,
+				i % RTE_ACL_MAX_CATEGORIES, res_ref[i], res[i]);
+			return -EINVAL;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Test incremental update of rules.
+ */
+static int
+test_update_rules(void)
+{
+	int32_t rc;
+	uint32_t i, n;
+	struct rte_acl_ctx *acx, *ref;
+	struct rte_acl_param prm;
+	struct rte_acl_ipv4vlan_rule *rules;
+	struct rte_acl_ipv4vlan_rule tmp;
+
+	rc = -ENOMEM;
+	ref = NULL;
+	rules = NULL;
+
+	acx = rte_acl_create(&acl_param);
+	prm = acl_param;
+	prm.name = "acl_ref";
+	ref = rte_acl_create(&prm);
+	rules = malloc(UPDATE_NB_RULES * sizeof(rules[0]));
+	if (acx == NULL || ref == NULL || rules == NULL) {
+		printf("%s#%i: Error creating ACL context!\n",
+			__func__, __LINE__);
+		goto end;
+	}
+
+	/* context is not built yet */
+	rc = update_rules(acx, acl_test_rules, 1, NULL, 0);
+	if (rc != -EINVAL) {
+		printf("%s#%i: update of an unbuilt context returned %d\n",
+			__func__, __LINE__, rc);
+		rc = -EINVAL;
+		goto end;
+	}
+
+	/* build with one rule, then add the others incrementally */
+	rc = test_classify_buid(acx, acl_test_rules, 1);
+	if (rc == 0)
+		rc = update_rules(acx, acl_test_rules + 1,
+			RTE_DIM(acl_test_rules) - 1, NULL, 0);
+	if (rc == 0)
+		rc = test_classify_run(acx, acl_test_data,
+			RTE_DIM(acl_test_data));
+	if (rc != 0) {
+		printf("%s#%i: incremental add failed with error code: %d\n",
+			__func__, __LINE__, rc);
+		goto end;
+	}
+
+	/* delete and add back each rule */
+	for (i = 0; i != RTE_DIM(acl_test_rules) && rc == 0; i++) {
+		rc = update_rules(acx, NULL, 0, acl_test_rules + i, 1);
+		if (rc == 0 && update_rules(acx, NULL, 0,
+				acl_test_rules + i, 1) != -ENOENT)
+			rc = -EINVAL;
+		if (rc == 0)
+			rc = update_rules(acx, acl_test_rules + i, 1, NULL, 0);
+	}
+	if (rc == 0)
+		rc = test_classify_run(acx, acl_test_data,
+			RTE_DIM(acl_test_data));
+	if (rc != 0) {
+		printf("%s#%i: incremental delete failed at rule %u, "
+			"error code: %d\n", __func__, __LINE__, i, rc);
+		goto end;
+	}
+
+	/* context can't be left without rules */
+	rc = update_rules(acx, NULL, 0, acl_test_rules,
+		RTE_DIM(acl_test_rules));
+	if (rc != -EINVAL) {
+		printf("%s#%i: deletion of all rules returned %d\n",
+			__func__, __LINE__, rc);
+		rc = -EINVAL;
+		goto end;
+	}
+
+	/* random rule set, big enough to be split over several tries */
+	for (i = 0; i != UPDATE_NB_RULES; i++)
+		gen_update_rule(rules + i, i, 8);
+
+	rte_acl_reset(acx);
+	rc = test_classify_buid(acx, rules, UPDATE_NB_RULES / 4);
+	for (i = UPDATE_NB_RULES / 4; i < UPDATE_NB_RULES && rc == 0; i += n) {
+		n = RTE_MIN(UPDATE_NB_RULES - i, UPDATE_NB_RULES / 8);
+		rc = update_rules(acx, rules + i, n, NULL, 0);
+	}
+
+	/* delete random rules, move the last ones into their slots */
+	for (i = 0; i != UPDATE_NB_DEL && rc == 0; i++) {
+		n = rte_rand_max(UPDATE_NB_RULES - i);
+		rc = update_rules(acx, NULL, 0, rules + n, 1);
+		tmp = rules[n];
+		rules[n] = rules[UPDATE_NB_RULES - i - 1];
+		rules[UPDATE_NB_RULES - i - 1] = tmp;
+	}
+	if (rc != 0) {
+		printf("%s#%i: random update failed with error code: %d\n",
+			__func__, __LINE__, rc);
+		goto end;
+	}
+
+	rc = test_classify_buid(ref, rules, UPDATE_NB_RULES - UPDATE_NB_DEL);
+	if (rc == 0)
+		rc = test_classify_cmp(acx, ref, rules,
+			UPDATE_NB_RULES - UPDATE_NB_DEL);
+
+	/* add the deleted rules back at once */
+	if (rc == 0)
+		rc = update_rules(acx, rules + UPDATE_NB_RULES - UPDATE_NB_DEL,
+			UPDATE_NB_DEL, NULL, 0);
+	if (rc == 0) {
+		rte_acl_reset(ref);
+		rc = test_classify_buid(ref, rules, UPDATE_NB_RULES);
+	}
+	if (rc == 0)
+		rc = test_classify_cmp(acx, ref, rules, UPDATE_NB_RULES);
+
+end:
+	free(rules);
+	rte_acl_free(ref);
+	rte_acl_free(acx);
+	return rc;
+}
+
+#define	BUILD_NB_RULES		0x800
+
+/*
+ * Test build with several threads, over rules spread over several tries:
+ * lookups must give the same results as with a single thread build.
+ */
+static int
+test_build_threads(void)
+{
+	int32_t rc;
+	uint32_t i, n;
+	struct rte_acl_ctx *acx, *ref;
+	struct rte_acl_param prm;
+	struct rte_acl_config cfg;
+	struct rte_acl_build_param bprm;
+	struct rte_acl_ipv4vlan_rule *rules;
+
+	static const uint32_t num_threads[] = {
+		0, 2, 3, 16,
+	};
+
+	rc = -ENOMEM;
+	acx = rte_acl_create(&acl_param);
+	prm = acl_param;
+	prm.name = "acl_ref";
+	ref = rte_acl_create(&prm);
+	rules = malloc(BUILD_NB_RULES * sizeof(rules[0]));
+	if (acx == NULL || ref == NULL || rules == NULL) {
+		printf("%s#%i: Error creating ACL context!\n",
+			__func__, __LINE__);
+		goto end;
+	}
+
+	/* short prefixes make the tries big, so they get split */
+	for (i = 0; i != BUILD_NB_RULES; i++)
+		gen_update_rule(rules + i, i, 0);
+
+	rc = test_classify_buid(ref, rules, BUILD_NB_RULES);
+	if (rc == 0)
+		rc = rte_acl_ipv4vlan_add_rules(acx, rules, BUILD_NB_RULES);
+	if (rc != 0) {
+		printf("%s#%i: adding rules failed with error code: %d\n",
+			__func__, __LINE__, rc);
+		goto end;
+	}
+
+	memset(&cfg, 0, sizeof(cfg));
+	acl_ipv4vlan_config(&cfg, ipv4_7tuple_layout, RTE_ACL_MAX_CATEGORIES);
+
+	if (rte_acl_build_ext(acx, &cfg, NULL) != -EINVAL) {
+		printf("%s#%i: build without parameters should have failed\n",
+			__func__, __LINE__);
+		rc = -EINVAL;
+		goto end;
+	}
+
+	memset(&bprm, 0, sizeof(bprm));
+	for (n = 0; n != RTE_DIM(num_threads) && rc == 0; n++) {
+		bprm.num_threads = num_threads[n];
+		rc = rte_acl_build_ext(acx, &cfg, &bprm);
+		if (rc == 0)
+			rc = test_classify_cmp(acx, ref, rules,
+				BUILD_NB_RULES);
+	}
+	if (rc != 0)
+		printf("%s#%i: build with %u threads failed, error code: %d\n",
+			__func__, __LINE__, num_threads[n - 1], rc);
+
+end:
+	free(rules);
+	rte_acl_free(ref);
+	rte_acl_free(acx);
+	return rc;
+}
+
+/*
+ * Build the same rules within budgets of memory and of node transitions
+ * per packet, checking the budgets that can't be met are reported.
+ */
+static int
+test_build_budget(void)
+{
+	int32_t rc;
+	uint32_t i;
+	struct rte_acl_ctx *acx, *ref;
+	struct rte_acl_param prm;
+	struct rte_acl_config cfg;
+	struct rte_acl_build_param bprm;
+	struct rte_acl_ipv4vlan_rule *rules;
+
+	rc = -ENOMEM;
+	acx = rte_acl_create(&acl_param);
+	prm = acl_param;
+	prm.name = "acl_ref";
+	ref = rte_acl_create(&prm);
+	rules = malloc(BUILD_NB_RULES * sizeof(rules[0]));
+	if (acx == NULL || ref == NULL || rules == NULL) {
+		printf("%s#%i: Error creating ACL context!\n",
+			__func__, __LINE__);
+		goto end;
+	}
+
+	for (i = 0; i != BUILD_NB_RULES; i++)
+		gen_update_rule(rules + i, i, 0);
+
+	rc = test_classify_buid(ref, rules, BUILD_NB_RULES);
+	if (rc == 0)
+		rc = rte_acl_ipv4vlan_add_rules(acx, rules, BUILD_NB_RULES);
+	if (rc != 0) {
+		printf("%s#%i: adding rules failed with error code: %d\n",
+			__func__, __LINE__, rc);
+		goto end;
+	}
+
+	memset(&cfg, 0, sizeof(cfg));
+	acl_ipv4vlan_config(&cfg, ipv4_7tuple_layout, RTE_ACL_MAX_CATEGORIES);
+
+	memset(&bprm, 0, sizeof(bprm));
+
+	/* a lookup goes through more than one node. */
+	bprm.max_trans = 1;
+	rc = rte_acl_build_ext(acx, &cfg, &bprm);
+	if (rc != -ERANGE) {
+		printf("%s#%i: build within %u transitions returned %d\n",
+			__func__, __LINE__, bprm.max_trans, rc);
+		rc = -EINVAL;
+		goto end;
+	}
+
+	/* no split fits in a single byte. */
+	bprm.max_trans = UINT32_MAX;
+	cfg.max_size = 1;
+	rc = rte_acl_build_ext(acx, &cfg, &bprm);
+	if (rc != -ERANGE) {
+		printf("%s#%i: build within %zu bytes returned %d\n",
+			__func__, __LINE__, cfg.max_size, rc);
+		rc = -EINVAL;
+		goto end;
+	}
+
+	/* within the transition budget only, it matches the reference. */
+	cfg.max_size = 0;
+	rc = rte_acl_build_ext(acx, &cfg, &bprm);
+	if (rc == 0)
+		rc = test_classify_cmp(acx, ref, rules, BUILD_NB_RULES);
+	if (rc != 0)
+		printf("%s#%i: build within %u transitions failed, "
+			"error code: %d\n",
+			__func__, __LINE__, bprm.max_trans, rc);
+
+end:
+	free(rules);
+	rte_acl_free(ref);
+	rte_acl_free(acx);
+	return rc;
+}
+
 static int
 test_acl(void)
 {
@@ -1737,6 +2134,12 @@ test_acl(void)
 		return -1;
 	if (test_u32_range() < 0)
 		return -1;
+	if (test_update_rules() < 0)
+		return -1;
+	if (test_build_threads() < 0)
+		return -1;
+	if (test_build_budget() < 0)
+		return -1;
 
 	return 0;
 }
@@ -9,6 +9,9 @@
 
 #include <rte_ip.h>
 #include <rte_log.h>
+#include <rte_malloc.h>
+#include <rte_random.h>
+#include <rte_rcu_qsbr.h>
 #include <rte_fib.h>
 
 #include "test.h"
@@ -21,6 +24,13 @@ static int32_t test_free_null(void);
 static int32_t test_add_del_invalid(void);
 static int32_t test_get_invalid(void);
 static int32_t test_lookup(void);
+static int32_t test_rcu_qsbr_add(void);
+static int32_t test_rcu_qsbr_lookup(void);
+static int32_t test_txn(void);
+static int32_t test_poptrie(void);
+static int32_t test_poptrie_pool(void);
+static int32_t test_poptrie_rcu(void);
+static int32_t test_vrf(void);
 
 #define MAX_ROUTES	(1 << 16)
 #define MAX_TBL8	(1 << 15)
@@ -62,7 +72,20 @@ test_create_invalid(void)
 		"Call succeeded with invalid parameters\n");
 	config.max_routes = MAX_ROUTES;
 
-	config.type = RTE_FIB_DIR24_8 + 1;
+	config.type = RTE_FIB_POPTRIE + 1;
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	config.type = RTE_FIB_POPTRIE;
+	config.poptrie.num_nodes = 0;
+	config.poptrie.num_leaves = MAX_TBL8;
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	config.poptrie.num_nodes = MAX_TBL8;
+	config.poptrie.num_leaves = 0;
 	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
 	RTE_TEST_ASSERT(fib == NULL,
 		"Call succeeded with invalid parameters\n");
@@ -376,6 +399,629 @@ test_lookup(void)
 	return TEST_SUCCESS;
 }
 
+/*
+ * Check that rte_fib_rcu_qsbr_add validates its arguments and
+ * refuses to attach a second QSBR variable
+ */
+int32_t
+test_rcu_qsbr_add(void)
+{
+	struct rte_fib *fib = NULL;
+	struct rte_fib_conf config;
+	struct rte_fib_rcu_config rcu_cfg = {0};
+	struct rte_rcu_qsbr *qsv;
+	size_t sz;
+	int ret;
+
+	sz = rte_rcu_qsbr_get_memsize(RTE_MAX_LCORE);
+	qsv = (struct rte_rcu_qsbr *)rte_zmalloc_socket(NULL, sz,
+		RTE_CACHE_LINE_SIZE, SOCKET_ID_ANY);
+	RTE_TEST_ASSERT(qsv != NULL, "Can not allocate memory for QSBR\n");
+	rte_rcu_qsbr_init(qsv, RTE_MAX_LCORE);
+
+	config.max_routes = MAX_ROUTES;
+	config.rib_ext_sz = 0;
+	config.default_nh = 0;
+	config.type = RTE_FIB_DUMMY;
+
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	rcu_cfg.v = qsv;
+	ret = rte_fib_rcu_qsbr_add(fib, &rcu_cfg);
+	RTE_TEST_ASSERT(ret == -ENOTSUP,
+		"Call succeeded for FIB without tbl8 groups\n");
+	rte_fib_free(fib);
+
+	config.type = RTE_FIB_DIR24_8;
+	config.dir24_8.nh_sz = RTE_FIB_DIR24_8_4B;
+	config.dir24_8.num_tbl8 = MAX_TBL8;
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	/* Invalid QSBR mode */
+	rcu_cfg.mode = 2;
+	ret = rte_fib_rcu_qsbr_add(fib, &rcu_cfg);
+	RTE_TEST_ASSERT(ret == -EINVAL,
+		"Call succeeded with invalid parameters\n");
+
+	/* Missing QSBR variable */
+	rcu_cfg.v = NULL;
+	rcu_cfg.mode = RTE_FIB_QSBR_MODE_DQ;
+	ret = rte_fib_rcu_qsbr_add(fib, &rcu_cfg);
+	RTE_TEST_ASSERT(ret == -EINVAL,
+		"Call succeeded with invalid parameters\n");
+
+	ret = rte_fib_rcu_qsbr_add(NULL, &rcu_cfg);
+	RTE_TEST_ASSERT(ret == -EINVAL,
+		"Call succeeded with invalid parameters\n");
+	ret = rte_fib_rcu_qsbr_add(fib, NULL);
+	RTE_TEST_ASSERT(ret == -EINVAL,
+		"Call succeeded with invalid parameters\n");
+
+	rcu_cfg.v = qsv;
+	ret = rte_fib_rcu_qsbr_add(fib, &rcu_cfg);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add RCU QSBR variable\n");
+
+	/* Attach the QSBR variable again */
+	ret = rte_fib_rcu_qsbr_add(fib, &rcu_cfg);
+	RTE_TEST_ASSERT(ret == -EEXIST,
+		"Call succeeded with already attached QSBR variable\n");
+
+	rte_fib_free(fib);
+	rte_free(qsv);
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Run the lookup checks on a FIB with a QSBR variable attached in
+ * both reclamation modes. The test thread is the only reader and it
+ * stays offline, so every freed tbl8 group is immediately reusable.
+ */
+int32_t
+test_rcu_qsbr_lookup(void)
+{
+	struct rte_fib *fib = NULL;
+	struct rte_fib_conf config;
+	struct rte_fib_rcu_config rcu_cfg = {0};
+	struct rte_rcu_qsbr *qsv;
+	size_t sz;
+	int ret;
+
+	sz = rte_rcu_qsbr_get_memsize(RTE_MAX_LCORE);
+	qsv = (struct rte_rcu_qsbr *)rte_zmalloc_socket(NULL, sz,
+		RTE_CACHE_LINE_SIZE, SOCKET_ID_ANY);
+	RTE_TEST_ASSERT(qsv != NULL, "Can not allocate memory for QSBR\n");
+	rte_rcu_qsbr_init(qsv, RTE_MAX_LCORE);
+
+	config.max_routes = MAX_ROUTES;
+	config.rib_ext_sz = 0;
+	config.default_nh = 100;
+	config.type = RTE_FIB_DIR24_8;
+	config.dir24_8.nh_sz = RTE_FIB_DIR24_8_4B;
+	/* Few tbl8s, so the reclamation path is taken on allocation */
+	config.dir24_8.num_tbl8 = 64;
+
+	rcu_cfg.v = qsv;
+	rcu_cfg.mode = RTE_FIB_QSBR_MODE_SYNC;
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+	ret = rte_fib_rcu_qsbr_add(fib, &rcu_cfg);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add RCU QSBR variable\n");
+	ret = check_fib(fib);
+	RTE_TEST_ASSERT(ret == TEST_SUCCESS,
+		"Check_fib fails for SYNC mode\n");
+	rte_fib_free(fib);
+
+	rcu_cfg.mode = RTE_FIB_QSBR_MODE_DQ;
+	/* Keep the freed groups in the queue until allocation runs dry */
+	rcu_cfg.reclaim_thd = 64;
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+	ret = rte_fib_rcu_qsbr_add(fib, &rcu_cfg);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add RCU QSBR variable\n");
+	ret = check_fib(fib);
+	RTE_TEST_ASSERT(ret == TEST_SUCCESS,
+		"Check_fib fails for DQ mode\n");
+	rte_fib_free(fib);
+
+	rte_free(qsv);
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Check that routes updated in batches give the same lookup results
+ * as the routes updated one by one
+ */
+#define TXN_ROUTES	1000
+#define TXN_LOOKUPS	4096
+
+static int
+txn_check_same(struct rte_fib *fib, struct rte_fib *ref,
+	const uint32_t *ips)
+{
+	uint32_t ip_arr[TXN_LOOKUPS];
+	uint64_t nh_arr[TXN_LOOKUPS], ref_nh_arr[TXN_LOOKUPS];
+	uint32_t i;
+
+	for (i = 0; i < TXN_LOOKUPS; i++) {
+		ip_arr[i] = (i & 1) ? (uint32_t)rte_rand() :
+			ips[rte_rand_max(TXN_ROUTES)] + (rte_rand() & 0xff);
+	}
+	rte_fib_lookup_bulk(fib, ip_arr, nh_arr, TXN_LOOKUPS);
+	rte_fib_lookup_bulk(ref, ip_arr, ref_nh_arr, TXN_LOOKUPS);
+	for (i = 0; i < TXN_LOOKUPS; i++)
+		RTE_TEST_ASSERT(nh_arr[i] == ref_nh_arr[i],
+			"Failed to get proper nexthop\n");
+
+	return TEST_SUCCESS;
+}
+
+int32_t
+test_txn(void)
+{
+	struct rte_fib *fib = NULL, *ref = NULL;
+	struct rte_fib_conf config;
+	uint32_t ips[TXN_ROUTES];
+	uint8_t depths[TXN_ROUTES];
+	unsigned int i;
+	int ret;
+
+	config.max_routes = MAX_ROUTES;
+	config.rib_ext_sz = 0;
+	config.default_nh = 100;
+	config.type = RTE_FIB_DUMMY;
+
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+	ret = rte_fib_txn_begin(fib);
+	RTE_TEST_ASSERT(ret == -ENOTSUP,
+		"Call succeeded for FIB without batched updates\n");
+	rte_fib_free(fib);
+
+	config.type = RTE_FIB_DIR24_8;
+	config.dir24_8.nh_sz = RTE_FIB_DIR24_8_4B;
+	config.dir24_8.num_tbl8 = MAX_TBL8;
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+	ref = rte_fib_create("test_txn_ref", SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(ref != NULL, "Failed to create FIB\n");
+
+	ret = rte_fib_txn_begin(NULL);
+	RTE_TEST_ASSERT(ret == -EINVAL,
+		"Call succeeded with invalid parameters\n");
+	ret = rte_fib_txn_commit(fib);
+	RTE_TEST_ASSERT(ret == -EINVAL,
+		"Call succeeded without a started batch\n");
+	ret = rte_fib_txn_apply(fib, 0, 0);
+	RTE_TEST_ASSERT(ret == -EINVAL,
+		"Call succeeded with invalid parameters\n");
+	ret = rte_fib_txn_apply(fib, 1, 1);
+	RTE_TEST_ASSERT(ret == -EINVAL,
+		"Call succeeded with invalid parameters\n");
+	ret = rte_fib_txn_apply(fib, 0, RTE_FIB_TXN_MAX_PARTS + 1);
+	RTE_TEST_ASSERT(ret == -EINVAL,
+		"Call succeeded with invalid parameters\n");
+
+	/* Load all routes in one batch */
+	ret = rte_fib_txn_begin(fib);
+	RTE_TEST_ASSERT(ret == 0, "Failed to start a batch\n");
+	ret = rte_fib_txn_begin(fib);
+	RTE_TEST_ASSERT(ret == -EBUSY,
+		"Call succeeded with an already started batch\n");
+
+	for (i = 0; i < TXN_ROUTES; i++) {
+		ips[i] = rte_rand();
+		depths[i] = (i % 8 == 0) ? 25 + rte_rand_max(8) :
+			1 + rte_rand_max(24);
+		ret = rte_fib_add(fib, ips[i], depths[i], i);
+		RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+		ret = rte_fib_add(ref, ips[i], depths[i], i);
+		RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+	}
+	ret = rte_fib_txn_commit(fib);
+	RTE_TEST_ASSERT(ret == 0, "Failed to commit a batch\n");
+	ret = txn_check_same(fib, ref, ips);
+	RTE_TEST_ASSERT(ret == TEST_SUCCESS, "Lookup and check fails\n");
+
+	/* Withdraw and re-announce part of the routes, apply in parts */
+	ret = rte_fib_txn_begin(fib);
+	RTE_TEST_ASSERT(ret == 0, "Failed to start a batch\n");
+	for (i = 0; i < TXN_ROUTES; i += 2) {
+		rte_fib_delete(fib, ips[i], depths[i]);
+		rte_fib_delete(ref, ips[i], depths[i]);
+	}
+	for (i = 0; i < TXN_ROUTES; i += 4) {
+		ret = rte_fib_add(fib, ips[i], depths[i], i + 1);
+		RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+		ret = rte_fib_add(ref, ips[i], depths[i], i + 1);
+		RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+	}
+	for (i = 0; i < 3; i++) {
+		ret = rte_fib_txn_apply(fib, i, 3);
+		RTE_TEST_ASSERT(ret == 0, "Failed to apply a batch part\n");
+	}
+	ret = rte_fib_txn_commit(fib);
+	RTE_TEST_ASSERT(ret == 0, "Failed to commit a batch\n");
+	ret = txn_check_same(fib, ref, ips);
+	RTE_TEST_ASSERT(ret == TEST_SUCCESS, "Lookup and check fails\n");
+
+	/* Back to the default next hop everywhere */
+	ret = rte_fib_txn_begin(fib);
+	RTE_TEST_ASSERT(ret == 0, "Failed to start a batch\n");
+	for (i = 0; i < TXN_ROUTES; i++) {
+		rte_fib_delete(fib, ips[i], depths[i]);
+		rte_fib_delete(ref, ips[i], depths[i]);
+	}
+	ret = rte_fib_txn_commit(fib);
+	RTE_TEST_ASSERT(ret == 0, "Failed to commit a batch\n");
+	ret = check_fib(fib);
+	RTE_TEST_ASSERT(ret == TEST_SUCCESS, "Check_fib fails after batch\n");
+
+	rte_fib_free(ref);
+	rte_fib_free(fib);
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Check the Poptrie FIB against a DIR24_8 one holding the same routes,
+ * with every lookup implementation available
+ */
+#define POPTRIE_NUM_NODES	(1 << 14)
+#define POPTRIE_NUM_LEAVES	(1 << 18)
+
+int32_t
+test_poptrie(void)
+{
+	struct rte_fib *fib = NULL, *ref = NULL;
+	struct rte_fib_conf config, ref_config;
+	uint32_t ips[TXN_ROUTES];
+	uint8_t depths[TXN_ROUTES];
+	enum rte_fib_lookup_type types[] = {
+		RTE_FIB_LOOKUP_POPTRIE_SCALAR,
+		RTE_FIB_LOOKUP_POPTRIE_VECTOR_AVX512,
+	};
+	unsigned int i;
+	int ret;
+
+	config.max_routes = MAX_ROUTES;
+	config.rib_ext_sz = 0;
+	config.default_nh = 100;
+	config.type = RTE_FIB_POPTRIE;
+	config.poptrie.num_nodes = POPTRIE_NUM_NODES;
+	config.poptrie.num_leaves = POPTRIE_NUM_LEAVES;
+	ref_config = config;
+	ref_config.type = RTE_FIB_DIR24_8;
+	ref_config.dir24_8.nh_sz = RTE_FIB_DIR24_8_4B;
+	ref_config.dir24_8.num_tbl8 = MAX_TBL8;
+
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+	ref = rte_fib_create("test_poptrie_ref", SOCKET_ID_ANY, &ref_config);
+	RTE_TEST_ASSERT(ref != NULL, "Failed to create FIB\n");
+
+	ret = rte_fib_select_lookup(fib, RTE_FIB_LOOKUP_DIR24_8_SCALAR_MACRO);
+	RTE_TEST_ASSERT(ret == -EINVAL,
+		"Call succeeded with invalid parameters\n");
+
+	for (i = 0; i < RTE_DIM(types); i++) {
+		if (rte_fib_select_lookup(fib, types[i]) != 0)
+			continue;
+		ret = check_fib(fib);
+		RTE_TEST_ASSERT(ret == TEST_SUCCESS,
+			"Check_fib fails for POPTRIE type\n");
+	}
+
+	for (i = 0; i < TXN_ROUTES; i++) {
+		ips[i] = rte_rand();
+		depths[i] = (i % 8 == 0) ? 25 + rte_rand_max(8) :
+			1 + rte_rand_max(24);
+		ret = rte_fib_add(fib, ips[i], depths[i], i);
+		RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+		ret = rte_fib_add(ref, ips[i], depths[i], i);
+		RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+	}
+	for (i = 0; i < RTE_DIM(types); i++) {
+		if (rte_fib_select_lookup(fib, types[i]) != 0)
+			continue;
+		ret = txn_check_same(fib, ref, ips);
+		RTE_TEST_ASSERT(ret == TEST_SUCCESS,
+			"Lookup and check fails\n");
+	}
+
+	for (i = 0; i < TXN_ROUTES; i += 2) {
+		rte_fib_delete(fib, ips[i], depths[i]);
+		rte_fib_delete(ref, ips[i], depths[i]);
+	}
+	for (i = 0; i < TXN_ROUTES; i += 4) {
+		ret = rte_fib_add(fib, ips[i], depths[i], i + 1);
+		RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+		ret = rte_fib_add(ref, ips[i], depths[i], i + 1);
+		RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+	}
+	for (i = 0; i < RTE_DIM(types); i++) {
+		if (rte_fib_select_lookup(fib, types[i]) != 0)
+			continue;
+		ret = txn_check_same(fib, ref, ips);
+		RTE_TEST_ASSERT(ret == TEST_SUCCESS,
+			"Lookup and check fails\n");
+	}
+
+	for (i = 0; i < TXN_ROUTES; i++)
+		rte_fib_delete(fib, ips[i], depths[i]);
+	ret = check_fib(fib);
+	RTE_TEST_ASSERT(ret == TEST_SUCCESS,
+		"Check_fib fails after routes removal\n");
+
+	rte_fib_free(ref);
+	rte_fib_free(fib);
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Check that the leaves freed in blocks of some sizes can be reused for
+ * blocks of other sizes: a /24 at the start of a /22 takes a block of 2
+ * leaves, and a block of 3 in the middle of it.
+ */
+#define POPTRIE_POOL_ROUTES	64
+
+int32_t
+test_poptrie_pool(void)
+{
+	struct rte_fib *fib = NULL;
+	struct rte_fib_conf config;
+	uint64_t nh;
+	uint32_t ip;
+	unsigned int i;
+	int ret;
+
+	config.max_routes = MAX_ROUTES;
+	config.rib_ext_sz = 0;
+	config.default_nh = 100;
+	config.type = RTE_FIB_POPTRIE;
+	/* each route takes 2 nodes, and a leaf in the /16 node */
+	config.poptrie.num_nodes = 2 * POPTRIE_POOL_ROUTES;
+	config.poptrie.num_leaves = 3 * POPTRIE_POOL_ROUTES;
+
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	for (i = 0; i < POPTRIE_POOL_ROUTES; i++) {
+		ip = RTE_IPV4(10, i, 0, 0);
+		ret = rte_fib_add(fib, ip, 24, i);
+		RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+	}
+	ret = rte_fib_add(fib, RTE_IPV4(11, 0, 0, 0), 24, 1);
+	RTE_TEST_ASSERT(ret == -ENOSPC, "Call succeeded with full pools\n");
+	for (i = 0; i < POPTRIE_POOL_ROUTES; i++) {
+		ip = RTE_IPV4(10, i, 0, 0);
+		ret = rte_fib_delete(fib, ip, 24);
+		RTE_TEST_ASSERT(ret == 0, "Failed to delete a route\n");
+	}
+
+	for (i = 0; i < POPTRIE_POOL_ROUTES * 3 / 4; i++) {
+		ip = RTE_IPV4(10, i, 1, 0);
+		ret = rte_fib_add(fib, ip, 24, i);
+		RTE_TEST_ASSERT(ret == 0,
+			"Failed to reuse the freed leaves\n");
+	}
+	for (i = 0; i < POPTRIE_POOL_ROUTES * 3 / 4; i++) {
+		ip = RTE_IPV4(10, i, 1, 1);
+		ret = rte_fib_lookup_bulk(fib, &ip, &nh, 1);
+		RTE_TEST_ASSERT((ret == 0) && (nh == i),
+			"Failed to get proper nexthop\n");
+		ip = RTE_IPV4(10, i, 0, 1);
+		ret = rte_fib_lookup_bulk(fib, &ip, &nh, 1);
+		RTE_TEST_ASSERT((ret == 0) && (nh == config.default_nh),
+			"Failed to get proper nexthop\n");
+	}
+
+	rte_fib_free(fib);
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Run the lookup checks on a Poptrie FIB with a QSBR variable attached in
+ * both reclamation modes, then check that with a defer queue, the subtrees
+ * released while a reader is online are reused only once it reported
+ * a quiescent state.
+ */
+int32_t
+test_poptrie_rcu(void)
+{
+	struct rte_fib *fib = NULL;
+	struct rte_fib_conf config;
+	struct rte_fib_rcu_config rcu_cfg = {0};
+	struct rte_rcu_qsbr *qsv;
+	uint64_t nh;
+	uint32_t ip;
+	unsigned int i;
+	size_t sz;
+	int ret;
+
+	sz = rte_rcu_qsbr_get_memsize(RTE_MAX_LCORE);
+	qsv = (struct rte_rcu_qsbr *)rte_zmalloc_socket(NULL, sz,
+		RTE_CACHE_LINE_SIZE, SOCKET_ID_ANY);
+	RTE_TEST_ASSERT(qsv != NULL, "Can not allocate memory for QSBR\n");
+	rte_rcu_qsbr_init(qsv, RTE_MAX_LCORE);
+
+	config.max_routes = MAX_ROUTES;
+	config.rib_ext_sz = 0;
+	config.default_nh = 100;
+	config.type = RTE_FIB_POPTRIE;
+	config.poptrie.num_nodes = POPTRIE_NUM_NODES;
+	config.poptrie.num_leaves = POPTRIE_NUM_LEAVES;
+
+	rcu_cfg.v = qsv;
+	rcu_cfg.mode = RTE_FIB_QSBR_MODE_SYNC;
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+	ret = rte_fib_rcu_qsbr_add(fib, &rcu_cfg);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add RCU QSBR variable\n");
+	ret = check_fib(fib);
+	RTE_TEST_ASSERT(ret == TEST_SUCCESS,
+		"Check_fib fails for SYNC mode\n");
+	rte_fib_free(fib);
+
+	rcu_cfg.mode = RTE_FIB_QSBR_MODE_DQ;
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+	ret = rte_fib_rcu_qsbr_add(fib, &rcu_cfg);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add RCU QSBR variable\n");
+	ret = check_fib(fib);
+	RTE_TEST_ASSERT(ret == TEST_SUCCESS,
+		"Check_fib fails for DQ mode\n");
+	rte_fib_free(fib);
+
+	/* each route takes 2 nodes, and a leaf in the /16 node */
+	config.poptrie.num_nodes = 2 * POPTRIE_POOL_ROUTES;
+	config.poptrie.num_leaves = 3 * POPTRIE_POOL_ROUTES;
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+	ret = rte_fib_rcu_qsbr_add(fib, &rcu_cfg);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add RCU QSBR variable\n");
+
+	/* A reader online, which did not report a quiescent state */
+	rte_rcu_qsbr_thread_register(qsv, 0);
+	rte_rcu_qsbr_thread_online(qsv, 0);
+
+	for (i = 0; i < POPTRIE_POOL_ROUTES; i++) {
+		ip = RTE_IPV4(10, i, 0, 0);
+		ret = rte_fib_add(fib, ip, 24, i);
+		RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+	}
+	for (i = 0; i < POPTRIE_POOL_ROUTES; i++) {
+		ip = RTE_IPV4(10, i, 0, 0);
+		ret = rte_fib_delete(fib, ip, 24);
+		RTE_TEST_ASSERT(ret == 0, "Failed to delete a route\n");
+	}
+	ip = RTE_IPV4(10, 0, 0, 1);
+	ret = rte_fib_lookup_bulk(fib, &ip, &nh, 1);
+	RTE_TEST_ASSERT((ret == 0) && (nh == config.default_nh),
+		"Failed to get proper nexthop\n");
+
+	ret = rte_fib_add(fib, RTE_IPV4(11, 0, 0, 0), 24, 1);
+	RTE_TEST_ASSERT(ret == -ENOSPC,
+		"Released subtrees reused before the quiescent state\n");
+
+	rte_rcu_qsbr_quiescent(qsv, 0);
+	ret = rte_fib_add(fib, RTE_IPV4(11, 0, 0, 0), 24, 1);
+	RTE_TEST_ASSERT(ret == 0,
+		"Released subtrees not reclaimed after the quiescent state\n");
+	ip = RTE_IPV4(11, 0, 0, 1);
+	ret = rte_fib_lookup_bulk(fib, &ip, &nh, 1);
+	RTE_TEST_ASSERT((ret == 0) && (nh == 1),
+		"Failed to get proper nexthop\n");
+
+	rte_rcu_qsbr_thread_offline(qsv, 0);
+	rte_rcu_qsbr_thread_unregister(qsv, 0);
+	rte_fib_free(fib);
+	rte_free(qsv);
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Check that the routes of the VRFs of a multi VRF FIB are isolated
+ */
+#define VRF_NUM		16
+
+int32_t
+test_vrf(void)
+{
+	struct rte_fib *fib = NULL;
+	struct rte_fib_conf config;
+	uint32_t ip = RTE_IPV4(10, 0, 0, 0);
+	uint32_t ip_arr[VRF_NUM];
+	uint16_t vrf_arr[VRF_NUM];
+	uint64_t nh_arr[VRF_NUM];
+	uint64_t def_nh = 100;
+	unsigned int i;
+	int ret;
+
+	config.max_routes = MAX_ROUTES;
+	config.rib_ext_sz = 0;
+	config.default_nh = def_nh;
+	config.type = RTE_FIB_DIR24_8;
+	config.dir24_8.nh_sz = RTE_FIB_DIR24_8_4B;
+	config.dir24_8.num_tbl8 = MAX_TBL8;
+
+	fib = rte_fib_vrf_create(__func__, SOCKET_ID_ANY, &config, VRF_NUM);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded for FIB type without VRFs\n");
+
+	config.type = RTE_FIB_POPTRIE;
+	config.poptrie.num_nodes = POPTRIE_NUM_NODES;
+	config.poptrie.num_leaves = POPTRIE_NUM_LEAVES;
+	fib = rte_fib_vrf_create(__func__, SOCKET_ID_ANY, &config,
+		RTE_FIB_MAX_VRFS + 1);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	fib = rte_fib_vrf_create(__func__, SOCKET_ID_ANY, &config, VRF_NUM);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+	RTE_TEST_ASSERT(rte_fib_get_rib(fib) == NULL,
+		"Got an IPv4 RIB for multi VRF FIB\n");
+
+	ret = rte_fib_vrf_add(fib, VRF_NUM, ip, 24, 1);
+	RTE_TEST_ASSERT(ret == -EINVAL,
+		"Call succeeded with invalid parameters\n");
+
+	for (i = 0; i < VRF_NUM; i++) {
+		ret = rte_fib_vrf_add(fib, i, ip, 8 + i, i);
+		RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+		vrf_arr[i] = i;
+		ip_arr[i] = ip + i;
+	}
+	ret = rte_fib_vrf_lookup_bulk(fib, vrf_arr, ip_arr, nh_arr, VRF_NUM);
+	RTE_TEST_ASSERT(ret == 0, "Failed to lookup\n");
+	for (i = 0; i < VRF_NUM; i++)
+		RTE_TEST_ASSERT(nh_arr[i] == i,
+			"Failed to get proper nexthop\n");
+
+	/* Withdraw the routes of the odd VRFs */
+	for (i = 1; i < VRF_NUM; i += 2) {
+		ret = rte_fib_vrf_delete(fib, i, ip, 8 + i);
+		RTE_TEST_ASSERT(ret == 0, "Failed to delete a route\n");
+	}
+	ret = rte_fib_vrf_lookup_bulk(fib, vrf_arr, ip_arr, nh_arr, VRF_NUM);
+	RTE_TEST_ASSERT(ret == 0, "Failed to lookup\n");
+	for (i = 0; i < VRF_NUM; i++)
+		RTE_TEST_ASSERT(nh_arr[i] == ((i & 1) ? def_nh : i),
+			"Failed to get proper nexthop\n");
+
+	for (i = 0; i < VRF_NUM; i += 2) {
+		ret = rte_fib_vrf_delete(fib, i, ip, 8 + i);
+		RTE_TEST_ASSERT(ret == 0, "Failed to delete a route\n");
+	}
+
+	/* The single VRF API works on the VRF 0 */
+	ret = check_fib(fib);
+	RTE_TEST_ASSERT(ret == TEST_SUCCESS,
+		"Check_fib fails for multi VRF FIB\n");
+	rte_fib_free(fib);
+
+	/* No VRF count creates a single VRF FIB */
+	fib = rte_fib_vrf_create(__func__, SOCKET_ID_ANY, &config, 0);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+	RTE_TEST_ASSERT(rte_fib_get_rib(fib) != NULL,
+		"Failed to get the RIB of single VRF FIB\n");
+	ret = rte_fib_vrf_lookup_bulk(fib, vrf_arr, ip_arr, nh_arr, VRF_NUM);
+	RTE_TEST_ASSERT(ret == -ENOTSUP,
+		"Call succeeded for single VRF FIB\n");
+	ret = rte_fib_vrf_add(fib, 1, ip, 24, 1);
+	RTE_TEST_ASSERT(ret == -EINVAL,
+		"Call succeeded with invalid parameters\n");
+	rte_fib_free(fib);
+
+	return TEST_SUCCESS;
+}
+
 static struct unit_test_suite fib_fast_tests = {
 	.suite_name = "fib autotest",
 	.setup = NULL,
@@ -386,6 +1032,13 @@ static struct unit_test_suite fib_fast_tests = {
 	TEST_CASE(test_add_del_invalid),
 	TEST_CASE(test_get_invalid),
 	TEST_CASE(test_lookup),
+	TEST_CASE(test_rcu_qsbr_add),
+	TEST_CASE(test_rcu_qsbr_lookup),
+	TEST_CASE(test_txn),
+	TEST_CASE(test_poptrie),
+	TEST_CASE(test_poptrie_pool),
+	TEST_CASE(test_poptrie_rcu),
+	TEST_CASE(test_vrf),
 	TEST_CASES_END()
 	}
 };
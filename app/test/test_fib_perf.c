@@ -11,7 +11,12 @@
 #include <rte_cycles.h>
 #include <rte_random.h>
 #include <rte_branch_prediction.h>
+#include <rte_errno.h>
 #include <rte_ip.h>
+#include <rte_malloc.h>
+#include <rte_lcore.h>
+#include <rte_launch.h>
+#include <rte_rcu_qsbr.h>
 #include <rte_fib.h>
 
 #include "test.h"
@@ -30,6 +35,17 @@
 
 #define MAX_RULE_NUM (1200000)
 
+/* Route updates per second issued by the writer in the RCU test */
+#define RCU_UPDATE_RATE 100000
+/* Number of add + delete passes over the churned routes */
+#define RCU_ITERATIONS 5
+/* Max number of depth > 24 routes churned by the writer */
+#define RCU_MAX_CHURN_ROUTES 50000
+
+/* Poptrie pools shared by all the VRFs in the multi VRF test */
+#define VRF_NUM_NODES (1 << 21)
+#define VRF_NUM_LEAVES (1 << 24)
+
 struct route_rule {
 	uint32_t ip;
 	uint8_t depth;
@@ -316,6 +332,290 @@ print_route_distribution(const struct route_rule *table, uint32_t n)
 	printf("\n");
 }
 
+static struct rte_fib *rcu_fib;
+static struct rte_rcu_qsbr *rv;
+static volatile uint8_t writer_done;
+static uint64_t greader_cycles;
+static uint64_t greader_lookups;
+/* Indexes in large_route_table of the routes churned by the writer */
+static uint32_t churn_idx[RCU_MAX_CHURN_ROUTES];
+static uint32_t num_churn_routes;
+
+/*
+ * Reader thread doing bulk lookups, reporting its quiescent state
+ * after each batch.
+ */
+static int
+test_fib_rcu_qsbr_reader(void *arg)
+{
+	unsigned int i;
+	unsigned int lcore_id = rte_lcore_id();
+	uint32_t ip_batch[BATCH_SIZE];
+	uint64_t next_hops[BULK_SIZE];
+	uint64_t begin, cycles = 0, lookups = 0;
+
+	RTE_SET_USED(arg);
+	/* Register this thread to report quiescent state */
+	rte_rcu_qsbr_thread_register(rv, lcore_id);
+	rte_rcu_qsbr_thread_online(rv, lcore_id);
+
+	do {
+		for (i = 0; i < BATCH_SIZE; i++)
+			ip_batch[i] = rte_rand();
+
+		begin = rte_rdtsc();
+		for (i = 0; i < BATCH_SIZE; i += BULK_SIZE)
+			rte_fib_lookup_bulk(rcu_fib, &ip_batch[i], next_hops,
+				BULK_SIZE);
+		cycles += rte_rdtsc() - begin;
+		lookups += BATCH_SIZE;
+
+		/* Update quiescent state */
+		rte_rcu_qsbr_quiescent(rv, lcore_id);
+	} while (!writer_done);
+
+	rte_rcu_qsbr_thread_offline(rv, lcore_id);
+	rte_rcu_qsbr_thread_unregister(rv, lcore_id);
+
+	__atomic_fetch_add(&greader_cycles, cycles, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&greader_lookups, lookups, __ATOMIC_RELAXED);
+
+	return 0;
+}
+
+/*
+ * Writer adding and deleting the churned routes at RCU_UPDATE_RATE,
+ * so that tbl8 groups are constantly freed and reused under the readers.
+ */
+static int
+test_fib_rcu_qsbr_writer(uint64_t *updates)
+{
+	const struct route_rule *r;
+	uint64_t next, period;
+	uint64_t next_hop_add = 0xAA;
+	unsigned int i, j;
+
+	period = rte_get_tsc_hz() / RCU_UPDATE_RATE;
+	next = rte_rdtsc();
+	*updates = 0;
+
+	for (i = 0; i < RCU_ITERATIONS; i++) {
+		for (j = 0; j < num_churn_routes; j++) {
+			r = &large_route_table[churn_idx[j]];
+			while (rte_rdtsc() < next)
+				rte_pause();
+			next += period;
+			if (rte_fib_add(rcu_fib, r->ip, r->depth,
+					next_hop_add) != 0) {
+				printf("Failed to add iteration %u, route# %u\n",
+					i, j);
+				return -1;
+			}
+		}
+		for (j = 0; j < num_churn_routes; j++) {
+			r = &large_route_table[churn_idx[j]];
+			while (rte_rdtsc() < next)
+				rte_pause();
+			next += period;
+			if (rte_fib_delete(rcu_fib, r->ip, r->depth) != 0) {
+				printf("Failed to delete iteration %u, route# %u\n",
+					i, j);
+				return -1;
+			}
+		}
+		*updates += 2 * num_churn_routes;
+	}
+
+	return 0;
+}
+
+/*
+ * Lookups on all worker lcores while the main lcore churns the
+ * depth > 24 routes, with tbl8 groups recycled through an RCU
+ * defer queue.
+ */
+static int
+test_fib_rcu_perf(struct rte_fib_conf *config)
+{
+	struct rte_fib_rcu_config rcu_cfg = {0};
+	uint64_t begin, total_cycles, updates;
+	unsigned int i, core_id, num_readers;
+	uint32_t next_hop_add = 0xAA;
+	size_t sz;
+	int ret = -1;
+
+	num_readers = rte_lcore_count() - 1;
+	if (num_readers == 0) {
+		printf("Not enough cores for the FIB RCU test, expecting at least 2\n");
+		return 0;
+	}
+
+	/* Keep the shallow routes static, churn the ones using tbl8s */
+	rcu_fib = rte_fib_create("fib_rcu_perf", SOCKET_ID_ANY, config);
+	TEST_FIB_ASSERT(rcu_fib != NULL);
+
+	num_churn_routes = 0;
+	for (i = 0; i < NUM_ROUTE_ENTRIES; i++) {
+		if (large_route_table[i].depth > 24) {
+			if (num_churn_routes < RCU_MAX_CHURN_ROUTES)
+				churn_idx[num_churn_routes++] = i;
+			continue;
+		}
+		rte_fib_add(rcu_fib, large_route_table[i].ip,
+			large_route_table[i].depth, next_hop_add);
+	}
+
+	sz = rte_rcu_qsbr_get_memsize(RTE_MAX_LCORE);
+	rv = (struct rte_rcu_qsbr *)rte_zmalloc_socket(NULL, sz,
+		RTE_CACHE_LINE_SIZE, SOCKET_ID_ANY);
+	if (rv == NULL) {
+		printf("Can not allocate memory for QSBR\n");
+		goto error;
+	}
+	rte_rcu_qsbr_init(rv, RTE_MAX_LCORE);
+
+	rcu_cfg.v = rv;
+	rcu_cfg.mode = RTE_FIB_QSBR_MODE_DQ;
+	if (rte_fib_rcu_qsbr_add(rcu_fib, &rcu_cfg) != 0) {
+		printf("RCU variable assignment failed\n");
+		goto error;
+	}
+
+	printf("\nPerf test: %u readers, 1 writer churning %u routes at %u updates/s\n",
+		num_readers, num_churn_routes, RCU_UPDATE_RATE);
+
+	writer_done = 0;
+	__atomic_store_n(&greader_cycles, 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&greader_lookups, 0, __ATOMIC_RELAXED);
+
+	RTE_LCORE_FOREACH_WORKER(core_id)
+		rte_eal_remote_launch(test_fib_rcu_qsbr_reader, NULL, core_id);
+
+	begin = rte_rdtsc_precise();
+	ret = test_fib_rcu_qsbr_writer(&updates);
+	total_cycles = rte_rdtsc_precise() - begin;
+
+	writer_done = 1;
+	rte_eal_mp_wait_lcore();
+
+	if (ret != 0)
+		goto error;
+
+	printf("Achieved update rate: %.0f updates/s\n",
+		(double)updates * rte_get_tsc_hz() / total_cycles);
+	printf("Average reader lookup: %.1f cycles, %.1f Mlookups/s per reader\n",
+		(double)greader_cycles / greader_lookups,
+		(double)greader_lookups / num_readers /
+		((double)total_cycles / rte_get_tsc_hz()) / 1E6);
+
+error:
+	rte_fib_free(rcu_fib);
+	rte_free(rv);
+
+	return ret;
+}
+
+/* Sum of the memory allocated from the heaps of all the sockets */
+static size_t
+get_heap_alloc_sz(void)
+{
+	struct rte_malloc_socket_stats stats;
+	size_t sz = 0;
+	unsigned int i;
+
+	for (i = 0; i < rte_socket_count(); i++) {
+		if (rte_malloc_get_socket_stats(rte_socket_id_by_idx(i),
+				&stats) == 0)
+			sz += stats.heap_allocsz_bytes;
+	}
+
+	return sz;
+}
+
+/*
+ * Lookups in one multi VRF FIB holding the routes spread over num_vrfs VRFs,
+ * each lookup being done in a random VRF.
+ */
+static int
+test_fib_vrf_perf(uint32_t num_vrfs)
+{
+	struct rte_fib *fib = NULL;
+	struct rte_fib_conf config;
+	uint64_t begin, total_time;
+	size_t mem;
+	unsigned int i, j;
+	uint32_t next_hop_add = 0xAA;
+	int status = 0;
+	int64_t count = 0;
+
+	config.max_routes = NUM_ROUTE_ENTRIES;
+	config.rib_ext_sz = 0;
+	config.type = RTE_FIB_POPTRIE;
+	config.default_nh = 0;
+	config.poptrie.num_nodes = VRF_NUM_NODES;
+	config.poptrie.num_leaves = VRF_NUM_LEAVES;
+
+	mem = get_heap_alloc_sz();
+	fib = rte_fib_vrf_create(__func__, SOCKET_ID_ANY, &config, num_vrfs);
+	if (fib == NULL) {
+		printf("Can not create FIB with %u VRFs, err %d, skipped\n",
+			num_vrfs, rte_errno);
+		return TEST_SKIPPED;
+	}
+	mem = get_heap_alloc_sz() - mem;
+
+	begin = rte_rdtsc();
+	for (i = 0; i < NUM_ROUTE_ENTRIES; i++) {
+		if (rte_fib_vrf_add(fib, i % num_vrfs, large_route_table[i].ip,
+				large_route_table[i].depth, next_hop_add) == 0)
+			status++;
+	}
+	total_time = rte_rdtsc() - begin;
+
+	printf("\n%u VRFs, %zu KB\n", num_vrfs, mem >> 10);
+	printf("Unique added entries = %d\n", status);
+	printf("Average FIB Add: %g cycles\n",
+			(double)total_time / NUM_ROUTE_ENTRIES);
+
+	total_time = 0;
+	for (i = 0; i < ITERATIONS; i++) {
+		static uint32_t ip_batch[BATCH_SIZE];
+		static uint16_t vrf_batch[BATCH_SIZE];
+		uint64_t next_hops[BULK_SIZE];
+
+		for (j = 0; j < BATCH_SIZE; j++) {
+			ip_batch[j] = rte_rand();
+			vrf_batch[j] = rte_rand_max(num_vrfs);
+		}
+
+		begin = rte_rdtsc();
+		for (j = 0; j < BATCH_SIZE; j += BULK_SIZE) {
+			uint32_t k;
+			if (num_vrfs == 1)
+				rte_fib_lookup_bulk(fib, &ip_batch[j],
+					next_hops, BULK_SIZE);
+			else
+				rte_fib_vrf_lookup_bulk(fib, &vrf_batch[j],
+					&ip_batch[j], next_hops, BULK_SIZE);
+			for (k = 0; k < BULK_SIZE; k++)
+				if (unlikely(!(next_hops[k] != 0)))
+					count++;
+		}
+
+		total_time += rte_rdtsc() - begin;
+	}
+	printf("BULK FIB Lookup: %.1f cycles, %.1f Mlookups/s "
+		"(fails = %.1f%%)\n",
+		(double)total_time / ((double)ITERATIONS * BATCH_SIZE),
+		(double)ITERATIONS * BATCH_SIZE * rte_get_tsc_hz() /
+		total_time / 1E6,
+		(count * 100.0) / (double)(ITERATIONS * BATCH_SIZE));
+
+	rte_fib_free(fib);
+
+	return 0;
+}
+
 static int
 test_fib_perf(void)
 {
@@ -331,7 +631,8 @@ test_fib_perf(void)
 	uint64_t begin, total_time;
 	unsigned int i, j;
 	uint32_t next_hop_add = 0xAA;
-	int status = 0;
+	uint32_t vrf_nums[] = {1, 64, 4096};
+	int status = 0, skipped = 0;
 	int64_t count = 0;
 
 	rte_srand(rte_rdtsc());
@@ -406,7 +707,19 @@ test_fib_perf(void)
 
 	rte_fib_free(fib);
 
-	return 0;
+	status = test_fib_rcu_perf(&config);
+	if (status != 0)
+		return status;
+
+	for (i = 0; i < RTE_DIM(vrf_nums); i++) {
+		status = test_fib_vrf_perf(vrf_nums[i]);
+		if (status == TEST_SKIPPED)
+			skipped = 1;
+		else if (status != 0)
+			return status;
+	}
+
+	return skipped ? TEST_SKIPPED : 0;
 }
 
 REGISTER_TEST_COMMAND(fib_perf_autotest, test_fib_perf);
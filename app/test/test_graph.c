@@ -8,6 +8,7 @@
 #include <string.h>
 #include <unistd.h>
 
+#include <rte_cycles.h>
 #include <rte_errno.h>
 #include <rte_graph.h>
 #include <rte_graph_worker.h>
@@ -771,6 +772,278 @@ test_print_stats(void)
 	return 0;
 }
 
+static int hist_stats_rc;
+
+static int
+graph_cluster_stats_hist_cb_t(bool is_first, bool is_last, void *cookie,
+			      const struct rte_graph_cluster_node_stats *st)
+{
+	uint64_t objs_calls = 0, cycles_calls = 0;
+	uint64_t calls = st->calls - st->prev_calls;
+	int i;
+
+	RTE_SET_USED(is_first);
+	RTE_SET_USED(is_last);
+	RTE_SET_USED(cookie);
+
+	for (i = 0; i < RTE_GRAPH_HIST_OBJS_BUCKETS; i++)
+		objs_calls += st->hist_objs[i];
+	for (i = 0; i < RTE_GRAPH_HIST_CYCLES_BUCKETS; i++)
+		cycles_calls += st->hist_cycles[i];
+
+	/* Histograms only count the calls made since they were enabled */
+	if (objs_calls != calls) {
+		hist_stats_rc = -1;
+		printf("Hist call miss match for node = %s expected = %"PRId64", got = %"PRId64"\n",
+		       st->name, calls, objs_calls);
+		return -1;
+	}
+
+	/* Calls without objects have no cycles/obj sample */
+	if (cycles_calls != calls - st->hist_objs[0]) {
+		hist_stats_rc = -1;
+		printf("Hist cycles miss match for node = %s expected = %"PRId64", got = %"PRId64"\n",
+		       st->name, calls - st->hist_objs[0],
+		       cycles_calls);
+		return -1;
+	}
+
+	return 0;
+}
+
+static int
+test_graph_stats_hist(void)
+{
+	struct rte_graph *graph = rte_graph_lookup("worker0");
+	struct rte_graph_cluster_stats_param s_param;
+	struct rte_graph_cluster_stats *stats;
+	const char *pattern = "worker0";
+	int i, rc;
+
+	if (!rte_graph_has_stats_feature()) {
+		if (rte_graph_stats_hist_enable(graph_id, true) != -ENOTSUP) {
+			printf("Hist enable must fail without stats feature\n");
+			return -1;
+		}
+		return 0;
+	}
+
+	if (!graph) {
+		printf("Graph lookup failed\n");
+		return -1;
+	}
+
+	if (rte_graph_stats_hist_enable(RTE_GRAPH_ID_INVALID, true) != -EINVAL) {
+		printf("Hist enable on invalid graph must fail\n");
+		return -1;
+	}
+
+	memset(&s_param, 0, sizeof(s_param));
+	s_param.f = stdout;
+	s_param.socket_id = SOCKET_ID_ANY;
+	s_param.graph_patterns = &pattern;
+	s_param.nb_graph_patterns = 1;
+	s_param.fn = graph_cluster_stats_hist_cb_t;
+
+	stats = rte_graph_cluster_stats_create(&s_param);
+	if (stats == NULL) {
+		printf("Unable to get stats\n");
+		return -1;
+	}
+
+	/* Snapshot the counters preceding the histograms */
+	rte_graph_cluster_stats_get(stats, 1);
+	rc = rte_graph_stats_hist_enable(graph_id, true);
+	if (rc) {
+		printf("Unable to enable hist, rc = %d\n", rc);
+		goto destroy;
+	}
+
+	for (i = 0; i < 5; i++)
+		rte_graph_walk(graph);
+
+	hist_stats_rc = 0;
+	rte_graph_cluster_stats_get(stats, 0);
+	rc = hist_stats_rc;
+	rte_graph_stats_hist_enable(graph_id, false);
+destroy:
+	rte_graph_cluster_stats_destroy(stats);
+
+	return rc;
+}
+
+static int
+test_node_coalesce(void)
+{
+	struct rte_node *node;
+
+	if (rte_node_coalesce_set("test_node_source1", 1, 0) != -EINVAL) {
+		printf("Source node coalescing must fail\n");
+		return -1;
+	}
+
+	if (rte_node_coalesce_set("test_node00",
+				  RTE_GRAPH_BURST_SIZE + 1, 0) != -EINVAL) {
+		printf("Coalescing over burst size must fail\n");
+		return -1;
+	}
+
+	if (rte_node_coalesce_set("test_node00", RTE_GRAPH_BURST_SIZE, 100)) {
+		printf("Failed to set coalescing policy\n");
+		return -1;
+	}
+
+	node = rte_graph_node_get_by_name("worker0", "test_node00");
+	if (node == NULL || node->coalesce_objs != RTE_GRAPH_BURST_SIZE ||
+	    node->coalesce_cycles != 100 ||
+	    !rte_graph_lookup("worker0")->coalesce) {
+		printf("Coalescing policy not applied to graph\n");
+		return -1;
+	}
+
+	if (rte_node_coalesce_set("test_node00", 0, 0) ||
+	    node->coalesce_objs != 0 || rte_graph_lookup("worker0")->coalesce) {
+		printf("Coalescing policy not removed from graph\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+/* Objects enqueued per walk by the coalescing test source node */
+#define COALESCE_SRC_OBJS 4
+
+static uint64_t coalesce_src_objs;
+static uint64_t coalesce_snk_objs;
+static uint64_t coalesce_snk_calls;
+static uint16_t coalesce_snk_last;
+
+static uint16_t
+test_coalesce_source(struct rte_graph *graph, struct rte_node *node,
+		     void **objs, uint16_t nb_objs)
+{
+	RTE_SET_USED(objs);
+	RTE_SET_USED(nb_objs);
+
+	rte_node_enqueue(graph, node, 0, mbuf_p[0], COALESCE_SRC_OBJS);
+	coalesce_src_objs += COALESCE_SRC_OBJS;
+	return COALESCE_SRC_OBJS;
+}
+
+static struct rte_node_register test_coalesce_source_node = {
+	.name = "test_coalesce_source",
+	.process = test_coalesce_source,
+	.flags = RTE_NODE_SOURCE_F,
+	.nb_edges = 1,
+	.next_nodes = {"test_coalesce_sink"},
+};
+RTE_NODE_REGISTER(test_coalesce_source_node);
+
+static uint16_t
+test_coalesce_sink(struct rte_graph *graph, struct rte_node *node,
+		   void **objs, uint16_t nb_objs)
+{
+	RTE_SET_USED(graph);
+	RTE_SET_USED(node);
+	RTE_SET_USED(objs);
+
+	coalesce_snk_objs += nb_objs;
+	coalesce_snk_calls++;
+	coalesce_snk_last = nb_objs;
+	return nb_objs;
+}
+
+static struct rte_node_register test_coalesce_sink_node = {
+	.name = "test_coalesce_sink",
+	.process = test_coalesce_sink,
+};
+RTE_NODE_REGISTER(test_coalesce_sink_node);
+
+static int
+test_node_coalesce_walk(void)
+{
+	static const char *patterns[] = {
+		"test_coalesce_source", "test_coalesce_sink",
+	};
+	struct rte_graph_param gconf = {
+		.socket_id = SOCKET_ID_ANY,
+		.nb_node_patterns = RTE_DIM(patterns),
+		.node_patterns = patterns,
+	};
+	struct rte_graph *graph;
+	rte_graph_t id;
+	int rc = -1;
+	int i;
+
+	id = rte_graph_create("coalesce", &gconf);
+	if (id == RTE_GRAPH_ID_INVALID) {
+		printf("Coalescing graph creation failed\n");
+		return -1;
+	}
+	graph = rte_graph_lookup("coalesce");
+
+	/* Deferred until 4 walks have accumulated the objects */
+	if (rte_node_coalesce_set("test_coalesce_sink", 4 * COALESCE_SRC_OBJS,
+				  UINT64_MAX))
+		goto destroy;
+
+	for (i = 0; i < 3; i++)
+		rte_graph_walk(graph);
+	if (coalesce_snk_calls != 0) {
+		printf("Coalesced stream not deferred\n");
+		goto destroy;
+	}
+
+	rte_graph_walk(graph);
+	if (coalesce_snk_calls != 1 ||
+	    coalesce_snk_last != 4 * COALESCE_SRC_OBJS) {
+		printf("Coalesced stream not processed at %u objs\n",
+		       4 * COALESCE_SRC_OBJS);
+		goto destroy;
+	}
+
+	/* Deferred until the budget of 1 ms expires */
+	if (rte_node_coalesce_set("test_coalesce_sink", RTE_GRAPH_BURST_SIZE,
+				  rte_get_tsc_hz() / 1000))
+		goto destroy;
+
+	rte_graph_walk(graph);
+	if (coalesce_snk_calls != 1) {
+		printf("Coalesced stream not deferred within budget\n");
+		goto destroy;
+	}
+
+	rte_delay_ms(2);
+	rte_graph_walk(graph);
+	if (coalesce_snk_calls != 2 ||
+	    coalesce_snk_last != 2 * COALESCE_SRC_OBJS) {
+		printf("Coalesced stream not processed on budget expiry\n");
+		goto destroy;
+	}
+
+	/* Processed on every walk without the policy */
+	if (rte_node_coalesce_set("test_coalesce_sink", 0, 0))
+		goto destroy;
+
+	rte_graph_walk(graph);
+	if (coalesce_snk_calls != 3 || coalesce_snk_last != COALESCE_SRC_OBJS) {
+		printf("Stream not processed without coalescing policy\n");
+		goto destroy;
+	}
+
+	if (coalesce_snk_objs != coalesce_src_objs) {
+		printf("Coalescing lost objects, %" PRIu64 " of %" PRIu64 "\n",
+		       coalesce_snk_objs, coalesce_src_objs);
+		goto destroy;
+	}
+	rc = 0;
+
+destroy:
+	rte_node_coalesce_set("test_coalesce_sink", 0, 0);
+	rte_graph_destroy(id);
+	return rc;
+}
+
 static int
 graph_setup(void)
 {
@@ -822,6 +1095,9 @@ static struct unit_test_suite graph_testsuite = {
 		TEST_CASE(test_graph_lookup_functions),
 		TEST_CASE(test_graph_walk),
 		TEST_CASE(test_print_stats),
+		TEST_CASE(test_graph_stats_hist),
+		TEST_CASE(test_node_coalesce),
+		TEST_CASE(test_node_coalesce_walk),
 		TEST_CASES_END(), /**< NULL terminate unit test array */
 	},
 };
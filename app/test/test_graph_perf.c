@@ -4,16 +4,20 @@
 #include <inttypes.h>
 #include <signal.h>
 #include <stdio.h>
+#include <string.h>
 #include <unistd.h>
 
 #include <rte_common.h>
 #include <rte_cycles.h>
 #include <rte_errno.h>
+#include <rte_ether.h>
 #include <rte_graph.h>
 #include <rte_graph_worker.h>
+#include <rte_ip.h>
 #include <rte_lcore.h>
 #include <rte_malloc.h>
 #include <rte_mbuf.h>
+#include <rte_node_ip6_api.h>
 
 #include "test.h"
 
@@ -22,6 +26,15 @@
 #define TEST_GRAPH_SRC_BRST_ONE_NAME "test_graph_perf_source_one"
 #define TEST_GRAPH_WRK_NAME	     "test_graph_perf_worker"
 #define TEST_GRAPH_SNK_NAME	     "test_graph_perf_sink"
+#define TEST_GRAPH_IP6_SRC_NAME	     "test_graph_perf_ip6_source"
+
+/* 2001:db8:0:X::/64 routes, X == TEST_GRAPH_IP6_ROUTES has no route */
+#define TEST_GRAPH_IP6_ROUTES	     8
+#define TEST_GRAPH_IP6_NB_MBUFS	     8192
+
+/* Coalescing policy of the worker and sink nodes */
+#define TEST_GRAPH_COALESCE_OBJS     (RTE_GRAPH_BURST_SIZE / 4)
+#define TEST_GRAPH_COALESCE_US	     20
 
 #define SOURCES(map)	     RTE_DIM(map)
 #define STAGES(map)	     RTE_DIM(map)
@@ -39,13 +52,16 @@ struct test_node_data {
 
 struct test_graph_perf {
 	uint16_t nb_nodes;
+	uint32_t nb_stages;
 	rte_graph_t graph_id;
 	struct test_node_data *node_data;
+	struct rte_mempool *mp;
 };
 
 struct graph_lcore_data {
 	uint8_t done;
 	rte_graph_t graph_id;
+	uint32_t lcore_id;
 };
 
 static struct test_node_data *
@@ -235,6 +251,74 @@ static struct rte_node_register test_graph_perf_sink = {
 
 RTE_NODE_REGISTER(test_graph_perf_sink);
 
+static const uint8_t test_graph_ip6_dst[] = {
+	0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1
+};
+
+static int
+test_node_ip6_source_init(const struct rte_graph *graph, struct rte_node *node)
+{
+	struct test_graph_perf *graph_data;
+	const struct rte_memzone *mz;
+
+	RTE_SET_USED(graph);
+
+	mz = rte_memzone_lookup(TEST_GRAPH_PERF_MZ);
+	if (mz == NULL)
+		return -ENOMEM;
+	graph_data = mz->addr;
+	*(struct rte_mempool **)node->ctx = graph_data->mp;
+
+	return 0;
+}
+
+/* IPv6 source node function, spreading packets over the routes */
+static uint16_t
+test_perf_node_ip6_source(struct rte_graph *graph, struct rte_node *node,
+			  void **objs, uint16_t nb_objs)
+{
+	struct rte_mempool *mp = *(struct rte_mempool **)node->ctx;
+	struct rte_ipv6_hdr *ip6;
+	struct rte_mbuf **pkts;
+	uint16_t i;
+
+	RTE_SET_USED(objs);
+	RTE_SET_USED(nb_objs);
+
+	pkts = (struct rte_mbuf **)rte_node_next_stream_get(
+		graph, node, 0, RTE_GRAPH_BURST_SIZE);
+	if (rte_pktmbuf_alloc_bulk(mp, pkts, RTE_GRAPH_BURST_SIZE) < 0)
+		return 0;
+
+	for (i = 0; i < RTE_GRAPH_BURST_SIZE; i++) {
+		ip6 = rte_pktmbuf_mtod_offset(pkts[i], struct rte_ipv6_hdr *,
+					      sizeof(struct rte_ether_hdr));
+		memcpy(ip6->dst_addr, test_graph_ip6_dst, sizeof(ip6->dst_addr));
+		ip6->dst_addr[7] = i % (TEST_GRAPH_IP6_ROUTES + 1);
+		ip6->hop_limits = 64;
+		pkts[i]->packet_type = RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV6;
+		pkts[i]->data_len = sizeof(struct rte_ether_hdr) +
+				    sizeof(struct rte_ipv6_hdr);
+		pkts[i]->pkt_len = pkts[i]->data_len;
+	}
+	rte_node_next_stream_put(graph, node, 0, RTE_GRAPH_BURST_SIZE);
+
+	return RTE_GRAPH_BURST_SIZE;
+}
+
+static struct rte_node_register test_graph_perf_ip6_source = {
+	.name = TEST_GRAPH_IP6_SRC_NAME,
+	.process = test_perf_node_ip6_source,
+	.flags = RTE_NODE_SOURCE_F,
+	.init = test_node_ip6_source_init,
+	.nb_edges = 1,
+	.next_nodes = {
+		[0] = "ip6_lookup",
+	},
+};
+
+RTE_NODE_REGISTER(test_graph_perf_ip6_source);
+
 static int
 graph_perf_setup(void)
 {
@@ -334,6 +418,8 @@ graph_init(const char *gname, uint8_t nb_srcs, uint8_t nb_sinks,
 
 	graph_data = mz->addr;
 	graph_data->nb_nodes = 0;
+	graph_data->nb_stages = stages;
+	graph_data->mp = NULL;
 	graph_data->node_data =
 		malloc(sizeof(struct test_node_data) *
 		       (nb_srcs + nb_sinks + stages * nodes_per_stage));
@@ -614,34 +700,50 @@ _graph_perf_wrapper(void *args)
 	return 0;
 }
 
+/* Walk graph_ids[i] on the (i + 1)th worker lcore */
 static int
-measure_perf_get(rte_graph_t graph_id)
+measure_perf_get(const rte_graph_t *graph_ids, uint16_t nb_graphs)
 {
-	const char *pattern = rte_graph_id_to_name(graph_id);
-	uint32_t lcore_id = rte_get_next_lcore(-1, 1, 0);
+	char pattern[RTE_GRAPH_NAMESIZE + 1];
+	const char *ppattern = pattern;
 	struct rte_graph_cluster_stats_param param;
 	struct rte_graph_cluster_stats *stats;
 	struct graph_lcore_data *data;
+	uint32_t lcore_id = -1;
+	uint16_t i;
 
-	data = rte_zmalloc("Graph_perf", sizeof(struct graph_lcore_data),
-			   RTE_CACHE_LINE_SIZE);
-	data->graph_id = graph_id;
-	data->done = 0;
+	data = rte_zmalloc("Graph_perf", sizeof(struct graph_lcore_data) *
+			   nb_graphs, RTE_CACHE_LINE_SIZE);
+	if (data == NULL)
+		return -ENOMEM;
 
-	/* Run graph worker thread function */
-	rte_eal_remote_launch(_graph_perf_wrapper, data, lcore_id);
+	/* Run graph worker thread functions */
+	for (i = 0; i < nb_graphs; i++) {
+		lcore_id = rte_get_next_lcore(lcore_id, 1, 0);
+		data[i].graph_id = graph_ids[i];
+		data[i].lcore_id = lcore_id;
+		data[i].done = 0;
+		rte_eal_remote_launch(_graph_perf_wrapper, &data[i], lcore_id);
+	}
 
 	/* Collect stats for few msecs */
 	if (rte_graph_has_stats_feature()) {
+		/* Cloned graphs are named after the first graph */
+		snprintf(pattern, sizeof(pattern), "%s*",
+			 rte_graph_id_to_name(graph_ids[0]));
 		memset(&param, 0, sizeof(param));
 		param.f = stdout;
 		param.socket_id = SOCKET_ID_ANY;
-		param.graph_patterns = &pattern;
+		param.graph_patterns = &ppattern;
 		param.nb_graph_patterns = 1;
 
 		stats = rte_graph_cluster_stats_create(&param);
 		if (stats == NULL) {
 			printf("Failed to create stats\n");
+			for (i = 0; i < nb_graphs; i++)
+				data[i].done = 1;
+			rte_eal_mp_wait_lcore();
+			rte_free(data);
 			return -ENOMEM;
 		}
 
@@ -653,8 +755,11 @@ measure_perf_get(rte_graph_t graph_id)
 	} else
 		rte_delay_ms(1E3);
 
-	data->done = 1;
-	rte_eal_wait_lcore(lcore_id);
+	for (i = 0; i < nb_graphs; i++)
+		data[i].done = 1;
+	for (i = 0; i < nb_graphs; i++)
+		rte_eal_wait_lcore(data[i].lcore_id);
+	rte_free(data);
 
 	return 0;
 }
@@ -671,6 +776,7 @@ graph_fini(void)
 
 	rte_graph_destroy(graph_data->graph_id);
 	free(graph_data->node_data);
+	rte_mempool_free(graph_data->mp);
 	rte_memzone_free(rte_memzone_lookup(TEST_GRAPH_PERF_MZ));
 }
 
@@ -685,7 +791,119 @@ measure_perf(void)
 		return -ENOMEM;
 	graph_data = mz->addr;
 
-	return measure_perf_get(graph_data->graph_id);
+	return measure_perf_get(&graph_data->graph_id, 1);
+}
+
+static void
+measure_perf_dispatch_affinity_set(struct test_graph_perf *graph_data,
+				   unsigned int lcore_id)
+{
+	struct test_node_data *node_data;
+	const char *name;
+	uint32_t stage;
+	int i;
+
+	/* Affine the last half of the worker stages and the sinks */
+	for (i = 0; i < graph_data->nb_nodes; i++) {
+		node_data = &graph_data->node_data[i];
+		name = rte_node_id_to_name(node_data->node_id);
+		if (!node_data->is_sink &&
+		    (sscanf(name, TEST_GRAPH_WRK_NAME "-%u-", &stage) != 1 ||
+		     stage < graph_data->nb_stages / 2))
+			continue;
+		rte_graph_model_dispatch_lcore_affinity_set(name, lcore_id);
+	}
+}
+
+/* Same graph split over two lcores in dispatch model */
+static int
+measure_perf_dispatch(void)
+{
+	struct test_graph_perf *graph_data;
+	const struct rte_memzone *mz;
+	rte_graph_t graph_ids[2];
+	uint32_t lcores[2];
+	int rc = -1;
+	int i;
+
+	lcores[0] = rte_get_next_lcore(-1, 1, 0);
+	lcores[1] = rte_get_next_lcore(lcores[0], 1, 0);
+	if (lcores[1] >= RTE_MAX_LCORE) {
+		printf("Test requires at least 3 lcores\n");
+		return TEST_SKIPPED;
+	}
+
+	mz = rte_memzone_lookup(TEST_GRAPH_PERF_MZ);
+	if (mz == NULL)
+		return -ENOMEM;
+	graph_data = mz->addr;
+
+	graph_ids[0] = graph_data->graph_id;
+	graph_ids[1] = rte_graph_clone(graph_ids[0], "dispatch");
+	if (graph_ids[1] == RTE_GRAPH_ID_INVALID) {
+		printf("Graph clone failed with error = %d\n", rte_errno);
+		return -1;
+	}
+
+	measure_perf_dispatch_affinity_set(graph_data, lcores[1]);
+	for (i = 0; i < 2; i++) {
+		if (rte_graph_worker_model_set(graph_ids[i],
+					       RTE_GRAPH_MODEL_DISPATCH) ||
+		    rte_graph_model_dispatch_core_bind(graph_ids[i],
+						       lcores[i])) {
+			printf("Failed to bind graph to lcore %u\n",
+			       lcores[i]);
+			goto cleanup;
+		}
+	}
+
+	rc = measure_perf_get(graph_ids, 2);
+
+cleanup:
+	measure_perf_dispatch_affinity_set(graph_data, RTE_MAX_LCORE);
+	rte_graph_destroy(graph_ids[1]);
+	rte_graph_model_dispatch_core_unbind(graph_ids[0]);
+	rte_graph_worker_model_set(graph_ids[0], RTE_GRAPH_MODEL_RTC);
+
+	return rc;
+}
+
+static void
+measure_perf_coalesce_set(struct test_graph_perf *graph_data, uint16_t nb_objs,
+			  uint64_t cycles)
+{
+	const char *name;
+	int i;
+
+	for (i = 0; i < graph_data->nb_nodes; i++) {
+		name = rte_node_id_to_name(graph_data->node_data[i].node_id);
+		if (strncmp(name, TEST_GRAPH_SRC_NAME,
+			    strlen(TEST_GRAPH_SRC_NAME)) == 0)
+			continue;
+		rte_node_coalesce_set(name, nb_objs, cycles);
+	}
+}
+
+/* Same graph with the worker and sink nodes coalescing their streams */
+static int
+measure_perf_coalesce(void)
+{
+	struct test_graph_perf *graph_data;
+	const struct rte_memzone *mz;
+	int rc;
+
+	mz = rte_memzone_lookup(TEST_GRAPH_PERF_MZ);
+	if (mz == NULL)
+		return -ENOMEM;
+	graph_data = mz->addr;
+
+	measure_perf_coalesce_set(graph_data, TEST_GRAPH_COALESCE_OBJS,
+				  rte_get_tsc_hz() * TEST_GRAPH_COALESCE_US /
+				  US_PER_S);
+	rc = measure_perf_get(&graph_data->graph_id, 1);
+	measure_perf_coalesce_set(graph_data, 0, 0);
+
+	return rc;
 }
 
 static inline int
@@ -718,6 +936,36 @@ graph_tree_4s_4n_1src_4snk(void)
 	return measure_perf();
 }
 
+static inline int
+graph_hr_4s_1n_1src_1snk_dispatch(void)
+{
+	return measure_perf_dispatch();
+}
+
+static inline int
+graph_tree_4s_4n_1src_4snk_dispatch(void)
+{
+	return measure_perf_dispatch();
+}
+
+static inline int
+graph_skew_3s_4n_1src_4snk(void)
+{
+	return measure_perf();
+}
+
+static inline int
+graph_skew_3s_4n_1src_4snk_coalesce(void)
+{
+	return measure_perf_coalesce();
+}
+
+static inline int
+graph_ip6_lookup_rewrite(void)
+{
+	return measure_perf();
+}
+
 static inline int
 graph_reverse_tree_3s_4n_1src_1snk(void)
 {
@@ -968,6 +1216,129 @@ graph_init_parallel_tree(void)
 			  snk_map, edge_map, 0);
 }
 
+/* Graph Topology
+ * nodes per stage:	4
+ * stages:		3
+ * src:			1
+ * sink:		4
+ *
+ * The node 0 of each stage receives 85% of the objs, the nodes 1 to 3 get
+ * streams of a few objs per walk.
+ */
+static inline int
+graph_init_skew(void)
+{
+	uint8_t edge_map[][4][4] = {
+		{
+			{100, 0, 0, 0},
+			{100, 0, 0, 0},
+			{100, 0, 0, 0},
+			{100, 0, 0, 0}
+		},
+		{
+			{85, 85, 85, 85},
+			{5, 5, 5, 5},
+			{5, 5, 5, 5},
+			{5, 5, 5, 5}
+		},
+		{
+			{85, 85, 85, 85},
+			{5, 5, 5, 5},
+			{5, 5, 5, 5},
+			{5, 5, 5, 5}
+		},
+	};
+	uint8_t src_map[][4] = { {85, 5, 5, 5} };
+	uint8_t snk_map[][4] = {
+		{100, 0, 0, 0},
+		{0, 100, 0, 0},
+		{0, 0, 100, 0},
+		{0, 0, 0, 100}
+	};
+
+	return graph_init("graph_skew", SOURCES(src_map), SINKS(snk_map),
+			  STAGES(edge_map), NODES_PER_STAGE(edge_map), src_map,
+			  snk_map, edge_map, 0);
+}
+
+/* Graph Topology
+ * ip6_source -> ip6_lookup -> ip6_rewrite -> pkt_drop
+ *
+ * One packet out of TEST_GRAPH_IP6_ROUTES + 1 has no route and is dropped
+ * by ip6_lookup, the others are rewritten and, no next hop being set up with
+ * a Tx port, sent to pkt_drop by ip6_rewrite.
+ */
+static inline int
+graph_init_ip6(void)
+{
+	static const char *node_patterns[] = {
+		TEST_GRAPH_IP6_SRC_NAME,
+		"ip6*",
+		"pkt_drop",
+	};
+	uint8_t ip[RTE_DIM(test_graph_ip6_dst)];
+	struct test_graph_perf *graph_data;
+	struct rte_graph_param gconf;
+	const struct rte_memzone *mz;
+	rte_graph_t graph_id;
+	uint16_t i;
+
+	mz = rte_memzone_reserve(TEST_GRAPH_PERF_MZ,
+				 sizeof(struct test_graph_perf), 0, 0);
+	if (mz == NULL) {
+		printf("Failed to allocate graph common memory\n");
+		return -ENOMEM;
+	}
+
+	graph_data = mz->addr;
+	graph_data->nb_nodes = 0;
+	graph_data->nb_stages = 0;
+	graph_data->node_data = NULL;
+	graph_data->mp = rte_pktmbuf_pool_create("graph_perf_ip6",
+						 TEST_GRAPH_IP6_NB_MBUFS,
+						 RTE_GRAPH_BURST_SIZE, 0,
+						 RTE_MBUF_DEFAULT_BUF_SIZE,
+						 SOCKET_ID_ANY);
+	if (graph_data->mp == NULL) {
+		printf("Failed to create mbuf pool\n");
+		goto memzone_free;
+	}
+
+	/* ip6_lookup uses the LPM table of the graph socket */
+	gconf.socket_id = rte_socket_id();
+	gconf.nb_node_patterns = RTE_DIM(node_patterns);
+	gconf.node_patterns = node_patterns;
+
+	graph_id = rte_graph_create("graph_ip6", &gconf);
+	if (graph_id == RTE_GRAPH_ID_INVALID) {
+		printf("Graph creation failed with error = %d\n", rte_errno);
+		goto mempool_free;
+	}
+	graph_data->graph_id = graph_id;
+
+	/* Routes are added once the lookup node has set up its LPM tables */
+	memcpy(ip, test_graph_ip6_dst, sizeof(ip));
+	ip[RTE_DIM(ip) - 1] = 0;
+	for (i = 0; i < TEST_GRAPH_IP6_ROUTES; i++) {
+		ip[7] = i;
+		if (rte_node_ip6_route_add(ip, 64, i,
+					   RTE_NODE_IP6_LOOKUP_NEXT_REWRITE)) {
+			printf("Failed to add ip6 route %u\n", i);
+			goto graph_destroy;
+		}
+	}
+
+	return 0;
+
+graph_destroy:
+	rte_graph_destroy(graph_id);
+mempool_free:
+	rte_mempool_free(graph_data->mp);
+memzone_free:
+	rte_memzone_free(mz);
+	return -ENOMEM;
+}
+
 /** Graph Creation cheat sheet
  *  edge_map -> dictates graph flow from worker stage 0 to worker stage n-1.
  *  src_map  -> dictates source nodes enqueue percentage to worker stage 0.
@@ -1050,6 +1421,16 @@ static struct unit_test_suite graph_perf_testsuite = {
 			     graph_reverse_tree_3s_4n_1src_1snk),
 		TEST_CASE_ST(graph_init_parallel_tree, graph_fini,
 			     graph_parallel_tree_5s_4n_4src_4snk),
+		TEST_CASE_ST(graph_init_hr, graph_fini,
+			     graph_hr_4s_1n_1src_1snk_dispatch),
+		TEST_CASE_ST(graph_init_tree, graph_fini,
+			     graph_tree_4s_4n_1src_4snk_dispatch),
+		TEST_CASE_ST(graph_init_skew, graph_fini,
+			     graph_skew_3s_4n_1src_4snk),
+		TEST_CASE_ST(graph_init_skew, graph_fini,
+			     graph_skew_3s_4n_1src_4snk_coalesce),
+		TEST_CASE_ST(graph_init_ip6, graph_fini,
+			     graph_ip6_lookup_rewrite),
 		TEST_CASES_END(), /**< NULL terminate unit test array */
 	},
 };
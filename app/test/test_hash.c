@@ -2189,6 +2189,282 @@ test_hash_rcu_qsbr_sync_mode(uint8_t ext_bkt)
 
 }
 
+#define PIPELINE_ENTRIES 1024
+#define PIPELINE_KEYS 512
+
+/*
+ * Check the pipelined bulk lookup finds the same keys and data as the
+ * single key lookup, for any burst size and with missing keys.
+ */
+static int
+test_hash_bulk_pipeline(uint8_t ext_bkt)
+{
+	struct rte_hash_parameters params = {
+		.name = "test_hash_bulk_pipeline",
+		.entries = PIPELINE_ENTRIES,
+		.key_len = sizeof(uint32_t),
+		.hash_func = rte_jhash,
+		.hash_func_init_val = 0,
+		.socket_id = 0,
+		.extra_flag = ext_bkt ? RTE_HASH_EXTRA_FLAGS_EXT_TABLE : 0,
+	};
+	uint32_t key_vals[RTE_HASH_LOOKUP_BULK_MAX];
+	const void *keys[RTE_HASH_LOOKUP_BULK_MAX];
+	hash_sig_t hashes[RTE_HASH_LOOKUP_BULK_MAX];
+	void *data[RTE_HASH_LOOKUP_BULK_MAX];
+	uint32_t i, j, num_keys;
+	uint64_t hit_mask, expected_mask;
+	struct rte_hash *handle;
+	int ret;
+
+	handle = rte_hash_create(&params);
+	RETURN_IF_ERROR(handle == NULL, "hash creation failed");
+
+	/* Add even keys only */
+	for (i = 0; i < PIPELINE_KEYS; i++) {
+		j = i * 2;
+		ret = rte_hash_add_key_data(handle, &j,
+				(void *)((uintptr_t)j + 1));
+		RETURN_IF_ERROR(ret != 0, "failed to add key %u (%d)", j, ret);
+	}
+
+	for (num_keys = 1; num_keys <= RTE_HASH_LOOKUP_BULK_MAX;
+			num_keys++) {
+		expected_mask = 0;
+		for (j = 0; j < num_keys; j++) {
+			key_vals[j] = (num_keys * 7 + j * 3) %
+					(PIPELINE_KEYS * 2);
+			keys[j] = &key_vals[j];
+			hashes[j] = rte_hash_hash(handle, keys[j]);
+			data[j] = NULL;
+			if ((key_vals[j] & 1) == 0)
+				expected_mask |= 1ULL << j;
+		}
+
+		ret = rte_hash_lookup_with_hash_bulk_pipeline(handle, keys,
+				hashes, num_keys, &hit_mask, data);
+		RETURN_IF_ERROR(ret != __builtin_popcountll(expected_mask),
+				"unexpected number of hits %d for %u keys",
+				ret, num_keys);
+		RETURN_IF_ERROR(hit_mask != expected_mask,
+				"unexpected hit mask 0x%" PRIx64 " for %u keys",
+				hit_mask, num_keys);
+		for (j = 0; j < num_keys; j++) {
+			if (!(hit_mask & (1ULL << j)))
+				continue;
+			RETURN_IF_ERROR(data[j] !=
+					(void *)((uintptr_t)key_vals[j] + 1),
+					"wrong data for key %u", key_vals[j]);
+		}
+	}
+
+	rte_hash_free(handle);
+
+	return 0;
+}
+
+#define RSZ_INIT_ENTRIES 64
+#define RSZ_KEYS 4096
+#define RSZ_KEYS_KEPT 16
+#define RSZ_LARGE_ENTRIES (1 << 16)
+#define RSZ_FILL_KEYS 1024
+static int32_t rsz_pos[RSZ_KEYS + RSZ_FILL_KEYS];
+
+/*
+ * Test a resizable hash table: grow it well beyond its initial size, shrink
+ * it back and check that the key positions are kept across the resizes.
+ */
+static int
+test_hash_resizable(uint8_t lf)
+{
+	struct rte_hash_parameters params = {
+		.name = "test_hash_resizable",
+		.entries = RSZ_INIT_ENTRIES,
+		.key_len = sizeof(uint32_t),
+		.hash_func = rte_jhash,
+		.hash_func_init_val = 0,
+		.socket_id = 0,
+		.extra_flag = RTE_HASH_EXTRA_FLAGS_RESIZABLE,
+	};
+	struct rte_hash_rcu_config rcu_cfg = {0};
+	const void *keys[RTE_HASH_LOOKUP_BULK_MAX];
+	int32_t positions[RTE_HASH_LOOKUP_BULK_MAX];
+	uint32_t key_vals[RTE_HASH_LOOKUP_BULK_MAX];
+	const void *next_key;
+	void *next_data;
+	uint32_t i, j, iter = 0, count = 0;
+	int32_t pos, status;
+	size_t sz;
+
+	g_qsv = NULL;
+	g_handle = NULL;
+
+	if (lf) {
+		params.extra_flag |= RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF;
+		printf("\n# Running resizable hash functional test with"
+		       " lock free concurrency\n");
+	} else
+		printf("\n# Running resizable hash functional test\n");
+
+	/* Resizable tables have a single writer */
+	params.extra_flag |= RTE_HASH_EXTRA_FLAGS_EXT_TABLE;
+	g_handle = rte_hash_create(&params);
+	RETURN_IF_ERROR_RCU_QSBR(g_handle != NULL,
+		"Resizable hash creation with ext table should have failed");
+	params.extra_flag &= ~RTE_HASH_EXTRA_FLAGS_EXT_TABLE;
+
+	g_handle = rte_hash_create(&params);
+	RETURN_IF_ERROR_RCU_QSBR(g_handle == NULL, "Hash creation failed");
+
+	if (lf) {
+		/* Old buckets of a lock free table are released using RCU */
+		status = rte_hash_resize(g_handle, RSZ_INIT_ENTRIES * 2);
+		RETURN_IF_ERROR_RCU_QSBR(status != -ENOTSUP,
+			"Resize without RCU QSBR should fail (%d)", status);
+
+		sz = rte_rcu_qsbr_get_memsize(RTE_MAX_LCORE);
+		g_qsv = (struct rte_rcu_qsbr *)rte_zmalloc_socket(NULL, sz,
+					RTE_CACHE_LINE_SIZE, SOCKET_ID_ANY);
+		RETURN_IF_ERROR_RCU_QSBR(g_qsv == NULL,
+				"RCU QSBR variable creation failed");
+		status = rte_rcu_qsbr_init(g_qsv, RTE_MAX_LCORE);
+		RETURN_IF_ERROR_RCU_QSBR(status != 0,
+				"RCU QSBR variable initialization failed");
+
+		rcu_cfg.v = g_qsv;
+		rcu_cfg.mode = RTE_HASH_QSBR_MODE_DQ;
+		rcu_cfg.dq_size = RSZ_KEYS;
+		status = rte_hash_rcu_qsbr_add(g_handle, &rcu_cfg);
+		RETURN_IF_ERROR_RCU_QSBR(status != 0,
+				"Attach RCU QSBR to hash table failed");
+	}
+
+	/* Grow */
+	for (i = 0; i < RSZ_KEYS; i++) {
+		rsz_pos[i] = rte_hash_add_key(g_handle, &i);
+		RETURN_IF_ERROR_RCU_QSBR(rsz_pos[i] < 0,
+			"failed to add key %u (pos=%d)", i, rsz_pos[i]);
+	}
+	RETURN_IF_ERROR_RCU_QSBR(rte_hash_count(g_handle) != RSZ_KEYS,
+			"Unexpected number of keys %d",
+			rte_hash_count(g_handle));
+	RETURN_IF_ERROR_RCU_QSBR(rte_hash_max_key_id(g_handle) < RSZ_KEYS,
+			"Table did not grow (max key id %d)",
+			rte_hash_max_key_id(g_handle));
+
+	/* Lookup with a resize possibly in progress, then once it is done */
+	for (j = 0; j < 2; j++) {
+		for (i = 0; i < RSZ_KEYS; i++) {
+			pos = rte_hash_lookup(g_handle, &i);
+			RETURN_IF_ERROR_RCU_QSBR(pos != rsz_pos[i],
+				"failed to find key %u (pos=%d)", i, pos);
+		}
+		status = rte_hash_resize_step(g_handle, UINT32_MAX);
+		RETURN_IF_ERROR_RCU_QSBR(status != 0,
+				"Resize did not complete (%d)", status);
+	}
+
+	/* Bulk lookup */
+	for (i = 0; i < RSZ_KEYS; i += RTE_HASH_LOOKUP_BULK_MAX) {
+		for (j = 0; j < RTE_HASH_LOOKUP_BULK_MAX; j++) {
+			key_vals[j] = i + j;
+			keys[j] = &key_vals[j];
+		}
+		status = rte_hash_lookup_bulk(g_handle, keys,
+				RTE_HASH_LOOKUP_BULK_MAX, positions);
+		RETURN_IF_ERROR_RCU_QSBR(status != 0,
+				"Bulk lookup failed (%d)", status);
+		for (j = 0; j < RTE_HASH_LOOKUP_BULK_MAX; j++)
+			RETURN_IF_ERROR_RCU_QSBR(positions[j] != rsz_pos[i + j],
+				"failed to find key %u (pos=%d)", i + j,
+				positions[j]);
+	}
+
+	/* Iterate */
+	while (rte_hash_iterate(g_handle, &next_key, &next_data, &iter) >= 0)
+		count++;
+	RETURN_IF_ERROR_RCU_QSBR(count != RSZ_KEYS,
+			"Iterated over %u keys instead of %u", count, RSZ_KEYS);
+
+	/* Shrink */
+	for (i = RSZ_KEYS_KEPT; i < RSZ_KEYS; i++) {
+		pos = rte_hash_del_key(g_handle, &i);
+		RETURN_IF_ERROR_RCU_QSBR(pos != rsz_pos[i],
+			"failed to delete key %u (pos=%d)", i, pos);
+	}
+	status = rte_hash_resize_step(g_handle, UINT32_MAX);
+	RETURN_IF_ERROR_RCU_QSBR(status != 0,
+			"Resize did not complete (%d)", status);
+	for (i = 0; i < RSZ_KEYS; i++) {
+		pos = rte_hash_lookup(g_handle, &i);
+		RETURN_IF_ERROR_RCU_QSBR(pos != (i < RSZ_KEYS_KEPT ?
+					rsz_pos[i] : -ENOENT),
+			"Unexpected lookup result for key %u (pos=%d)", i, pos);
+	}
+
+	/* Explicit resize */
+	status = rte_hash_resize(g_handle, RSZ_KEYS_KEPT / 2);
+	RETURN_IF_ERROR_RCU_QSBR(status != -ENOSPC,
+			"Resize below the number of keys should fail (%d)",
+			status);
+	status = rte_hash_resize(g_handle, RSZ_KEYS);
+	RETURN_IF_ERROR_RCU_QSBR(status != 0, "Resize failed (%d)", status);
+	status = rte_hash_resize_step(g_handle, UINT32_MAX);
+	RETURN_IF_ERROR_RCU_QSBR(status != 0,
+			"Resize did not complete (%d)", status);
+	for (i = 0; i < RSZ_KEYS_KEPT; i++) {
+		pos = rte_hash_lookup(g_handle, &i);
+		RETURN_IF_ERROR_RCU_QSBR(pos != rsz_pos[i],
+			"failed to find key %u (pos=%d)", i, pos);
+	}
+
+	/* Fill the smaller table while a shrink is still migrating, which
+	 * aborts the shrink.
+	 */
+	status = rte_hash_resize(g_handle, RSZ_LARGE_ENTRIES);
+	RETURN_IF_ERROR_RCU_QSBR(status != 0, "Resize failed (%d)", status);
+	status = rte_hash_resize_step(g_handle, UINT32_MAX);
+	RETURN_IF_ERROR_RCU_QSBR(status != 0,
+			"Resize did not complete (%d)", status);
+	status = rte_hash_resize(g_handle, RSZ_INIT_ENTRIES);
+	RETURN_IF_ERROR_RCU_QSBR(status != 0, "Resize failed (%d)", status);
+	for (i = RSZ_KEYS; i < RSZ_KEYS + RSZ_FILL_KEYS; i++) {
+		rsz_pos[i] = rte_hash_add_key(g_handle, &i);
+		RETURN_IF_ERROR_RCU_QSBR(rsz_pos[i] < 0,
+			"failed to add key %u during shrink (pos=%d)", i,
+			rsz_pos[i]);
+	}
+	status = rte_hash_resize_step(g_handle, UINT32_MAX);
+	RETURN_IF_ERROR_RCU_QSBR(status != 0,
+			"Resize did not complete (%d)", status);
+	for (i = 0; i < RSZ_KEYS + RSZ_FILL_KEYS; i++) {
+		if (i >= RSZ_KEYS_KEPT && i < RSZ_KEYS)
+			continue;
+		pos = rte_hash_lookup(g_handle, &i);
+		RETURN_IF_ERROR_RCU_QSBR(pos != rsz_pos[i],
+			"failed to find key %u (pos=%d)", i, pos);
+	}
+	status = rte_hash_resize(g_handle, RSZ_LARGE_ENTRIES * 2);
+	RETURN_IF_ERROR_RCU_QSBR(status != 0,
+			"Resize after an aborted shrink failed (%d)", status);
+
+	rte_hash_free(g_handle);
+	rte_free(g_qsv);
+	g_qsv = NULL;
+
+	/* Only tables created with RTE_HASH_EXTRA_FLAGS_RESIZABLE resize */
+	params.extra_flag = 0;
+	g_handle = rte_hash_create(&params);
+	RETURN_IF_ERROR_RCU_QSBR(g_handle == NULL, "Hash creation failed");
+	status = rte_hash_resize(g_handle, RSZ_KEYS);
+	RETURN_IF_ERROR_RCU_QSBR(status != -ENOTSUP,
+			"Resize of a fixed size table should fail (%d)",
+			status);
+	rte_hash_free(g_handle);
+
+	return 0;
+}
+
 /*
  * Do all unit and performance tests.
  */
@@ -2267,6 +2543,18 @@ test_hash(void)
 	if (test_hash_rcu_qsbr_sync_mode(1) < 0)
 		return -1;
 
+	if (test_hash_bulk_pipeline(0) < 0)
+		return -1;
+
+	if (test_hash_bulk_pipeline(1) < 0)
+		return -1;
+
+	if (test_hash_resizable(0) < 0)
+		return -1;
+
+	if (test_hash_resizable(1) < 0)
+		return -1;
+
 	return 0;
 }
 
@@ -96,7 +96,7 @@ test_hash_multiwriter_worker(void *arg)
 
 
 static int
-test_hash_multiwriter(void)
+test_hash_multiwriter(unsigned int nb_writers)
 {
 	unsigned int i, rounded_nb_total_tsx_insertion;
 	static unsigned calledCount = 1;
@@ -140,7 +140,7 @@ test_hash_multiwriter(void)
 
 	tbl_multiwriter_test_params.h = handle;
 	tbl_multiwriter_test_params.nb_tsx_insertion =
-		nb_total_tsx_insertion / rte_lcore_count();
+		nb_total_tsx_insertion / nb_writers;
 
 	rounded_nb_total_tsx_insertion = (nb_total_tsx_insertion /
 		tbl_multiwriter_test_params.nb_tsx_insertion)
@@ -171,17 +171,11 @@ test_hash_multiwriter(void)
 	__atomic_store_n(&gcycles, 0, __ATOMIC_RELAXED);
 	__atomic_store_n(&ginsertions, 0, __ATOMIC_RELAXED);
 
-	/* Get list of enabled cores */
+	/* Get list of enabled cores, starting with the main one */
 	i = 0;
-	for (core_id = 0; core_id < RTE_MAX_LCORE; core_id++) {
-		if (i == rte_lcore_count())
-			break;
-
-		if (rte_lcore_is_enabled(core_id)) {
-			enabled_core_ids[i] = core_id;
-			i++;
-		}
-	}
+	enabled_core_ids[i++] = rte_get_main_lcore();
+	RTE_LCORE_FOREACH_WORKER(core_id)
+		enabled_core_ids[i++] = core_id;
 
 	if (i != rte_lcore_count()) {
 		printf("Number of enabled cores in list is different from "
@@ -189,9 +183,11 @@ test_hash_multiwriter(void)
 		goto err3;
 	}
 
-	/* Fire all threads. */
-	rte_eal_mp_remote_launch(test_hash_multiwriter_worker,
-				 enabled_core_ids, CALL_MAIN);
+	/* Fire the writer threads, the main lcore being the first one. */
+	for (i = 1; i < nb_writers; i++)
+		rte_eal_remote_launch(test_hash_multiwriter_worker,
+				      enabled_core_ids, enabled_core_ids[i]);
+	test_hash_multiwriter_worker(enabled_core_ids);
 	rte_eal_mp_wait_lcore();
 
 	count = rte_hash_count(handle);
@@ -238,7 +234,8 @@ test_hash_multiwriter(void)
 		__atomic_load_n(&gcycles, __ATOMIC_RELAXED)/
 		__atomic_load_n(&ginsertions, __ATOMIC_RELAXED);
 
-	printf(" cycles per insertion: %llu\n", cycles_per_insertion);
+	printf(" cycles per insertion: %llu with %u writers\n",
+	       cycles_per_insertion, nb_writers);
 
 	rte_free(tbl_multiwriter_test_params.found);
 	rte_free(tbl_multiwriter_test_params.keys);
@@ -257,6 +254,8 @@ test_hash_multiwriter(void)
 static int
 test_hash_multiwriter_main(void)
 {
+	unsigned int nb_writers;
+
 	if (rte_lcore_count() < 2) {
 		printf("Not enough cores for distributor_autotest, expecting at least 2\n");
 		return TEST_SKIPPED;
@@ -275,13 +274,22 @@ test_hash_multiwriter_main(void)
 		printf("Test multi-writer with Hardware transactional memory\n");
 
 		use_htm = 1;
-		if (test_hash_multiwriter() < 0)
+		if (test_hash_multiwriter(rte_lcore_count()) < 0)
 			return -1;
 	}
 
 	printf("Test multi-writer without Hardware transactional memory\n");
 	use_htm = 0;
-	if (test_hash_multiwriter() < 0)
+	/*
+	 * Double the number of writers up to all lcores (at most 64), to
+	 * show how the insertion rate, and so the free slots allocation,
+	 * scales with the number of writers.
+	 */
+	for (nb_writers = 2; nb_writers < RTE_MIN(rte_lcore_count(), 64U);
+			nb_writers *= 2)
+		if (test_hash_multiwriter(nb_writers) < 0)
+			return -1;
+	if (test_hash_multiwriter(RTE_MIN(rte_lcore_count(), 64U)) < 0)
 		return -1;
 
 	return 0;
@@ -3,6 +3,7 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <inttypes.h>
 
 #include <rte_lcore.h>
@@ -13,6 +14,7 @@
 #include <rte_jhash.h>
 #include <rte_fbk_hash.h>
 #include <rte_random.h>
+#include <rte_rcu_qsbr.h>
 #include <rte_string_fns.h>
 
 #include "test.h"
@@ -719,6 +721,226 @@ fbk_hash_perf_test(void)
 	return 0;
 }
 
+#define PIPELINE_LOOKUPS (1 << 22)	/* How many keys to look up. */
+
+/* Derive a key from its index, keys are spread over the whole table. */
+static inline uint64_t
+pipeline_perf_key(uint32_t idx)
+{
+	return (uint64_t)idx * 0x9e3779b97f4a7c15ULL;
+}
+
+/*
+ * Compare rte_hash_lookup_with_hash_bulk_data() with its software pipelined
+ * variant on a table too large to fit in the CPU caches.
+ */
+static int
+bulk_pipeline_perf_test(uint32_t entries)
+{
+	struct rte_hash_parameters params = {
+		.name = "bulk_pipeline_perf",
+		.entries = entries,
+		.key_len = sizeof(uint64_t),
+		.hash_func = rte_hash_crc,
+		.hash_func_init_val = 0,
+		.socket_id = rte_socket_id(),
+	};
+	const uint32_t n_keys = entries / 4 * 3;
+	uint64_t burst_keys[RTE_HASH_LOOKUP_BULK_MAX];
+	const void *burst_key_ptrs[RTE_HASH_LOOKUP_BULK_MAX];
+	hash_sig_t burst_hash[RTE_HASH_LOOKUP_BULK_MAX];
+	void *burst_data[RTE_HASH_LOOKUP_BULK_MAX];
+	uint64_t cycles_bulk = 0, cycles_pipeline = 0;
+	uint64_t hit_mask, begin, key;
+	uint32_t i, j, pass, hits = 0;
+	struct rte_hash *h;
+	int ret;
+
+	h = rte_hash_create(&params);
+	if (h == NULL) {
+		printf("bulk pipeline: cannot create a %u entries table,"
+		       " skipped\n", entries);
+		return 0;
+	}
+
+	for (i = 0; i < n_keys; i++) {
+		key = pipeline_perf_key(i);
+		ret = rte_hash_add_key_data(h, &key,
+				(void *)(uintptr_t)i);
+		if (ret != 0) {
+			printf("bulk pipeline: failed to add key %u (%d)\n",
+			       i, ret);
+			rte_hash_free(h);
+			return -1;
+		}
+	}
+
+	for (j = 0; j < RTE_HASH_LOOKUP_BULK_MAX; j++)
+		burst_key_ptrs[j] = &burst_keys[j];
+
+	for (pass = 0; pass < 2; pass++) {
+		/* Both passes look up the same random keys */
+		rte_srand(entries);
+		for (i = 0; i < PIPELINE_LOOKUPS; i += RTE_HASH_LOOKUP_BULK_MAX) {
+			for (j = 0; j < RTE_HASH_LOOKUP_BULK_MAX; j++) {
+				burst_keys[j] = pipeline_perf_key(
+						rte_rand() % n_keys);
+				burst_hash[j] = rte_hash_hash(h,
+						&burst_keys[j]);
+			}
+
+			begin = rte_rdtsc();
+			if (pass == 0)
+				ret = rte_hash_lookup_with_hash_bulk_data(h,
+						burst_key_ptrs, burst_hash,
+						RTE_HASH_LOOKUP_BULK_MAX, &hit_mask,
+						burst_data);
+			else
+				ret = rte_hash_lookup_with_hash_bulk_pipeline(
+						h, burst_key_ptrs, burst_hash,
+						RTE_HASH_LOOKUP_BULK_MAX, &hit_mask,
+						burst_data);
+			if (pass == 0)
+				cycles_bulk += rte_rdtsc() - begin;
+			else
+				cycles_pipeline += rte_rdtsc() - begin;
+
+			if (ret != RTE_HASH_LOOKUP_BULK_MAX) {
+				printf("bulk pipeline: %d hits out of %u\n",
+				       ret, RTE_HASH_LOOKUP_BULK_MAX);
+				rte_hash_free(h);
+				return -1;
+			}
+			hits += ret;
+		}
+	}
+
+	printf("\n\n *** Bulk lookup with hash, %u entries ***\n", entries);
+	printf("Ticks per lookup: bulk %.1f, pipelined %.1f (%u hits)\n",
+	       (double)cycles_bulk / PIPELINE_LOOKUPS,
+	       (double)cycles_pipeline / PIPELINE_LOOKUPS, hits);
+
+	rte_hash_free(h);
+
+	return 0;
+}
+
+#define RSZ_INIT_ENTRIES (1 << 12)	/* Initial size of the resizable table. */
+#define RSZ_KEYS (1 << 18)		/* How many keys to add. */
+
+static int
+cmp_u64(const void *a, const void *b)
+{
+	const uint64_t x = *(const uint64_t *)a;
+	const uint64_t y = *(const uint64_t *)b;
+
+	return (x > y) - (x < y);
+}
+
+static void
+print_latency_tail(const char *phase, uint64_t *lat, uint32_t n)
+{
+	if (n == 0) {
+		printf("%-10s no samples\n", phase);
+		return;
+	}
+
+	qsort(lat, n, sizeof(*lat), cmp_u64);
+	printf("%-10s %8u samples, p50 %6"PRIu64" p99 %6"PRIu64
+	       " p99.9 %6"PRIu64" max %8"PRIu64" cycles\n", phase, n,
+	       lat[n / 2], lat[(uint64_t)n * 99 / 100],
+	       lat[(uint64_t)n * 999 / 1000], lat[n - 1]);
+}
+
+/*
+ * Measure the lookup latency of a resizable table growing from
+ * RSZ_INIT_ENTRIES to RSZ_KEYS entries: each key add is followed by the
+ * lookup of a random key already added, the latency is accounted to the
+ * resizing phase if a bucket migration is in progress.
+ */
+static int
+resizable_hash_perf_test(void)
+{
+	struct rte_hash_parameters params = {
+		.name = "resizable_hash_perf",
+		.entries = RSZ_INIT_ENTRIES,
+		.key_len = sizeof(uint32_t),
+		.hash_func = rte_jhash,
+		.hash_func_init_val = 0,
+		.socket_id = rte_socket_id(),
+		.extra_flag = RTE_HASH_EXTRA_FLAGS_RESIZABLE |
+			RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF,
+	};
+	struct rte_hash_rcu_config rcu_cfg = {0};
+	struct rte_rcu_qsbr *qsv = NULL;
+	struct rte_hash *h = NULL;
+	uint64_t *lat_rsz = NULL, *lat_steady = NULL;
+	uint32_t n_rsz = 0, n_steady = 0;
+	uint32_t i, key;
+	uint64_t begin, end;
+	int32_t pos, ret = -1;
+	int resizing;
+
+	h = rte_hash_create(&params);
+	qsv = rte_zmalloc(NULL, rte_rcu_qsbr_get_memsize(RTE_MAX_LCORE),
+			  RTE_CACHE_LINE_SIZE);
+	lat_rsz = rte_zmalloc(NULL, RSZ_KEYS * sizeof(*lat_rsz), 0);
+	lat_steady = rte_zmalloc(NULL, RSZ_KEYS * sizeof(*lat_steady), 0);
+	if (h == NULL || qsv == NULL || lat_rsz == NULL ||
+			lat_steady == NULL) {
+		printf("resizable hash: allocation failed\n");
+		goto end;
+	}
+
+	rte_rcu_qsbr_init(qsv, RTE_MAX_LCORE);
+	rcu_cfg.v = qsv;
+	rcu_cfg.mode = RTE_HASH_QSBR_MODE_DQ;
+	rcu_cfg.dq_size = RSZ_KEYS;
+	if (rte_hash_rcu_qsbr_add(h, &rcu_cfg) != 0) {
+		printf("resizable hash: attach RCU QSBR failed\n");
+		goto end;
+	}
+
+	for (i = 0; i < RSZ_KEYS; i++) {
+		pos = rte_hash_add_key(h, &i);
+		if (pos < 0) {
+			printf("resizable hash: failed to add key %u (%d)\n",
+			       i, pos);
+			goto end;
+		}
+
+		resizing = rte_hash_resize_step(h, 0) > 0;
+		key = rte_rand() % (i + 1);
+		begin = rte_rdtsc_precise();
+		pos = rte_hash_lookup(h, &key);
+		end = rte_rdtsc_precise();
+		if (pos < 0) {
+			printf("resizable hash: failed to find key %u (%d)\n",
+			       key, pos);
+			goto end;
+		}
+
+		if (resizing)
+			lat_rsz[n_rsz++] = end - begin;
+		else
+			lat_steady[n_steady++] = end - begin;
+	}
+
+	printf("\n\n *** Resizable hash lookup latency (%u to %u entries) ***\n",
+	       RSZ_INIT_ENTRIES, RSZ_KEYS);
+	print_latency_tail("resizing", lat_rsz, n_rsz);
+	print_latency_tail("steady", lat_steady, n_steady);
+	ret = 0;
+
+end:
+	rte_hash_free(h);
+	rte_free(qsv);
+	rte_free(lat_rsz);
+	rte_free(lat_steady);
+
+	return ret;
+}
+
 static int
 test_hash_perf(void)
 {
@@ -746,6 +968,15 @@ test_hash_perf(void)
 	if (fbk_hash_perf_test() < 0)
 		return -1;
 
+	if (bulk_pipeline_perf_test(1 << 20) < 0)
+		return -1;
+
+	if (bulk_pipeline_perf_test(1 << 24) < 0)
+		return -1;
+
+	if (resizable_hash_perf_test() < 0)
+		return -1;
+
 	return 0;
 }
 
@@ -885,6 +885,48 @@ test_pktmbuf_pool_bulk(void)
 		goto err;
 	}
 
+	printf("Test bulk free of mixed direct, shared and cloned mbufs.\n");
+
+	/* Every fourth mbuf is shared, and every fourth one is cloned. */
+	RTE_BUILD_BUG_ON(NB_MBUF % 8 != 0);
+	for (i = 0; i < NB_MBUF / 2; i++) {
+		mbufs[i] = rte_pktmbuf_alloc((i & 1) ? pool2 : pool);
+		if (mbufs[i] == NULL) {
+			printf("rte_pktmbuf_alloc() failed (%u)\n", i);
+			goto err;
+		}
+		if ((i % 4) == 2)
+			rte_mbuf_refcnt_update(mbufs[i], 1);
+	}
+	for (i = 0; i < NB_MBUF / 8; i++) {
+		m = rte_pktmbuf_clone(mbufs[i * 4 + 3], pool);
+		if (m == NULL) {
+			printf("rte_pktmbuf_clone() failed (%u)\n", i);
+			goto err;
+		}
+		mbufs[NB_MBUF / 2 + i] = m;
+	}
+	/* Free all of them, the shared mbufs stay allocated. */
+	rte_pktmbuf_free_bulk(mbufs, NB_MBUF / 2 + NB_MBUF / 8);
+	if (rte_mempool_avail_count(pool) + rte_mempool_avail_count(pool2) !=
+			2 * NB_MBUF - NB_MBUF / 8) {
+		printf("mempools avail count incorrect\n");
+		goto err;
+	}
+	for (i = 0; i < NB_MBUF / 8; i++) {
+		m = mbufs[i * 4 + 2];
+		if (rte_mbuf_refcnt_read(m) != 1) {
+			printf("shared mbuf refcnt incorrect\n");
+			goto err;
+		}
+		mbufs[i] = m;
+	}
+	rte_pktmbuf_free_bulk(mbufs, NB_MBUF / 8);
+	if (!(rte_mempool_full(pool) && rte_mempool_full(pool2))) {
+		printf("mempools not full\n");
+		goto err;
+	}
+
 	ret = 0;
 	goto done;
 
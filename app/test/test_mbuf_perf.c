@@ -0,0 +1,146 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 agent <agent@local>
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_lcore.h>
+#include <rte_mbuf.h>
+#include <rte_mempool.h>
+
+#include "test.h"
+
+/*
+ * Mbuf free performance
+ * =====================
+ *
+ * Bursts of mbufs interleaving 1, 2 or 4 mempools, i.e. the mbuf i of a
+ * burst comes from the pool i % nb_pools, are freed with a loop of
+ * rte_pktmbuf_free() and with rte_pktmbuf_free_bulk(). Only the free is
+ * timed, the result is given in nanoseconds per mbuf.
+ */
+
+#define MAX_POOLS 4
+#define NB_MBUF 8191
+#define MBUF_CACHE_SIZE 256
+#define BURST_SIZE 32
+#define ITERATIONS (1 << 16)
+
+enum free_type {
+	free_type_loop,
+	free_type_bulk,
+};
+
+static const enum free_type free_types[] = {
+	free_type_loop,
+	free_type_bulk,
+};
+
+static const char *
+free_type_desc(enum free_type free_type)
+{
+	switch (free_type) {
+	case free_type_loop:
+		return "rte_pktmbuf_free() loop";
+	case free_type_bulk:
+		return "rte_pktmbuf_free_bulk()";
+	default:
+		return NULL;
+	}
+}
+
+/* Allocate a burst interleaving the mbufs of the pools */
+static int
+test_mbuf_perf_alloc(struct rte_mempool **pools, unsigned int nb_pools,
+		     struct rte_mbuf **burst)
+{
+	struct rte_mbuf *allocated[MAX_POOLS][BURST_SIZE];
+	unsigned int per_pool = BURST_SIZE / nb_pools;
+	unsigned int i, p;
+
+	for (p = 0; p < nb_pools; p++)
+		if (rte_pktmbuf_alloc_bulk(pools[p], allocated[p],
+					   per_pool) != 0)
+			return -1;
+	for (i = 0; i < BURST_SIZE; i++)
+		burst[i] = allocated[i % nb_pools][i / nb_pools];
+
+	return 0;
+}
+
+static int
+test_mbuf_perf_free(struct rte_mempool **pools, unsigned int nb_pools)
+{
+	uint64_t start, cycles[RTE_DIM(free_types)] = { 0 };
+	struct rte_mbuf *burst[BURST_SIZE];
+	unsigned int iter, i, t;
+
+	/* Alternate the free types to get the same conditions */
+	for (iter = 0; iter < ITERATIONS; iter++) {
+		for (t = 0; t < RTE_DIM(free_types); t++) {
+			if (test_mbuf_perf_alloc(pools, nb_pools, burst) < 0)
+				return -1;
+
+			start = rte_rdtsc_precise();
+			switch (free_types[t]) {
+			case free_type_loop:
+				for (i = 0; i < BURST_SIZE; i++)
+					rte_pktmbuf_free(burst[i]);
+				break;
+			case free_type_bulk:
+				rte_pktmbuf_free_bulk(burst, BURST_SIZE);
+				break;
+			}
+			cycles[t] += rte_rdtsc_precise() - start;
+		}
+	}
+
+	for (t = 0; t < RTE_DIM(free_types); t++)
+		printf("%u pool(s), %s: %.2f ns/mbuf\n", nb_pools,
+		       free_type_desc(free_types[t]),
+		       (double)cycles[t] * 1E9 / rte_get_tsc_hz() /
+		       ((uint64_t)ITERATIONS * BURST_SIZE));
+
+	return 0;
+}
+
+static int
+test_mbuf_perf(void)
+{
+	static const unsigned int nb_pools_list[] = { 1, 2, 4 };
+	struct rte_mempool *pools[MAX_POOLS] = { NULL };
+	char name[RTE_MEMPOOL_NAMESIZE];
+	unsigned int i;
+	int ret = -1;
+
+	RTE_BUILD_BUG_ON(BURST_SIZE % MAX_POOLS != 0);
+
+	for (i = 0; i < MAX_POOLS; i++) {
+		snprintf(name, sizeof(name), "perf_mbuf_pool%u", i);
+		pools[i] = rte_pktmbuf_pool_create(name, NB_MBUF,
+				MBUF_CACHE_SIZE, 0, RTE_MBUF_DEFAULT_BUF_SIZE,
+				SOCKET_ID_ANY);
+		if (pools[i] == NULL) {
+			printf("cannot create mbuf pool %u\n", i);
+			goto out;
+		}
+	}
+
+	printf("Mbuf free latencies, bursts of %u mbufs:\n", BURST_SIZE);
+	for (i = 0; i < RTE_DIM(nb_pools_list); i++) {
+		if (test_mbuf_perf_free(pools, nb_pools_list[i]) < 0)
+			goto out;
+	}
+
+	ret = 0;
+
+out:
+	for (i = 0; i < MAX_POOLS; i++)
+		rte_mempool_free(pools[i]);
+	return ret;
+}
+
+REGISTER_TEST_COMMAND(mbuf_perf_autotest, test_mbuf_perf);
@@ -17,6 +17,8 @@
 struct rte_member_setsum *setsum_ht;
 struct rte_member_setsum *setsum_cache;
 struct rte_member_setsum *setsum_vbf;
+struct rte_member_setsum *setsum_sketch;
+struct rte_member_setsum *setsum_cf;
 
 /* 5-tuple key type */
 struct flow_key {
@@ -89,7 +91,7 @@ static struct rte_member_parameters params = {
 		.num_keys = MAX_ENTRIES,	/* Total hash table entries. */
 		.key_len = KEY_SIZE,		/* Length of hash key. */
 
-		/* num_set and false_positive_rate only relevant to vBF */
+		/* num_set and false_positive_rate only relevant to vBF and CF */
 		.num_set = 16,
 		.false_positive_rate = 0.03,
 		.prim_hash_seed = 1,
@@ -217,7 +219,58 @@ test_member_create_bad_param(void)
 		return -1;
 	}
 
+	bad_params.name = "bad_param6";
+	bad_params.type = RTE_MEMBER_TYPE_CF;
+	bad_params.num_keys = MAX_ENTRIES;
+	bad_params.num_set = 0;
+	/* Test with 0 set for CF should fail */
+	bad_setsum = rte_member_create(&bad_params);
+	if (bad_setsum != NULL) {
+		rte_member_free(bad_setsum);
+		printf("Impossible creating setsum successfully with invalid "
+			"number of set for CF\n");
+		return -1;
+	}
+
+	bad_params.name = "bad_param7";
+	bad_params.num_set = 32;
+	bad_params.fingerprint_bits = RTE_MEMBER_CF_ENTRY_BITS_MAX - 4;
+	/* Test with more than the maximum entry bits for CF should fail */
+	bad_setsum = rte_member_create(&bad_params);
+	if (bad_setsum != NULL) {
+		rte_member_free(bad_setsum);
+		printf("Impossible creating setsum successfully with too many "
+			"fingerprint and set id bits for CF\n");
+		return -1;
+	}
+
+	bad_params.name = "bad_param8";
+	bad_params.fingerprint_bits = RTE_MEMBER_CF_FP_BITS_MIN - 1;
+	/* Test with too short fingerprints for CF should fail */
+	bad_setsum = rte_member_create(&bad_params);
+	if (bad_setsum != NULL) {
+		rte_member_free(bad_setsum);
+		printf("Impossible creating setsum successfully with too few "
+			"fingerprint bits for CF\n");
+		return -1;
+	}
+
+	bad_params.name = "bad_param9";
+	bad_params.fingerprint_bits = 0;
+	bad_params.false_positive_rate = 0;
+	/* Test with neither fingerprint bits nor false positive rate for CF */
+	bad_setsum = rte_member_create(&bad_params);
+	if (bad_setsum != NULL) {
+		rte_member_free(bad_setsum);
+		printf("Impossible creating setsum successfully with invalid "
+			"false positive rate for CF\n");
+		return -1;
+	}
+
 	bad_params.name = "bad_param5";
+	bad_params.type = RTE_MEMBER_TYPE_HT;
+	bad_params.num_keys = RTE_MEMBER_ENTRIES_MAX + 1;
+	bad_params.false_positive_rate = 0.03;
 	/* Test with same name should fail */
 	bad_setsum = rte_member_create(&bad_params);
 	if (bad_setsum != NULL) {
@@ -249,7 +302,12 @@ static int test_member_create(void)
 	params.type = RTE_MEMBER_TYPE_VBF;
 	setsum_vbf = rte_member_create(&params);
 
-	if (setsum_ht == NULL || setsum_cache == NULL || setsum_vbf == NULL) {
+	params.name = "test_member_cf";
+	params.type = RTE_MEMBER_TYPE_CF;
+	setsum_cf = rte_member_create(&params);
+
+	if (setsum_ht == NULL || setsum_cache == NULL || setsum_vbf == NULL ||
+			setsum_cf == NULL) {
 		printf("Creation of setsums fail\n");
 		return -1;
 	}
@@ -259,31 +317,38 @@ static int test_member_create(void)
 
 static int test_member_insert(void)
 {
-	int ret_ht, ret_cache, ret_vbf, i;
+	int ret_ht, ret_cache, ret_vbf, ret_cf, i;
 
 	for (i = 0; i < NUM_SAMPLES; i++) {
 		ret_ht = rte_member_add(setsum_ht, &keys[i], test_set[i]);
 		ret_cache = rte_member_add(setsum_cache, &keys[i],
 						test_set[i]);
 		ret_vbf = rte_member_add(setsum_vbf, &keys[i], test_set[i]);
-		TEST_ASSERT(ret_ht >= 0 && ret_cache >= 0 && ret_vbf >= 0,
+		ret_cf = rte_member_add(setsum_cf, &keys[i], test_set[i]);
+		TEST_ASSERT(ret_ht >= 0 && ret_cache >= 0 && ret_vbf >= 0 &&
+				ret_cf >= 0,
 				"insert error");
 	}
+	/* CF set ids are limited by num_set */
+	ret_cf = rte_member_add(setsum_cf, &keys[0], params.num_set + 1);
+	TEST_ASSERT(ret_cf == -EINVAL, "CF insert with too large set id");
 	printf("insert key success\n");
 	return 0;
 }
 
 static int test_member_lookup(void)
 {
-	int ret_ht, ret_cache, ret_vbf, i;
-	uint16_t set_ht, set_cache, set_vbf;
+	int ret_ht, ret_cache, ret_vbf, ret_cf, i;
+	uint16_t set_ht, set_cache, set_vbf, set_cf;
 	member_set_t set_ids_ht[NUM_SAMPLES] = {0};
 	member_set_t set_ids_cache[NUM_SAMPLES] = {0};
 	member_set_t set_ids_vbf[NUM_SAMPLES] = {0};
+	member_set_t set_ids_cf[NUM_SAMPLES] = {0};
 
 	uint32_t num_key_ht = NUM_SAMPLES;
 	uint32_t num_key_cache = NUM_SAMPLES;
 	uint32_t num_key_vbf = NUM_SAMPLES;
+	uint32_t num_key_cf = NUM_SAMPLES;
 
 	const void *key_array[NUM_SAMPLES];
 
@@ -293,12 +358,15 @@ static int test_member_lookup(void)
 		ret_cache = rte_member_lookup(setsum_cache, &keys[i],
 							&set_cache);
 		ret_vbf = rte_member_lookup(setsum_vbf, &keys[i], &set_vbf);
-		TEST_ASSERT(ret_ht >= 0 && ret_cache >= 0 && ret_vbf >= 0,
+		ret_cf = rte_member_lookup(setsum_cf, &keys[i], &set_cf);
+		TEST_ASSERT(ret_ht >= 0 && ret_cache >= 0 && ret_vbf >= 0 &&
+				ret_cf >= 0,
 				"single lookup function error");
 
 		TEST_ASSERT(set_ht == test_set[i] &&
 				set_cache == test_set[i] &&
-				set_vbf == test_set[i],
+				set_vbf == test_set[i] &&
+				set_cf == test_set[i],
 				"single lookup set value error");
 	}
 	printf("lookup single key success\n");
@@ -316,13 +384,18 @@ static int test_member_lookup(void)
 	ret_vbf = rte_member_lookup_bulk(setsum_vbf, key_array,
 			num_key_vbf, set_ids_vbf);
 
-	TEST_ASSERT(ret_ht >= 0 && ret_cache >= 0 && ret_vbf >= 0,
+	ret_cf = rte_member_lookup_bulk(setsum_cf, key_array,
+			num_key_cf, set_ids_cf);
+
+	TEST_ASSERT(ret_ht >= 0 && ret_cache >= 0 && ret_vbf >= 0 &&
+			ret_cf >= 0,
 			"bulk lookup function error");
 
 	for (i = 0; i < NUM_SAMPLES; i++) {
 		TEST_ASSERT((set_ids_ht[i] == test_set[i]) &&
 				(set_ids_cache[i] == test_set[i]) &&
-				(set_ids_vbf[i] == test_set[i]),
+				(set_ids_vbf[i] == test_set[i]) &&
+				(set_ids_cf[i] == test_set[i]),
 				"bulk lookup result error");
 	}
 
@@ -331,15 +404,17 @@ static int test_member_lookup(void)
 
 static int test_member_delete(void)
 {
-	int ret_ht, ret_cache, ret_vbf, i;
-	uint16_t set_ht, set_cache, set_vbf;
+	int ret_ht, ret_cache, ret_vbf, ret_cf, i;
+	uint16_t set_ht, set_cache, set_vbf, set_cf;
 	const void *key_array[NUM_SAMPLES];
 	member_set_t set_ids_ht[NUM_SAMPLES] = {0};
 	member_set_t set_ids_cache[NUM_SAMPLES] = {0};
 	member_set_t set_ids_vbf[NUM_SAMPLES] = {0};
+	member_set_t set_ids_cf[NUM_SAMPLES] = {0};
 	uint32_t num_key_ht = NUM_SAMPLES;
 	uint32_t num_key_cache = NUM_SAMPLES;
 	uint32_t num_key_vbf = NUM_SAMPLES;
+	uint32_t num_key_cf = NUM_SAMPLES;
 
 	/* Delete part of all inserted keys */
 	for (i = 0; i < NUM_SAMPLES / 2; i++) {
@@ -347,13 +422,31 @@ static int test_member_delete(void)
 		ret_cache = rte_member_delete(setsum_cache, &keys[i],
 						test_set[i]);
 		ret_vbf = rte_member_delete(setsum_vbf, &keys[i], test_set[i]);
+		ret_cf = rte_member_delete(setsum_cf, &keys[i], test_set[i]);
 		/* VBF does not support delete yet, so return error code */
-		TEST_ASSERT(ret_ht >= 0 && ret_cache >= 0,
+		TEST_ASSERT(ret_ht >= 0 && ret_cache >= 0 && ret_cf >= 0,
 				"key deletion function error");
 		TEST_ASSERT(ret_vbf < 0,
 				"vbf does not support deletion, error");
 	}
 
+	/* A key is only deleted from the set it was added to */
+	i = NUM_SAMPLES - 1;
+	ret_ht = rte_member_delete(setsum_ht, &keys[i], test_set[i] + 1);
+	ret_cf = rte_member_delete(setsum_cf, &keys[i], test_set[i] + 1);
+	TEST_ASSERT(ret_ht == -ENOENT && ret_cf == -ENOENT,
+			"key deleted from another set");
+	ret_ht = rte_member_delete(setsum_ht, &keys[i], RTE_MEMBER_NO_MATCH);
+	ret_cf = rte_member_delete(setsum_cf, &keys[i], RTE_MEMBER_NO_MATCH);
+	TEST_ASSERT(ret_ht == -EINVAL && ret_cf == -EINVAL,
+			"key deleted from no set");
+
+	/* Deleted keys cannot be deleted again */
+	ret_ht = rte_member_delete(setsum_ht, &keys[0], test_set[0]);
+	ret_cf = rte_member_delete(setsum_cf, &keys[0], test_set[0]);
+	TEST_ASSERT(ret_ht == -ENOENT && ret_cf == -ENOENT,
+			"deleted key deleted again");
+
 	for (i = 0; i < NUM_SAMPLES; i++)
 		key_array[i] = &keys[i];
 
@@ -366,19 +459,25 @@ static int test_member_delete(void)
 	ret_vbf = rte_member_lookup_bulk(setsum_vbf, key_array,
 			num_key_vbf, set_ids_vbf);
 
-	TEST_ASSERT(ret_ht >= 0 && ret_cache >= 0 && ret_vbf >= 0,
+	ret_cf = rte_member_lookup_bulk(setsum_cf, key_array,
+			num_key_cf, set_ids_cf);
+
+	TEST_ASSERT(ret_ht >= 0 && ret_cache >= 0 && ret_vbf >= 0 &&
+			ret_cf >= 0,
 			"bulk lookup function error");
 
 	for (i = 0; i < NUM_SAMPLES / 2; i++) {
 		TEST_ASSERT((set_ids_ht[i] == RTE_MEMBER_NO_MATCH) &&
-				(set_ids_cache[i] == RTE_MEMBER_NO_MATCH),
+				(set_ids_cache[i] == RTE_MEMBER_NO_MATCH) &&
+				(set_ids_cf[i] == RTE_MEMBER_NO_MATCH),
 				"bulk lookup result error");
 	}
 
 	for (i = NUM_SAMPLES / 2; i < NUM_SAMPLES; i++) {
 		TEST_ASSERT((set_ids_ht[i] == test_set[i]) &&
 				(set_ids_cache[i] == test_set[i]) &&
-				(set_ids_vbf[i] == test_set[i]),
+				(set_ids_vbf[i] == test_set[i]) &&
+				(set_ids_cf[i] == test_set[i]),
 				"bulk lookup result error");
 	}
 
@@ -388,8 +487,9 @@ static int test_member_delete(void)
 		ret_cache = rte_member_delete(setsum_cache, &keys[i],
 						test_set[i]);
 		ret_vbf = rte_member_delete(setsum_vbf, &keys[i], test_set[i]);
+		ret_cf = rte_member_delete(setsum_cf, &keys[i], test_set[i]);
 		/* VBF does not support delete yet, so return error code */
-		TEST_ASSERT(ret_ht >= 0 && ret_cache >= 0,
+		TEST_ASSERT(ret_ht >= 0 && ret_cache >= 0 && ret_cf >= 0,
 				"key deletion function error");
 		TEST_ASSERT(ret_vbf < 0,
 				"vbf does not support deletion, error");
@@ -400,10 +500,12 @@ static int test_member_delete(void)
 		ret_cache = rte_member_lookup(setsum_cache, &keys[i],
 						&set_cache);
 		ret_vbf = rte_member_lookup(setsum_vbf, &keys[i], &set_vbf);
-		TEST_ASSERT(ret_ht >= 0 && ret_cache >= 0,
+		ret_cf = rte_member_lookup(setsum_cf, &keys[i], &set_cf);
+		TEST_ASSERT(ret_ht >= 0 && ret_cache >= 0 && ret_cf >= 0,
 				"key lookup function error");
 		TEST_ASSERT(set_ht == RTE_MEMBER_NO_MATCH &&
-				ret_cache == RTE_MEMBER_NO_MATCH,
+				ret_cache == RTE_MEMBER_NO_MATCH &&
+				set_cf == RTE_MEMBER_NO_MATCH,
 				"key deletion failed");
 	}
 	/* Reset vbf for other following tests */
@@ -415,36 +517,44 @@ static int test_member_delete(void)
 
 static int test_member_multimatch(void)
 {
-	int ret_ht, ret_vbf, ret_cache;
+	int ret_ht, ret_vbf, ret_cache, ret_cf;
 	member_set_t set_ids_ht[MAX_MATCH] = {0};
 	member_set_t set_ids_vbf[MAX_MATCH] = {0};
 	member_set_t set_ids_cache[MAX_MATCH] = {0};
+	member_set_t set_ids_cf[MAX_MATCH] = {0};
 
 	member_set_t set_ids_ht_m[NUM_SAMPLES][MAX_MATCH] = {{0} };
 	member_set_t set_ids_vbf_m[NUM_SAMPLES][MAX_MATCH] = {{0} };
 	member_set_t set_ids_cache_m[NUM_SAMPLES][MAX_MATCH] = {{0} };
+	member_set_t set_ids_cf_m[NUM_SAMPLES][MAX_MATCH] = {{0} };
 
 	uint32_t match_count_ht[NUM_SAMPLES];
 	uint32_t match_count_vbf[NUM_SAMPLES];
 	uint32_t match_count_cache[NUM_SAMPLES];
+	uint32_t match_count_cf[NUM_SAMPLES];
 
 	uint32_t num_key_ht = NUM_SAMPLES;
 	uint32_t num_key_vbf = NUM_SAMPLES;
 	uint32_t num_key_cache = NUM_SAMPLES;
+	uint32_t num_key_cf = NUM_SAMPLES;
 
 	const void *key_array[NUM_SAMPLES];
 
 	uint32_t i, j;
 
-	/* Same key at most inserted 2*entry_per_bucket times for HT mode */
+	/*
+	 * Same key at most inserted 2*entry_per_bucket times for HT mode,
+	 * which fills both buckets of the key for CF mode.
+	 */
 	for (i = M_MATCH_S; i <= M_MATCH_E; i += M_MATCH_STEP) {
 		for (j = 0; j < NUM_SAMPLES; j++) {
 			ret_ht = rte_member_add(setsum_ht, &keys[j], i);
 			ret_vbf = rte_member_add(setsum_vbf, &keys[j], i);
 			ret_cache = rte_member_add(setsum_cache, &keys[j], i);
+			ret_cf = rte_member_add(setsum_cf, &keys[j], i);
 
 			TEST_ASSERT(ret_ht >= 0 && ret_vbf >= 0 &&
-					ret_cache >= 0,
+					ret_cache >= 0 && ret_cf >= 0,
 					"insert function error");
 		}
 	}
@@ -457,12 +567,14 @@ static int test_member_multimatch(void)
 							MAX_MATCH, set_ids_ht);
 		ret_cache = rte_member_lookup_multi(setsum_cache, &keys[i],
 						MAX_MATCH, set_ids_cache);
+		ret_cf = rte_member_lookup_multi(setsum_cf, &keys[i],
+							MAX_MATCH, set_ids_cf);
 		/*
 		 * For cache mode, keys overwrite when signature same.
 		 * the mutimatch should work like single match.
 		 */
 		TEST_ASSERT(ret_ht == M_MATCH_CNT && ret_vbf == M_MATCH_CNT &&
-				ret_cache == 1,
+				ret_cache == 1 && ret_cf == M_MATCH_CNT,
 				"single lookup_multi error");
 		TEST_ASSERT(set_ids_cache[0] == M_MATCH_E,
 				"single lookup_multi cache error");
@@ -470,6 +582,8 @@ static int test_member_multimatch(void)
 		for (j = 1; j <= M_MATCH_CNT; j++) {
 			TEST_ASSERT(set_ids_ht[j-1] == j * M_MATCH_STEP - 1 &&
 					set_ids_vbf[j-1] ==
+							j * M_MATCH_STEP - 1 &&
+					set_ids_cf[j-1] ==
 							j * M_MATCH_STEP - 1,
 					"single multimatch lookup error");
 		}
@@ -491,6 +605,10 @@ static int test_member_multimatch(void)
 			&key_array[0], num_key_cache, MAX_MATCH,
 			match_count_cache, (member_set_t *)set_ids_cache_m);
 
+	ret_cf = rte_member_lookup_multi_bulk(setsum_cf,
+			&key_array[0], num_key_cf, MAX_MATCH, match_count_cf,
+			(member_set_t *)set_ids_cf_m);
+
 
 	for (j = 0; j < NUM_SAMPLES; j++) {
 		TEST_ASSERT(match_count_ht[j] == M_MATCH_CNT,
@@ -499,6 +617,8 @@ static int test_member_multimatch(void)
 			"bulk multimatch lookup vBF match count error");
 		TEST_ASSERT(match_count_cache[j] == 1,
 			"bulk multimatch lookup CACHE match count error");
+		TEST_ASSERT(match_count_cf[j] == M_MATCH_CNT,
+			"bulk multimatch lookup CF match count error");
 		TEST_ASSERT(set_ids_cache_m[j][0] == M_MATCH_E,
 			"bulk multimatch lookup CACHE set value error");
 
@@ -509,6 +629,9 @@ static int test_member_multimatch(void)
 			TEST_ASSERT(set_ids_vbf_m[j][i-1] ==
 							i * M_MATCH_STEP - 1,
 				"bulk multimatch lookup vBF set value error");
+			TEST_ASSERT(set_ids_cf_m[j][i-1] ==
+							i * M_MATCH_STEP - 1,
+				"bulk multimatch lookup CF set value error");
 		}
 	}
 
@@ -598,6 +721,8 @@ test_member_loadfactor(void)
 	rte_member_free(setsum_ht);
 	rte_member_free(setsum_cache);
 	rte_member_free(setsum_vbf);
+	rte_member_free(setsum_cf);
+	setsum_vbf = NULL;
 
 	params.key_len = KEY_SIZE;
 	params.name = "test_member_ht";
@@ -609,8 +734,12 @@ test_member_loadfactor(void)
 	params.is_cache = 1;
 	setsum_cache = rte_member_create(&params);
 
+	params.name = "test_member_cf";
+	params.is_cache = 0;
+	params.type = RTE_MEMBER_TYPE_CF;
+	setsum_cf = rte_member_create(&params);
 
-	if (setsum_ht == NULL || setsum_cache == NULL) {
+	if (setsum_ht == NULL || setsum_cache == NULL || setsum_cf == NULL) {
 		printf("Creation of setsums fail\n");
 		return -1;
 	}
@@ -662,6 +791,299 @@ test_member_loadfactor(void)
 	printf("\nKeys inserted when eviction happens(cache)= %.2f%% (%u/%u)\n",
 		((double) average_keys_added / params.num_keys * 100),
 		average_keys_added, params.num_keys);
+
+	/* Test CF mode, the table is sized to hold num_keys keys */
+	added_keys = average_keys_added = 0;
+	for (j = 0; j < ITERATIONS; j++) {
+		ret = add_generated_keys(setsum_cf, &added_keys);
+		if (ret < 0 || added_keys != params.num_keys) {
+			printf("Unexpected error when adding keys\n");
+			return -1;
+		}
+		average_keys_added += added_keys;
+
+		/* Reset the table */
+		rte_member_reset(setsum_cf);
+
+		/* Print a dot to show progress on operations */
+		printf(".");
+		fflush(stdout);
+	}
+
+	average_keys_added /= ITERATIONS;
+
+	printf("\nKeys inserted (CF) = %.2f%% of the entries (%u/%u)\n",
+		((double) average_keys_added / (setsum_cf->bucket_cnt *
+			RTE_MEMBER_CF_BUCKET_ENTRIES) * 100),
+		average_keys_added,
+		setsum_cf->bucket_cnt * RTE_MEMBER_CF_BUCKET_ENTRIES);
+	return 0;
+}
+
+#define CF_KEYS (MAX_ENTRIES / 2)
+
+/*
+ * Sequence of operations for CF setsummary, for 8 and 12 bit fingerprints
+ *
+ *  - add half of the generated keys to 16 sets
+ *  - lookup added keys: each matches its set, singly and in bulks
+ *  - lookup the other keys: false positive rate close to the estimate
+ *  - delete all added keys: every lookup misses
+ */
+static int
+test_member_cf(void)
+{
+	static const uint32_t fp_bits[] = {8, 12};
+	member_set_t set_ids[RTE_MEMBER_LOOKUP_BULK_MAX];
+	member_set_t multi_ids[MAX_MATCH];
+	const void *key_ptrs[RTE_MEMBER_LOOKUP_BULK_MAX];
+	uint32_t i, j, k, num_match, false_hits, num_entries;
+	member_set_t set_id;
+	double fpr_est;
+	int ret;
+
+	for (k = 0; k < RTE_DIM(fp_bits); k++) {
+		rte_member_free(setsum_cf);
+		params.name = "test_member_cf";
+		params.type = RTE_MEMBER_TYPE_CF;
+		params.num_set = 16;
+		params.fingerprint_bits = fp_bits[k];
+		setsum_cf = rte_member_create(&params);
+		TEST_ASSERT(setsum_cf != NULL, "CF creation failed");
+		TEST_ASSERT(setsum_cf->fp_bits == fp_bits[k] &&
+			setsum_cf->entry_bits == fp_bits[k] + 4,
+			"CF entry layout error");
+
+		for (i = 0; i < CF_KEYS; i++) {
+			ret = rte_member_add(setsum_cf, &generated_keys[i],
+					(i & 0xf) + 1);
+			TEST_ASSERT(ret >= 0, "CF add failed");
+		}
+
+		/* No false negatives */
+		for (i = 0; i < CF_KEYS; i++) {
+			num_match = rte_member_lookup_multi(setsum_cf,
+					&generated_keys[i], MAX_MATCH,
+					multi_ids);
+			for (j = 0; j < num_match; j++)
+				if (multi_ids[j] == (i & 0xf) + 1)
+					break;
+			TEST_ASSERT(j < num_match, "CF false negative");
+		}
+
+		/* False positives, bulk lookup matches single lookup */
+		false_hits = 0;
+		for (i = CF_KEYS; i < MAX_ENTRIES;
+				i += RTE_MEMBER_LOOKUP_BULK_MAX) {
+			for (j = 0; j < RTE_MEMBER_LOOKUP_BULK_MAX; j++)
+				key_ptrs[j] = &generated_keys[i + j];
+			false_hits += rte_member_lookup_bulk(setsum_cf,
+					key_ptrs, RTE_MEMBER_LOOKUP_BULK_MAX,
+					set_ids);
+			for (j = 0; j < RTE_MEMBER_LOOKUP_BULK_MAX; j++) {
+				rte_member_lookup(setsum_cf, key_ptrs[j],
+						&set_id);
+				TEST_ASSERT(set_id == set_ids[j],
+					"CF bulk and single lookups mismatch");
+			}
+		}
+
+		/* Two buckets of entries, a fingerprint is never 0 */
+		num_entries = setsum_cf->bucket_cnt *
+				RTE_MEMBER_CF_BUCKET_ENTRIES;
+		fpr_est = 2.0 * RTE_MEMBER_CF_BUCKET_ENTRIES * CF_KEYS /
+				num_entries / ((1 << fp_bits[k]) - 1);
+		printf("CF %u bit fingerprint: %u/%u false positives, "
+			"estimate %.3f%%\n", fp_bits[k], false_hits,
+			MAX_ENTRIES - CF_KEYS, fpr_est * 100);
+		TEST_ASSERT(false_hits <= 2 * fpr_est * (MAX_ENTRIES - CF_KEYS),
+			"CF false positive rate too high");
+
+		for (i = 0; i < CF_KEYS; i++) {
+			ret = rte_member_delete(setsum_cf, &generated_keys[i],
+					(i & 0xf) + 1);
+			TEST_ASSERT(ret == 0, "CF delete failed");
+		}
+		for (i = 0; i < MAX_ENTRIES; i++) {
+			ret = rte_member_lookup(setsum_cf, &generated_keys[i],
+					&set_id);
+			TEST_ASSERT(ret == 0 && set_id == RTE_MEMBER_NO_MATCH,
+				"CF key found after deleting all keys");
+		}
+	}
+	params.fingerprint_bits = 0;
+
+	printf("CF lookup and delete success\n");
+	return 0;
+}
+
+#define SKETCH_TOPK 16
+#define SKETCH_KEYS 8192
+#define SKETCH_ERROR_RATE 0.001
+#define SKETCH_ERROR_PROB 0.01
+
+/*
+ * Sequence of operations for sketch setsummary
+ *
+ *  - create with bad parameters: fail
+ *  - count SKETCH_TOPK heavy keys many times and the other keys once,
+ *    singly and in bulks
+ *  - estimated counts: never below, and mostly close to the actual counts
+ *  - heavy hitters: the heavy keys, in decreasing order of count
+ *  - decay halves the counts, reset zeroes them
+ */
+static int
+test_member_sketch(void)
+{
+	static uint64_t actual[SKETCH_KEYS];
+	uint64_t counts[RTE_MEMBER_LOOKUP_BULK_MAX];
+	uint64_t hh_counts[SKETCH_TOPK];
+	const void *key_ptrs[RTE_MEMBER_LOOKUP_BULK_MAX];
+	void *hh_keys[SKETCH_TOPK];
+	uint64_t count, total = 0;
+	uint32_t i, j, num_above = 0;
+	member_set_t set_id;
+	int ret;
+	struct rte_member_parameters sketch_params = {
+		.name = "test_member_sketch",
+		.key_len = KEY_SIZE,
+		.type = RTE_MEMBER_TYPE_SKETCH,
+		.prim_hash_seed = 1,
+		.sec_hash_seed = 11,
+		.socket_id = 0,
+		.error_rate = 0,
+		.error_prob = SKETCH_ERROR_PROB,
+		.top_k = SKETCH_TOPK,
+	};
+
+	printf("Expected error section begin...\n");
+	/* Test with 0 error rate should fail */
+	setsum_sketch = rte_member_create(&sketch_params);
+	TEST_ASSERT(setsum_sketch == NULL, "sketch created with 0 error rate");
+
+	/* Test with error probability of 1 should fail */
+	sketch_params.error_rate = SKETCH_ERROR_RATE;
+	sketch_params.error_prob = 1;
+	setsum_sketch = rte_member_create(&sketch_params);
+	TEST_ASSERT(setsum_sketch == NULL,
+		"sketch created with error probability of 1");
+
+	/* Test with too many heavy hitters should fail */
+	sketch_params.error_prob = SKETCH_ERROR_PROB;
+	sketch_params.top_k = RTE_MEMBER_SKETCH_TOPK_MAX + 1;
+	setsum_sketch = rte_member_create(&sketch_params);
+	TEST_ASSERT(setsum_sketch == NULL,
+		"sketch created with too many heavy hitters");
+	printf("Expected error section end...\n");
+
+	sketch_params.top_k = SKETCH_TOPK;
+	setsum_sketch = rte_member_create(&sketch_params);
+	TEST_ASSERT(setsum_sketch != NULL, "sketch creation failed");
+
+	/* The counting API is only for sketch */
+	TEST_ASSERT(rte_member_add_count(setsum_ht, &generated_keys[0], 1) ==
+		-EINVAL, "count added to a HT setsummary");
+	TEST_ASSERT(rte_member_delete(setsum_sketch, &generated_keys[0], 1) ==
+		-EINVAL, "key deleted from a sketch");
+
+	/* Heavy keys: key i counted 1000 * (i + 1) times */
+	for (i = 0; i < SKETCH_TOPK; i++) {
+		for (j = 0; j < 10; j++) {
+			ret = rte_member_add_count(setsum_sketch,
+					&generated_keys[i], 100 * (i + 1));
+			TEST_ASSERT(ret == 0, "count add failed");
+		}
+		ret = rte_member_add(setsum_sketch, &generated_keys[i], 0);
+		TEST_ASSERT(ret == 0, "add failed");
+		actual[i] = 1000 * (i + 1) + 1;
+	}
+
+	/* Other keys: counted once, in bulks */
+	for (i = SKETCH_TOPK; i < SKETCH_KEYS;
+			i += RTE_MEMBER_LOOKUP_BULK_MAX) {
+		for (j = 0; j < RTE_MEMBER_LOOKUP_BULK_MAX; j++) {
+			key_ptrs[j] = &generated_keys[(i + j) % SKETCH_KEYS];
+			actual[(i + j) % SKETCH_KEYS]++;
+		}
+		ret = rte_member_add_count_bulk(setsum_sketch, key_ptrs,
+				RTE_MEMBER_LOOKUP_BULK_MAX, NULL);
+		TEST_ASSERT(ret == 0, "bulk count add failed");
+	}
+
+	for (i = 0; i < SKETCH_KEYS; i++)
+		total += actual[i];
+
+	/* Estimated counts, singly and in bulks */
+	for (i = 0; i < SKETCH_KEYS; i += RTE_MEMBER_LOOKUP_BULK_MAX) {
+		for (j = 0; j < RTE_MEMBER_LOOKUP_BULK_MAX; j++)
+			key_ptrs[j] = &generated_keys[i + j];
+		ret = rte_member_query_count_bulk(setsum_sketch, key_ptrs,
+				RTE_MEMBER_LOOKUP_BULK_MAX, counts);
+		TEST_ASSERT(ret == 0, "bulk count query failed");
+
+		for (j = 0; j < RTE_MEMBER_LOOKUP_BULK_MAX; j++) {
+			ret = rte_member_query_count(setsum_sketch,
+					&generated_keys[i + j], &count);
+			TEST_ASSERT(ret == 0, "count query failed");
+			TEST_ASSERT(count == counts[j],
+				"bulk and single count queries mismatch");
+			TEST_ASSERT(count >= actual[i + j],
+				"estimated count below the actual count");
+			if (count - actual[i + j] > SKETCH_ERROR_RATE * total)
+				num_above++;
+		}
+	}
+	printf("%u/%u estimated counts above the error bound\n",
+		num_above, SKETCH_KEYS);
+	TEST_ASSERT(num_above <= 2 * SKETCH_ERROR_PROB * SKETCH_KEYS,
+		"too many estimated counts above the error bound");
+
+	/* The heavy keys are the heavy hitters, the largest first */
+	ret = rte_member_report_heavyhitter(setsum_sketch, hh_keys, hh_counts);
+	TEST_ASSERT(ret == SKETCH_TOPK, "wrong number of heavy hitters");
+	for (i = 0; i < SKETCH_TOPK; i++) {
+		TEST_ASSERT(memcmp(hh_keys[i],
+			&generated_keys[SKETCH_TOPK - 1 - i], KEY_SIZE) == 0,
+			"wrong heavy hitter");
+		TEST_ASSERT(hh_counts[i] >= actual[SKETCH_TOPK - 1 - i],
+			"heavy hitter count below the actual count");
+	}
+
+	ret = rte_member_lookup(setsum_sketch, &generated_keys[0], &set_id);
+	TEST_ASSERT(ret == 1 && set_id == 1, "heavy hitter lookup failed");
+	ret = rte_member_lookup(setsum_sketch, &generated_keys[SKETCH_TOPK],
+			&set_id);
+	TEST_ASSERT(ret == 0 && set_id == RTE_MEMBER_NO_MATCH,
+		"light key found as heavy hitter");
+
+	/* Decay halves the counts */
+	for (i = 0; i < SKETCH_TOPK; i++)
+		key_ptrs[i] = &generated_keys[i];
+	rte_member_query_count_bulk(setsum_sketch, key_ptrs, SKETCH_TOPK,
+			counts);
+	ret = rte_member_decay_count(setsum_sketch, 1);
+	TEST_ASSERT(ret == 0, "count decay failed");
+	for (i = 0; i < SKETCH_TOPK; i++) {
+		rte_member_query_count(setsum_sketch, &generated_keys[i],
+				&count);
+		TEST_ASSERT(count == counts[i] >> 1,
+			"count not halved by decay");
+	}
+	ret = rte_member_report_heavyhitter(setsum_sketch, hh_keys, counts);
+	TEST_ASSERT(ret == SKETCH_TOPK && counts[0] == hh_counts[0] >> 1,
+		"heavy hitter count not halved by decay");
+
+	/* Reset zeroes the counts */
+	rte_member_reset(setsum_sketch);
+	for (i = 0; i < SKETCH_TOPK; i++) {
+		rte_member_query_count(setsum_sketch, &generated_keys[i],
+				&count);
+		TEST_ASSERT(count == 0, "count not zeroed by reset");
+	}
+	ret = rte_member_report_heavyhitter(setsum_sketch, hh_keys, counts);
+	TEST_ASSERT(ret == 0, "heavy hitters not removed by reset");
+
+	printf("sketch count and heavy hitters success\n");
 	return 0;
 }
 
@@ -671,6 +1093,8 @@ perform_free(void)
 	rte_member_free(setsum_ht);
 	rte_member_free(setsum_cache);
 	rte_member_free(setsum_vbf);
+	rte_member_free(setsum_sketch);
+	rte_member_free(setsum_cf);
 }
 
 static int
@@ -705,6 +1129,15 @@ test_member(void)
 	if (test_member_loadfactor() < 0) {
 		rte_member_free(setsum_ht);
 		rte_member_free(setsum_cache);
+		rte_member_free(setsum_cf);
+		return -1;
+	}
+	if (test_member_cf() < 0) {
+		perform_free();
+		return -1;
+	}
+	if (test_member_sketch() < 0) {
+		perform_free();
 		return -1;
 	}
 
@@ -4,6 +4,7 @@
 
 #include <stdio.h>
 #include <inttypes.h>
+#include <math.h>
 
 #include <rte_lcore.h>
 #include <rte_cycles.h>
@@ -24,6 +25,10 @@
 #define VBF_SET_CNT 16
 #define BURST_SIZE 64
 #define VBF_FALSE_RATE 0.03
+#define CF_FP_BITS 12
+#define SKETCH_ERROR_RATE 0.0001
+#define SKETCH_ERROR_PROB 0.01
+#define SKETCH_TOPK 64
 
 static unsigned int test_socket_id;
 
@@ -31,6 +36,7 @@ enum sstype {
 	HT = 0,
 	CACHE,
 	VBF,
+	CF,
 	NUM_TYPE
 };
 
@@ -45,6 +51,14 @@ enum operations {
 	NUM_OPERATIONS
 };
 
+enum sketch_operations {
+	SKETCH_ADD = 0,
+	SKETCH_ADD_BULK,
+	SKETCH_QUERY,
+	SKETCH_QUERY_BULK,
+	NUM_SKETCH_OPERATIONS
+};
+
 struct  member_perf_params {
 	struct rte_member_setsum *setsum[NUM_TYPE];
 	uint32_t key_size;
@@ -73,6 +87,23 @@ static uint64_t false_data_multi_bulk[NUM_TYPE][NUM_KEYSIZES];
 
 static uint64_t false_hit[NUM_TYPE][NUM_KEYSIZES];
 
+/* Memory size of the setsummaries holding half of the keys */
+static uint64_t mem_size[NUM_TYPE][NUM_KEYSIZES];
+
+/* False positives and memory size of a vBF sized like the HT or CF one */
+static uint64_t vbf_same_mem_false_hit[NUM_TYPE][NUM_KEYSIZES];
+static uint64_t vbf_same_mem_size[NUM_TYPE][NUM_KEYSIZES];
+
+/* Sketch cycles per operation, estimation error and heavy hitter recall */
+static uint64_t sketch_cycles[NUM_KEYSIZES][NUM_SKETCH_OPERATIONS];
+static double sketch_avg_error[NUM_KEYSIZES];
+static uint64_t sketch_max_error[NUM_KEYSIZES];
+static double sketch_recall[NUM_KEYSIZES];
+
+/* Skewed stream of key indexes counted by sketch, and their actual counts */
+static uint32_t sketch_stream[NUM_LOOKUPS];
+static uint64_t sketch_count[KEYS_TO_ADD];
+
 static member_set_t data[NUM_TYPE][/* Array to store the data */KEYS_TO_ADD];
 
 /* Array to store all input keys */
@@ -111,7 +142,7 @@ struct rte_member_parameters member_params = {
 		.num_keys = MAX_ENTRIES,	/* Total hash table entries. */
 		.key_len = 4,			/* Length of hash key. */
 
-		/* num_set and false_positive_rate only relevant to vBF */
+		/* num_set relevant to vBF and CF, false_positive_rate to vBF */
 		.num_set = VBF_SET_CNT,
 		.false_positive_rate = 0.03,
 		.prim_hash_seed = 0,
@@ -139,7 +170,7 @@ setup_keys_and_data(struct member_perf_params *params, unsigned int cycle,
 			keys[i][j] = rte_rand() & 0xFF;
 
 		data[HT][i] = data[CACHE][i] = (rte_rand() & 0x7FFE) + 1;
-		data[VBF][i] = rte_rand() % VBF_SET_CNT + 1;
+		data[VBF][i] = data[CF][i] = rte_rand() % VBF_SET_CNT + 1;
 	}
 
 	/* Remove duplicates from the keys array */
@@ -197,6 +228,13 @@ setup_keys_and_data(struct member_perf_params *params, unsigned int cycle,
 	params->setsum[VBF] = rte_member_create(&member_params);
 	if (params->setsum[VBF] == NULL)
 		fprintf(stderr, "VBF create fail\n");
+
+	member_params.name = "test_member_cf";
+	member_params.type = RTE_MEMBER_TYPE_CF;
+	member_params.fingerprint_bits = CF_FP_BITS;
+	params->setsum[CF] = rte_member_create(&member_params);
+	if (params->setsum[CF] == NULL)
+		fprintf(stderr, "CF create fail\n");
 	for (i = 0; i < NUM_TYPE; i++) {
 		if (params->setsum[i] == NULL)
 			return -1;
@@ -251,8 +289,10 @@ timed_lookups(struct member_perf_params *params, int type)
 				printf("lookup wrong internally");
 				return -1;
 			}
-			if (type == HT && result == RTE_MEMBER_NO_MATCH) {
-				printf("HT mode shouldn't have false negative");
+			if ((type == HT || type == CF) &&
+					result == RTE_MEMBER_NO_MATCH) {
+				printf("HT and CF modes shouldn't have false "
+					"negative");
 				return -1;
 			}
 			if (result != data[type][j])
@@ -295,9 +335,9 @@ timed_lookups_bulk(struct member_perf_params *params, int type)
 			}
 			for (k = 0; k < BURST_SIZE; k++) {
 				uint32_t data_idx = j * BURST_SIZE + k;
-				if (type == HT && result[k] ==
+				if ((type == HT || type == CF) && result[k] ==
 						RTE_MEMBER_NO_MATCH) {
-					printf("HT mode shouldn't have "
+					printf("HT and CF modes shouldn't have "
 						"false negative");
 					return -1;
 				}
@@ -333,8 +373,9 @@ timed_lookups_multimatch(struct member_perf_params *params, int type)
 				printf("lookup multi has wrong return value %d,"
 					"type %d\n", ret, type);
 			}
-			if (type == HT && ret == 0) {
-				printf("HT mode shouldn't have false negative");
+			if ((type == HT || type == CF) && ret == 0) {
+				printf("HT and CF modes shouldn't have false "
+					"negative");
 				return -1;
 			}
 			/*
@@ -389,8 +430,9 @@ timed_lookups_multimatch_bulk(struct member_perf_params *params, int type)
 						"wrong match count\n");
 					return -1;
 				}
-				if (type == HT && match_count[k] == 0) {
-					printf("HT mode shouldn't have "
+				if ((type == HT || type == CF) &&
+						match_count[k] == 0) {
+					printf("HT and CF modes shouldn't have "
 						"false negative");
 					return -1;
 				}
@@ -436,6 +478,24 @@ timed_deletes(struct member_perf_params *params, int type)
 	return 0;
 }
 
+static uint64_t
+setsum_mem_size(const struct rte_member_setsum *setsum)
+{
+	switch (setsum->type) {
+	case RTE_MEMBER_TYPE_HT:
+		/* buckets of 16-bit signatures and 16-bit set ids */
+		return (uint64_t)setsum->bucket_cnt * RTE_MEMBER_BUCKET_ENTRIES *
+			(sizeof(uint16_t) + sizeof(member_set_t));
+	case RTE_MEMBER_TYPE_VBF:
+		return (uint64_t)setsum->num_set * setsum->bits / 8;
+	case RTE_MEMBER_TYPE_CF:
+		return (uint64_t)setsum->bucket_cnt *
+			RTE_MEMBER_CF_BUCKET_ENTRIES * setsum->entry_bits / 8;
+	default:
+		return 0;
+	}
+}
+
 static int
 timed_miss_lookup(struct member_perf_params *params, int type)
 {
@@ -443,6 +503,7 @@ timed_miss_lookup(struct member_perf_params *params, int type)
 	int ret;
 
 	false_hit[type][params->cycle] = 0;
+	mem_size[type][params->cycle] = setsum_mem_size(params->setsum[type]);
 
 	for (i = 0; i < KEYS_TO_ADD / 2; i++) {
 		ret = rte_member_add(params->setsum[type], &keys[i],
@@ -482,6 +543,175 @@ timed_miss_lookup(struct member_perf_params *params, int type)
 	return 0;
 }
 
+/*
+ * Count the false positives of a vBF holding the same keys as the HT or CF
+ * setsummary in at least as much memory, by lowering its target false
+ * positive rate until it gets as large, so that both compare at equal bits
+ * per key, or more for the vBF as its BFs are rounded to a power of 2.
+ */
+static int
+vbf_same_mem_miss_lookup(struct member_perf_params *params, int type)
+{
+	struct rte_member_parameters vbf_params = member_params;
+	struct rte_member_setsum *vbf = NULL;
+	uint64_t mem = setsum_mem_size(params->setsum[type]);
+	float false_positive_rate = VBF_FALSE_RATE;
+	member_set_t result;
+	unsigned int i, j;
+	int ret = -1;
+
+	vbf_params.name = "test_member_vbf_same_mem";
+	vbf_params.type = RTE_MEMBER_TYPE_VBF;
+	vbf_params.num_keys = KEYS_TO_ADD / 2;
+	do {
+		rte_member_free(vbf);
+		vbf_params.false_positive_rate = false_positive_rate;
+		vbf = rte_member_create(&vbf_params);
+		if (vbf == NULL) {
+			printf("vBF create fail\n");
+			return -1;
+		}
+		false_positive_rate /= 2;
+	} while (setsum_mem_size(vbf) < mem);
+
+	vbf_same_mem_false_hit[type][params->cycle] = 0;
+	vbf_same_mem_size[type][params->cycle] = setsum_mem_size(vbf);
+
+	for (i = 0; i < KEYS_TO_ADD / 2; i++) {
+		if (rte_member_add(vbf, &keys[i], data[VBF][i]) < 0) {
+			printf("Error in rte_member_add\n");
+			goto out;
+		}
+	}
+
+	for (i = 0; i < 2 * NUM_LOOKUPS / KEYS_TO_ADD; i++) {
+		for (j = KEYS_TO_ADD / 2; j < KEYS_TO_ADD; j++) {
+			if (rte_member_lookup(vbf, &keys[j], &result) < 0) {
+				printf("lookup wrong internally");
+				goto out;
+			}
+			if (result != RTE_MEMBER_NO_MATCH)
+				vbf_same_mem_false_hit[type][params->cycle]++;
+		}
+	}
+	ret = 0;
+
+out:
+	rte_member_free(vbf);
+	return ret;
+}
+
+static int
+count_compare(const void *a, const void *b)
+{
+	uint64_t x = sketch_count[*(const uint32_t *)a];
+	uint64_t y = sketch_count[*(const uint32_t *)b];
+
+	return (x < y) - (x > y);
+}
+
+/*
+ * Count a skewed stream of keys, where the n-th most frequent key is
+ * about n times less frequent than the most frequent one, as flows are:
+ * the logarithm of the key index is uniformly distributed.
+ */
+static int
+timed_sketch(struct member_perf_params *params)
+{
+	static uint32_t order[KEYS_TO_ADD];
+	struct rte_member_setsum *sketch;
+	const void *keys_burst[BURST_SIZE];
+	uint64_t counts[BURST_SIZE];
+	uint64_t start_tsc, count, error, sum_error = 0, max_error = 0;
+	unsigned int i, j, found = 0;
+	member_set_t set_id;
+	int ret = -1;
+
+	memset(sketch_count, 0, sizeof(sketch_count));
+	for (i = 0; i < NUM_LOOKUPS; i++) {
+		sketch_stream[i] = exp((double)rte_rand() / UINT64_MAX *
+				log(KEYS_TO_ADD)) - 1;
+		sketch_count[sketch_stream[i]]++;
+	}
+
+	member_params.name = "test_member_sketch";
+	member_params.type = RTE_MEMBER_TYPE_SKETCH;
+	member_params.key_len = params->key_size;
+	member_params.error_rate = SKETCH_ERROR_RATE;
+	member_params.error_prob = SKETCH_ERROR_PROB;
+	member_params.top_k = SKETCH_TOPK;
+	sketch = rte_member_create(&member_params);
+	if (sketch == NULL) {
+		fprintf(stderr, "sketch create fail\n");
+		return -1;
+	}
+
+	start_tsc = rte_rdtsc();
+	for (i = 0; i < NUM_LOOKUPS; i++) {
+		if (rte_member_add_count(sketch, &keys[sketch_stream[i]],
+				1) < 0) {
+			printf("sketch count add error\n");
+			goto exit;
+		}
+	}
+	sketch_cycles[params->cycle][SKETCH_ADD] =
+			(rte_rdtsc() - start_tsc) / NUM_LOOKUPS;
+
+	rte_member_reset(sketch);
+	start_tsc = rte_rdtsc();
+	for (i = 0; i < NUM_LOOKUPS; i += BURST_SIZE) {
+		for (j = 0; j < BURST_SIZE; j++)
+			keys_burst[j] = keys[sketch_stream[i + j]];
+		if (rte_member_add_count_bulk(sketch, keys_burst, BURST_SIZE,
+				NULL) < 0) {
+			printf("sketch bulk count add error\n");
+			goto exit;
+		}
+	}
+	sketch_cycles[params->cycle][SKETCH_ADD_BULK] =
+			(rte_rdtsc() - start_tsc) / NUM_LOOKUPS;
+
+	start_tsc = rte_rdtsc();
+	for (i = 0; i < KEYS_TO_ADD; i++) {
+		rte_member_query_count(sketch, &keys[i], &count);
+		if (count < sketch_count[i]) {
+			printf("sketch estimated count below actual count\n");
+			goto exit;
+		}
+		error = count - sketch_count[i];
+		sum_error += error;
+		max_error = RTE_MAX(max_error, error);
+	}
+	sketch_cycles[params->cycle][SKETCH_QUERY] =
+			(rte_rdtsc() - start_tsc) / KEYS_TO_ADD;
+
+	start_tsc = rte_rdtsc();
+	for (i = 0; i < KEYS_TO_ADD / BURST_SIZE; i++) {
+		for (j = 0; j < BURST_SIZE; j++)
+			keys_burst[j] = keys[i * BURST_SIZE + j];
+		rte_member_query_count_bulk(sketch, keys_burst, BURST_SIZE,
+				counts);
+	}
+	sketch_cycles[params->cycle][SKETCH_QUERY_BULK] =
+			(rte_rdtsc() - start_tsc) / KEYS_TO_ADD;
+
+	sketch_avg_error[params->cycle] = (double)sum_error / KEYS_TO_ADD;
+	sketch_max_error[params->cycle] = max_error;
+
+	/* Share of the actual top keys found as heavy hitters */
+	for (i = 0; i < KEYS_TO_ADD; i++)
+		order[i] = i;
+	qsort(order, KEYS_TO_ADD, sizeof(order[0]), count_compare);
+	for (i = 0; i < SKETCH_TOPK; i++)
+		found += rte_member_lookup(sketch, &keys[order[i]], &set_id);
+	sketch_recall[params->cycle] = (double)found / SKETCH_TOPK;
+
+	ret = 0;
+exit:
+	rte_member_free(sketch);
+	return ret;
+}
+
 static void
 perform_frees(struct member_perf_params *params)
 {
@@ -551,6 +781,10 @@ run_all_tbl_perf_tests(void)
 
 			/* Print a dot to show progress on operations */
 		}
+
+		if (timed_sketch(&params) < 0)
+			return exit_with_fail("timed_sketch", &params, i,
+						NUM_TYPE);
 		printf(".");
 		fflush(stdout);
 
@@ -568,6 +802,12 @@ run_all_tbl_perf_tests(void)
 				return exit_with_fail("timed_miss_lookup",
 						&params, i, j);
 		}
+		if (vbf_same_mem_miss_lookup(&params, HT) < 0)
+			return exit_with_fail("vbf_same_mem_miss_lookup",
+					&params, i, HT);
+		if (vbf_same_mem_miss_lookup(&params, CF) < 0)
+			return exit_with_fail("vbf_same_mem_miss_lookup",
+					&params, i, CF);
 		perform_frees(&params);
 	}
 
@@ -589,9 +829,10 @@ run_all_tbl_perf_tests(void)
 
 	printf("\nFalse results rate (and false positive rate)\n");
 	printf("-----------------------------------\n");
-	printf("\n%-18s%-18s%-18s%-18s%-18s%-18s%-18s\n",
+	printf("\n%-18s%-18s%-18s%-18s%-18s%-18s%-21s%-18s\n",
 			"Keysize", "type",  "fr_single", "fr_bulk", "fr_multi",
-			"fr_multi_bulk", "false_positive_rate");
+			"fr_multi_bulk", "false_positive_rate",
+			"bits_per_key");
 	/* Key size not influence False rate so just print out one key size */
 	for (i = 0; i < 1; i++) {
 		for (j = 0; j < NUM_TYPE; j++) {
@@ -604,11 +845,46 @@ run_all_tbl_perf_tests(void)
 						NUM_LOOKUPS);
 			printf("%-18f", (float)false_data_multi_bulk[j][i] /
 						NUM_LOOKUPS);
-			printf("%-18f", (float)false_hit[j][i] /
+			printf("%-21f", (float)false_hit[j][i] /
 						NUM_LOOKUPS);
+			printf("%-18f", (float)mem_size[j][i] * 8 /
+						(KEYS_TO_ADD / 2));
 			printf("\n");
 		}
 	}
+
+	printf("\nFalse positive rate of a vBF at least as large as the HT and "
+		"CF setsummaries\n");
+	printf("-----------------------------------\n");
+	printf("\n%-18s%-18s%-21s%-18s\n", "Keysize", "as_large_as_type",
+			"false_positive_rate", "bits_per_key");
+	for (j = 0; j < NUM_TYPE; j++) {
+		if (j != HT && j != CF)
+			continue;
+		printf("%-18d", hashtest_key_lens[0]);
+		printf("%-18d", j);
+		printf("%-21f", (float)vbf_same_mem_false_hit[j][0] /
+					NUM_LOOKUPS);
+		printf("%-18f", (float)vbf_same_mem_size[j][0] * 8 /
+					(KEYS_TO_ADD / 2));
+		printf("\n");
+	}
+
+	printf("\nSketch results (in CPU cycles/operation), estimation error "
+		"and heavy hitter recall\n");
+	printf("-----------------------------------\n");
+	printf("\n%-18s%-18s%-18s%-18s%-18s%-18s%-18s%-18s\n",
+			"Keysize", "Add", "Add_bulk", "Query", "Query_bulk",
+			"avg_error", "max_error", "top_recall");
+	for (i = 0; i < NUM_KEYSIZES; i++) {
+		printf("%-18d", hashtest_key_lens[i]);
+		for (k = 0; k < NUM_SKETCH_OPERATIONS; k++)
+			printf("%-18"PRIu64, sketch_cycles[i][k]);
+		printf("%-18f", sketch_avg_error[i]);
+		printf("%-18"PRIu64, sketch_max_error[i]);
+		printf("%-18f", sketch_recall[i]);
+		printf("\n");
+	}
 	return 0;
 }
 
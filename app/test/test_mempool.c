@@ -24,6 +24,7 @@
 #include <rte_lcore.h>
 #include <rte_branch_prediction.h>
 #include <rte_mempool.h>
+#include <rte_mempool_zc.h>
 #include <rte_spinlock.h>
 #include <rte_malloc.h>
 #include <rte_mbuf_pool_ops.h>
@@ -435,6 +436,159 @@ test_mempool_basic_ex(struct rte_mempool *mp)
 	return ret;
 }
 
+/*
+ * Get and put objects with the zero copy cache API, checking that the
+ * cache is refilled and flushed the same way as with the copying API.
+ */
+static int
+test_mempool_zc(struct rte_mempool *mp)
+{
+	void *obj_table[MAX_KEEP];
+	struct rte_mempool_cache *cache;
+	unsigned int avail, len, i;
+	void **cache_objs;
+	int ret = -1;
+
+	cache = rte_mempool_cache_create(RTE_MEMPOOL_CACHE_MAX_SIZE,
+					 SOCKET_ID_ANY);
+	if (cache == NULL)
+		RET_ERR();
+	avail = rte_mempool_avail_count(mp);
+
+	/* borrowing as many objects as the cache size is refused */
+	if (rte_mempool_cache_zc_get_bulk_start(cache, mp,
+			cache->size) != NULL)
+		GOTO_ERR(ret, out);
+
+	/* borrowing from the empty cache refills it */
+	cache_objs = rte_mempool_cache_zc_get_bulk_start(cache, mp, MAX_KEEP);
+	if (cache_objs == NULL)
+		GOTO_ERR(ret, out);
+	for (i = 0; i < MAX_KEEP; i++)
+		obj_table[i] = cache_objs[i];
+	rte_mempool_cache_zc_get_finish(cache, mp, MAX_KEEP);
+	if (cache->len != cache->size)
+		GOTO_ERR(ret, out);
+	if (rte_mempool_avail_count(mp) + cache->len != avail - MAX_KEEP)
+		GOTO_ERR(ret, out);
+	for (i = 0; i < MAX_KEEP; i++)
+		if (rte_mempool_from_obj(obj_table[i]) != mp)
+			GOTO_ERR(ret, out);
+
+	/* reserving more slots than the max cache size is refused */
+	if (rte_mempool_cache_zc_put_bulk_start(cache, mp,
+			RTE_MEMPOOL_CACHE_MAX_SIZE + 1) != NULL)
+		GOTO_ERR(ret, out);
+
+	/* put the objects back */
+	cache_objs = rte_mempool_cache_zc_put_bulk_start(cache, mp, MAX_KEEP);
+	if (cache_objs == NULL)
+		GOTO_ERR(ret, out);
+	for (i = 0; i < MAX_KEEP; i++)
+		cache_objs[i] = obj_table[i];
+	rte_mempool_cache_zc_put_finish(cache, mp, MAX_KEEP);
+	if (rte_mempool_avail_count(mp) + cache->len != avail)
+		GOTO_ERR(ret, out);
+
+	/* putting objects up to the flush threshold flushes the cache */
+	do {
+		len = cache->len;
+		if (rte_mempool_generic_get(mp, obj_table, MAX_KEEP,
+					    NULL) < 0)
+			GOTO_ERR(ret, out);
+		cache_objs = rte_mempool_cache_zc_put_bulk_start(cache, mp,
+								 MAX_KEEP);
+		if (cache_objs == NULL)
+			GOTO_ERR(ret, out);
+		for (i = 0; i < MAX_KEEP; i++)
+			cache_objs[i] = obj_table[i];
+		rte_mempool_cache_zc_put_finish(cache, mp, MAX_KEEP);
+	} while (cache->len == len + MAX_KEEP);
+	if (cache->len != cache->size || len + MAX_KEEP < cache->flushthresh)
+		GOTO_ERR(ret, out);
+
+	rte_mempool_cache_flush(cache, mp);
+	if (rte_mempool_avail_count(mp) != avail)
+		GOTO_ERR(ret, out);
+
+	ret = 0;
+
+out:
+	rte_mempool_cache_flush(cache, mp);
+	rte_mempool_cache_free(cache);
+	return ret;
+}
+
+/*
+ * Check that an adaptive cache shrinks when only used to put objects,
+ * grows back when gets keep missing it, and shrinks again, releasing
+ * its extra objects, when it serves all gets.
+ */
+static int
+test_mempool_cache_adaptive(void)
+{
+	const unsigned int max_size = RTE_MEMPOOL_CACHE_MAX_SIZE;
+	void *obj_table[MAX_KEEP];
+	struct rte_mempool_cache *cache;
+	struct rte_mempool *mp;
+	unsigned int i;
+	int ret = -1;
+
+	mp = rte_mempool_create("test_cache_adaptive", 4095, 64, max_size, 0,
+				NULL, NULL, NULL, NULL, SOCKET_ID_ANY,
+				RTE_MEMPOOL_F_CACHE_ADAPTIVE);
+	if (mp == NULL)
+		RET_ERR();
+	cache = rte_mempool_default_cache(mp, rte_lcore_id());
+	if (cache == NULL || cache->size != max_size ||
+			cache->adapt_max_size != max_size)
+		GOTO_ERR(ret, out);
+
+	/* objects freed on this lcore but allocated elsewhere */
+	for (i = 0; i < RTE_MEMPOOL_CACHE_ADAPT_PERIOD; i++) {
+		if (rte_mempool_generic_get(mp, obj_table, 1, NULL) < 0)
+			GOTO_ERR(ret, out);
+		rte_mempool_generic_put(mp, obj_table, 1, cache);
+	}
+	if (cache->size != max_size / 8 ||
+			cache->flushthresh != max_size / 8 + max_size / 2 ||
+			cache->adapt_resizes != 1)
+		GOTO_ERR(ret, out);
+	/* the shrunk cache gave its extra objects back */
+	if (cache->len > cache->size)
+		GOTO_ERR(ret, out);
+
+	/* objects allocated on this lcore but freed elsewhere */
+	rte_mempool_cache_flush(cache, mp);
+	for (i = 0; i < RTE_MEMPOOL_CACHE_ADAPT_PERIOD; i++) {
+		if (rte_mempool_generic_get(mp, obj_table, MAX_KEEP,
+					    cache) < 0)
+			GOTO_ERR(ret, out);
+		rte_mempool_generic_put(mp, obj_table, MAX_KEEP, NULL);
+	}
+	if (cache->size != max_size / 4 ||
+			cache->flushthresh != max_size / 4 * 3 / 2 ||
+			cache->adapt_resizes != 2)
+		GOTO_ERR(ret, out);
+
+	/* gets served by the cache shrink it back, with its objects */
+	for (i = 0; i < RTE_MEMPOOL_CACHE_ADAPT_PERIOD; i++) {
+		if (rte_mempool_generic_get(mp, obj_table, 1, cache) < 0)
+			GOTO_ERR(ret, out);
+		rte_mempool_generic_put(mp, obj_table, 1, cache);
+	}
+	if (cache->size != max_size / 8 || cache->len > cache->size ||
+			cache->adapt_resizes != 3)
+		GOTO_ERR(ret, out);
+
+	rte_mempool_dump(stdout, mp);
+	ret = 0;
+
+out:
+	rte_mempool_free(mp);
+	return ret;
+}
+
 static int
 test_mempool_same_name_twice_creation(void)
 {
@@ -848,6 +1002,7 @@ test_mempool(void)
 	struct rte_mempool *mp_stack_anon = NULL;
 	struct rte_mempool *mp_stack_mempool_iter = NULL;
 	struct rte_mempool *mp_stack = NULL;
+	struct rte_mempool *mp_numa = NULL;
 	struct rte_mempool *default_pool = NULL;
 	struct mp_data cb_arg = {
 		.ret = -1
@@ -944,6 +1099,27 @@ test_mempool(void)
 	}
 	rte_mempool_obj_iter(mp_stack, my_obj_init, NULL);
 
+	/* create a mempool with per NUMA node rings */
+	mp_numa = rte_mempool_create_empty("test_numa",
+		MEMPOOL_SIZE,
+		MEMPOOL_ELT_SIZE,
+		RTE_MEMPOOL_CACHE_MAX_SIZE, 0,
+		SOCKET_ID_ANY, 0);
+
+	if (mp_numa == NULL) {
+		printf("cannot allocate mp_numa mempool\n");
+		GOTO_ERR(ret, err);
+	}
+	if (rte_mempool_set_ops_byname(mp_numa, "ring_numa", NULL) < 0) {
+		printf("cannot set ring_numa handler\n");
+		GOTO_ERR(ret, err);
+	}
+	if (rte_mempool_populate_default(mp_numa) < 0) {
+		printf("cannot populate mp_numa mempool\n");
+		GOTO_ERR(ret, err);
+	}
+	rte_mempool_obj_iter(mp_numa, my_obj_init, NULL);
+
 	/* Create a mempool based on Default handler */
 	printf("Testing %s mempool handler\n", default_pool_ops);
 	default_pool = rte_mempool_create_empty("default_pool",
@@ -994,6 +1170,14 @@ test_mempool(void)
 	if (test_mempool_basic_ex(mp_nocache) < 0)
 		GOTO_ERR(ret, err);
 
+	/* zero copy tests with user-owned cache */
+	if (test_mempool_zc(mp_nocache) < 0)
+		GOTO_ERR(ret, err);
+
+	/* adaptive cache sizing */
+	if (test_mempool_cache_adaptive() < 0)
+		GOTO_ERR(ret, err);
+
 	/* mempool operation test based on single producer and single consumer */
 	if (test_mempool_sp_sc() < 0)
 		GOTO_ERR(ret, err);
@@ -1011,6 +1195,12 @@ test_mempool(void)
 	if (test_mempool_basic(mp_stack, 1) < 0)
 		GOTO_ERR(ret, err);
 
+	/* test the NUMA handler, with and without cache */
+	if (test_mempool_basic(mp_numa, 0) < 0)
+		GOTO_ERR(ret, err);
+	if (test_mempool_basic(mp_numa, 1) < 0)
+		GOTO_ERR(ret, err);
+
 	if (test_mempool_basic(default_pool, 1) < 0)
 		GOTO_ERR(ret, err);
 
@@ -1038,6 +1228,7 @@ test_mempool(void)
 	rte_mempool_free(mp_stack_anon);
 	rte_mempool_free(mp_stack_mempool_iter);
 	rte_mempool_free(mp_stack);
+	rte_mempool_free(mp_numa);
 	rte_mempool_free(default_pool);
 
 	return ret;
@@ -22,6 +22,8 @@
 #include <rte_lcore.h>
 #include <rte_branch_prediction.h>
 #include <rte_mempool.h>
+#include <rte_mempool_zc.h>
+#include <rte_ring.h>
 #include <rte_spinlock.h>
 #include <rte_malloc.h>
 #include <rte_mbuf_pool_ops.h>
@@ -60,6 +62,15 @@
  *
  *      - 32
  *      - 128
+ *
+ *    A last test runs a producer core getting objects and passing them
+ *    through a ring to a consumer core, on another NUMA socket if any,
+ *    which puts them back. It compares the default ring handler with the
+ *    ring_numa one, which returns the objects to their home socket.
+ *
+ *    Another one emulates a PMD refilling its Rx ring and freeing its
+ *    completed Tx descriptors, with the copying and the zero copy cache
+ *    APIs, and displays the cycles per object.
  */
 
 #define N 65536
@@ -249,6 +260,258 @@ launch_cores(struct rte_mempool *mp, unsigned int cores)
 	return 0;
 }
 
+#define XSOCKET_BULK 32
+#define XSOCKET_MEMPOOL_SIZE 8191
+
+static struct rte_ring *xsocket_ring;
+static uint32_t xsocket_stop;
+
+/* Get objects from the mempool and pass them to the consumer */
+static int
+xsocket_producer(void *arg)
+{
+	void *obj_table[XSOCKET_BULK];
+	struct rte_mempool *mp = arg;
+	uint64_t start_cycles, hz = rte_get_timer_hz();
+	uint64_t count = 0;
+
+	start_cycles = rte_get_timer_cycles();
+	while (rte_get_timer_cycles() - start_cycles < TIME_S * hz) {
+		if (rte_mempool_get_bulk(mp, obj_table, XSOCKET_BULK) < 0) {
+			rte_pause();
+			continue;
+		}
+		while (rte_ring_enqueue_bulk(xsocket_ring, obj_table,
+				XSOCKET_BULK, NULL) == 0)
+			rte_pause();
+		count += XSOCKET_BULK;
+	}
+	__atomic_store_n(&xsocket_stop, 1, __ATOMIC_RELEASE);
+	stats[rte_lcore_id()].enq_count = count;
+
+	return 0;
+}
+
+/* Put the objects passed by the producer back in the mempool */
+static int
+xsocket_consumer(void *arg)
+{
+	void *obj_table[XSOCKET_BULK];
+	struct rte_mempool *mp = arg;
+	uint32_t stop;
+	unsigned int n;
+
+	for (;;) {
+		stop = __atomic_load_n(&xsocket_stop, __ATOMIC_ACQUIRE);
+		n = rte_ring_dequeue_burst(xsocket_ring, obj_table,
+					   XSOCKET_BULK, NULL);
+		if (n == 0) {
+			if (stop)
+				break;
+			rte_pause();
+			continue;
+		}
+		rte_mempool_put_bulk(mp, obj_table, n);
+	}
+
+	return 0;
+}
+
+/* Producer on the main core, consumer on another socket if possible */
+static int
+test_mempool_perf_xsocket(const char *ops_name)
+{
+	unsigned int main_socket = rte_lcore_to_socket_id(rte_get_main_lcore());
+	unsigned int lcore_id, consumer = RTE_MAX_LCORE;
+	struct rte_mempool *mp;
+	int ret = -1;
+
+	RTE_LCORE_FOREACH_WORKER(lcore_id) {
+		if (consumer == RTE_MAX_LCORE)
+			consumer = lcore_id;
+		if (rte_lcore_to_socket_id(lcore_id) != main_socket) {
+			consumer = lcore_id;
+			break;
+		}
+	}
+	if (consumer == RTE_MAX_LCORE) {
+		printf("cross socket test needs at least 2 cores, skipped\n");
+		return 0;
+	}
+
+	mp = rte_mempool_create_empty("perf_test_xsocket",
+				      XSOCKET_MEMPOOL_SIZE,
+				      MEMPOOL_ELT_SIZE,
+				      RTE_MEMPOOL_CACHE_MAX_SIZE, 0,
+				      SOCKET_ID_ANY, 0);
+	if (mp == NULL)
+		return -1;
+	if (rte_mempool_set_ops_byname(mp, ops_name, NULL) < 0) {
+		printf("cannot set %s handler, skipped\n", ops_name);
+		ret = 0;
+		goto err;
+	}
+	if (rte_mempool_populate_default(mp) < 0) {
+		printf("cannot populate %s mempool\n", ops_name);
+		goto err;
+	}
+
+	xsocket_ring = rte_ring_create("perf_test_xsocket", 1024,
+				       SOCKET_ID_ANY,
+				       RING_F_SP_ENQ | RING_F_SC_DEQ);
+	if (xsocket_ring == NULL)
+		goto err;
+
+	memset(stats, 0, sizeof(stats));
+	__atomic_store_n(&xsocket_stop, 0, __ATOMIC_RELAXED);
+	rte_eal_remote_launch(xsocket_consumer, mp, consumer);
+	xsocket_producer(mp);
+	rte_eal_wait_lcore(consumer);
+
+	printf("mempool_autotest ops=%s producer_socket=%u "
+	       "consumer_socket=%u rate_persec=%" PRIu64 "\n",
+	       ops_name, main_socket, rte_lcore_to_socket_id(consumer),
+	       stats[rte_get_main_lcore()].enq_count / TIME_S);
+	rte_mempool_dump(stdout, mp);
+
+	ret = 0;
+	if (rte_mempool_avail_count(mp) != XSOCKET_MEMPOOL_SIZE) {
+		printf("mempool is not full\n");
+		ret = -1;
+	}
+
+err:
+	rte_ring_free(xsocket_ring);
+	xsocket_ring = NULL;
+	rte_mempool_free(mp);
+	return ret;
+}
+
+#define ZC_SW_RING_SIZE 512
+#define ZC_ITERATIONS 20000
+
+/* Software ring entry of a PMD, holding the object of a descriptor */
+struct zc_sw_entry {
+	void *obj;
+	uint64_t data;
+};
+
+static struct zc_sw_entry zc_sw_ring[ZC_SW_RING_SIZE];
+
+static int
+zc_refill_copy(struct rte_mempool *mp, struct rte_mempool_cache *cache,
+	       struct zc_sw_entry *sw_ring, unsigned int n)
+{
+	void *obj_table[MAX_KEEP];
+	unsigned int i;
+
+	if (rte_mempool_generic_get(mp, obj_table, n, cache) < 0)
+		return -1;
+	for (i = 0; i < n; i++)
+		sw_ring[i].obj = obj_table[i];
+
+	return 0;
+}
+
+static int
+zc_refill_zc(struct rte_mempool *mp, struct rte_mempool_cache *cache,
+	     struct zc_sw_entry *sw_ring, unsigned int n)
+{
+	void **cache_objs;
+	unsigned int i;
+
+	cache_objs = rte_mempool_cache_zc_get_bulk_start(cache, mp, n);
+	if (cache_objs == NULL)
+		return -1;
+	for (i = 0; i < n; i++)
+		sw_ring[i].obj = cache_objs[i];
+	rte_mempool_cache_zc_get_finish(cache, mp, n);
+
+	return 0;
+}
+
+static void
+zc_free_copy(struct rte_mempool *mp, struct rte_mempool_cache *cache,
+	     struct zc_sw_entry *sw_ring, unsigned int n)
+{
+	void *obj_table[MAX_KEEP];
+	unsigned int i;
+
+	for (i = 0; i < n; i++)
+		obj_table[i] = sw_ring[i].obj;
+	rte_mempool_generic_put(mp, obj_table, n, cache);
+}
+
+static void
+zc_free_zc(struct rte_mempool *mp, struct rte_mempool_cache *cache,
+	   struct zc_sw_entry *sw_ring, unsigned int n)
+{
+	void **cache_objs;
+	unsigned int i;
+
+	cache_objs = rte_mempool_cache_zc_put_bulk_start(cache, mp, n);
+	for (i = 0; i < n; i++)
+		cache_objs[i] = sw_ring[i].obj;
+	rte_mempool_cache_zc_put_finish(cache, mp, n);
+}
+
+/* Return the cycles per object got or put, or 0 on error */
+static double
+zc_run(struct rte_mempool *mp, unsigned int bulk, int zero_copy)
+{
+	struct rte_mempool_cache *cache;
+	uint64_t start_cycles;
+	unsigned int i, idx;
+	int ret;
+
+	cache = rte_mempool_default_cache(mp, rte_lcore_id());
+	start_cycles = rte_rdtsc();
+	for (i = 0; i < ZC_ITERATIONS; i++) {
+		for (idx = 0; idx < ZC_SW_RING_SIZE; idx += bulk) {
+			if (zero_copy)
+				ret = zc_refill_zc(mp, cache,
+						   &zc_sw_ring[idx], bulk);
+			else
+				ret = zc_refill_copy(mp, cache,
+						     &zc_sw_ring[idx], bulk);
+			if (ret < 0)
+				return 0;
+		}
+		for (idx = 0; idx < ZC_SW_RING_SIZE; idx += bulk) {
+			if (zero_copy)
+				zc_free_zc(mp, cache, &zc_sw_ring[idx], bulk);
+			else
+				zc_free_copy(mp, cache, &zc_sw_ring[idx],
+					     bulk);
+		}
+	}
+
+	return (double)(rte_rdtsc() - start_cycles) /
+		((double)ZC_ITERATIONS * ZC_SW_RING_SIZE * 2);
+}
+
+static int
+test_mempool_perf_zc(struct rte_mempool *mp)
+{
+	unsigned int bulk_tab[] = { 1, 4, 32, 0 };
+	double copy_cycles, zc_cycles;
+	unsigned int *bulk_ptr;
+
+	for (bulk_ptr = bulk_tab; *bulk_ptr; bulk_ptr++) {
+		copy_cycles = zc_run(mp, *bulk_ptr, 0);
+		zc_cycles = zc_run(mp, *bulk_ptr, 1);
+		if (copy_cycles == 0 || zc_cycles == 0) {
+			printf("cannot get objects from the mempool\n");
+			return -1;
+		}
+		printf("mempool_autotest cache=%u bulk=%u "
+		       "copy_cycles_per_obj=%.2f zc_cycles_per_obj=%.2f\n",
+		       mp->cache_size, *bulk_ptr, copy_cycles, zc_cycles);
+	}
+
+	return 0;
+}
+
 /* for a given number of core, launch all test cases */
 static int
 do_one_mempool_test(struct rte_mempool *mp, unsigned int cores)
@@ -382,6 +645,23 @@ test_mempool_perf(void)
 	if (do_one_mempool_test(mp_nocache, rte_lcore_count()) < 0)
 		goto err;
 
+	use_external_cache = 0;
+
+	/* performance test of the zero copy cache API */
+	printf("start zero copy performance test (with cache)\n");
+
+	if (test_mempool_perf_zc(mp_cache) < 0)
+		goto err;
+
+	/* performance test with producer and consumer on 2 sockets */
+	printf("start cross socket performance test\n");
+
+	if (test_mempool_perf_xsocket(default_pool_ops) < 0)
+		goto err;
+
+	if (test_mempool_perf_xsocket("ring_numa") < 0)
+		goto err;
+
 	rte_mempool_list_dump(stdout);
 
 	ret = 0;
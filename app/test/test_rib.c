@@ -21,9 +21,12 @@ static int32_t test_insert_invalid(void);
 static int32_t test_get_fn(void);
 static int32_t test_basic(void);
 static int32_t test_tree_traversal(void);
+static int32_t test_tree_traversal_bulk(void);
 
 #define MAX_DEPTH 32
 #define MAX_RULES (1 << 22)
+#define TRAVERSAL_NB_ROUTES 64
+#define TRAVERSAL_BULK 5
 
 /*
  * Check that rte_rib_create fails gracefully for incorrect user input
@@ -323,6 +326,76 @@ test_tree_traversal(void)
 	return TEST_SUCCESS;
 }
 
+/*
+ * Check that the iterator returns the same routes as rte_rib_get_nxt()
+ */
+int32_t
+test_tree_traversal_bulk(void)
+{
+	struct rte_rib *rib = NULL;
+	struct rte_rib_node *node, *nodes[TRAVERSAL_BULK];
+	struct rte_rib_conf config;
+	struct rte_rib_iter iter;
+	uint32_t ip = RTE_IPV4(10, 10, 0, 0);
+	unsigned int i, n, total;
+	int flag, ret;
+
+	config.max_nodes = MAX_RULES;
+	config.ext_sz = 0;
+
+	rib = rte_rib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(rib != NULL, "Failed to create RIB\n");
+
+	ret = rte_rib_iter_init(NULL, rib, ip, 16, RTE_RIB_GET_NXT_ALL);
+	RTE_TEST_ASSERT(ret != 0, "Call succeeded with invalid parameters\n");
+	ret = rte_rib_iter_init(&iter, NULL, ip, 16, RTE_RIB_GET_NXT_ALL);
+	RTE_TEST_ASSERT(ret != 0, "Call succeeded with invalid parameters\n");
+	ret = rte_rib_iter_init(&iter, rib, ip, MAX_DEPTH + 1,
+		RTE_RIB_GET_NXT_ALL);
+	RTE_TEST_ASSERT(ret != 0, "Call succeeded with invalid parameters\n");
+	ret = rte_rib_iter_init(&iter, rib, ip, 16, RTE_RIB_GET_NXT_COVER + 1);
+	RTE_TEST_ASSERT(ret != 0, "Call succeeded with invalid parameters\n");
+
+	node = rte_rib_insert(rib, ip, 16);
+	RTE_TEST_ASSERT(node != NULL, "Failed to insert rule\n");
+	node = rte_rib_insert(rib, RTE_IPV4(10, 10, 0, 128), 25);
+	RTE_TEST_ASSERT(node != NULL, "Failed to insert rule\n");
+	for (i = 0; i < TRAVERSAL_NB_ROUTES; i++) {
+		node = rte_rib_insert(rib, ip + (i << 8), 24);
+		RTE_TEST_ASSERT(node != NULL, "Failed to insert rule\n");
+	}
+
+	for (flag = RTE_RIB_GET_NXT_ALL; flag <= RTE_RIB_GET_NXT_COVER;
+			flag++) {
+		ret = rte_rib_iter_init(&iter, rib, ip, 16, flag);
+		RTE_TEST_ASSERT(ret == 0, "Failed to init iterator\n");
+		node = NULL;
+		total = 0;
+		do {
+			n = rte_rib_iter_next_bulk(&iter, nodes,
+				TRAVERSAL_BULK);
+			for (i = 0; i < n; i++) {
+				node = rte_rib_get_nxt(rib, ip, 16, node, flag);
+				RTE_TEST_ASSERT(nodes[i] == node,
+					"Iterator returned a wrong route\n");
+			}
+			total += n;
+		} while (n == TRAVERSAL_BULK);
+		node = rte_rib_get_nxt(rib, ip, 16, node, flag);
+		RTE_TEST_ASSERT(node == NULL, "Iterator missed routes\n");
+		RTE_TEST_ASSERT(total == TRAVERSAL_NB_ROUTES +
+			(flag == RTE_RIB_GET_NXT_ALL),
+			"Iterator returned a wrong number of routes\n");
+		n = rte_rib_iter_next_bulk(&iter, nodes, TRAVERSAL_BULK);
+		RTE_TEST_ASSERT(n == 0,
+			"Iterator returned routes after the end\n");
+	}
+
+	rte_rib_free(rib);
+
+	return TEST_SUCCESS;
+}
+
 static struct unit_test_suite rib_tests = {
 	.suite_name = "rib autotest",
 	.setup = NULL,
@@ -334,6 +407,7 @@ static struct unit_test_suite rib_tests = {
 		TEST_CASE(test_get_fn),
 		TEST_CASE(test_basic),
 		TEST_CASE(test_tree_traversal),
+		TEST_CASE(test_tree_traversal_bulk),
 		TEST_CASES_END()
 	}
 };
@@ -297,6 +297,19 @@ static const struct {
 			.felem = rte_ring_dequeue_bulk_elem,
 		},
 	},
+	{
+		.desc = "MP_ORD/MC sync mode",
+		.api_type = TEST_RING_ELEM_BULK | TEST_RING_THREAD_DEF,
+		.create_flags = RING_F_MP_ORD_ENQ,
+		.enq = {
+			.flegacy = rte_ring_enqueue_bulk,
+			.felem = rte_ring_enqueue_bulk_elem,
+		},
+		.deq = {
+			.flegacy = rte_ring_dequeue_bulk,
+			.felem = rte_ring_dequeue_bulk_elem,
+		},
+	},
 	{
 		.desc = "MP/MC sync mode",
 		.api_type = TEST_RING_ELEM_BURST | TEST_RING_THREAD_DEF,
@@ -362,6 +375,19 @@ static const struct {
 			.felem = rte_ring_dequeue_burst_elem,
 		},
 	},
+	{
+		.desc = "MP_ORD/MC sync mode",
+		.api_type = TEST_RING_ELEM_BURST | TEST_RING_THREAD_DEF,
+		.create_flags = RING_F_MP_ORD_ENQ,
+		.enq = {
+			.flegacy = rte_ring_enqueue_burst,
+			.felem = rte_ring_enqueue_burst_elem,
+		},
+		.deq = {
+			.flegacy = rte_ring_dequeue_burst,
+			.felem = rte_ring_dequeue_burst_elem,
+		},
+	},
 	{
 		.desc = "SP/SC sync mode (ZC)",
 		.api_type = TEST_RING_ELEM_BULK | TEST_RING_THREAD_SPSC,
@@ -1076,6 +1102,282 @@ test_ring_basic_ex(void)
 	return -1;
 }
 
+/* Finish an ordered enqueue with the legacy or elem API */
+static void
+test_ring_ord_finish(struct rte_ring *r, uint32_t pos, void *obj, int esize,
+	unsigned int n)
+{
+	if (esize == -1)
+		rte_ring_ord_enqueue_finish(r, pos, obj, n);
+	else
+		rte_ring_ord_enqueue_finish_elem(r, pos, obj, esize, n);
+}
+
+/*
+ * Ordered producer ring: enqueues finished out of order are dequeued in
+ * the reservation order.
+ */
+static int
+test_ring_ordered(void)
+{
+	struct rte_ring *r = NULL;
+	void *ring_mem = NULL;
+	void **src = NULL, **dst = NULL;
+	uint32_t pos1, pos2;
+	unsigned int i, n;
+	int ret;
+
+	for (i = 0; i < RTE_DIM(esize); i++) {
+		test_ring_print_test_string("Test ordered producer ring",
+				TEST_RING_IGNORE_API_TYPE, esize[i]);
+
+		r = test_ring_create("test_ring_ord", esize[i], RING_SIZE,
+				SOCKET_ID_ANY, RING_F_MP_ORD_ENQ | RING_F_SC_DEQ);
+		if (r == NULL) {
+			printf("%s: error, can't create ring\n", __func__);
+			goto test_fail;
+		}
+		TEST_RING_VERIFY(rte_ring_get_prod_sync_type(r) ==
+				RTE_RING_SYNC_MT_ORD, r, goto test_fail);
+
+		src = test_ring_calloc(2 * MAX_BULK, esize[i]);
+		if (src == NULL)
+			goto test_fail;
+		test_ring_mem_init(src, 2 * MAX_BULK, esize[i]);
+		dst = test_ring_calloc(2 * MAX_BULK, esize[i]);
+		if (dst == NULL)
+			goto test_fail;
+
+		/* reserve two bulks */
+		n = rte_ring_ord_enqueue_bulk_start(r, MAX_BULK, &pos1, NULL);
+		TEST_RING_VERIFY(n == MAX_BULK, r, goto test_fail);
+		n = rte_ring_ord_enqueue_burst_start(r, MAX_BULK, &pos2, NULL);
+		TEST_RING_VERIFY(n == MAX_BULK, r, goto test_fail);
+		TEST_RING_VERIFY(pos2 == pos1 + MAX_BULK, r, goto test_fail);
+
+		/* the second bulk is not visible before the first one */
+		test_ring_ord_finish(r, pos2,
+				test_ring_inc_ptr(src, esize[i], MAX_BULK),
+				esize[i], MAX_BULK);
+		TEST_RING_VERIFY(rte_ring_count(r) == 0, r, goto test_fail);
+
+		/* finish the first bulk in two parts, the last one first */
+		test_ring_ord_finish(r, pos1 + MAX_BULK / 2,
+				test_ring_inc_ptr(src, esize[i], MAX_BULK / 2),
+				esize[i], MAX_BULK / 2);
+		TEST_RING_VERIFY(rte_ring_count(r) == 0, r, goto test_fail);
+		test_ring_ord_finish(r, pos1, src, esize[i], MAX_BULK / 2);
+		TEST_RING_VERIFY(rte_ring_count(r) == 2 * MAX_BULK, r,
+				goto test_fail);
+
+		ret = test_ring_dequeue(r, dst, esize[i], 2 * MAX_BULK,
+				TEST_RING_THREAD_DEF | TEST_RING_ELEM_BULK);
+		TEST_RING_VERIFY(ret == 2 * MAX_BULK, r, goto test_fail);
+		TEST_RING_VERIFY(test_ring_mem_cmp(src, dst,
+				RTE_PTR_DIFF(test_ring_inc_ptr(dst, esize[i],
+				2 * MAX_BULK), dst)) == 0, r, goto test_fail);
+
+		/* reset drops an unfinished reservation */
+		n = rte_ring_ord_enqueue_bulk_start(r, MAX_BULK, &pos1, NULL);
+		TEST_RING_VERIFY(n == MAX_BULK, r, goto test_fail);
+		rte_ring_reset(r);
+		ret = test_ring_enqueue(r, src, esize[i], MAX_BULK,
+				TEST_RING_THREAD_DEF | TEST_RING_ELEM_BULK);
+		TEST_RING_VERIFY(ret == MAX_BULK, r, goto test_fail);
+		TEST_RING_VERIFY(rte_ring_count(r) == MAX_BULK, r,
+				goto test_fail);
+
+		rte_free(src);
+		rte_free(dst);
+		rte_ring_free(r);
+		src = NULL;
+		dst = NULL;
+		r = NULL;
+	}
+
+	/* rte_ring_init() doesn't know where the sequence values are */
+	ring_mem = rte_zmalloc(NULL, rte_ring_get_memsize(RING_SIZE),
+			RTE_CACHE_LINE_SIZE);
+	if (ring_mem == NULL)
+		goto test_fail;
+	if (rte_ring_init(ring_mem, "test_ring_ord_init", RING_SIZE,
+			RING_F_MP_ORD_ENQ) != -EINVAL) {
+		printf("%s: error, ordered ring init not rejected\n",
+			__func__);
+		goto test_fail;
+	}
+	rte_free(ring_mem);
+
+	return 0;
+
+test_fail:
+	rte_free(ring_mem);
+	rte_free(src);
+	rte_free(dst);
+	rte_ring_free(r);
+	return -1;
+}
+
+/* Dequeue with wait using the legacy or elem API */
+static unsigned int
+test_ring_dequeue_wait(struct rte_ring *r, void **obj, int esize,
+	unsigned int n, uint64_t timeout)
+{
+	if (esize == -1)
+		return rte_ring_dequeue_burst_wait(r, obj, n, NULL, timeout);
+	else
+		return rte_ring_dequeue_burst_elem_wait(r, obj, esize, n, NULL,
+				timeout);
+}
+
+/*
+ * Dequeue with wait: times out on an empty ring, returns the available
+ * objects without waiting otherwise.
+ */
+static int
+test_ring_burst_wait(void)
+{
+	struct rte_ring *r = NULL;
+	void **src = NULL, **dst = NULL;
+	const uint64_t timeout = rte_get_tsc_hz() / 100;
+	uint64_t start, elapsed;
+	unsigned int i, n;
+	int ret;
+
+	for (i = 0; i < RTE_DIM(esize); i++) {
+		test_ring_print_test_string("Test dequeue with wait",
+				TEST_RING_IGNORE_API_TYPE, esize[i]);
+
+		r = test_ring_create("test_ring_wait", esize[i], RING_SIZE,
+				SOCKET_ID_ANY, 0);
+		if (r == NULL) {
+			printf("%s: error, can't create ring\n", __func__);
+			goto test_fail;
+		}
+
+		src = test_ring_calloc(MAX_BULK, esize[i]);
+		if (src == NULL)
+			goto test_fail;
+		test_ring_mem_init(src, MAX_BULK, esize[i]);
+		dst = test_ring_calloc(MAX_BULK, esize[i]);
+		if (dst == NULL)
+			goto test_fail;
+
+		/* empty ring, wait until the timeout */
+		start = rte_get_tsc_cycles();
+		n = test_ring_dequeue_wait(r, dst, esize[i], MAX_BULK, timeout);
+		elapsed = rte_get_tsc_cycles() - start;
+		TEST_RING_VERIFY(n == 0, r, goto test_fail);
+		TEST_RING_VERIFY(elapsed >= timeout, r, goto test_fail);
+
+		/* objects available, no wait */
+		ret = test_ring_enqueue(r, src, esize[i], MAX_BULK,
+				TEST_RING_THREAD_DEF | TEST_RING_ELEM_BULK);
+		TEST_RING_VERIFY(ret == MAX_BULK, r, goto test_fail);
+		start = rte_get_tsc_cycles();
+		n = test_ring_dequeue_wait(r, dst, esize[i], MAX_BULK, timeout);
+		elapsed = rte_get_tsc_cycles() - start;
+		TEST_RING_VERIFY(n == MAX_BULK, r, goto test_fail);
+		TEST_RING_VERIFY(elapsed < timeout, r, goto test_fail);
+		TEST_RING_VERIFY(test_ring_mem_cmp(src, dst,
+				RTE_PTR_DIFF(test_ring_inc_ptr(dst, esize[i],
+				MAX_BULK), dst)) == 0, r, goto test_fail);
+
+		rte_free(src);
+		rte_free(dst);
+		rte_ring_free(r);
+		src = NULL;
+		dst = NULL;
+		r = NULL;
+	}
+
+	return 0;
+
+test_fail:
+	rte_free(src);
+	rte_free(dst);
+	rte_ring_free(r);
+	return -1;
+}
+
+/*
+ * Enqueue on several rings: the objects land on their ring in order, the
+ * ones which don't fit are returned in order.
+ */
+#define MULTI_NB_RING 4
+#define MULTI_RING_SIZE 32
+#define MULTI_NB_OBJ (3 * RTE_RING_MULTI_BURST_MAX + 8)
+
+static int
+test_ring_burst_multi(void)
+{
+	struct rte_ring *rings[MULTI_NB_RING] = { NULL };
+	void *src[MULTI_NB_OBJ], *unsent[MULTI_NB_OBJ], *dst[MULTI_NB_OBJ];
+	void *exp;
+	uint16_t idx[MULTI_NB_OBJ];
+	unsigned int cnt[MULTI_NB_RING] = { 0 };
+	char name[RTE_RING_NAMESIZE];
+	unsigned int i, j, k, n;
+	int ret = -1;
+
+	test_ring_print_test_string("Test enqueue on several rings",
+			TEST_RING_IGNORE_API_TYPE, -1);
+
+	for (i = 0; i < RTE_DIM(rings); i++) {
+		snprintf(name, sizeof(name), "test_ring_multi_%u", i);
+		rings[i] = rte_ring_create(name, MULTI_RING_SIZE,
+				SOCKET_ID_ANY, 0);
+		if (rings[i] == NULL) {
+			printf("%s: error, can't create ring\n", __func__);
+			goto exit;
+		}
+	}
+
+	for (i = 0; i < MULTI_NB_OBJ; i++) {
+		src[i] = (void *)(uintptr_t)(i + 1);
+		idx[i] = (i / 3) % MULTI_NB_RING;
+	}
+
+	n = rte_ring_enqueue_burst_multi(rings, src, idx, MULTI_NB_OBJ,
+			unsent);
+	TEST_RING_VERIFY(n == MULTI_NB_RING * (MULTI_RING_SIZE - 1),
+			rings[0], goto exit);
+
+	/* each ring got the first objects for it, the others are unsent */
+	for (i = 0; i < RTE_DIM(rings); i++) {
+		k = rte_ring_dequeue_burst(rings[i], dst, RTE_DIM(dst), NULL);
+		TEST_RING_VERIFY(k == MULTI_RING_SIZE - 1, rings[i],
+				goto exit);
+	}
+	for (i = 0, k = 0; i < MULTI_NB_OBJ; i++) {
+		if (cnt[idx[i]]++ < MULTI_RING_SIZE - 1)
+			continue;
+		TEST_RING_VERIFY(unsent[k++] == src[i], rings[idx[i]],
+				goto exit);
+	}
+	TEST_RING_VERIFY(k == MULTI_NB_OBJ - n, rings[0], goto exit);
+
+	/* objects of a ring keep their order */
+	k = 2 * MULTI_NB_RING * 3;
+	n = rte_ring_enqueue_burst_multi(rings, src, idx, k, NULL);
+	TEST_RING_VERIFY(n == k, rings[0], goto exit);
+	for (i = 0; i < RTE_DIM(rings); i++) {
+		k = rte_ring_dequeue_burst(rings[i], dst, RTE_DIM(dst), NULL);
+		TEST_RING_VERIFY(k == 6, rings[i], goto exit);
+		for (j = 0; j != k; j++) {
+			/* groups of 3 objects, round robin on the rings */
+			exp = src[(j / 3 * MULTI_NB_RING + i) * 3 + j % 3];
+			TEST_RING_VERIFY(dst[j] == exp, rings[i], goto exit);
+		}
+	}
+
+	ret = 0;
+exit:
+	for (i = 0; i < RTE_DIM(rings); i++)
+		rte_ring_free(rings[i]);
+	return ret;
+}
+
 /*
  * Basic test cases with exact size ring.
  */
@@ -1207,6 +1509,15 @@ test_ring(void)
 	if (test_ring_with_exact_size() < 0)
 		goto test_fail;
 
+	if (test_ring_ordered() < 0)
+		goto test_fail;
+
+	if (test_ring_burst_wait() < 0)
+		goto test_fail;
+
+	if (test_ring_burst_multi() < 0)
+		goto test_fail;
+
 	/* Burst and bulk operations with sp/sc, mp/mc and default.
 	 * The test cases are split into smaller test cases to
 	 * help clang compile faster.
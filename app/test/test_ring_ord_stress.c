@@ -0,0 +1,212 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 agent <agent@local>
+ */
+
+#include <rte_errno.h>
+
+#include "test_ring_stress.h"
+
+/**
+ * Stress test for the ordered producer ring mode.
+ * Each worker reserves slots, writes their position in the objects,
+ * optionally spins for a random time and finishes the enqueue in two
+ * parts, the last one first. The main lcore dequeues the objects and
+ * checks that they come in the reservation order, without gap.
+ * Serves as both functional and performance test of the ordered
+ * enqueue under high contention.
+ */
+
+#define RING_NAME	"RING_ORD_STRESS"
+#define BULK_NUM	32
+#define RING_SIZE	(2 * BULK_NUM * RTE_MAX_LCORE)
+#define MAX_DELAY_CYCLES	1024
+
+enum {
+	WRK_CMD_STOP,
+	WRK_CMD_RUN,
+};
+
+static uint32_t wrk_cmd __rte_cache_aligned = WRK_CMD_STOP;
+
+/* test run-time in seconds */
+static const uint32_t run_time = 60;
+
+struct lcore_arg {
+	struct rte_ring *rng;
+	uint64_t nb_call;
+	uint64_t nb_obj;
+	uint64_t nb_cycle;
+} __rte_cache_aligned;
+
+static int
+test_worker(void *arg, int32_t delay)
+{
+	uint32_t i, k, n, num, pos;
+	uint64_t tm, end;
+	struct lcore_arg *la;
+	void *obj[BULK_NUM];
+
+	la = arg;
+
+	while (__atomic_load_n(&wrk_cmd, __ATOMIC_RELAXED) != WRK_CMD_RUN)
+		rte_pause();
+
+	do {
+		num = 1 + rte_rand() % BULK_NUM;
+
+		tm = rte_rdtsc_precise();
+		n = rte_ring_ord_enqueue_bulk_start(la->rng, num, &pos, NULL);
+		if (n == 0) {
+			rte_pause();
+			continue;
+		}
+
+		for (i = 0; i != n; i++)
+			obj[i] = (void *)(uintptr_t)(pos + i);
+
+		/* let the other workers finish their later slots first */
+		if (delay != 0) {
+			end = rte_rdtsc() + rte_rand() % MAX_DELAY_CYCLES;
+			while (rte_rdtsc() < end)
+				rte_pause();
+		}
+
+		k = rte_rand() % (n + 1);
+		rte_ring_ord_enqueue_finish(la->rng, pos + k, obj + k, n - k);
+		rte_ring_ord_enqueue_finish(la->rng, pos, obj, k);
+		tm = rte_rdtsc_precise() - tm;
+
+		la->nb_call++;
+		la->nb_obj += n;
+		la->nb_cycle += tm;
+
+	} while (__atomic_load_n(&wrk_cmd, __ATOMIC_RELAXED) == WRK_CMD_RUN);
+
+	return 0;
+}
+
+static int
+test_worker_nodelay(void *arg)
+{
+	return test_worker(arg, 0);
+}
+
+static int
+test_worker_delay(void *arg)
+{
+	return test_worker(arg, 1);
+}
+
+/* dequeue all available objects and check their order */
+static int
+check_dequeue(struct rte_ring *r, uint32_t *exp, uint64_t *nb_obj)
+{
+	uint32_t i, n;
+	void *obj[2 * BULK_NUM];
+
+	n = rte_ring_sc_dequeue_burst(r, obj, RTE_DIM(obj), NULL);
+	for (i = 0; i != n; i++) {
+		if ((uint32_t)(uintptr_t)obj[i] != *exp) {
+			printf("%s: object %u out of order, expected: %u\n",
+				__func__, (uint32_t)(uintptr_t)obj[i], *exp);
+			return -EINVAL;
+		}
+		(*exp)++;
+	}
+
+	*nb_obj += n;
+	return n;
+}
+
+static int
+test_mt1(int (*test)(void *))
+{
+	int32_t rc;
+	uint32_t exp, lc;
+	uint64_t end, nb_call, nb_cycle, nb_obj, nb_deq;
+	struct rte_ring *r;
+	struct lcore_arg arg[RTE_MAX_LCORE];
+
+	r = rte_ring_create(RING_NAME, RING_SIZE, SOCKET_ID_ANY,
+		RING_F_MP_ORD_ENQ | RING_F_SC_DEQ);
+	if (r == NULL) {
+		printf("%s: rte_ring_create(%u) failed, error: %d(%s)\n",
+			__func__, RING_SIZE, rte_errno,
+			rte_strerror(rte_errno));
+		return -rte_errno;
+	}
+
+	memset(arg, 0, sizeof(arg));
+
+	/* launch on all workers */
+	RTE_LCORE_FOREACH_WORKER(lc) {
+		arg[lc].rng = r;
+		rte_eal_remote_launch(test, &arg[lc], lc);
+	}
+
+	/* signal worker to start test */
+	__atomic_store_n(&wrk_cmd, WRK_CMD_RUN, __ATOMIC_RELEASE);
+
+	/* main lcore is the consumer */
+	rc = 1;
+	exp = 0;
+	nb_deq = 0;
+	end = rte_get_timer_cycles() + run_time * rte_get_timer_hz();
+	while (rc >= 0 && rte_get_timer_cycles() < end)
+		rc = check_dequeue(r, &exp, &nb_deq);
+
+	/* signal worker to stop test */
+	__atomic_store_n(&wrk_cmd, WRK_CMD_STOP, __ATOMIC_RELEASE);
+
+	nb_call = 0;
+	nb_obj = 0;
+	nb_cycle = 0;
+	RTE_LCORE_FOREACH_WORKER(lc) {
+		if (rte_eal_wait_lcore(lc) != 0)
+			rc = -1;
+		nb_call += arg[lc].nb_call;
+		nb_obj += arg[lc].nb_obj;
+		nb_cycle += arg[lc].nb_cycle;
+	}
+
+	/* workers finished all their reserved slots, drain the ring */
+	if (rc >= 0) {
+		do {
+			rc = check_dequeue(r, &exp, &nb_deq);
+		} while (rc > 0);
+	}
+
+	if (rc == 0 && nb_deq != nb_obj) {
+		printf("%s: dequeued %" PRIu64 " objects, enqueued %" PRIu64
+			"\n", __func__, nb_deq, nb_obj);
+		rc = -ENOSPC;
+	}
+
+	printf("%s: nb_call=%" PRIu64 ", nb_obj=%" PRIu64
+		", cycles/obj(avg): %.2Lf, cycles/call(avg): %.2Lf\n",
+		__func__, nb_call, nb_obj,
+		(long double)nb_cycle / RTE_MAX(nb_obj, 1ULL),
+		(long double)nb_cycle / RTE_MAX(nb_call, 1ULL));
+
+	rte_ring_free(r);
+	return (rc < 0) ? rc : 0;
+}
+
+static const struct test_case tests[] = {
+	{
+		.name = "MT_ORD-WRK_ENQ-MST_DEQ",
+		.func = test_mt1,
+		.wfunc = test_worker_nodelay,
+	},
+	{
+		.name = "MT_ORD-WRK_ENQ_DELAY-MST_DEQ",
+		.func = test_mt1,
+		.wfunc = test_worker_delay,
+	},
+};
+
+const struct test test_ring_ord_stress = {
+	.name = "MT_ORD",
+	.nb_case = RTE_DIM(tests),
+	.cases = tests,
+};
@@ -10,6 +10,7 @@
 #include <rte_cycles.h>
 #include <rte_launch.h>
 #include <rte_pause.h>
+#include <rte_random.h>
 #include <string.h>
 
 #include "test.h"
@@ -490,6 +491,135 @@ test_burst_bulk_enqueue_dequeue(struct rte_ring *r, const int esize,
 	return 0;
 }
 
+/*
+ * Test that reserves two bulks on an ordered producer ring, finishes the
+ * second one first and dequeues both, to measure the cost of the out of
+ * order completion.
+ */
+static int
+test_ord_out_of_order_enqueue_dequeue(struct rte_ring *r, const int esize)
+{
+	const unsigned int iter_shift = 23;
+	const unsigned int iterations = 1 << iter_shift;
+	unsigned int sz, i = 0;
+	uint32_t pos1, pos2;
+	void **burst = NULL;
+
+	burst = test_ring_calloc(2 * MAX_BURST, esize);
+	if (burst == NULL)
+		return -1;
+
+	for (sz = 0; sz < RTE_DIM(bulk_sizes); sz++) {
+		const uint64_t start = rte_rdtsc();
+		for (i = 0; i < iterations; i++) {
+			rte_ring_ord_enqueue_bulk_start(r, bulk_sizes[sz],
+					&pos1, NULL);
+			rte_ring_ord_enqueue_bulk_start(r, bulk_sizes[sz],
+					&pos2, NULL);
+			if (esize == -1) {
+				rte_ring_ord_enqueue_finish(r, pos2, burst,
+						bulk_sizes[sz]);
+				rte_ring_ord_enqueue_finish(r, pos1, burst,
+						bulk_sizes[sz]);
+			} else {
+				rte_ring_ord_enqueue_finish_elem(r, pos2,
+						burst, esize, bulk_sizes[sz]);
+				rte_ring_ord_enqueue_finish_elem(r, pos1,
+						burst, esize, bulk_sizes[sz]);
+			}
+			test_ring_dequeue(r, burst, esize, 2 * bulk_sizes[sz],
+					TEST_RING_THREAD_DEF |
+					TEST_RING_ELEM_BULK);
+		}
+		const uint64_t end = rte_rdtsc();
+
+		test_ring_print_test_string(TEST_RING_IGNORE_API_TYPE, esize,
+				bulk_sizes[sz], 0);
+		printf(": out of order bulk (size: 2x%u): %.2F\n",
+				bulk_sizes[sz],
+				((double)(end - start)) / iterations);
+	}
+
+	rte_free(burst);
+
+	return 0;
+}
+
+/* the numbers of destination rings of the fan out test */
+static const volatile unsigned int fanout_sizes[] = { 8, 16, 32 };
+
+#define MAX_FANOUT 32
+#define FANOUT_BURSTS ((RING_SIZE - 1) / MAX_BURST)
+
+/*
+ * Test that fans out bursts of MAX_BURST objects to several rings with
+ * random destinations, with one enqueue per object and with one call to
+ * rte_ring_enqueue_burst_multi(). Only the enqueues are measured, the
+ * rings are drained between the rounds.
+ */
+static int
+test_fanout_enqueue(void)
+{
+	const unsigned int rounds = 1 << 10;
+	const unsigned int bursts = FANOUT_BURSTS;
+	struct rte_ring *rings[MAX_FANOUT] = { NULL };
+	char name[RTE_RING_NAMESIZE];
+	void *burst[MAX_BURST] = { NULL };
+	static uint16_t idx[FANOUT_BURSTS][MAX_BURST];
+	uint64_t start, tm_single, tm_multi;
+	unsigned int b, i, j, k, sz;
+	int ret = -1;
+
+	for (i = 0; i < RTE_DIM(rings); i++) {
+		snprintf(name, sizeof(name), RING_NAME "_%u", i);
+		rings[i] = rte_ring_create(name, RING_SIZE, rte_socket_id(),
+				RING_F_SP_ENQ | RING_F_SC_DEQ);
+		if (rings[i] == NULL)
+			goto exit;
+	}
+
+	for (sz = 0; sz < RTE_DIM(fanout_sizes); sz++) {
+		for (b = 0; b < bursts; b++)
+			for (j = 0; j < MAX_BURST; j++)
+				idx[b][j] = rte_rand() % fanout_sizes[sz];
+
+		tm_single = 0;
+		tm_multi = 0;
+		for (i = 0; i < rounds; i++) {
+			start = rte_rdtsc();
+			for (b = 0; b < bursts; b++)
+				for (j = 0; j < MAX_BURST; j++)
+					rte_ring_enqueue(rings[idx[b][j]],
+							burst[j]);
+			tm_single += rte_rdtsc() - start;
+
+			for (k = 0; k < fanout_sizes[sz]; k++)
+				rte_ring_reset(rings[k]);
+
+			start = rte_rdtsc();
+			for (b = 0; b < bursts; b++)
+				rte_ring_enqueue_burst_multi(rings, burst,
+						idx[b], MAX_BURST, NULL);
+			tm_multi += rte_rdtsc() - start;
+
+			for (k = 0; k < fanout_sizes[sz]; k++)
+				rte_ring_reset(rings[k]);
+		}
+
+		printf("fan out to %u rings (burst size: %u): "
+			"single: %.2F, multi: %.2F\n",
+			fanout_sizes[sz], MAX_BURST,
+			(double)tm_single / ((uint64_t)rounds * bursts),
+			(double)tm_multi / ((uint64_t)rounds * bursts));
+	}
+
+	ret = 0;
+exit:
+	for (i = 0; i < RTE_DIM(rings); i++)
+		rte_ring_free(rings[i]);
+	return ret;
+}
+
 /* Run all tests for a given element size */
 static __rte_always_inline int
 test_ring_perf_esize(const int esize)
@@ -558,6 +688,28 @@ test_ring_perf_esize(const int esize)
 
 	rte_ring_free(r);
 
+	/*
+	 * Performance test for the ordered producer mode through the
+	 * default APIs, multi-lcore contention is measured by
+	 * ring_stress_autotest like for the RTS and HTS modes.
+	 */
+	r = test_ring_create(RING_NAME, esize, RING_SIZE, rte_socket_id(),
+			RING_F_MP_ORD_ENQ);
+	if (r == NULL)
+		goto test_fail;
+
+	printf("\n### Testing ordered producer enq/deq ###\n");
+	if (test_burst_bulk_enqueue_dequeue(r, esize,
+			TEST_RING_THREAD_DEF | TEST_RING_ELEM_BURST) < 0)
+		goto test_fail;
+	if (test_burst_bulk_enqueue_dequeue(r, esize,
+			TEST_RING_THREAD_DEF | TEST_RING_ELEM_BULK) < 0)
+		goto test_fail;
+	if (test_ord_out_of_order_enqueue_dequeue(r, esize) < 0)
+		goto test_fail;
+
+	rte_ring_free(r);
+
 	return 0;
 
 test_fail:
@@ -576,6 +728,10 @@ test_ring_perf(void)
 	if (test_ring_perf_esize(16) == -1)
 		return -1;
 
+	printf("\n### Testing fan out enq to several rings ###\n");
+	if (test_fanout_enqueue() == -1)
+		return -1;
+
 	return 0;
 }
 
@@ -5,6 +5,7 @@
 #include <string.h>
 #include <rte_byteorder.h>
 #include <rte_table_lpm_ipv6.h>
+#include <rte_swx_table_lpm.h>
 #include <rte_lru.h>
 #include <rte_cycles.h>
 #include "test_table_tables.h"
@@ -15,6 +16,7 @@ table_test table_tests[] = {
 	test_table_array,
 	test_table_lpm,
 	test_table_lpm_ipv6,
+	test_table_swx_lpm,
 	test_table_hash_lru,
 	test_table_hash_ext,
 	test_table_hash_cuckoo,
@@ -1052,3 +1054,240 @@ test_table_hash_cuckoo(void)
 
 	return 0;
 }
+
+struct swx_lpm_entry {
+	struct rte_swx_table_entry entry;
+	uint8_t key[16];
+	uint8_t key_mask[16];
+	uint32_t action_data;
+};
+
+static struct rte_swx_table_entry *
+swx_lpm_entry_ipv4(struct swx_lpm_entry *e, uint32_t ip, uint32_t depth,
+	uint64_t action_id, uint32_t action_data)
+{
+	uint32_t ip_be = rte_cpu_to_be_32(ip);
+	uint32_t mask_be = depth ?
+		rte_cpu_to_be_32(UINT32_MAX << (32 - depth)) : 0;
+
+	memset(e, 0, sizeof(*e));
+	memcpy(e->key, &ip_be, sizeof(ip_be));
+	memcpy(e->key_mask, &mask_be, sizeof(mask_be));
+	e->action_data = action_data;
+	e->entry.key = e->key;
+	e->entry.key_mask = e->key_mask;
+	e->entry.action_id = action_id;
+	e->entry.action_data = (uint8_t *)&e->action_data;
+
+	return &e->entry;
+}
+
+/* Run the lookup steps, return the hit flag */
+static int
+swx_lpm_lookup(void *table, uint8_t *pkt, uint64_t *action_id,
+	uint8_t **action_data)
+{
+	uint64_t mailbox[4] = {0};
+	int hit = 0;
+
+	while (!rte_swx_table_lpm_ops.lkp(table, mailbox, &pkt, action_id,
+			action_data, &hit))
+		;
+
+	return hit;
+}
+
+static int
+swx_lpm_lookup_ipv4(void *table, uint32_t ip, uint64_t *action_id,
+	uint32_t *action_data)
+{
+	uint8_t pkt[8] = {0};
+	uint32_t ip_be = rte_cpu_to_be_32(ip);
+	uint8_t *data;
+
+	/* Key at offset 2 of the packet */
+	memcpy(&pkt[2], &ip_be, sizeof(ip_be));
+	if (!swx_lpm_lookup(table, pkt, action_id, &data))
+		return 0;
+
+	memcpy(action_data, data, sizeof(*action_data));
+	return 1;
+}
+
+int
+test_table_swx_lpm(void)
+{
+	struct rte_swx_table_ops *ops = &rte_swx_table_lpm_ops;
+	struct rte_swx_table_params params = {
+		.match_type = RTE_SWX_TABLE_MATCH_LPM,
+		.key_size = 4,
+		.key_offset = 2,
+		.action_data_size = 4,
+		.n_keys_max = 4,
+	};
+	struct rte_swx_table_entry_list entries;
+	struct swx_lpm_entry e, e_list;
+	uint64_t action_id;
+	uint32_t action_data;
+	uint8_t *data;
+	void *table;
+	int status;
+
+	if (ops->mailbox_size_get() > 4 * sizeof(uint64_t))
+		return -1;
+
+	/* Create */
+	if (ops->footprint_get(&params, NULL, "num_tbl8=16") == 0)
+		return -2;
+
+	if (ops->footprint_get(&params, NULL, "bogus") != 0)
+		return -3;
+
+	params.n_keys_max = 0;
+	table = ops->create(&params, NULL, NULL, 0);
+	if (table != NULL)
+		return -4;
+
+	params.n_keys_max = 4;
+	TAILQ_INIT(&entries);
+	TAILQ_INSERT_TAIL(&entries,
+		swx_lpm_entry_ipv4(&e_list, 0x0a000000, 8, 1, 100), node);
+	table = ops->create(&params, &entries, "num_tbl8=16", 0);
+	if (table == NULL)
+		return -5;
+
+	if (!swx_lpm_lookup_ipv4(table, 0x0a010203, &action_id,
+			&action_data) ||
+	    action_id != 1 || action_data != 100)
+		return -6;
+
+	if (swx_lpm_lookup_ipv4(table, 0x0b010203, &action_id, &action_data))
+		return -7;
+
+	/* Add */
+	status = ops->add(table, swx_lpm_entry_ipv4(&e, 0x0a010000, 16, 2,
+		200));
+	if (status != 0)
+		return -8;
+
+	status = ops->add(table, swx_lpm_entry_ipv4(&e, 0x0a010203, 32, 3,
+		300));
+	if (status != 0)
+		return -9;
+
+	if (!swx_lpm_lookup_ipv4(table, 0x0a010204, &action_id,
+			&action_data) ||
+	    action_id != 2 || action_data != 200)
+		return -10;
+
+	if (!swx_lpm_lookup_ipv4(table, 0x0a010203, &action_id,
+			&action_data) ||
+	    action_id != 3 || action_data != 300)
+		return -11;
+
+	/* Modify, the key bits out of the prefix are ignored */
+	status = ops->add(table, swx_lpm_entry_ipv4(&e, 0x0a01ffff, 16, 2,
+		222));
+	if (status != 0)
+		return -12;
+
+	if (!swx_lpm_lookup_ipv4(table, 0x0a010204, &action_id,
+			&action_data) ||
+	    action_id != 2 || action_data != 222)
+		return -13;
+
+	/* Full table */
+	status = ops->add(table, swx_lpm_entry_ipv4(&e, 0, 0, 4, 400));
+	if (status != 0)
+		return -14;
+
+	status = ops->add(table, swx_lpm_entry_ipv4(&e, 0x01000000, 8, 5,
+		500));
+	if (status != -ENOSPC)
+		return -15;
+
+	if (!swx_lpm_lookup_ipv4(table, 0x0b010203, &action_id,
+			&action_data) ||
+	    action_id != 4)
+		return -16;
+
+	/* Delete */
+	status = ops->del(table, swx_lpm_entry_ipv4(&e, 0x0a010000, 16, 0, 0));
+	if (status != 0)
+		return -17;
+
+	if (!swx_lpm_lookup_ipv4(table, 0x0a010204, &action_id,
+			&action_data) ||
+	    action_id != 1 || action_data != 100)
+		return -18;
+
+	status = ops->del(table, swx_lpm_entry_ipv4(&e, 0x0a010000, 16, 0, 0));
+	if (status != 0)
+		return -19;
+
+	status = ops->add(table, swx_lpm_entry_ipv4(&e, 0x01000000, 8, 5,
+		500));
+	if (status != 0)
+		return -20;
+
+	if (!swx_lpm_lookup_ipv4(table, 0x01020304, &action_id,
+			&action_data) ||
+	    action_id != 5 || action_data != 500)
+		return -21;
+
+	/* Non contiguous mask */
+	swx_lpm_entry_ipv4(&e, 0x0a000000, 8, 6, 600);
+	e.key_mask[3] = 1;
+	if (ops->add(table, &e.entry) != -EINVAL)
+		return -22;
+
+	if (ops->del(table, &e.entry) != -EINVAL)
+		return -23;
+
+	ops->free(table);
+
+	/* IPv6 */
+	struct rte_swx_table_params params6 = {
+		.match_type = RTE_SWX_TABLE_MATCH_LPM,
+		.key_size = 16,
+		.key_offset = 0,
+		.action_data_size = 0,
+		.n_keys_max = 8,
+	};
+	uint8_t pkt6[16] = {0x20, 0x01, 0x0d, 0xb8, 0x09};
+
+	table = ops->create(&params6, NULL, NULL, 0);
+	if (table == NULL)
+		return -24;
+
+	/* 2001:db8::/32 */
+	memset(&e, 0, sizeof(e));
+	memcpy(e.key, pkt6, 4);
+	memset(e.key_mask, 0xff, 4);
+	e.entry.key = e.key;
+	e.entry.key_mask = e.key_mask;
+	e.entry.action_id = 7;
+	status = ops->add(table, &e.entry);
+	if (status != 0)
+		return -25;
+
+	if (!swx_lpm_lookup(table, pkt6, &action_id, &data) ||
+	    action_id != 7)
+		return -26;
+
+	pkt6[3] = 0xb9;
+	if (swx_lpm_lookup(table, pkt6, &action_id, &data))
+		return -27;
+
+	status = ops->del(table, &e.entry);
+	if (status != 0)
+		return -28;
+
+	pkt6[3] = 0xb8;
+	if (swx_lpm_lookup(table, pkt6, &action_id, &data))
+		return -29;
+
+	ops->free(table);
+
+	return 0;
+}
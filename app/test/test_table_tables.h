@@ -6,6 +6,7 @@
 int test_table_hash_cuckoo(void);
 int test_table_lpm(void);
 int test_table_lpm_ipv6(void);
+int test_table_swx_lpm(void);
 int test_table_array(void);
 #ifdef RTE_LIB_ACL
 int test_table_acl(void);
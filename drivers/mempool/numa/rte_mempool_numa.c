@@ -0,0 +1,331 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 agent <agent@local>
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <rte_errno.h>
+#include <rte_lcore.h>
+#include <rte_malloc.h>
+#include <rte_memory.h>
+#include <rte_mempool.h>
+#include <rte_ring.h>
+
+/*
+ * The NUMA mempool driver keeps one ring of free objects per NUMA node.
+ * Every object has a home node, the one of the memory chunk it lives in,
+ * and is always returned to the ring of its home node, whichever lcore
+ * frees it. Lcores get objects from the ring of their own node, and only
+ * steal from the rings of the remote nodes when the local one is short.
+ */
+
+#define NUMA_RING_NAME_FORMAT "MPN%u_%s"
+
+/* Per node statistics, updated by the lcores of all nodes */
+struct numa_node_stats {
+	uint64_t put_objs;        /**< Objects returned to the node ring. */
+	uint64_t remote_put_objs; /**< Of which returned by remote lcores. */
+	uint64_t get_objs;        /**< Objects got by lcores of the node. */
+	uint64_t steal_objs;      /**< Of which stolen from remote nodes. */
+	uint64_t stolen_objs;     /**< Objects of the node got by remote lcores. */
+} __rte_cache_aligned;
+
+/* Memory chunk of the pool, all its objects have the same home node */
+struct numa_mem_chunk {
+	uintptr_t start;
+	uintptr_t end;
+	unsigned int node;
+};
+
+struct numa_pool {
+	unsigned int nb_nodes;
+	unsigned int default_node; /**< Node of unknown sockets and threads. */
+	uint8_t socket_node[RTE_MAX_NUMA_NODES]; /**< Socket ID to node. */
+	struct rte_ring *rings[RTE_MAX_NUMA_NODES];
+	unsigned int nb_chunks;
+	unsigned int max_chunks;
+	struct numa_mem_chunk *chunks; /**< Sorted by address. */
+	struct numa_node_stats stats[RTE_MAX_NUMA_NODES];
+};
+
+static inline unsigned int
+numa_socket_node(const struct numa_pool *p, int socket_id)
+{
+	if ((unsigned int)socket_id >= RTE_MAX_NUMA_NODES)
+		return p->default_node;
+	return p->socket_node[socket_id];
+}
+
+/* Home node of an object, looked up in the memory chunks of the pool */
+static inline unsigned int
+numa_obj_node(const struct numa_pool *p, const void *obj)
+{
+	const struct numa_mem_chunk *chunk;
+	uintptr_t addr = (uintptr_t)obj;
+	unsigned int lo = 0, hi = p->nb_chunks, mid;
+
+	if (p->nb_nodes == 1)
+		return 0;
+
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		chunk = &p->chunks[mid];
+		if (addr < chunk->start)
+			hi = mid;
+		else if (addr >= chunk->end)
+			lo = mid + 1;
+		else
+			return chunk->node;
+	}
+
+	return p->default_node;
+}
+
+static int
+numa_enqueue(struct rte_mempool *mp, void * const *obj_table, unsigned int n)
+{
+	struct numa_pool *p = mp->pool_data;
+	unsigned int local, node, first, i;
+
+	local = numa_socket_node(p, rte_socket_id());
+
+	/* Objects of a burst usually share their home node */
+	for (first = 0; first < n; first = i) {
+		node = numa_obj_node(p, obj_table[first]);
+		for (i = first + 1; i < n; i++)
+			if (numa_obj_node(p, obj_table[i]) != node)
+				break;
+
+		/* Every ring is large enough for all the objects */
+		if (rte_ring_enqueue_bulk(p->rings[node], &obj_table[first],
+				i - first, NULL) == 0)
+			return -ENOBUFS;
+
+		__atomic_fetch_add(&p->stats[node].put_objs, i - first,
+				   __ATOMIC_RELAXED);
+		if (node != local)
+			__atomic_fetch_add(&p->stats[node].remote_put_objs,
+					   i - first, __ATOMIC_RELAXED);
+	}
+
+	return 0;
+}
+
+static int
+numa_dequeue(struct rte_mempool *mp, void **obj_table, unsigned int n)
+{
+	struct numa_pool *p = mp->pool_data;
+	unsigned int stolen[RTE_MAX_NUMA_NODES];
+	unsigned int local, node, local_got, got, i;
+
+	local = numa_socket_node(p, rte_socket_id());
+	if (rte_ring_dequeue_bulk(p->rings[local], obj_table, n, NULL) != 0) {
+		__atomic_fetch_add(&p->stats[local].get_objs, n,
+				   __ATOMIC_RELAXED);
+		return 0;
+	}
+
+	/* Local node is short, complete with objects of remote nodes */
+	local_got = rte_ring_dequeue_burst(p->rings[local], obj_table, n,
+					   NULL);
+	got = local_got;
+	for (i = 1; i < p->nb_nodes; i++) {
+		node = (local + i) % p->nb_nodes;
+		stolen[node] = 0;
+		if (got < n) {
+			stolen[node] = rte_ring_dequeue_burst(p->rings[node],
+					&obj_table[got], n - got, NULL);
+			got += stolen[node];
+		}
+	}
+
+	if (got < n) {
+		/* Not enough objects, give back the ones already taken */
+		rte_ring_enqueue_bulk(p->rings[local], obj_table, local_got,
+				      NULL);
+		got = local_got;
+		for (i = 1; i < p->nb_nodes; i++) {
+			node = (local + i) % p->nb_nodes;
+			rte_ring_enqueue_bulk(p->rings[node], &obj_table[got],
+					      stolen[node], NULL);
+			got += stolen[node];
+		}
+		return -ENOBUFS;
+	}
+
+	__atomic_fetch_add(&p->stats[local].get_objs, n, __ATOMIC_RELAXED);
+	for (i = 1; i < p->nb_nodes; i++) {
+		node = (local + i) % p->nb_nodes;
+		if (stolen[node] == 0)
+			continue;
+		__atomic_fetch_add(&p->stats[local].steal_objs, stolen[node],
+				   __ATOMIC_RELAXED);
+		__atomic_fetch_add(&p->stats[node].stolen_objs, stolen[node],
+				   __ATOMIC_RELAXED);
+	}
+
+	return 0;
+}
+
+static unsigned int
+numa_get_count(const struct rte_mempool *mp)
+{
+	const struct numa_pool *p = mp->pool_data;
+	unsigned int count = 0, i;
+
+	for (i = 0; i < p->nb_nodes; i++)
+		count += rte_ring_count(p->rings[i]);
+
+	return count;
+}
+
+static void
+numa_free(struct rte_mempool *mp)
+{
+	struct numa_pool *p = mp->pool_data;
+	unsigned int i;
+
+	if (p == NULL)
+		return;
+
+	for (i = 0; i < p->nb_nodes; i++)
+		rte_ring_free(p->rings[i]);
+	rte_free(p->chunks);
+	rte_free(p);
+	mp->pool_data = NULL;
+}
+
+static int
+numa_alloc(struct rte_mempool *mp)
+{
+	char rg_name[RTE_RING_NAMESIZE];
+	uint32_t rg_flags = 0;
+	struct numa_pool *p;
+	unsigned int i;
+	int socket_id;
+	int ret;
+
+	p = rte_zmalloc_socket("mempool_numa", sizeof(*p),
+			       RTE_CACHE_LINE_SIZE, mp->socket_id);
+	if (p == NULL) {
+		rte_errno = ENOMEM;
+		return -rte_errno;
+	}
+	mp->pool_data = p;
+
+	if (mp->flags & RTE_MEMPOOL_F_SP_PUT)
+		rg_flags |= RING_F_SP_ENQ;
+	if (mp->flags & RTE_MEMPOOL_F_SC_GET)
+		rg_flags |= RING_F_SC_DEQ;
+
+	p->nb_nodes = RTE_MAX(rte_socket_count(), 1u);
+	for (i = 0; i < p->nb_nodes; i++) {
+		socket_id = rte_socket_id_by_idx(i);
+		if (socket_id >= 0 && socket_id < RTE_MAX_NUMA_NODES)
+			p->socket_node[socket_id] = i;
+		else
+			socket_id = SOCKET_ID_ANY;
+
+		ret = snprintf(rg_name, sizeof(rg_name),
+			NUMA_RING_NAME_FORMAT, i, mp->name);
+		if (ret < 0 || ret >= (int)sizeof(rg_name)) {
+			rte_errno = ENAMETOOLONG;
+			goto err;
+		}
+
+		/* Each node may end up holding all the objects */
+		p->rings[i] = rte_ring_create(rg_name,
+			rte_align32pow2(mp->size + 1), socket_id, rg_flags);
+		if (p->rings[i] == NULL)
+			goto err;
+	}
+	p->default_node = numa_socket_node(p, mp->socket_id);
+
+	return 0;
+
+err:
+	ret = -rte_errno;
+	numa_free(mp);
+	return ret;
+}
+
+/* Record the memory chunk and its home node before adding its objects */
+static int
+numa_populate(struct rte_mempool *mp, unsigned int max_objs,
+	      void *vaddr, rte_iova_t iova, size_t len,
+	      rte_mempool_populate_obj_cb_t *obj_cb, void *obj_cb_arg)
+{
+	struct numa_pool *p = mp->pool_data;
+	const struct rte_memseg_list *msl;
+	struct numa_mem_chunk *chunks;
+	unsigned int i;
+	int ret;
+
+	if (p->nb_chunks == p->max_chunks) {
+		chunks = rte_realloc_socket(p->chunks,
+			sizeof(*chunks) * RTE_MAX(p->max_chunks * 2, 8u),
+			0, mp->socket_id);
+		if (chunks == NULL)
+			return -ENOMEM;
+		p->chunks = chunks;
+		p->max_chunks = RTE_MAX(p->max_chunks * 2, 8u);
+	}
+
+	for (i = p->nb_chunks; i > 0; i--) {
+		if (p->chunks[i - 1].start < (uintptr_t)vaddr)
+			break;
+		p->chunks[i] = p->chunks[i - 1];
+	}
+	p->chunks[i].start = (uintptr_t)vaddr;
+	p->chunks[i].end = (uintptr_t)vaddr + len;
+	msl = rte_mem_virt2memseg_list(vaddr);
+	p->chunks[i].node = numa_socket_node(p,
+			msl != NULL ? msl->socket_id : mp->socket_id);
+	p->nb_chunks++;
+
+	ret = rte_mempool_op_populate_helper(mp, 0, max_objs, vaddr, iova,
+					     len, obj_cb, obj_cb_arg);
+	if (ret <= 0) {
+		p->nb_chunks--;
+		memmove(&p->chunks[i], &p->chunks[i + 1],
+			sizeof(p->chunks[0]) * (p->nb_chunks - i));
+	}
+
+	return ret;
+}
+
+static void
+numa_dump(FILE *f, const struct rte_mempool *mp)
+{
+	const struct numa_pool *p = mp->pool_data;
+	const struct numa_node_stats *s;
+	unsigned int i;
+
+	fprintf(f, "  numa_nodes=%u\n", p->nb_nodes);
+	for (i = 0; i < p->nb_nodes; i++) {
+		s = &p->stats[i];
+		fprintf(f, "    node %u: socket_id=%d count=%u\n", i,
+			rte_socket_id_by_idx(i), rte_ring_count(p->rings[i]));
+		fprintf(f, "      put_objs=%"PRIu64"\n", s->put_objs);
+		fprintf(f, "      remote_put_objs=%"PRIu64"\n",
+			s->remote_put_objs);
+		fprintf(f, "      get_objs=%"PRIu64"\n", s->get_objs);
+		fprintf(f, "      steal_objs=%"PRIu64"\n", s->steal_objs);
+		fprintf(f, "      stolen_objs=%"PRIu64"\n", s->stolen_objs);
+	}
+}
+
+static const struct rte_mempool_ops ops_numa = {
+	.name = "ring_numa",
+	.alloc = numa_alloc,
+	.free = numa_free,
+	.enqueue = numa_enqueue,
+	.dequeue = numa_dequeue,
+	.get_count = numa_get_count,
+	.populate = numa_populate,
+	.dump = numa_dump,
+};
+
+RTE_MEMPOOL_REGISTER_OPS(ops_numa);
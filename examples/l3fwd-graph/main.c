@@ -30,6 +30,7 @@
 #include <rte_mempool.h>
 #include <rte_node_eth_api.h>
 #include <rte_node_ip4_api.h>
+#include <rte_node_ip6_api.h>
 #include <rte_per_lcore.h>
 #include <rte_string_fns.h>
 #include <rte_vect.h>
@@ -53,6 +54,8 @@
 
 #define MAX_LCORE_PARAMS 1024
 
+#define MAX_NODE_AFFINITY_PARAMS 64
+
 #define NB_SOCKETS 8
 
 /* Static global variables used within this file. */
@@ -127,6 +130,19 @@ static struct rte_eth_conf port_conf = {
 
 static uint32_t max_pkt_len;
 
+/* Graph worker model, run-to-completion by default */
+static uint8_t worker_model = RTE_GRAPH_MODEL_RTC;
+
+/* Node lcore affinity in dispatch model */
+struct node_affinity_params {
+	char node_name[RTE_NODE_NAMESIZE];
+	uint32_t lcore_id;
+};
+
+static struct node_affinity_params
+	node_affinity_params[MAX_NODE_AFFINITY_PARAMS];
+static uint16_t nb_node_affinity_params;
+
 static struct rte_mempool *pktmbuf_pool[RTE_MAX_ETHPORTS][NB_SOCKETS];
 
 static struct rte_node_ethdev_config ethdev_conf[RTE_MAX_ETHPORTS];
@@ -148,6 +164,26 @@ static struct ipv4_l3fwd_lpm_route ipv4_l3fwd_lpm_route_array[] = {
 	{RTE_IPV4(198, 18, 6, 0), 24, 6}, {RTE_IPV4(198, 18, 7, 0), 24, 7},
 };
 
+struct ipv6_l3fwd_lpm_route {
+	uint8_t ip[16];
+	uint8_t depth;
+	uint8_t if_out;
+};
+
+#define IPV6_L3FWD_LPM_NUM_ROUTES                                              \
+	(sizeof(ipv6_l3fwd_lpm_route_array) /                                  \
+	 sizeof(ipv6_l3fwd_lpm_route_array[0]))
+static struct ipv6_l3fwd_lpm_route ipv6_l3fwd_lpm_route_array[] = {
+	{{32, 1, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, 64, 0},
+	{{32, 1, 2, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0}, 64, 1},
+	{{32, 1, 2, 0, 0, 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0}, 64, 2},
+	{{32, 1, 2, 0, 0, 0, 0, 3, 0, 0, 0, 0, 0, 0, 0, 0}, 64, 3},
+	{{32, 1, 2, 0, 0, 0, 0, 4, 0, 0, 0, 0, 0, 0, 0, 0}, 64, 4},
+	{{32, 1, 2, 0, 0, 0, 0, 5, 0, 0, 0, 0, 0, 0, 0, 0}, 64, 5},
+	{{32, 1, 2, 0, 0, 0, 0, 6, 0, 0, 0, 0, 0, 0, 0, 0}, 64, 6},
+	{{32, 1, 2, 0, 0, 0, 0, 7, 0, 0, 0, 0, 0, 0, 0, 0}, 64, 7},
+};
+
 static int
 check_lcore_params(void)
 {
@@ -182,6 +218,47 @@ check_lcore_params(void)
 	return 0;
 }
 
+static int
+check_node_affinity_params(void)
+{
+	uint32_t lcore;
+	uint16_t i;
+
+	if (nb_node_affinity_params &&
+	    worker_model != RTE_GRAPH_MODEL_DISPATCH) {
+		printf("Error: node affinity requires dispatch model\n");
+		return -1;
+	}
+
+	for (i = 0; i < nb_node_affinity_params; ++i) {
+		lcore = node_affinity_params[i].lcore_id;
+		if (!rte_lcore_is_enabled(lcore)) {
+			printf("Error: lcore %u is not enabled in lcore mask\n",
+			       lcore);
+			return -1;
+		}
+
+		if (lcore == rte_get_main_lcore()) {
+			printf("Error: lcore %u is main lcore\n", lcore);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static bool
+lcore_has_node_affinity(uint32_t lcore_id)
+{
+	uint16_t i;
+
+	for (i = 0; i < nb_node_affinity_params; ++i)
+		if (node_affinity_params[i].lcore_id == lcore_id)
+			return true;
+
+	return false;
+}
+
 static int
 check_port_config(void)
 {
@@ -262,7 +339,9 @@ print_usage(const char *prgname)
 		" [--eth-dest=X,MM:MM:MM:MM:MM:MM]"
 		" [--max-pkt-len PKTLEN]"
 		" [--no-numa]"
-		" [--per-port-pool]\n\n"
+		" [--per-port-pool]"
+		" [--model rtc|dispatch]"
+		" [--node-affinity (node,lcore)[,(node,lcore)]]\n\n"
 
 		"  -p PORTMASK: Hexadecimal bitmask of ports to configure\n"
 		"  -P : Enable promiscuous mode\n"
@@ -271,10 +350,28 @@ print_usage(const char *prgname)
 		"port X\n"
 		"  --max-pkt-len PKTLEN: maximum packet length in decimal (64-9600)\n"
 		"  --no-numa: Disable numa awareness\n"
-		"  --per-port-pool: Use separate buffer pool per port\n\n",
+		"  --per-port-pool: Use separate buffer pool per port\n"
+		"  --model rtc|dispatch: Graph worker model, a graph per lcore"
+		" in rtc model, a graph shared by the lcores in dispatch model"
+		"\n"
+		"  --node-affinity (node,lcore): Lcore to run a node on in"
+		" dispatch model\n\n",
 		prgname);
 }
 
+static int
+parse_worker_model(const char *model)
+{
+	if (strcmp(model, "rtc") == 0)
+		worker_model = RTE_GRAPH_MODEL_RTC;
+	else if (strcmp(model, "dispatch") == 0)
+		worker_model = RTE_GRAPH_MODEL_DISPATCH;
+	else
+		return -1;
+
+	return 0;
+}
+
 static int
 parse_max_pkt_len(const char *pktlen)
 {
@@ -367,6 +464,61 @@ parse_config(const char *q_arg)
 	return 0;
 }
 
+static int
+parse_node_affinity(const char *q_arg)
+{
+	enum fieldnames { FLD_NODE = 0, FLD_LCORE, _NUM_FLD };
+	const char *p, *p0 = q_arg;
+	char *str_fld[_NUM_FLD];
+	unsigned long lcore;
+	uint32_t size;
+	char s[256];
+	char *end;
+
+	nb_node_affinity_params = 0;
+
+	while ((p = strchr(p0, '(')) != NULL) {
+		++p;
+		p0 = strchr(p, ')');
+		if (p0 == NULL)
+			return -1;
+
+		size = p0 - p;
+		if (size >= sizeof(s))
+			return -1;
+
+		memcpy(s, p, size);
+		s[size] = '\0';
+		if (rte_strsplit(s, sizeof(s), str_fld, _NUM_FLD, ',') !=
+		    _NUM_FLD)
+			return -1;
+
+		errno = 0;
+		lcore = strtoul(str_fld[FLD_LCORE], &end, 0);
+		if (errno != 0 || end == str_fld[FLD_LCORE])
+			return -1;
+
+		if (nb_node_affinity_params >= MAX_NODE_AFFINITY_PARAMS) {
+			printf("Exceeded max number of node affinity params: %hu\n",
+			       nb_node_affinity_params);
+			return -1;
+		}
+
+		if (lcore >= RTE_MAX_LCORE ||
+		    strlen(str_fld[FLD_NODE]) >= RTE_NODE_NAMESIZE) {
+			printf("Invalid node/lcore\n");
+			return -1;
+		}
+
+		strcpy(node_affinity_params[nb_node_affinity_params].node_name,
+		       str_fld[FLD_NODE]);
+		node_affinity_params[nb_node_affinity_params].lcore_id = lcore;
+		++nb_node_affinity_params;
+	}
+
+	return 0;
+}
+
 static void
 parse_eth_dest(const char *optarg)
 {
@@ -405,6 +557,8 @@ static const char short_options[] = "p:" /* portmask */
 #define CMD_LINE_OPT_NO_NUMA	   "no-numa"
 #define CMD_LINE_OPT_MAX_PKT_LEN   "max-pkt-len"
 #define CMD_LINE_OPT_PER_PORT_POOL "per-port-pool"
+#define CMD_LINE_OPT_WORKER_MODEL  "model"
+#define CMD_LINE_OPT_NODE_AFFINITY "node-affinity"
 enum {
 	/* Long options mapped to a short option */
 
@@ -417,6 +571,8 @@ enum {
 	CMD_LINE_OPT_NO_NUMA_NUM,
 	CMD_LINE_OPT_MAX_PKT_LEN_NUM,
 	CMD_LINE_OPT_PARSE_PER_PORT_POOL,
+	CMD_LINE_OPT_WORKER_MODEL_NUM,
+	CMD_LINE_OPT_NODE_AFFINITY_NUM,
 };
 
 static const struct option lgopts[] = {
@@ -425,6 +581,8 @@ static const struct option lgopts[] = {
 	{CMD_LINE_OPT_NO_NUMA, 0, 0, CMD_LINE_OPT_NO_NUMA_NUM},
 	{CMD_LINE_OPT_MAX_PKT_LEN, 1, 0, CMD_LINE_OPT_MAX_PKT_LEN_NUM},
 	{CMD_LINE_OPT_PER_PORT_POOL, 0, 0, CMD_LINE_OPT_PARSE_PER_PORT_POOL},
+	{CMD_LINE_OPT_WORKER_MODEL, 1, 0, CMD_LINE_OPT_WORKER_MODEL_NUM},
+	{CMD_LINE_OPT_NODE_AFFINITY, 1, 0, CMD_LINE_OPT_NODE_AFFINITY_NUM},
 	{NULL, 0, 0, 0},
 };
 
@@ -499,6 +657,24 @@ parse_args(int argc, char **argv)
 			per_port_pool = 1;
 			break;
 
+		case CMD_LINE_OPT_WORKER_MODEL_NUM:
+			ret = parse_worker_model(optarg);
+			if (ret) {
+				fprintf(stderr, "Invalid worker model\n");
+				print_usage(prgname);
+				return -1;
+			}
+			break;
+
+		case CMD_LINE_OPT_NODE_AFFINITY_NUM:
+			ret = parse_node_affinity(optarg);
+			if (ret) {
+				fprintf(stderr, "Invalid node affinity\n");
+				print_usage(prgname);
+				return -1;
+			}
+			break;
+
 		default:
 			print_usage(prgname);
 			return -1;
@@ -744,6 +920,7 @@ main(int argc, char **argv)
 	/* Graph initialization. 8< */
 	static const char * const default_patterns[] = {
 		"ip4*",
+		"ip6*",
 		"ethdev_tx-*",
 		"pkt_drop",
 	};
@@ -756,6 +933,7 @@ main(int argc, char **argv)
 	uint16_t queueid, portid, i;
 	const char **node_patterns;
 	struct lcore_conf *qconf;
+	rte_graph_t parent_id = RTE_GRAPH_ID_INVALID;
 	uint16_t nb_graphs = 0;
 	uint16_t nb_patterns;
 	uint8_t rewrite_len;
@@ -788,6 +966,9 @@ main(int argc, char **argv)
 	if (check_lcore_params() < 0)
 		rte_exit(EXIT_FAILURE, "check_lcore_params() failed\n");
 
+	if (check_node_affinity_params() < 0)
+		rte_exit(EXIT_FAILURE, "check_node_affinity_params() failed\n");
+
 	ret = init_lcore_rx_queues();
 	if (ret < 0)
 		rte_exit(EXIT_FAILURE, "init_lcore_rx_queues() failed\n");
@@ -1018,7 +1199,7 @@ main(int argc, char **argv)
 
 	/* Graph Initialization */
 	nb_patterns = RTE_DIM(default_patterns);
-	node_patterns = malloc((MAX_RX_QUEUE_PER_LCORE + nb_patterns) *
+	node_patterns = malloc((nb_lcore_params + nb_patterns) *
 			       sizeof(*node_patterns));
 	if (!node_patterns)
 		return -ENOMEM;
@@ -1029,7 +1210,9 @@ main(int argc, char **argv)
 	graph_conf.node_patterns = node_patterns;
 
 	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		char name[RTE_GRAPH_NAMESIZE];
 		rte_graph_t graph_id;
+		uint32_t lcore;
 		rte_edge_t i;
 
 		if (rte_lcore_is_enabled(lcore_id) == 0)
@@ -1037,28 +1220,50 @@ main(int argc, char **argv)
 
 		qconf = &lcore_conf[lcore_id];
 
-		/* Skip graph creation if no source exists */
-		if (!qconf->n_rx_queue)
+		/* Skip graph creation if no source exists, unless a node is
+		 * affinitized to this lcore in dispatch model.
+		 */
+		if (!qconf->n_rx_queue && !lcore_has_node_affinity(lcore_id))
 			continue;
 
-		/* Add rx node patterns of this lcore */
-		for (i = 0; i < qconf->n_rx_queue; i++) {
-			graph_conf.node_patterns[nb_patterns + i] =
-				qconf->rx_queue_list[i].node_name;
-		}
-
-		graph_conf.nb_node_patterns = nb_patterns + i;
-		graph_conf.socket_id = rte_lcore_to_socket_id(lcore_id);
+		if (parent_id != RTE_GRAPH_ID_INVALID) {
+			/* Clone the graph holding the rx nodes of all lcores */
+			snprintf(name, sizeof(name), "%u", lcore_id);
+			graph_id = rte_graph_clone(parent_id, name);
+		} else {
+			/* Add rx node patterns of this lcore, or of all the
+			 * lcores in dispatch model.
+			 */
+			i = 0;
+			for (lcore = 0; lcore < RTE_MAX_LCORE; lcore++) {
+				if (lcore != lcore_id &&
+				    worker_model != RTE_GRAPH_MODEL_DISPATCH)
+					continue;
+				for (queue = 0;
+				     queue < lcore_conf[lcore].n_rx_queue;
+				     queue++)
+					graph_conf.node_patterns[nb_patterns +
+								 i++] =
+						lcore_conf[lcore]
+							.rx_queue_list[queue]
+							.node_name;
+			}
 
-		snprintf(qconf->name, sizeof(qconf->name), "worker_%u",
-			 lcore_id);
+			graph_conf.nb_node_patterns = nb_patterns + i;
+			graph_conf.socket_id = rte_lcore_to_socket_id(lcore_id);
 
-		graph_id = rte_graph_create(qconf->name, &graph_conf);
+			snprintf(name, sizeof(name), "worker_%u", lcore_id);
+			graph_id = rte_graph_create(name, &graph_conf);
+			if (worker_model == RTE_GRAPH_MODEL_DISPATCH)
+				parent_id = graph_id;
+		}
 		if (graph_id == RTE_GRAPH_ID_INVALID)
 			rte_exit(EXIT_FAILURE,
 				 "rte_graph_create(): graph_id invalid"
 				 " for lcore %u\n", lcore_id);
 
+		snprintf(qconf->name, sizeof(qconf->name), "%s",
+			 rte_graph_id_to_name(graph_id));
 		qconf->graph_id = graph_id;
 		qconf->graph = rte_graph_lookup(qconf->name);
 		/* >8 End of graph initialization. */
@@ -1066,6 +1271,37 @@ main(int argc, char **argv)
 			rte_exit(EXIT_FAILURE,
 				 "rte_graph_lookup(): graph %s not found\n",
 				 qconf->name);
+
+		if (worker_model != RTE_GRAPH_MODEL_DISPATCH)
+			continue;
+
+		/* Poll the rx queues of this lcore on this lcore only */
+		for (i = 0; i < qconf->n_rx_queue; i++) {
+			ret = rte_graph_model_dispatch_lcore_affinity_set(
+				qconf->rx_queue_list[i].node_name, lcore_id);
+			if (ret < 0)
+				rte_exit(EXIT_FAILURE,
+					 "Unable to set affinity of node %s\n",
+					 qconf->rx_queue_list[i].node_name);
+		}
+
+		if (rte_graph_worker_model_set(graph_id,
+					       RTE_GRAPH_MODEL_DISPATCH) ||
+		    rte_graph_model_dispatch_core_bind(graph_id, lcore_id))
+			rte_exit(EXIT_FAILURE,
+				 "Unable to bind graph %s to lcore %u\n",
+				 qconf->name, lcore_id);
+	}
+
+	/* Run the nodes given by --node-affinity on their lcores */
+	for (i = 0; i < nb_node_affinity_params; i++) {
+		ret = rte_graph_model_dispatch_lcore_affinity_set(
+			node_affinity_params[i].node_name,
+			node_affinity_params[i].lcore_id);
+		if (ret < 0)
+			rte_exit(EXIT_FAILURE,
+				 "Unable to set affinity of node %s\n",
+				 node_affinity_params[i].node_name);
 	}
 
 	memset(&rewrite_data, 0, sizeof(rewrite_data));
@@ -1117,6 +1353,51 @@ main(int argc, char **argv)
 	}
 	/* >8 End of adding route to ip4 graph infa. */
 
+	/* Add route to ip6 graph infra. 8< */
+	for (i = 0; i < IPV6_L3FWD_LPM_NUM_ROUTES; i++) {
+		char route_str[INET6_ADDRSTRLEN * 4];
+		char abuf[INET6_ADDRSTRLEN];
+		uint32_t dst_port;
+
+		/* Skip unused ports */
+		if ((1 << ipv6_l3fwd_lpm_route_array[i].if_out &
+		     enabled_port_mask) == 0)
+			continue;
+
+		dst_port = ipv6_l3fwd_lpm_route_array[i].if_out;
+
+		snprintf(route_str, sizeof(route_str), "%s / %d (%d)",
+			 inet_ntop(AF_INET6, ipv6_l3fwd_lpm_route_array[i].ip,
+				   abuf, sizeof(abuf)),
+			 ipv6_l3fwd_lpm_route_array[i].depth,
+			 ipv6_l3fwd_lpm_route_array[i].if_out);
+
+		/* Use route index 'i' as next hop id */
+		ret = rte_node_ip6_route_add(
+			ipv6_l3fwd_lpm_route_array[i].ip,
+			ipv6_l3fwd_lpm_route_array[i].depth, i,
+			RTE_NODE_IP6_LOOKUP_NEXT_REWRITE);
+
+		if (ret < 0)
+			rte_exit(EXIT_FAILURE,
+				 "Unable to add ip6 route %s to graph\n",
+				 route_str);
+
+		memcpy(rewrite_data, val_eth + dst_port, rewrite_len);
+
+		/* Add next hop rewrite data for id 'i' */
+		ret = rte_node_ip6_rewrite_add(i, rewrite_data,
+					       rewrite_len, dst_port);
+		if (ret < 0)
+			rte_exit(EXIT_FAILURE,
+				 "Unable to add next hop %u for "
+				 "route %s\n", i, route_str);
+
+		RTE_LOG(INFO, L3FWD_GRAPH, "Added route %s, next_hop %u\n",
+			route_str, i);
+	}
+	/* >8 End of adding route to ip6 graph infa. */
+
 	/* Launch per-lcore init on every worker lcore */
 	rte_eal_mp_remote_launch(graph_main_loop, NULL, SKIP_MAIN);
 
@@ -1128,9 +1409,15 @@ main(int argc, char **argv)
 	ret = 0;
 	RTE_LCORE_FOREACH_WORKER(lcore_id) {
 		ret = rte_eal_wait_lcore(lcore_id);
-		/* Destroy graph */
-		if (ret < 0 || rte_graph_destroy(
-			rte_graph_from_name(lcore_conf[lcore_id].name))) {
+		if (ret < 0)
+			break;
+	}
+
+	/* Destroy graphs, the cloned ones before their parent */
+	for (lcore_id = RTE_MAX_LCORE; ret >= 0 && lcore_id-- > 0;) {
+		if (lcore_conf[lcore_id].graph == NULL)
+			continue;
+		if (rte_graph_destroy(lcore_conf[lcore_id].graph_id)) {
 			ret = -1;
 			break;
 		}
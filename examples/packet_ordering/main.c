@@ -488,6 +488,8 @@ worker_thread(void *args_ptr)
 	struct rte_ring *ring_in, *ring_out;
 	const unsigned xor_val = (nb_ports > 1);
 	unsigned int core_id = rte_lcore_id();
+	/* idle on an empty ring, checking quit_signal every millisecond */
+	const uint64_t wait_cycles = rte_get_tsc_hz() / 1000;
 
 	args = (struct worker_thread_args *) args_ptr;
 	ring_in  = args->ring_in;
@@ -499,8 +501,9 @@ worker_thread(void *args_ptr)
 	while (!quit_signal) {
 
 		/* dequeue the mbufs from rx_to_workers ring */
-		burst_size = rte_ring_dequeue_burst(ring_in,
-				(void *)burst_buffer, MAX_PKTS_BURST, NULL);
+		burst_size = rte_ring_dequeue_burst_wait(ring_in,
+				(void *)burst_buffer, MAX_PKTS_BURST, NULL,
+				wait_cycles);
 		if (unlikely(burst_size == 0))
 			continue;
 
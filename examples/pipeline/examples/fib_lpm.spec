@@ -0,0 +1,157 @@
+; SPDX-License-Identifier: BSD-3-Clause
+; Copyright(c) 2022 agent <agent@local>
+
+; This example is a variant of the FIB example (fib.spec) without the VRF support, which allows the
+; routing table to be keyed by the IP destination address read directly from the packet header. The
+; single LPM match field of this table being a header field, the table is implemented by the
+; dedicated LPM table type built on top of the DPDK FIB library, which supports large routing tables
+; (millions of routes) with constant lookup time and incremental route updates.
+;
+; The LPM table type can be compared against the wildcard match table type for the same routing
+; table by adding the "instanceof wildcard" statement to the routing_table definition below, then
+; checking the packet rate reported by the "pipeline PIPELINE0 stats" CLI command for each case.
+;
+; The optional "pragma num_tbl8=<N>" statement of the routing table sets the number of FIB tbl8
+; groups, each one being used by a /24 network that contains routes longer than /24.
+
+//
+// Headers
+//
+struct ethernet_h {
+	bit<48> dst_addr
+	bit<48> src_addr
+	bit<16> ethertype
+}
+
+struct ipv4_h {
+	bit<8> ver_ihl
+	bit<8> diffserv
+	bit<16> total_len
+	bit<16> identification
+	bit<16> flags_offset
+	bit<8> ttl
+	bit<8> protocol
+	bit<16> hdr_checksum
+	bit<32> src_addr
+	bit<32> dst_addr
+}
+
+header ethernet instanceof ethernet_h
+header ipv4 instanceof ipv4_h
+
+//
+// Meta-data
+//
+struct metadata_t {
+	bit<32> port_in
+	bit<32> port_out
+	bit<32> nexthop_group_id
+	bit<32> nexthop_id
+}
+
+metadata instanceof metadata_t
+
+//
+// Actions
+//
+struct nexthop_group_action_args_t {
+	bit<32> nexthop_group_id
+}
+
+action nexthop_group_action args instanceof nexthop_group_action_args_t {
+	mov m.nexthop_group_id t.nexthop_group_id
+	return
+}
+
+struct nexthop_action_args_t {
+	bit<48> ethernet_dst_addr
+	bit<48> ethernet_src_addr
+	bit<16> ethernet_ethertype
+	bit<32> port_out
+}
+
+action nexthop_action args instanceof nexthop_action_args_t {
+	//Set Ethernet header.
+	mov h.ethernet.dst_addr t.ethernet_dst_addr
+	mov h.ethernet.src_addr t.ethernet_src_addr
+	mov h.ethernet.ethertype t.ethernet_ethertype
+	validate h.ethernet
+
+	//Decrement the TTL and update the checksum within the IPv4 header.
+	cksub h.ipv4.hdr_checksum h.ipv4.ttl
+	sub h.ipv4.ttl 0x1
+	ckadd h.ipv4.hdr_checksum h.ipv4.ttl
+
+	//Set the output port.
+	mov m.port_out t.port_out
+
+	return
+}
+
+action drop args none {
+	drop
+}
+
+//
+// Tables
+//
+table routing_table {
+	key {
+		h.ipv4.dst_addr lpm
+	}
+
+	actions {
+		nexthop_group_action
+		drop
+	}
+
+	default_action drop args none
+
+	size 1048576
+}
+
+selector nexthop_group_table {
+	group_id m.nexthop_group_id
+
+	selector {
+		h.ipv4.protocol
+		h.ipv4.src_addr
+		h.ipv4.dst_addr
+	}
+
+	member_id m.nexthop_id
+
+	n_groups_max 65536
+
+	n_members_per_group_max 64
+}
+
+table nexthop_table {
+	key {
+		m.nexthop_id exact
+	}
+
+	actions {
+		nexthop_action
+		drop
+	}
+
+	default_action drop args none
+
+	size 1048576
+}
+
+//
+// Pipeline
+//
+apply {
+	rx m.port_in
+	extract h.ethernet
+	extract h.ipv4
+	table routing_table
+	table nexthop_group_table
+	table nexthop_table
+	emit h.ethernet
+	emit h.ipv4
+	tx m.port_out
+}
@@ -119,6 +119,8 @@ struct rte_acl_node {
 	int32_t                 fanout;
 	/* number of ranges (transitions w/ consecutive bits) */
 	int32_t                 id;
+	int32_t                 depth;
+	/* most transitions from this node down to a match */
 	struct rte_acl_match_results *mrt; /* only valid when match_flag != 0 */
 	union {
 		char            transitions[RTE_ACL_QUAD_SIZE];
@@ -163,17 +165,27 @@ struct rte_acl_bld_trie {
 	struct rte_acl_node *trie;
 };
 
+struct acl_inc_build;
+
 struct rte_acl_ctx {
 	char                name[RTE_ACL_NAMESIZE];
 	/** Name of the ACL context. */
 	int32_t             socket_id;
 	/** Socket ID to allocate memory from. */
 	enum rte_acl_classify_alg alg;
+	struct rte_acl_ctx *rt;
+	/** Context holding the run-time structures in use. */
 	uint32_t           first_load_sz;
 	void               *rules;
 	uint32_t            max_rules;
 	uint32_t            rule_sz;
 	uint32_t            num_rules;
+	struct acl_inc_build *inc;
+	/** Incremental build state, see rte_acl_update_rules(). */
+	/* RCU config. */
+	enum rte_acl_qsbr_mode rcu_mode;	/* Blocking, defer queue. */
+	struct rte_rcu_qsbr	*v;		/* RCU QSBR variable. */
+	struct rte_rcu_qsbr_dq	*dq;		/* RCU QSBR defer queue. */
 	uint32_t            num_categories;
 	uint32_t            num_tries;
 	uint32_t            match_index;
@@ -184,12 +196,34 @@ struct rte_acl_ctx {
 	struct rte_acl_trie trie[RTE_ACL_MAX_TRIES];
 	void               *mem;
 	size_t              mem_sz;
+	uint32_t            num_trans;
+	/** Node transitions of a packet over all the tries, worst case. */
 	struct rte_acl_config config; /* copy of build config. */
 };
 
 int rte_acl_gen(struct rte_acl_ctx *ctx, struct rte_acl_trie *trie,
 	struct rte_acl_bld_trie *node_bld_trie, uint32_t num_tries,
-	uint32_t num_categories, uint32_t data_index_sz, size_t max_size);
+	uint32_t num_categories, uint32_t data_index_sz, size_t max_size,
+	uint32_t max_trans, uint32_t num_threads);
+
+/*
+ * Run fn(arg, n) for each n below num_jobs (at most RTE_ACL_MAX_TRIES),
+ * spread over up to num_threads threads, the calling one included.
+ * Returns the error of the first failed job.
+ */
+int acl_run_jobs(uint32_t num_threads, uint32_t num_jobs,
+	int (*fn)(void *arg, uint32_t n), void *arg);
+
+/*
+ * Incremental build: remove the rules at the given (ascending) indexes,
+ * append the new ones and generate the run-time structures of the
+ * resulting rule set into a new context returned in *rt.
+ */
+int acl_inc_update(struct rte_acl_ctx *ctx, const uint32_t *del_idx,
+	uint32_t num_del, const struct rte_acl_rule *add, uint32_t num_add,
+	struct rte_acl_ctx **rt);
+
+void acl_inc_free(struct rte_acl_ctx *ctx);
 
 typedef int (*rte_acl_classify_t)
 (const struct rte_acl_ctx *, const uint8_t **, uint32_t *, uint32_t, uint32_t);
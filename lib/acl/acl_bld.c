@@ -2,7 +2,10 @@
  * Copyright(c) 2010-2014 Intel Corporation
  */
 
+#include <pthread.h>
+
 #include <rte_acl.h>
+#include <rte_lcore.h>
 #include "tb_mem.h"
 #include "acl.h"
 
@@ -15,6 +18,8 @@
 /* macros for dividing rule sets heuristics */
 #define NODE_MAX	0x4000
 #define NODE_MIN	0x800
+/* lowest node limit tried when a transition budget is given. */
+#define NODE_BUDGET_MIN	(NODE_MIN / 4)
 
 /* TALLY are statistics per field */
 enum {
@@ -62,6 +67,23 @@ struct rte_acl_build_rule {
 	uint32_t                    *wildness;
 };
 
+/*
+ * Jobs run by the build threads, up to one per trie: the calling
+ * thread adds them while the others run them.
+ */
+struct acl_jobs {
+	int (*fn)(void *arg, uint32_t n);
+	void               *arg;
+	pthread_mutex_t    lock;
+	pthread_cond_t     cond;
+	uint32_t           num;         /* number of jobs added */
+	uint32_t           next;        /* next job to run */
+	uint32_t           closed;      /* no more jobs to add */
+	uint32_t           num_threads; /* number of threads started */
+	pthread_t          tid[RTE_ACL_MAX_TRIES];
+	int32_t            rc[RTE_ACL_MAX_TRIES];
+};
+
 /* Context for build phase */
 struct acl_build_context {
 	const struct rte_acl_ctx *acx;
@@ -77,7 +99,12 @@ struct acl_build_context {
 	uint32_t                  src_mask;
 	uint32_t                  num_build_rules;
 	uint32_t                  num_tries;
+	uint32_t                  num_threads;
 	struct tb_mem_pool        pool;
+	/* contexts the split tries are rebuilt in, one per trie. */
+	struct acl_build_context  *sub;
+	struct acl_jobs           jobs;
+	struct rte_acl_build_rule *rule_sets[RTE_ACL_MAX_TRIES];
 	struct rte_acl_trie       tries[RTE_ACL_MAX_TRIES];
 	struct rte_acl_bld_trie   bld_tries[RTE_ACL_MAX_TRIES];
 	uint32_t            data_indexes[RTE_ACL_MAX_TRIES][RTE_ACL_MAX_FIELDS];
@@ -772,6 +799,12 @@ acl_merge_trie(struct acl_build_context *context,
 static void
 acl_build_reset(struct rte_acl_ctx *ctx)
 {
+	acl_inc_free(ctx);
+	if (ctx->rt != ctx) {
+		rte_free(ctx->rt->mem);
+		rte_free(ctx->rt);
+		ctx->rt = ctx;
+	}
 	rte_free(ctx->mem);
 	memset(&ctx->num_categories, 0,
 		sizeof(*ctx) - offsetof(struct rte_acl_ctx, num_categories));
@@ -1335,33 +1368,161 @@ build_one_trie(struct acl_build_context *context,
 	return last;
 }
 
+static void *
+acl_jobs_thread(void *arg)
+{
+	uint32_t n, run;
+	struct acl_jobs *jobs;
+
+	jobs = arg;
+	do {
+		pthread_mutex_lock(&jobs->lock);
+		while (jobs->next == jobs->num && jobs->closed == 0)
+			pthread_cond_wait(&jobs->cond, &jobs->lock);
+		n = jobs->next;
+		run = (n != jobs->num);
+		jobs->next += run;
+		pthread_mutex_unlock(&jobs->lock);
+
+		if (run != 0)
+			jobs->rc[n] = jobs->fn(jobs->arg, n);
+	} while (run != 0);
+
+	return NULL;
+}
+
+/*
+ * Start num_threads - 1 threads to run the jobs added next.
+ * If a thread can't be created, the others take over its jobs.
+ */
+static void
+acl_jobs_start(struct acl_jobs *jobs, uint32_t num_threads,
+	int (*fn)(void *arg, uint32_t n), void *arg)
+{
+	uint32_t i, n;
+	char name[RTE_MAX_THREAD_NAME_LEN];
+
+	memset(jobs, 0, sizeof(*jobs));
+	jobs->fn = fn;
+	jobs->arg = arg;
+	pthread_mutex_init(&jobs->lock, NULL);
+	pthread_cond_init(&jobs->cond, NULL);
+
+	n = RTE_MIN(num_threads, RTE_DIM(jobs->tid) + 1);
+	for (i = 0; i + 1 < n; i++) {
+		snprintf(name, sizeof(name), "acl-bld-%u", i + 1);
+		if (rte_ctrl_thread_create(&jobs->tid[i], name, NULL,
+				acl_jobs_thread, jobs) != 0)
+			break;
+	}
+	jobs->num_threads = i;
+}
+
+static void
+acl_jobs_add(struct acl_jobs *jobs)
+{
+	RTE_VERIFY(jobs->num < RTE_DIM(jobs->rc));
+
+	pthread_mutex_lock(&jobs->lock);
+	jobs->num++;
+	pthread_cond_signal(&jobs->cond);
+	pthread_mutex_unlock(&jobs->lock);
+}
+
+/*
+ * Run the jobs left on the calling thread too, and wait for the others.
+ * Returns the error of the first failed job.
+ */
 static int
-acl_build_tries(struct acl_build_context *context,
+acl_jobs_finish(struct acl_jobs *jobs)
+{
+	uint32_t i;
+
+	pthread_mutex_lock(&jobs->lock);
+	jobs->closed = 1;
+	pthread_cond_broadcast(&jobs->cond);
+	pthread_mutex_unlock(&jobs->lock);
+
+	acl_jobs_thread(jobs);
+
+	for (i = 0; i != jobs->num_threads; i++)
+		pthread_join(jobs->tid[i], NULL);
+
+	pthread_cond_destroy(&jobs->cond);
+	pthread_mutex_destroy(&jobs->lock);
+	jobs->fn = NULL;
+
+	for (i = 0; i != jobs->num; i++) {
+		if (jobs->rc[i] != 0)
+			return jobs->rc[i];
+	}
+	return 0;
+}
+
+int
+acl_run_jobs(uint32_t num_threads, uint32_t num_jobs,
+	int (*fn)(void *arg, uint32_t n), void *arg)
+{
+	uint32_t i;
+	struct acl_jobs jobs;
+
+	acl_jobs_start(&jobs, RTE_MIN(num_threads, num_jobs), fn, arg);
+	for (i = 0; i != num_jobs; i++)
+		acl_jobs_add(&jobs);
+	return acl_jobs_finish(&jobs);
+}
+
+/*
+ * Rebuild a split trie for its reduced rule-set in its own context,
+ * while the next tries get split.
+ */
+static int
+acl_build_split_trie(void *arg, uint32_t n)
+{
+	int32_t rc;
+	struct acl_build_context *bcx, *context;
+
+	context = arg;
+	bcx = context->sub + n;
+	bcx->acx = context->acx;
+	bcx->pool.alignment = ACL_POOL_ALIGN;
+	bcx->pool.min_alloc = ACL_POOL_ALLOC_MIN;
+	/* fields of context->cfg may be deactivated by the first trie. */
+	bcx->cfg.num_categories = context->cfg.num_categories;
+	bcx->category_mask = context->category_mask;
+
+	rc = sigsetjmp(bcx->pool.fail, 0);
+
+	/* build of that trie runs out of memory. */
+	if (rc != 0)
+		return rc;
+
+	/* Don't try to split it any further. */
+	if (build_one_trie(bcx, context->rule_sets, n, INT32_MAX) != NULL ||
+			bcx->bld_tries[n].trie == NULL) {
+		RTE_LOG(ERR, ACL, "Build of %u-th trie failed\n", n);
+		return -ENOMEM;
+	}
+
+	return 0;
+}
+
+static int
+acl_split_tries(struct acl_build_context *context,
 	struct rte_acl_build_rule *head)
 {
 	uint32_t n, num_tries;
 	struct rte_acl_config *config;
 	struct rte_acl_build_rule *last;
-	struct rte_acl_build_rule *rule_sets[RTE_ACL_MAX_TRIES];
+	struct rte_acl_build_rule **rule_sets;
 
-	config = head->config;
+	rule_sets = context->rule_sets;
 	rule_sets[0] = head;
 
-	/* initialize tries */
-	for (n = 0; n < RTE_DIM(context->tries); n++) {
-		context->tries[n].type = RTE_ACL_UNUSED_TRIE;
-		context->bld_tries[n].trie = NULL;
-		context->tries[n].count = 0;
-	}
-
-	context->tries[0].type = RTE_ACL_FULL_TRIE;
-
-	/* calc wildness of each field of each rule */
-	acl_calc_wildness(head, config);
-
 	for (n = 0;; n = num_tries) {
 
 		num_tries = n + 1;
+		context->num_tries = num_tries;
 
 		last = build_one_trie(context, rule_sets, n, context->node_max);
 		if (context->bld_tries[n].trie == NULL) {
@@ -1377,13 +1538,16 @@ acl_build_tries(struct acl_build_context *context,
 			RTE_LOG(ERR, ACL,
 				"Exceeded max number of tries: %u\n",
 				num_tries);
-			return -ENOMEM;
+			/* only the search within budgets goes below NODE_MIN. */
+			return (context->node_max < NODE_MIN) ? -ERANGE :
+				-ENOMEM;
 		}
 
 		/* Trie is getting too big, split remaining rule set. */
 		rule_sets[num_tries] = last->next;
 		last->next = NULL;
 		acl_free_node(context, context->bld_tries[n].trie);
+		context->bld_tries[n].trie = NULL;
 
 		/* Create a new copy of config for remaining rules. */
 		config = acl_build_alloc(context, 1, sizeof(*config));
@@ -1394,35 +1558,95 @@ acl_build_tries(struct acl_build_context *context,
 				head = head->next)
 			head->config = config;
 
-		/*
-		 * Rebuild the trie for the reduced rule-set.
-		 * Don't try to split it any further.
-		 */
-		last = build_one_trie(context, rule_sets, n, INT32_MAX);
-		if (context->bld_tries[n].trie == NULL || last != NULL) {
-			RTE_LOG(ERR, ACL, "Build of %u-th trie failed\n", n);
-			return -ENOMEM;
-		}
+		/* Rebuild the trie for the reduced rule-set. */
+		acl_jobs_add(&context->jobs);
+	}
+
+	return 0;
+}
+
+static int
+acl_build_tries(struct acl_build_context *context,
+	struct rte_acl_build_rule *head)
+{
+	int32_t rc, rc2;
+	uint32_t n;
+
+	/* initialize tries */
+	for (n = 0; n < RTE_DIM(context->tries); n++) {
+		context->tries[n].type = RTE_ACL_UNUSED_TRIE;
+		context->bld_tries[n].trie = NULL;
+		context->tries[n].count = 0;
+	}
+
+	context->tries[0].type = RTE_ACL_FULL_TRIE;
+
+	/* calc wildness of each field of each rule */
+	acl_calc_wildness(head, head->config);
 
+	context->sub = acl_build_alloc(context, RTE_DIM(context->tries),
+		sizeof(context->sub[0]));
+
+	/*
+	 * The split tries are rebuilt by the other threads, while the
+	 * calling one goes on splitting the remaining rules.
+	 */
+	acl_jobs_start(&context->jobs, context->num_threads,
+		acl_build_split_trie, context);
+	rc = acl_split_tries(context, head);
+	rc2 = acl_jobs_finish(&context->jobs);
+	if (rc != 0 || rc2 != 0)
+		return (rc != 0) ? rc : rc2;
+
+	for (n = 0; n != context->num_tries - 1; n++) {
+		context->tries[n] = context->sub[n].tries[n];
+		context->tries[n].data_index = context->data_indexes[n];
+		memcpy(context->data_indexes[n], context->sub[n].data_indexes[n],
+			sizeof(context->data_indexes[n]));
+		context->bld_tries[n] = context->sub[n].bld_tries[n];
+		context->num_nodes += context->sub[n].num_nodes;
 	}
 
-	context->num_tries = num_tries;
 	return 0;
 }
 
+/*
+ * Release the memory of the build context and of its sub-contexts.
+ */
+static void
+acl_build_free_pools(struct acl_build_context *bcx)
+{
+	uint32_t n;
+
+	if (bcx->sub != NULL) {
+		for (n = 0; n != RTE_DIM(bcx->tries); n++)
+			tb_free_pool(&bcx->sub[n].pool);
+	}
+	tb_free_pool(&bcx->pool);
+}
+
 static void
 acl_build_log(const struct acl_build_context *ctx)
 {
 	uint32_t n;
+	size_t alloc;
+
+	alloc = ctx->pool.alloc;
+	if (ctx->sub != NULL) {
+		for (n = 0; n != RTE_DIM(ctx->tries); n++)
+			alloc += ctx->sub[n].pool.alloc;
+	}
 
 	RTE_LOG(DEBUG, ACL, "Build phase for ACL \"%s\":\n"
 		"node limit for tree split: %u\n"
+		"build threads: %u\n"
 		"nodes created: %u\n"
 		"memory consumed: %zu\n",
 		ctx->acx->name,
 		ctx->node_max,
+		ctx->num_threads,
 		ctx->num_nodes,
-		ctx->pool.alloc);
+		alloc);
 
 	for (n = 0; n < RTE_DIM(ctx->tries); n++) {
 		if (ctx->tries[n].count != 0)
@@ -1499,7 +1723,8 @@ acl_set_data_indexes(struct rte_acl_ctx *ctx)
  */
 static int
 acl_bld(struct acl_build_context *bcx, struct rte_acl_ctx *ctx,
-	const struct rte_acl_config *cfg, uint32_t node_max)
+	const struct rte_acl_config *cfg, uint32_t node_max,
+	uint32_t num_threads)
 {
 	int32_t rc;
 
@@ -1512,6 +1737,7 @@ acl_bld(struct acl_build_context *bcx, struct rte_acl_ctx *ctx,
 	bcx->category_mask = RTE_LEN2MASK(bcx->cfg.num_categories,
 		typeof(bcx->category_mask));
 	bcx->node_max = node_max;
+	bcx->num_threads = num_threads;
 
 	rc = sigsetjmp(bcx->pool.fail, 0);
 
@@ -1520,6 +1746,9 @@ acl_bld(struct acl_build_context *bcx, struct rte_acl_ctx *ctx,
 		RTE_LOG(ERR, ACL,
 			"ACL context: %s, %s() failed with error code: %d\n",
 			bcx->acx->name, __func__, rc);
+		/* wait for the split tries being rebuilt. */
+		if (bcx->jobs.fn != NULL)
+			acl_jobs_finish(&bcx->jobs);
 		return rc;
 	}
 
@@ -1613,38 +1842,55 @@ get_first_load_size(const struct rte_acl_config *cfg)
 }
 
 int
-rte_acl_build(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg)
+rte_acl_build_ext(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg,
+	const struct rte_acl_build_param *prm)
 {
 	int32_t rc;
-	uint32_t n;
+	uint32_t n, node_min, num_threads, max_trans;
 	size_t max_size;
 	struct acl_build_context bcx;
 
+	if (prm == NULL)
+		return -EINVAL;
+
 	rc = acl_check_bld_param(ctx, cfg);
 	if (rc != 0)
 		return rc;
 
+	num_threads = RTE_MAX(prm->num_threads, 1U);
+
 	acl_build_reset(ctx);
 
-	if (cfg->max_size == 0) {
+	max_size = (cfg->max_size == 0) ? SIZE_MAX : cfg->max_size;
+	max_trans = (prm->max_trans == 0) ? UINT32_MAX : prm->max_trans;
+
+	/*
+	 * With no budget, build with the smallest tries.
+	 * Otherwise, go from the fewest tries to the smallest ones and
+	 * stop at the first split fitting the budgets: a lower node limit
+	 * splits the rules into more tries, each trie adding its depth to
+	 * the transitions of a packet, but that usually takes less memory.
+	 */
+	if (cfg->max_size == 0 && prm->max_trans == 0) {
 		n = NODE_MIN;
-		max_size = SIZE_MAX;
+		node_min = NODE_MIN;
 	} else {
 		n = NODE_MAX;
-		max_size = cfg->max_size;
+		node_min = (prm->max_trans == 0) ? NODE_MIN : NODE_BUDGET_MIN;
 	}
 
-	for (rc = -ERANGE; n >= NODE_MIN && rc == -ERANGE; n /= 2) {
+	for (rc = -ERANGE; n >= node_min && rc == -ERANGE; n /= 2) {
 
 		/* perform build phase. */
-		rc = acl_bld(&bcx, ctx, cfg, n);
+		rc = acl_bld(&bcx, ctx, cfg, n, num_threads);
 
 		if (rc == 0) {
 			/* allocate and fill run-time  structures. */
 			rc = rte_acl_gen(ctx, bcx.tries, bcx.bld_tries,
 				bcx.num_tries, bcx.cfg.num_categories,
 				RTE_ACL_MAX_FIELDS * RTE_DIM(bcx.tries) *
-				sizeof(ctx->data_indexes[0]), max_size);
+				sizeof(ctx->data_indexes[0]), max_size,
+				max_trans, num_threads);
 			if (rc == 0) {
 				/* set data indexes. */
 				acl_set_data_indexes(ctx);
@@ -1660,8 +1906,465 @@ rte_acl_build(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg)
 		acl_build_log(&bcx);
 
 		/* cleanup after build. */
-		tb_free_pool(&bcx.pool);
+		acl_build_free_pools(&bcx);
 	}
 
 	return rc;
 }
+
+int
+rte_acl_build(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg)
+{
+	struct rte_acl_build_param prm = {
+		.num_threads = 1,
+	};
+
+	return rte_acl_build_ext(ctx, cfg, &prm);
+}
+
+/*
+ * Incremental build state, kept between rte_acl_update_rules() calls:
+ * the build context with the build-time tries and the rules of each trie.
+ */
+struct acl_inc_build {
+	struct acl_build_context  bcx;
+	/* build config of each trie, fields always wild being deactivated. */
+	struct rte_acl_config     trie_cfg[RTE_ACL_MAX_TRIES];
+	/* rules of each trie, NULL for an unused trie. */
+	struct rte_acl_build_rule *trie_rules[RTE_ACL_MAX_TRIES];
+	/* free build rules, chained by next. */
+	struct rte_acl_build_rule *free_rules;
+	/* number of rules in the tries. */
+	uint32_t                  num_rules;
+	/* bitmask of the tries to rebuild. */
+	uint32_t                  dirty;
+	/* build rule of each context rule, NULL if not in any trie. */
+	__extension__ struct rte_acl_build_rule *rule_map[0];
+};
+
+void
+acl_inc_free(struct rte_acl_ctx *ctx)
+{
+	if (ctx->inc == NULL)
+		return;
+
+	tb_free_pool(&ctx->inc->bcx.pool);
+	rte_free(ctx->inc);
+	ctx->inc = NULL;
+}
+
+static struct rte_acl_build_rule *
+acl_inc_alloc_rule(struct acl_inc_build *inc, const struct rte_acl_rule *rule)
+{
+	struct acl_build_context *bcx;
+	struct rte_acl_build_rule *br;
+
+	bcx = &inc->bcx;
+	br = inc->free_rules;
+	if (br != NULL) {
+		inc->free_rules = br->next;
+	} else {
+		br = tb_alloc(&bcx->pool, sizeof(*br) +
+			bcx->cfg.num_fields * sizeof(br->wildness[0]));
+		br->wildness = (uint32_t *)(br + 1);
+	}
+
+	br->next = NULL;
+	br->config = &bcx->cfg;
+	br->f = rule;
+	acl_calc_wildness(br, &bcx->cfg);
+
+	return br;
+}
+
+/*
+ * Get the first unused trie, RTE_ACL_MAX_TRIES if there is none.
+ */
+static uint32_t
+acl_inc_free_trie(const struct acl_inc_build *inc)
+{
+	uint32_t n;
+
+	for (n = 0; n != RTE_DIM(inc->trie_rules) &&
+			inc->trie_rules[n] != NULL; n++)
+		;
+
+	return n;
+}
+
+/*
+ * Get the used trie with the fewest rules, the cheapest one to rebuild.
+ */
+static uint32_t
+acl_inc_min_trie(const struct acl_inc_build *inc)
+{
+	uint32_t m, n;
+
+	m = RTE_DIM(inc->trie_rules);
+	for (n = 0; n != RTE_DIM(inc->trie_rules); n++) {
+		if (inc->trie_rules[n] != NULL && (m == RTE_DIM(inc->trie_rules) ||
+				inc->bcx.tries[n].count < inc->bcx.tries[m].count))
+			m = n;
+	}
+
+	return (m != RTE_DIM(inc->trie_rules)) ? m : acl_inc_free_trie(inc);
+}
+
+static struct rte_acl_build_rule *
+acl_inc_build_one(struct acl_inc_build *inc, uint32_t n, int32_t node_max)
+{
+	struct acl_build_context *bcx;
+
+	bcx = &inc->bcx;
+	if (bcx->bld_tries[n].trie != NULL)
+		acl_free_node(bcx, bcx->bld_tries[n].trie);
+
+	/* start over from all the fields, as the rules changed. */
+	inc->trie_cfg[n] = bcx->cfg;
+	return build_one_trie(bcx, inc->trie_rules, n, node_max);
+}
+
+/*
+ * Rebuild given trie, splitting its rules over unused tries as
+ * acl_build_tries() does when it gets too big.
+ */
+static int
+acl_inc_build_trie(struct acl_inc_build *inc, uint32_t n)
+{
+	uint32_t m;
+	struct acl_build_context *bcx;
+	struct rte_acl_build_rule *last, *rule;
+
+	bcx = &inc->bcx;
+
+	while (1) {
+
+		last = acl_inc_build_one(inc, n, bcx->node_max);
+		if (bcx->bld_tries[n].trie == NULL)
+			break;
+
+		/* Build of the last trie completed. */
+		if (last == NULL)
+			return 0;
+
+		/*
+		 * Trie is getting too big, move remaining rules to an unused
+		 * trie if there is one.
+		 */
+		m = acl_inc_free_trie(inc);
+		if (m != RTE_DIM(inc->trie_rules)) {
+			inc->trie_rules[m] = last->next;
+			last->next = NULL;
+			for (rule = inc->trie_rules[m]; rule != NULL;
+					rule = rule->next)
+				rule->config = &inc->trie_cfg[m];
+		}
+
+		/*
+		 * Rebuild the trie for the reduced rule-set.
+		 * Don't try to split it any further.
+		 */
+		last = acl_inc_build_one(inc, n, INT32_MAX);
+		if (bcx->bld_tries[n].trie == NULL || last != NULL)
+			break;
+
+		if (m == RTE_DIM(inc->trie_rules))
+			return 0;
+		n = m;
+	}
+
+	RTE_LOG(ERR, ACL, "Build of %u-th trie failed\n", n);
+	return -ENOMEM;
+}
+
+static int
+acl_inc_build_dirty(struct acl_inc_build *inc)
+{
+	int32_t rc;
+	uint32_t n;
+
+	while (inc->dirty != 0) {
+		n = rte_bsf32(inc->dirty);
+		inc->dirty &= ~(1U << n);
+		rc = acl_inc_build_trie(inc, n);
+		if (rc != 0)
+			return rc;
+	}
+
+	return 0;
+}
+
+/*
+ * Setup the incremental build state from the rules of the context:
+ * build all the tries as rte_acl_build() does.
+ */
+static int
+acl_inc_init(struct rte_acl_ctx *ctx)
+{
+	int32_t rc;
+	uint32_t i, n;
+	struct acl_inc_build *inc;
+	struct acl_build_context *bcx;
+	struct rte_acl_build_rule *br;
+	const struct rte_acl_rule *rule;
+
+	inc = rte_zmalloc_socket(ctx->name, sizeof(*inc) +
+		ctx->max_rules * sizeof(inc->rule_map[0]),
+		RTE_CACHE_LINE_SIZE, ctx->socket_id);
+	if (inc == NULL) {
+		RTE_LOG(ERR, ACL,
+			"ACL context: %s, incremental build state allocation failed\n",
+			ctx->name);
+		return -ENOMEM;
+	}
+	ctx->inc = inc;
+
+	bcx = &inc->bcx;
+	bcx->acx = ctx;
+	bcx->pool.alignment = ACL_POOL_ALIGN;
+	bcx->pool.min_alloc = ACL_POOL_ALLOC_MIN;
+	bcx->cfg = ctx->config;
+	bcx->category_mask = RTE_LEN2MASK(bcx->cfg.num_categories,
+		typeof(bcx->category_mask));
+	/* keep the tries small, each change rebuilds a whole trie. */
+	bcx->node_max = NODE_MIN;
+
+	for (n = 0; n != RTE_DIM(bcx->tries); n++)
+		bcx->tries[n].type = RTE_ACL_UNUSED_TRIE;
+
+	rc = sigsetjmp(bcx->pool.fail, 0);
+
+	/* build phase runs out of memory. */
+	if (rc != 0) {
+		RTE_LOG(ERR, ACL,
+			"ACL context: %s, %s() failed with error code: %d\n",
+			ctx->name, __func__, rc);
+		acl_inc_free(ctx);
+		return rc;
+	}
+
+	for (i = 0; i != ctx->num_rules; i++) {
+		rule = (const struct rte_acl_rule *)
+			((uintptr_t)ctx->rules + ctx->rule_sz * i);
+		if ((rule->data.category_mask & bcx->category_mask) != 0) {
+			br = acl_inc_alloc_rule(inc, rule);
+			br->config = &inc->trie_cfg[0];
+			br->next = inc->trie_rules[0];
+			inc->trie_rules[0] = br;
+			inc->rule_map[i] = br;
+			inc->num_rules++;
+		}
+	}
+
+	if (inc->trie_rules[0] != NULL)
+		inc->dirty = 1;
+
+	rc = acl_inc_build_dirty(inc);
+	if (rc != 0)
+		acl_inc_free(ctx);
+	return rc;
+}
+
+/*
+ * Clear the marks left by the generation phase on the nodes,
+ * so the trie can be generated again.
+ */
+static void
+acl_inc_reset_node(struct rte_acl_node *node)
+{
+	uint32_t n;
+
+	/* skip if this node has been reset */
+	if (node->node_type == (uint32_t)RTE_ACL_NODE_UNDEFINED)
+		return;
+
+	node->node_type = RTE_ACL_NODE_UNDEFINED;
+	node->node_index = RTE_ACL_NODE_UNDEFINED;
+	node->fanout = 0;
+
+	for (n = 0; n < node->num_ptrs; n++) {
+		if (node->ptrs[n].ptr != NULL)
+			acl_inc_reset_node(node->ptrs[n].ptr);
+	}
+}
+
+/*
+ * Generate the run-time structures of all the tries into a new context.
+ */
+static int
+acl_inc_gen(struct rte_acl_ctx *ctx, struct rte_acl_ctx **rt)
+{
+	int32_t rc;
+	uint32_t k, n;
+	struct rte_acl_ctx *nrt;
+	struct acl_inc_build *inc;
+	struct rte_acl_trie tries[RTE_ACL_MAX_TRIES];
+	struct rte_acl_bld_trie bld_tries[RTE_ACL_MAX_TRIES];
+
+	inc = ctx->inc;
+
+	k = 0;
+	for (n = 0; n != RTE_DIM(tries); n++) {
+		if (inc->trie_rules[n] != NULL) {
+			acl_inc_reset_node(inc->bcx.bld_tries[n].trie);
+			tries[k] = inc->bcx.tries[n];
+			bld_tries[k] = inc->bcx.bld_tries[n];
+			k++;
+		}
+	}
+	for (n = k; n != RTE_DIM(tries); n++) {
+		memset(&tries[n], 0, sizeof(tries[n]));
+		tries[n].type = RTE_ACL_UNUSED_TRIE;
+		bld_tries[n].trie = NULL;
+	}
+
+	nrt = rte_zmalloc_socket(ctx->name, sizeof(*nrt), RTE_CACHE_LINE_SIZE,
+		ctx->socket_id);
+	if (nrt == NULL) {
+		RTE_LOG(ERR, ACL,
+			"allocation of %zu bytes on socket %d for %s failed\n",
+			sizeof(*nrt), ctx->socket_id, ctx->name);
+		return -ENOMEM;
+	}
+
+	/* new context holds only the run-time fields. */
+	memcpy(nrt, ctx, offsetof(struct rte_acl_ctx, num_categories));
+	nrt->rt = nrt;
+	nrt->inc = NULL;
+	nrt->v = NULL;
+	nrt->dq = NULL;
+
+	rc = rte_acl_gen(nrt, tries, bld_tries, k,
+		inc->bcx.cfg.num_categories,
+		RTE_ACL_MAX_FIELDS * RTE_DIM(tries) *
+		sizeof(nrt->data_indexes[0]),
+		(ctx->config.max_size == 0) ? SIZE_MAX : ctx->config.max_size,
+		UINT32_MAX, 1);
+	if (rc != 0) {
+		rte_free(nrt);
+		return rc;
+	}
+
+	acl_set_data_indexes(nrt);
+	nrt->first_load_sz = get_first_load_size(&ctx->config);
+	nrt->config = ctx->config;
+
+	*rt = nrt;
+	return 0;
+}
+
+int
+acl_inc_update(struct rte_acl_ctx *ctx, const uint32_t *del_idx,
+	uint32_t num_del, const struct rte_acl_rule *add, uint32_t num_add,
+	struct rte_acl_ctx **rt)
+{
+	int32_t rc;
+	uint32_t i, j, k, n, num;
+	struct acl_inc_build *inc;
+	struct acl_build_context *bcx;
+	struct rte_acl_build_rule *br, **prev;
+	struct rte_acl_rule *rule;
+
+	if (ctx->inc == NULL) {
+		rc = acl_inc_init(ctx);
+		if (rc != 0)
+			return rc;
+	}
+
+	inc = ctx->inc;
+	bcx = &inc->bcx;
+
+	/* check that the update leaves some rules to build. */
+	num = inc->num_rules;
+	for (i = 0; i != num_del; i++)
+		num -= (inc->rule_map[del_idx[i]] != NULL);
+	for (i = 0; i != num_add; i++) {
+		rule = (struct rte_acl_rule *)((uintptr_t)add + i * ctx->rule_sz);
+		num += ((rule->data.category_mask & bcx->category_mask) != 0);
+	}
+	if (num == 0)
+		return -EINVAL;
+
+	rc = sigsetjmp(bcx->pool.fail, 0);
+
+	/* build phase runs out of memory. */
+	if (rc != 0) {
+		RTE_LOG(ERR, ACL,
+			"ACL context: %s, %s() failed with error code: %d\n",
+			ctx->name, __func__, rc);
+		acl_inc_free(ctx);
+		return rc;
+	}
+
+	/* remove deleted rules from their tries. */
+	for (i = 0; i != num_del; i++) {
+		br = inc->rule_map[del_idx[i]];
+		if (br == NULL)
+			continue;
+		n = br->config - inc->trie_cfg;
+		for (prev = &inc->trie_rules[n]; *prev != br;
+				prev = &(*prev)->next)
+			;
+		*prev = br->next;
+		br->next = inc->free_rules;
+		inc->free_rules = br;
+		inc->dirty |= 1U << n;
+	}
+
+	/* compact remaining rules. */
+	j = (num_del != 0) ? del_idx[0] : ctx->num_rules;
+	for (i = j, k = 0; i != ctx->num_rules; i++) {
+		if (k != num_del && del_idx[k] == i) {
+			k++;
+			continue;
+		}
+		rule = (struct rte_acl_rule *)
+			((uintptr_t)ctx->rules + j * ctx->rule_sz);
+		memcpy(rule, (const void *)((uintptr_t)ctx->rules +
+			i * ctx->rule_sz), ctx->rule_sz);
+		inc->rule_map[j] = inc->rule_map[i];
+		if (inc->rule_map[j] != NULL)
+			inc->rule_map[j]->f = rule;
+		j++;
+	}
+	ctx->num_rules = j;
+
+	/* append new rules to the trie cheapest to rebuild. */
+	n = acl_inc_min_trie(inc);
+	for (i = 0; i != num_add; i++) {
+		rule = (struct rte_acl_rule *)
+			((uintptr_t)ctx->rules + ctx->num_rules * ctx->rule_sz);
+		memcpy(rule, (const void *)((uintptr_t)add + i * ctx->rule_sz),
+			ctx->rule_sz);
+		br = NULL;
+		if ((rule->data.category_mask & bcx->category_mask) != 0) {
+			br = acl_inc_alloc_rule(inc, rule);
+			br->config = &inc->trie_cfg[n];
+			br->next = inc->trie_rules[n];
+			inc->trie_rules[n] = br;
+			inc->dirty |= 1U << n;
+		}
+		inc->rule_map[ctx->num_rules++] = br;
+	}
+	inc->num_rules = num;
+
+	/* release emptied tries. */
+	for (n = 0; n != RTE_DIM(inc->trie_rules); n++) {
+		if (inc->trie_rules[n] == NULL &&
+				bcx->bld_tries[n].trie != NULL) {
+			acl_free_node(bcx, bcx->bld_tries[n].trie);
+			bcx->bld_tries[n].trie = NULL;
+			bcx->tries[n].type = RTE_ACL_UNUSED_TRIE;
+			bcx->tries[n].count = 0;
+			inc->dirty &= ~(1U << n);
+		}
+	}
+
+	rc = acl_inc_build_dirty(inc);
+	if (rc != 0) {
+		acl_inc_free(ctx);
+		return rc;
+	}
+
+	return acl_inc_gen(ctx, rt);
+}
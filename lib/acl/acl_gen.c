@@ -20,6 +20,7 @@ struct acl_node_counters {
 	int32_t quad_vectors;
 	int32_t dfa;
 	int32_t dfa_gr64;
+	int32_t trans;
 };
 
 struct rte_acl_indices {
@@ -42,6 +43,7 @@ acl_gen_log_stats(const struct rte_acl_ctx *ctx,
 		"quad nodes/vectors/bytes used: %d/%d/%zu\n"
 		"DFA nodes/group64/bytes used: %d/%d/%zu\n"
 		"match nodes/bytes used: %d/%zu\n"
+		"node transitions per packet: %d\n"
 		"total: %zu bytes\n"
 		"max limit: %zu bytes\n",
 		ctx->name, ctx->socket_id,
@@ -52,6 +54,7 @@ acl_gen_log_stats(const struct rte_acl_ctx *ctx,
 		indices->dfa_index * sizeof(uint64_t),
 		counts->match,
 		counts->match * sizeof(struct rte_acl_match_results),
+		counts->trans,
 		ctx->mem_sz,
 		max_size);
 }
@@ -214,24 +217,28 @@ acl_count_fanout(struct rte_acl_node *node)
 }
 
 /*
- * Determine the type of nodes and count each type
+ * Determine the type of nodes and count each type.
+ * Returns the depth of the node: the most transitions a lookup
+ * goes through from it down to a match.
  */
-static void
+static int32_t
 acl_count_trie_types(struct acl_node_counters *counts,
 	struct rte_acl_node *node, uint64_t no_match, int force_dfa)
 {
 	uint32_t n;
 	int num_ptrs;
+	int32_t depth;
 	uint64_t dfa[RTE_ACL_DFA_SIZE];
 
 	/* skip if this node has been counted */
 	if (node->node_type != (uint32_t)RTE_ACL_NODE_UNDEFINED)
-		return;
+		return node->depth;
 
 	if (node->match_flag != 0 || node->num_ptrs == 0) {
 		counts->match++;
 		node->node_type = RTE_ACL_NODE_MATCH;
-		return;
+		node->depth = 0;
+		return 0;
 	}
 
 	num_ptrs = acl_count_fanout(node);
@@ -266,11 +273,15 @@ acl_count_trie_types(struct acl_node_counters *counts,
 	/*
 	 * recursively count the types of all children
 	 */
+	depth = 0;
 	for (n = 0; n < node->num_ptrs; n++) {
 		if (node->ptrs[n].ptr != NULL)
-			acl_count_trie_types(counts, node->ptrs[n].ptr,
-				no_match, 0);
+			depth = RTE_MAX(depth, acl_count_trie_types(counts,
+				node->ptrs[n].ptr, no_match, 0));
 	}
+
+	node->depth = depth + 1;
+	return node->depth;
 }
 
 static void
@@ -414,21 +425,56 @@ acl_gen_node(struct rte_acl_node *node, uint64_t *node_array,
 	}
 }
 
+/*
+ * Tries don't share nodes, they are counted and generated separately.
+ * Each trie gets its own share of each node array, placed after the
+ * shares of the previous tries, so the result doesn't depend on the
+ * order the tries are processed in.
+ */
+struct acl_gen_tries {
+	struct rte_acl_trie *trie;
+	struct rte_acl_bld_trie *node_bld_trie;
+	uint64_t *node_array;
+	uint64_t no_match;
+	int num_categories;
+	struct acl_node_counters counts[RTE_ACL_MAX_TRIES];
+	struct rte_acl_indices indices[RTE_ACL_MAX_TRIES];
+};
+
+static int
+acl_count_trie(void *arg, uint32_t n)
+{
+	struct acl_gen_tries *gt = arg;
+
+	memset(&gt->counts[n], 0, sizeof(gt->counts[n]));
+	gt->counts[n].trans = acl_count_trie_types(&gt->counts[n],
+		gt->node_bld_trie[n].trie, gt->no_match, 1);
+	return 0;
+}
+
 static void
 acl_calc_counts_indices(struct acl_node_counters *counts,
-	struct rte_acl_indices *indices,
-	struct rte_acl_bld_trie *node_bld_trie, uint32_t num_tries,
-	uint64_t no_match)
+	struct rte_acl_indices *indices, struct acl_gen_tries *gt,
+	uint32_t num_tries, uint32_t num_threads)
 {
 	uint32_t n;
+	const struct acl_node_counters *tc;
 
 	memset(indices, 0, sizeof(*indices));
 	memset(counts, 0, sizeof(*counts));
 
 	/* Get stats on nodes */
+	acl_run_jobs(num_threads, num_tries, acl_count_trie, gt);
+
 	for (n = 0; n < num_tries; n++) {
-		acl_count_trie_types(counts, node_bld_trie[n].trie,
-			no_match, 1);
+		tc = &gt->counts[n];
+		counts->match += tc->match;
+		counts->single += tc->single;
+		counts->quad += tc->quad;
+		counts->quad_vectors += tc->quad_vectors;
+		counts->dfa += tc->dfa;
+		counts->dfa_gr64 += tc->dfa_gr64;
+		counts->trans += tc->trans;
 	}
 
 	indices->dfa_index = RTE_ACL_DFA_SIZE + 1;
@@ -439,6 +485,35 @@ acl_calc_counts_indices(struct acl_node_counters *counts,
 	indices->match_start = RTE_ALIGN(indices->match_start,
 		(XMM_SIZE / sizeof(uint64_t)));
 	indices->match_index = 1;
+
+	/* starting indices of each trie. */
+	gt->indices[0] = *indices;
+	for (n = 1; n < num_tries; n++) {
+		tc = &gt->counts[n - 1];
+		gt->indices[n] = gt->indices[n - 1];
+		gt->indices[n].dfa_index += tc->dfa_gr64 *
+			RTE_ACL_DFA_GR64_SIZE;
+		gt->indices[n].quad_index += tc->quad_vectors;
+		gt->indices[n].single_index += tc->single;
+		gt->indices[n].match_index += tc->match;
+	}
+}
+
+static int
+acl_gen_trie(void *arg, uint32_t n)
+{
+	struct acl_gen_tries *gt = arg;
+	struct rte_acl_node *root;
+
+	root = gt->node_bld_trie[n].trie;
+	acl_gen_node(root, gt->node_array, gt->no_match, &gt->indices[n],
+		gt->num_categories);
+
+	if (root->node_index == gt->no_match)
+		gt->trie[n].root_index = 0;
+	else
+		gt->trie[n].root_index = root->node_index;
+	return 0;
 }
 
 /*
@@ -447,7 +522,8 @@ acl_calc_counts_indices(struct acl_node_counters *counts,
 int
 rte_acl_gen(struct rte_acl_ctx *ctx, struct rte_acl_trie *trie,
 	struct rte_acl_bld_trie *node_bld_trie, uint32_t num_tries,
-	uint32_t num_categories, uint32_t data_index_sz, size_t max_size)
+	uint32_t num_categories, uint32_t data_index_sz, size_t max_size,
+	uint32_t max_trans, uint32_t num_threads)
 {
 	void *mem;
 	size_t total_size;
@@ -456,12 +532,18 @@ rte_acl_gen(struct rte_acl_ctx *ctx, struct rte_acl_trie *trie,
 	struct rte_acl_match_results *match;
 	struct acl_node_counters counts;
 	struct rte_acl_indices indices;
+	struct acl_gen_tries gt;
 
 	no_match = RTE_ACL_NODE_MATCH;
 
+	gt.trie = trie;
+	gt.node_bld_trie = node_bld_trie;
+	gt.no_match = no_match;
+	gt.num_categories = num_categories;
+
 	/* Fill counts and indices arrays from the nodes. */
-	acl_calc_counts_indices(&counts, &indices,
-		node_bld_trie, num_tries, no_match);
+	acl_calc_counts_indices(&counts, &indices, &gt, num_tries,
+		num_threads);
 
 	/* Allocate runtime memory (align to cache boundary) */
 	total_size = RTE_ALIGN(data_index_sz, RTE_CACHE_LINE_SIZE) +
@@ -477,6 +559,14 @@ rte_acl_gen(struct rte_acl_ctx *ctx, struct rte_acl_trie *trie,
 		return -ERANGE;
 	}
 
+	if ((uint32_t)counts.trans > max_trans) {
+		RTE_LOG(DEBUG, ACL,
+			"Gen phase for ACL ctx \"%s\" exceeds max_trans limit, "
+			"node transitions per packet: %d, allowed: %u\n",
+			ctx->name, counts.trans, max_trans);
+		return -ERANGE;
+	}
+
 	mem = rte_zmalloc_socket(ctx->name, total_size, RTE_CACHE_LINE_SIZE,
 			ctx->socket_id);
 	if (mem == NULL) {
@@ -505,16 +595,14 @@ rte_acl_gen(struct rte_acl_ctx *ctx, struct rte_acl_trie *trie,
 	match = ((struct rte_acl_match_results *)(node_array + match_index));
 	memset(match, 0, sizeof(*match));
 
-	for (n = 0; n < num_tries; n++) {
-
-		acl_gen_node(node_bld_trie[n].trie, node_array, no_match,
-			&indices, num_categories);
+	gt.node_array = node_array;
+	acl_run_jobs(num_threads, num_tries, acl_gen_trie, &gt);
 
-		if (node_bld_trie[n].trie->node_index == no_match)
-			trie[n].root_index = 0;
-		else
-			trie[n].root_index = node_bld_trie[n].trie->node_index;
-	}
+	/* indices past the nodes of all the tries, for the stats. */
+	indices.dfa_index += counts.dfa_gr64 * RTE_ACL_DFA_GR64_SIZE;
+	indices.quad_index += counts.quad_vectors;
+	indices.single_index += counts.single;
+	indices.match_index += counts.match;
 
 	ctx->mem = mem;
 	ctx->mem_sz = total_size;
@@ -525,6 +613,7 @@ rte_acl_gen(struct rte_acl_ctx *ctx, struct rte_acl_trie *trie,
 	ctx->no_match = no_match;
 	ctx->idle = node_array[RTE_ACL_DFA_SIZE];
 	ctx->trans_table = node_array;
+	ctx->num_trans = counts.trans;
 	memcpy(ctx->trie, trie, sizeof(ctx->trie));
 
 	acl_gen_log_stats(ctx, &counts, &indices, max_size);
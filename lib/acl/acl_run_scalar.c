@@ -118,6 +118,9 @@ rte_acl_classify_scalar(const struct rte_acl_ctx *ctx, const uint8_t **data,
 	struct completion cmplt[MAX_SEARCHES_SCALAR];
 	struct parms parms[MAX_SEARCHES_SCALAR];
 
+	/* might be called directly, bypassing rte_acl_classify_alg() */
+	ctx = __atomic_load_n(&ctx->rt, __ATOMIC_ACQUIRE);
+
 	acl_set_flow(&flows, cmplt, RTE_DIM(cmplt), data, results, num,
 		categories, ctx->trans_table);
 
@@ -106,6 +106,24 @@ static const rte_acl_classify_t classify_fns[] = {
 	[RTE_ACL_CLASSIFY_AVX512X32] = rte_acl_classify_avx512x32,
 };
 
+/*
+ * Lookup cost model of the classify methods reported by rte_acl_dump():
+ * the number of flows one SIMD step of the method moves to their next
+ * node, that is the width of its registers in 32-bit node indexes.
+ */
+static const struct {
+	const char *name;
+	uint32_t step_flows;
+} classify_costs[] = {
+	[RTE_ACL_CLASSIFY_SCALAR] = {"scalar", 1},
+	[RTE_ACL_CLASSIFY_SSE] = {"sse", 4},
+	[RTE_ACL_CLASSIFY_AVX2] = {"avx2", 8},
+	[RTE_ACL_CLASSIFY_NEON] = {"neon", 4},
+	[RTE_ACL_CLASSIFY_ALTIVEC] = {"altivec", 4},
+	[RTE_ACL_CLASSIFY_AVX512X16] = {"avx512x16", 8},
+	[RTE_ACL_CLASSIFY_AVX512X32] = {"avx512x32", 16},
+};
+
 /*
  * Helper function for acl_check_alg.
  * Check support for ARM specific classify methods.
@@ -296,6 +314,8 @@ rte_acl_classify_alg(const struct rte_acl_ctx *ctx, const uint8_t **data,
 			((RTE_ACL_RESULTS_MULTIPLIER - 1) & categories) != 0)
 		return -EINVAL;
 
+	/* run-time structures might be replaced by rte_acl_update_rules() */
+	ctx = __atomic_load_n(&ctx->rt, __ATOMIC_ACQUIRE);
 	return classify_fns[alg](ctx, data, results, num, categories);
 }
 
@@ -358,6 +378,13 @@ rte_acl_free(struct rte_acl_ctx *ctx)
 
 	rte_mcfg_tailq_write_unlock();
 
+	if (ctx->dq != NULL)
+		rte_rcu_qsbr_dq_delete(ctx->dq);
+	acl_inc_free(ctx);
+	if (ctx->rt != ctx) {
+		rte_free(ctx->rt->mem);
+		rte_free(ctx->rt);
+	}
 	rte_free(ctx->mem);
 	rte_free(ctx);
 	rte_free(te);
@@ -415,6 +442,7 @@ rte_acl_create(const struct rte_acl_param *param)
 			goto exit;
 		}
 		/* init new allocated context. */
+		ctx->rt = ctx;
 		ctx->rules = ctx + 1;
 		ctx->max_rules = param->max_rule_num;
 		ctx->rule_sz = param->rule_size;
@@ -481,6 +509,8 @@ rte_acl_add_rules(struct rte_acl_ctx *ctx, const struct rte_acl_rule *rules,
 		}
 	}
 
+	/* incremental build state doesn't track these rules */
+	acl_inc_free(ctx);
 	return acl_add_rules(ctx, rules, num);
 }
 
@@ -491,8 +521,236 @@ rte_acl_add_rules(struct rte_acl_ctx *ctx, const struct rte_acl_rule *rules,
 void
 rte_acl_reset_rules(struct rte_acl_ctx *ctx)
 {
-	if (ctx != NULL)
+	if (ctx != NULL) {
+		acl_inc_free(ctx);
 		ctx->num_rules = 0;
+	}
+}
+
+/* Run-time structures replaced by an update, to free. */
+struct acl_rt_free {
+	struct rte_acl_ctx *rt; /* context holding them, NULL if the main one */
+	void *mem;
+};
+
+static void
+acl_rt_free(struct acl_rt_free *f)
+{
+	rte_free(f->mem);
+	rte_free(f->rt);
+}
+
+static void
+__acl_rcu_qsbr_free_resource(void *p, void *data, unsigned int n)
+{
+	RTE_SET_USED(p);
+	RTE_SET_USED(n);
+	acl_rt_free(data);
+}
+
+/*
+ * Make new run-time structures visible to the lookups and
+ * free the previous ones once they are not used anymore.
+ */
+static void
+acl_rt_publish(struct rte_acl_ctx *ctx, struct rte_acl_ctx *rt)
+{
+	struct acl_rt_free f;
+
+	if (ctx->rt == ctx) {
+		f.rt = NULL;
+		f.mem = ctx->mem;
+		ctx->mem = NULL;
+	} else {
+		f.rt = ctx->rt;
+		f.mem = ctx->rt->mem;
+	}
+
+	__atomic_store_n(&ctx->rt, rt, __ATOMIC_RELEASE);
+
+	if (ctx->v == NULL) {
+		acl_rt_free(&f);
+	} else if (ctx->rcu_mode == RTE_ACL_QSBR_MODE_DQ &&
+			rte_rcu_qsbr_dq_enqueue(ctx->dq, &f) == 0) {
+		/* Freed by the defer queue. */
+	} else {
+		/* Wait for quiescent state change. */
+		rte_rcu_qsbr_synchronize(ctx->v, RTE_QSBR_THRID_INVALID);
+		acl_rt_free(&f);
+	}
+}
+
+/*
+ * Compare two rules on the bytes the build config actually uses:
+ * the upper bytes of narrow fields are left unspecified by the user.
+ */
+static int
+acl_rule_cmp(const struct rte_acl_config *cfg, const struct rte_acl_rule *r1,
+	const struct rte_acl_rule *r2)
+{
+	uint32_t n;
+	uint64_t msk;
+	const struct rte_acl_field *f1, *f2;
+
+	if (memcmp(&r1->data, &r2->data, sizeof(r1->data)) != 0)
+		return -1;
+
+	for (n = 0; n != cfg->num_fields; n++) {
+		msk = RTE_LEN2MASK(CHAR_BIT * cfg->defs[n].size, uint64_t);
+		f1 = r1->field + cfg->defs[n].field_index;
+		f2 = r2->field + cfg->defs[n].field_index;
+
+		if (((f1->value.u64 ^ f2->value.u64) & msk) != 0)
+			return -1;
+		if (cfg->defs[n].type == RTE_ACL_FIELD_TYPE_MASK) {
+			if (f1->mask_range.u32 != f2->mask_range.u32)
+				return -1;
+		} else if (((f1->mask_range.u64 ^ f2->mask_range.u64) &
+				msk) != 0)
+			return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * Find context rules to delete, their indexes are returned in ascending order.
+ */
+static int
+acl_find_rules(const struct rte_acl_ctx *ctx, const struct rte_acl_rule *rules,
+	uint32_t num, uint32_t *idx)
+{
+	const struct rte_acl_rule *rv;
+	uint32_t i, j, k;
+
+	for (i = 0; i != num; i++) {
+		rv = (const struct rte_acl_rule *)
+			((uintptr_t)rules + i * ctx->rule_sz);
+
+		/* skip rules already selected by an identical one */
+		for (j = 0; j != ctx->num_rules; j++) {
+			if (acl_rule_cmp(&ctx->config, rv,
+					(const struct rte_acl_rule *)
+					((uintptr_t)ctx->rules +
+					j * ctx->rule_sz)) != 0)
+				continue;
+			for (k = 0; k != i && idx[k] != j; k++)
+				;
+			if (k == i)
+				break;
+		}
+
+		if (j == ctx->num_rules) {
+			RTE_LOG(ERR, ACL, "%s(%s): rule #%u to delete not found\n",
+				__func__, ctx->name, i + 1);
+			return -ENOENT;
+		}
+
+		/* insertion sort */
+		for (k = i; k != 0 && idx[k - 1] > j; k--)
+			idx[k] = idx[k - 1];
+		idx[k] = j;
+	}
+
+	return 0;
+}
+
+int
+rte_acl_update_rules(struct rte_acl_ctx *ctx,
+	const struct rte_acl_rule *add, uint32_t num_add,
+	const struct rte_acl_rule *del, uint32_t num_del)
+{
+	const struct rte_acl_rule *rv;
+	struct rte_acl_ctx *rt;
+	uint32_t *idx;
+	uint32_t i;
+	int32_t rc;
+
+	if (ctx == NULL || (add == NULL && num_add != 0) ||
+			(del == NULL && num_del != 0) || ctx->rule_sz == 0 ||
+			ctx->config.num_categories == 0)
+		return -EINVAL;
+
+	for (i = 0; i != num_add; i++) {
+		rv = (const struct rte_acl_rule *)
+			((uintptr_t)add + i * ctx->rule_sz);
+		rc = acl_check_rule(&rv->data);
+		if (rc != 0) {
+			RTE_LOG(ERR, ACL, "%s(%s): rule #%u is invalid\n",
+				__func__, ctx->name, i + 1);
+			return rc;
+		}
+	}
+
+	if (num_del > ctx->num_rules ||
+			ctx->num_rules - num_del + num_add > ctx->max_rules)
+		return (num_del > ctx->num_rules) ? -ENOENT : -ENOMEM;
+
+	idx = NULL;
+	if (num_del != 0) {
+		idx = rte_malloc(NULL, num_del * sizeof(idx[0]), 0);
+		if (idx == NULL)
+			return -ENOMEM;
+		rc = acl_find_rules(ctx, del, num_del, idx);
+		if (rc != 0) {
+			rte_free(idx);
+			return rc;
+		}
+	}
+
+	rc = acl_inc_update(ctx, idx, num_del, add, num_add, &rt);
+	rte_free(idx);
+	if (rc != 0)
+		return rc;
+
+	acl_rt_publish(ctx, rt);
+	return 0;
+}
+
+int
+rte_acl_rcu_qsbr_add(struct rte_acl_ctx *ctx, struct rte_acl_rcu_config *cfg)
+{
+	struct rte_rcu_qsbr_dq_parameters params = {0};
+	char rcu_dq_name[RTE_RCU_QSBR_DQ_NAMESIZE];
+
+	if (ctx == NULL || cfg == NULL || cfg->v == NULL)
+		return -EINVAL;
+
+	if (ctx->v != NULL)
+		return -EEXIST;
+
+	switch (cfg->mode) {
+	case RTE_ACL_QSBR_MODE_DQ:
+		/* Init QSBR defer queue. */
+		snprintf(rcu_dq_name, sizeof(rcu_dq_name),
+				"ACL_RCU_%s", ctx->name);
+		params.name = rcu_dq_name;
+		params.size = cfg->dq_size;
+		if (params.size == 0)
+			params.size = RTE_ACL_RCU_DQ_SIZE;
+		params.trigger_reclaim_limit = cfg->reclaim_thd;
+		params.max_reclaim_size = cfg->reclaim_max;
+		if (params.max_reclaim_size == 0)
+			params.max_reclaim_size = RTE_ACL_RCU_DQ_RECLAIM_MAX;
+		params.esize = sizeof(struct acl_rt_free);
+		params.free_fn = __acl_rcu_qsbr_free_resource;
+		params.p = ctx;
+		params.v = cfg->v;
+		ctx->dq = rte_rcu_qsbr_dq_create(&params);
+		if (ctx->dq == NULL)
+			return -rte_errno;
+		break;
+	case RTE_ACL_QSBR_MODE_SYNC:
+		/* No other things to do. */
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	ctx->rcu_mode = cfg->mode;
+	ctx->v = cfg->v;
+
+	return 0;
 }
 
 /*
@@ -513,17 +771,30 @@ rte_acl_reset(struct rte_acl_ctx *ctx)
 void
 rte_acl_dump(const struct rte_acl_ctx *ctx)
 {
+	uint32_t i;
+
 	if (!ctx)
 		return;
 	printf("acl context <%s>@%p\n", ctx->name, ctx);
 	printf("  socket_id=%"PRId32"\n", ctx->socket_id);
 	printf("  alg=%"PRId32"\n", ctx->alg);
-	printf("  first_load_sz=%"PRIu32"\n", ctx->first_load_sz);
+	printf("  first_load_sz=%"PRIu32"\n", ctx->rt->first_load_sz);
 	printf("  max_rules=%"PRIu32"\n", ctx->max_rules);
 	printf("  rule_size=%"PRIu32"\n", ctx->rule_sz);
 	printf("  num_rules=%"PRIu32"\n", ctx->num_rules);
-	printf("  num_categories=%"PRIu32"\n", ctx->num_categories);
-	printf("  num_tries=%"PRIu32"\n", ctx->num_tries);
+	printf("  num_categories=%"PRIu32"\n", ctx->rt->num_categories);
+	printf("  num_tries=%"PRIu32"\n", ctx->rt->num_tries);
+	printf("  incremental=%d\n", ctx->inc != NULL);
+	printf("  mem_sz=%zu\n", ctx->rt->mem_sz);
+	printf("  num_trans=%"PRIu32"\n", ctx->rt->num_trans);
+	/* only the methods this binary can run on this CPU */
+	for (i = RTE_ACL_CLASSIFY_SCALAR; i != RTE_DIM(classify_costs); i++) {
+		if (acl_check_alg(i) != 0)
+			continue;
+		printf("  cost_%s=%.2f\n", classify_costs[i].name,
+			(double)ctx->rt->num_trans /
+			classify_costs[i].step_flows);
+	}
 }
 
 /*
@@ -11,7 +11,9 @@
  * RTE Classifier.
  */
 
+#include <rte_compat.h>
 #include <rte_acl_osdep.h>
+#include <rte_rcu_qsbr.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -122,6 +124,36 @@ RTE_ACL_RULE_DEF(rte_acl_rule,);
 /** Max number of characters in name.*/
 #define	RTE_ACL_NAMESIZE		32
 
+/** @internal Default RCU defer queue size. */
+#define RTE_ACL_RCU_DQ_SIZE		64
+
+/** @internal Default RCU defer queue entries to reclaim in one go. */
+#define RTE_ACL_RCU_DQ_RECLAIM_MAX	16
+
+/** RCU reclamation modes */
+enum rte_acl_qsbr_mode {
+	/** Create defer queue for reclaim. */
+	RTE_ACL_QSBR_MODE_DQ = 0,
+	/** Use blocking mode reclaim. No defer queue created. */
+	RTE_ACL_QSBR_MODE_SYNC
+};
+
+/** ACL RCU QSBR configuration structure. */
+struct rte_acl_rcu_config {
+	struct rte_rcu_qsbr *v;	/* RCU QSBR variable. */
+	/* Mode of RCU QSBR. RTE_ACL_QSBR_MODE_xxx
+	 * '0' for default: create defer queue for reclaim.
+	 */
+	enum rte_acl_qsbr_mode mode;
+	uint32_t dq_size;	/* RCU defer queue size.
+				 * default: RTE_ACL_RCU_DQ_SIZE.
+				 */
+	uint32_t reclaim_thd;	/* Threshold to trigger auto reclaim. */
+	uint32_t reclaim_max;	/* Max entries to reclaim in one go.
+				 * default: RTE_ACL_RCU_DQ_RECLAIM_MAX.
+				 */
+};
+
 /**
  * Parameters used when creating the ACL context.
  */
@@ -220,6 +252,126 @@ rte_acl_reset_rules(struct rte_acl_ctx *ctx);
 int
 rte_acl_build(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg);
 
+/**
+ * Extra parameters for rte_acl_build_ext().
+ */
+struct rte_acl_build_param {
+	uint32_t num_threads;
+	/**<
+	 * Number of threads to build with, the calling one included.
+	 * 0 or 1 builds on the calling thread only. Extra threads are
+	 * control threads, they build and generate separate tries,
+	 * so more threads than tries don't help.
+	 */
+	uint32_t max_trans;
+	/**<
+	 * Budget of node transitions per packet: the number of nodes a
+	 * lookup goes through in the worst case, over all the tries.
+	 * 0 means no limit. If non zero, the build searches a wider range
+	 * of trie splits for the one with the fewest tries that fits both
+	 * this budget and the max_size of the build config, one split
+	 * more costing one more trie to walk through per packet, but
+	 * usually less memory. rte_acl_dump() reports the resulting
+	 * transitions and their estimated lookup cost for each classify
+	 * method.
+	 */
+};
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Analyze set of rules and build required internal run-time structures,
+ * as rte_acl_build() does, using several threads.
+ * The resulting run-time structures don't depend on the number of threads.
+ * This function is not multi-thread safe.
+ *
+ * @param ctx
+ *   ACL context to build.
+ * @param cfg
+ *   Pointer to struct rte_acl_config - defines build parameters.
+ * @param prm
+ *   Pointer to struct rte_acl_build_param - defines how to build.
+ * @return
+ *   - -ENOMEM if couldn't allocate enough memory.
+ *   - -EINVAL if the parameters are invalid.
+ *   - -ERANGE if no trie split fits the max_size and max_trans budgets.
+ *   - Negative error code if operation failed.
+ *   - Zero if operation completed successfully.
+ */
+__rte_experimental
+int
+rte_acl_build_ext(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg,
+	const struct rte_acl_build_param *prm);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Add and delete rules of an already built ACL context, rebuilding only
+ * the tries holding the changed rules.
+ * The new run-time structures are published atomically, so the lookups
+ * can go on during the update. The replaced ones are freed once the
+ * lookup threads reported a quiescent state when a RCU QSBR variable is
+ * associated with the context, right away otherwise.
+ * The first update after rte_acl_build(), rte_acl_add_rules() or
+ * rte_acl_reset_rules() sets up the incremental build state, which costs
+ * as much as a full build: calling it with no rules prepares the context
+ * for the following updates.
+ * This function is not multi-thread safe.
+ *
+ * @param ctx
+ *   ACL context to update.
+ * @param add
+ *   Array of rules to add to the ACL context, in the format used by
+ *   rte_acl_add_rules().
+ * @param num_add
+ *   Number of elements in the *add* array.
+ * @param del
+ *   Array of rules to delete from the ACL context, deleted first.
+ *   Each of them removes one rule of the context with identical contents.
+ * @param num_del
+ *   Number of elements in the *del* array.
+ * @return
+ *   - -EINVAL if the parameters are invalid, the context is not built or
+ *     would be left without rules to build.
+ *   - -ENOENT if a rule to delete is not in the context.
+ *   - -ENOMEM if there is no space in the ACL context for these rules, or
+ *     if couldn't allocate enough memory.
+ *   - -ERANGE if the run-time structures exceed the build max_size.
+ *   - Zero if operation completed successfully.
+ *   On -ENOMEM or -ERANGE failures after the rules were changed, the
+ *   context keeps using the previous run-time structures until the next
+ *   successful update or build.
+ */
+__rte_experimental
+int
+rte_acl_update_rules(struct rte_acl_ctx *ctx,
+	const struct rte_acl_rule *add, uint32_t num_add,
+	const struct rte_acl_rule *del, uint32_t num_del);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Associate RCU QSBR variable with an ACL context.
+ * The run-time structures replaced by rte_acl_update_rules() are then
+ * freed only once the lookup threads reported a quiescent state.
+ *
+ * @param ctx
+ *   ACL context to add RCU QSBR to.
+ * @param cfg
+ *   RCU QSBR configuration
+ * @return
+ *   0 on success, negative value otherwise:
+ *   - -EINVAL - invalid pointer or mode
+ *   - -EEXIST - already added QSBR
+ *   - -ENOMEM - memory allocation failure
+ */
+__rte_experimental
+int
+rte_acl_rcu_qsbr_add(struct rte_acl_ctx *ctx, struct rte_acl_rcu_config *cfg);
+
 /**
  * Delete all rules from the ACL context and
  * destroy all internal run-time structures.
@@ -341,6 +493,11 @@ rte_acl_set_ctx_classify(struct rte_acl_ctx *ctx,
 
 /**
  * Dump an ACL context structure to the console.
+ * For a built context, that includes the memory of its run-time
+ * structures, the node transitions of a packet in the worst case and
+ * their estimated lookup cost for each classify method, in SIMD steps
+ * per packet: the transitions divided by the number of flows a step of
+ * the method moves forward at once.
  *
  * @param ctx
  *   ACL context to dump.
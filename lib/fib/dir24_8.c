@@ -14,6 +14,7 @@
 #include <rte_errno.h>
 #include <rte_memory.h>
 #include <rte_vect.h>
+#include <rte_rcu_qsbr.h>
 
 #include <rte_rib.h>
 #include <rte_fib.h>
@@ -26,6 +27,8 @@
 #endif /* CC_DIR24_8_AVX512_SUPPORT */
 
 #define DIR24_8_NAMESIZE	64
+/* Number of routes retrieved at once when walking through the RIB */
+#define DIR24_8_RIB_BULK	32
 
 #define ROUNDUP(x, y)	 RTE_ALIGN_CEIL(x, (1 << (32 - y)))
 
@@ -150,27 +153,93 @@ write_to_fib(void *ptr, uint64_t val, enum rte_fib_dir24_8_nh_sz size, int n)
 }
 
 static int
-tbl8_get_idx(struct dir24_8_tbl *dp)
+__tbl8_get_idx(struct dir24_8_tbl *dp)
 {
 	uint32_t i;
-	int bit_idx;
+	int bit_idx = -ENOSPC;
 
+	rte_spinlock_lock(&dp->tbl8_lock);
 	for (i = 0; (i < (dp->number_tbl8s >> BITMAP_SLAB_BIT_SIZE_LOG2)) &&
 			(dp->tbl8_idxes[i] == UINT64_MAX); i++)
 		;
 	if (i < (dp->number_tbl8s >> BITMAP_SLAB_BIT_SIZE_LOG2)) {
 		bit_idx = __builtin_ctzll(~dp->tbl8_idxes[i]);
 		dp->tbl8_idxes[i] |= (1ULL << bit_idx);
-		return (i << BITMAP_SLAB_BIT_SIZE_LOG2) + bit_idx;
+		bit_idx += i << BITMAP_SLAB_BIT_SIZE_LOG2;
 	}
-	return -ENOSPC;
+	rte_spinlock_unlock(&dp->tbl8_lock);
+	return bit_idx;
 }
 
 static inline void
 tbl8_free_idx(struct dir24_8_tbl *dp, int idx)
 {
+	rte_spinlock_lock(&dp->tbl8_lock);
 	dp->tbl8_idxes[idx >> BITMAP_SLAB_BIT_SIZE_LOG2] &=
 		~(1ULL << (idx & BITMAP_SLAB_BITMASK));
+	rte_spinlock_unlock(&dp->tbl8_lock);
+}
+
+static int
+tbl8_get_idx(struct dir24_8_tbl *dp)
+{
+	int tbl8_idx;
+
+	tbl8_idx = __tbl8_get_idx(dp);
+	if (tbl8_idx == -ENOSPC && dp->dq != NULL) {
+		/* If there are no tbl8 groups try to reclaim one. */
+		if (rte_rcu_qsbr_dq_reclaim(dp->dq, 1, NULL, NULL, NULL) == 0)
+			tbl8_idx = __tbl8_get_idx(dp);
+	}
+
+	return tbl8_idx;
+}
+
+static void
+tbl8_cleanup(struct dir24_8_tbl *dp, uint64_t tbl8_idx)
+{
+	uint8_t *ptr = (uint8_t *)dp->tbl8 +
+		((tbl8_idx * DIR24_8_TBL8_GRP_NUM_ENT) << dp->nh_sz);
+
+	memset(ptr, 0, DIR24_8_TBL8_GRP_NUM_ENT << dp->nh_sz);
+	tbl8_free_idx(dp, tbl8_idx);
+	__atomic_fetch_sub(&dp->cur_tbl8s, 1, __ATOMIC_RELAXED);
+}
+
+static void
+__rcu_qsbr_free_resource(void *p, void *data, unsigned int n)
+{
+	struct dir24_8_tbl *dp = p;
+	uint32_t tbl8_idx = *(uint32_t *)data;
+
+	RTE_SET_USED(n);
+	tbl8_cleanup(dp, tbl8_idx);
+}
+
+/*
+ * Free a tbl8 group no longer referenced by tbl24. With RCU, it is kept
+ * unchanged until the lookup threads can't be reading it anymore.
+ */
+static void
+tbl8_free(struct dir24_8_tbl *dp, uint64_t tbl8_idx)
+{
+	uint32_t idx = tbl8_idx;
+
+	if (dp->v == NULL) {
+		tbl8_cleanup(dp, tbl8_idx);
+	} else if (dp->rcu_mode == RTE_FIB_QSBR_MODE_SYNC) {
+		/* Wait for quiescent state change. */
+		rte_rcu_qsbr_synchronize(dp->v, RTE_QSBR_THRID_INVALID);
+		tbl8_cleanup(dp, tbl8_idx);
+	} else if (dp->rcu_mode == RTE_FIB_QSBR_MODE_DQ) {
+		/* Push into QSBR defer queue. */
+		if (rte_rcu_qsbr_dq_enqueue(dp->dq, &idx) != 0) {
+			/* defer queue full, fall back to blocking mode */
+			rte_rcu_qsbr_synchronize(dp->v,
+				RTE_QSBR_THRID_INVALID);
+			tbl8_cleanup(dp, tbl8_idx);
+		}
+	}
 }
 
 static int
@@ -189,7 +258,7 @@ tbl8_alloc(struct dir24_8_tbl *dp, uint64_t nh)
 	write_to_fib((void *)tbl8_ptr, nh|
 		DIR24_8_EXT_ENT, dp->nh_sz,
 		DIR24_8_TBL8_GRP_NUM_ENT);
-	dp->cur_tbl8s++;
+	__atomic_fetch_add(&dp->cur_tbl8s, 1, __ATOMIC_RELAXED);
 	return tbl8_idx;
 }
 
@@ -214,8 +283,6 @@ tbl8_recycle(struct dir24_8_tbl *dp, uint32_t ip, uint64_t tbl8_idx)
 		}
 		((uint8_t *)dp->tbl24)[ip >> 8] =
 			nh & ~DIR24_8_EXT_ENT;
-		for (i = 0; i < DIR24_8_TBL8_GRP_NUM_ENT; i++)
-			ptr8[i] = 0;
 		break;
 	case RTE_FIB_DIR24_8_2B:
 		ptr16 = &((uint16_t *)dp->tbl8)[tbl8_idx *
@@ -227,8 +294,6 @@ tbl8_recycle(struct dir24_8_tbl *dp, uint32_t ip, uint64_t tbl8_idx)
 		}
 		((uint16_t *)dp->tbl24)[ip >> 8] =
 			nh & ~DIR24_8_EXT_ENT;
-		for (i = 0; i < DIR24_8_TBL8_GRP_NUM_ENT; i++)
-			ptr16[i] = 0;
 		break;
 	case RTE_FIB_DIR24_8_4B:
 		ptr32 = &((uint32_t *)dp->tbl8)[tbl8_idx *
@@ -240,8 +305,6 @@ tbl8_recycle(struct dir24_8_tbl *dp, uint32_t ip, uint64_t tbl8_idx)
 		}
 		((uint32_t *)dp->tbl24)[ip >> 8] =
 			nh & ~DIR24_8_EXT_ENT;
-		for (i = 0; i < DIR24_8_TBL8_GRP_NUM_ENT; i++)
-			ptr32[i] = 0;
 		break;
 	case RTE_FIB_DIR24_8_8B:
 		ptr64 = &((uint64_t *)dp->tbl8)[tbl8_idx *
@@ -253,12 +316,9 @@ tbl8_recycle(struct dir24_8_tbl *dp, uint32_t ip, uint64_t tbl8_idx)
 		}
 		((uint64_t *)dp->tbl24)[ip >> 8] =
 			nh & ~DIR24_8_EXT_ENT;
-		for (i = 0; i < DIR24_8_TBL8_GRP_NUM_ENT; i++)
-			ptr64[i] = 0;
 		break;
 	}
-	tbl8_free_idx(dp, tbl8_idx);
-	dp->cur_tbl8s--;
+	tbl8_free(dp, tbl8_idx);
 }
 
 static int
@@ -366,46 +426,155 @@ static int
 modify_fib(struct dir24_8_tbl *dp, struct rte_rib *rib, uint32_t ip,
 	uint8_t depth, uint64_t next_hop)
 {
-	struct rte_rib_node *tmp = NULL;
+	struct rte_rib_node *tmp[DIR24_8_RIB_BULK];
+	struct rte_rib_iter iter;
 	uint32_t ledge, redge, tmp_ip;
+	unsigned int i, n;
 	int ret;
 	uint8_t tmp_depth;
 
+	rte_rib_iter_init(&iter, rib, ip, depth, RTE_RIB_GET_NXT_COVER);
 	ledge = ip;
 	do {
-		tmp = rte_rib_get_nxt(rib, ip, depth, tmp,
-			RTE_RIB_GET_NXT_COVER);
-		if (tmp != NULL) {
-			rte_rib_get_depth(tmp, &tmp_depth);
-			if (tmp_depth == depth)
-				continue;
-			rte_rib_get_ip(tmp, &tmp_ip);
+		n = rte_rib_iter_next_bulk(&iter, tmp, RTE_DIM(tmp));
+		for (i = 0; i < n; i++) {
+			rte_rib_get_depth(tmp[i], &tmp_depth);
+			rte_rib_get_ip(tmp[i], &tmp_ip);
 			redge = tmp_ip & rte_rib_depth_to_mask(tmp_depth);
-			if (ledge == redge) {
-				ledge = redge +
-					(uint32_t)(1ULL << (32 - tmp_depth));
-				continue;
+			if (ledge != redge) {
+				ret = install_to_fib(dp, ledge, redge,
+					next_hop);
+				if (ret != 0)
+					return ret;
 			}
-			ret = install_to_fib(dp, ledge, redge,
-				next_hop);
-			if (ret != 0)
-				return ret;
 			ledge = redge +
 				(uint32_t)(1ULL << (32 - tmp_depth));
-		} else {
-			redge = ip + (uint32_t)(1ULL << (32 - depth));
-			if (ledge == redge)
-				break;
-			ret = install_to_fib(dp, ledge, redge,
-				next_hop);
+		}
+	} while (n == RTE_DIM(tmp));
+
+	redge = ip + (uint32_t)(1ULL << (32 - depth));
+	if (ledge == redge)
+		return 0;
+
+	return install_to_fib(dp, ledge, redge, next_hop);
+}
+
+/*
+ * Within a batched update, only record the /16 ranges to rebuild.
+ */
+static void
+txn_mark_dirty(struct dir24_8_tbl *dp, uint32_t ip, uint8_t depth)
+{
+	uint32_t first, last;
+
+	first = ip >> (32 - DIR24_8_TXN_CHUNK_DEPTH);
+	last = first;
+	if (depth < DIR24_8_TXN_CHUNK_DEPTH)
+		last += (1 << (DIR24_8_TXN_CHUNK_DEPTH - depth)) - 1;
+
+	for (; first <= last; first++)
+		dp->txn_dirty[first >> BITMAP_SLAB_BIT_SIZE_LOG2] |=
+			1ULL << (first & BITMAP_SLAB_BITMASK);
+}
+
+static int
+update_fib(struct dir24_8_tbl *dp, struct rte_rib *rib, uint32_t ip,
+	uint8_t depth, uint64_t next_hop)
+{
+	if (dp->txn_dirty != NULL) {
+		txn_mark_dirty(dp, ip, depth);
+		return 0;
+	}
+	return modify_fib(dp, rib, ip, depth, next_hop);
+}
+
+/*
+ * Write the whole prefix from the RIB: its own next hop where it is
+ * not covered by a more specific route, then recursively each of them.
+ * Every address of the prefix is written once.
+ */
+static int
+rebuild_fib(struct dir24_8_tbl *dp, struct rte_rib *rib, uint32_t ip,
+	uint8_t depth, uint64_t next_hop)
+{
+	struct rte_rib_node *tmp[DIR24_8_RIB_BULK];
+	struct rte_rib_iter iter;
+	uint32_t tmp_ip;
+	uint8_t tmp_depth;
+	uint64_t tmp_nh;
+	unsigned int i, n;
+	int ret;
+
+	ret = modify_fib(dp, rib, ip, depth, next_hop);
+	if (ret != 0)
+		return ret;
+
+	rte_rib_iter_init(&iter, rib, ip, depth, RTE_RIB_GET_NXT_COVER);
+	do {
+		n = rte_rib_iter_next_bulk(&iter, tmp, RTE_DIM(tmp));
+		for (i = 0; i < n; i++) {
+			rte_rib_get_ip(tmp[i], &tmp_ip);
+			rte_rib_get_depth(tmp[i], &tmp_depth);
+			rte_rib_get_nh(tmp[i], &tmp_nh);
+			ret = rebuild_fib(dp, rib, tmp_ip, tmp_depth, tmp_nh);
 			if (ret != 0)
 				return ret;
 		}
-	} while (tmp);
+	} while (n == RTE_DIM(tmp));
 
 	return 0;
 }
 
+static int
+txn_rebuild_chunk(struct dir24_8_tbl *dp, struct rte_rib *rib, uint32_t ip)
+{
+	uint32_t orph_ip[1 << (24 - DIR24_8_TXN_CHUNK_DEPTH)];
+	uint64_t orph_ent[1 << (24 - DIR24_8_TXN_CHUNK_DEPTH)];
+	struct rte_rib_node *node;
+	uint64_t nh = dp->def_nh;
+	uint64_t ent;
+	uint32_t i, n = 0;
+	uint8_t depth;
+	int ret;
+
+	/*
+	 * The tbl8 groups of the /24 without deeper routes anymore are
+	 * overwritten in tbl24 by the rebuild, free them afterwards.
+	 */
+	for (i = 0; i < RTE_DIM(orph_ip); i++) {
+		uint32_t ip24 = ip + (i << 8);
+
+		ent = get_tbl24(dp, ip24, dp->nh_sz);
+		if (((ent & DIR24_8_EXT_ENT) == DIR24_8_EXT_ENT) &&
+				(rte_rib_get_nxt(rib, ip24, 24, NULL,
+				RTE_RIB_GET_NXT_COVER) == NULL)) {
+			orph_ip[n] = ip24;
+			orph_ent[n++] = ent;
+		}
+	}
+
+	/* Next hop of the most specific route covering the whole range */
+	node = rte_rib_lookup(rib, ip);
+	while (node != NULL) {
+		rte_rib_get_depth(node, &depth);
+		if (depth <= DIR24_8_TXN_CHUNK_DEPTH)
+			break;
+		node = rte_rib_lookup_parent(node);
+	}
+	if (node != NULL)
+		rte_rib_get_nh(node, &nh);
+
+	ret = rebuild_fib(dp, rib, ip, DIR24_8_TXN_CHUNK_DEPTH, nh);
+
+	/* On failure, some of the groups may still be in use */
+	for (i = 0; i < n; i++) {
+		if (get_tbl24(dp, orph_ip[i], dp->nh_sz) != orph_ent[i])
+			tbl8_free(dp, orph_ent[i] >> 1);
+	}
+
+	return ret;
+}
+
 int
 dir24_8_modify(struct rte_fib *fib, uint32_t ip, uint8_t depth,
 	uint64_t next_hop, int op)
@@ -437,7 +606,7 @@ dir24_8_modify(struct rte_fib *fib, uint32_t ip, uint8_t depth,
 			rte_rib_get_nh(node, &node_nh);
 			if (node_nh == next_hop)
 				return 0;
-			ret = modify_fib(dp, rib, ip, depth, next_hop);
+			ret = update_fib(dp, rib, ip, depth, next_hop);
 			if (ret == 0)
 				rte_rib_set_nh(node, next_hop);
 			return 0;
@@ -460,7 +629,7 @@ dir24_8_modify(struct rte_fib *fib, uint32_t ip, uint8_t depth,
 			if (par_nh == next_hop)
 				return 0;
 		}
-		ret = modify_fib(dp, rib, ip, depth, next_hop);
+		ret = update_fib(dp, rib, ip, depth, next_hop);
 		if (ret != 0) {
 			rte_rib_remove(rib, ip, depth);
 			return ret;
@@ -477,9 +646,9 @@ dir24_8_modify(struct rte_fib *fib, uint32_t ip, uint8_t depth,
 			rte_rib_get_nh(parent, &par_nh);
 			rte_rib_get_nh(node, &node_nh);
 			if (par_nh != node_nh)
-				ret = modify_fib(dp, rib, ip, depth, par_nh);
+				ret = update_fib(dp, rib, ip, depth, par_nh);
 		} else
-			ret = modify_fib(dp, rib, ip, depth, dp->def_nh);
+			ret = update_fib(dp, rib, ip, depth, dp->def_nh);
 		if (ret == 0) {
 			rte_rib_remove(rib, ip, depth);
 			if (depth > 24) {
@@ -547,6 +716,7 @@ dir24_8_create(const char *name, int socket_id, struct rte_fib_conf *fib_conf)
 	dp->def_nh = def_nh;
 	dp->nh_sz = nh_sz;
 	dp->number_tbl8s = num_tbl8;
+	rte_spinlock_init(&dp->tbl8_lock);
 
 	snprintf(mem_name, sizeof(mem_name), "TBL8_idxes_%p", dp);
 	dp->tbl8_idxes = rte_zmalloc_socket(mem_name,
@@ -567,7 +737,117 @@ dir24_8_free(void *p)
 {
 	struct dir24_8_tbl *dp = (struct dir24_8_tbl *)p;
 
+	if (dp->dq != NULL)
+		rte_rcu_qsbr_dq_delete(dp->dq);
+	rte_free(dp->txn_dirty);
 	rte_free(dp->tbl8_idxes);
 	rte_free(dp->tbl8);
 	rte_free(dp);
 }
+
+int
+dir24_8_rcu_qsbr_add(struct dir24_8_tbl *dp, struct rte_fib_rcu_config *cfg,
+	const char *name)
+{
+	struct rte_rcu_qsbr_dq_parameters params = {0};
+	char rcu_dq_name[RTE_RCU_QSBR_DQ_NAMESIZE];
+
+	if (dp == NULL || cfg == NULL || cfg->v == NULL)
+		return -EINVAL;
+
+	if (dp->v != NULL)
+		return -EEXIST;
+
+	switch (cfg->mode) {
+	case RTE_FIB_QSBR_MODE_DQ:
+		/* Init QSBR defer queue. */
+		snprintf(rcu_dq_name, sizeof(rcu_dq_name),
+				"FIB_RCU_%s", name);
+		params.name = rcu_dq_name;
+		params.size = cfg->dq_size;
+		if (params.size == 0)
+			params.size = dp->number_tbl8s;
+		params.trigger_reclaim_limit = cfg->reclaim_thd;
+		params.max_reclaim_size = cfg->reclaim_max;
+		if (params.max_reclaim_size == 0)
+			params.max_reclaim_size = RTE_FIB_RCU_DQ_RECLAIM_MAX;
+		params.esize = sizeof(uint32_t);	/* tbl8 group index */
+		params.free_fn = __rcu_qsbr_free_resource;
+		params.p = dp;
+		params.v = cfg->v;
+		dp->dq = rte_rcu_qsbr_dq_create(&params);
+		if (dp->dq == NULL)
+			return -rte_errno;
+		break;
+	case RTE_FIB_QSBR_MODE_SYNC:
+		/* No other things to do. */
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	dp->rcu_mode = cfg->mode;
+	dp->v = cfg->v;
+
+	return 0;
+}
+
+int
+dir24_8_txn_begin(struct dir24_8_tbl *dp)
+{
+	if (dp->txn_dirty != NULL)
+		return -EBUSY;
+
+	dp->txn_dirty = rte_zmalloc("FIB_TXN",
+		DIR24_8_TXN_NUM_CHUNKS >> 3, RTE_CACHE_LINE_SIZE);
+	if (dp->txn_dirty == NULL)
+		return -ENOMEM;
+
+	return 0;
+}
+
+int
+dir24_8_txn_apply(struct dir24_8_tbl *dp, struct rte_rib *rib,
+	unsigned int part, unsigned int nb_parts)
+{
+	uint32_t slab, last, chunk;
+	uint64_t bits;
+	int ret;
+
+	if (dp->txn_dirty == NULL)
+		return -EINVAL;
+
+	/* Parts are made of consecutive /8, their slabs don't overlap */
+	slab = (part * 256 / nb_parts) * DIR24_8_TXN_SLABS_PER_8;
+	last = ((part + 1) * 256 / nb_parts) * DIR24_8_TXN_SLABS_PER_8;
+	for (; slab < last; slab++) {
+		bits = dp->txn_dirty[slab];
+		while (bits != 0) {
+			chunk = (slab << BITMAP_SLAB_BIT_SIZE_LOG2) +
+				__builtin_ctzll(bits);
+			ret = txn_rebuild_chunk(dp, rib,
+				chunk << (32 - DIR24_8_TXN_CHUNK_DEPTH));
+			if (ret != 0)
+				return ret;
+			bits &= bits - 1;
+			dp->txn_dirty[slab] = bits;
+		}
+	}
+
+	return 0;
+}
+
+int
+dir24_8_txn_commit(struct dir24_8_tbl *dp, struct rte_rib *rib)
+{
+	int ret;
+
+	ret = dir24_8_txn_apply(dp, rib, 0, 1);
+	if (ret != 0)
+		return ret;
+
+	rte_free(dp->txn_dirty);
+	dp->txn_dirty = NULL;
+
+	return 0;
+}
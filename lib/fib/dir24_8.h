@@ -8,6 +8,7 @@
 
 #include <rte_prefetch.h>
 #include <rte_branch_prediction.h>
+#include <rte_spinlock.h>
 
 /**
  * @file
@@ -23,6 +24,13 @@
 #define BITMAP_SLAB_BIT_SIZE		(1 << BITMAP_SLAB_BIT_SIZE_LOG2)
 #define BITMAP_SLAB_BITMASK		(BITMAP_SLAB_BIT_SIZE - 1)
 
+/* Depth of the address ranges rebuilt by a batched update */
+#define DIR24_8_TXN_CHUNK_DEPTH		16
+#define DIR24_8_TXN_NUM_CHUNKS		(1 << DIR24_8_TXN_CHUNK_DEPTH)
+/* Number of dirty bitmap slabs covering a /8 */
+#define DIR24_8_TXN_SLABS_PER_8		\
+	((1 << (DIR24_8_TXN_CHUNK_DEPTH - 8)) >> BITMAP_SLAB_BIT_SIZE_LOG2)
+
 struct dir24_8_tbl {
 	uint32_t	number_tbl8s;	/**< Total number of tbl8s */
 	uint32_t	rsvd_tbl8s;	/**< Number of reserved tbl8s */
@@ -31,6 +39,12 @@ struct dir24_8_tbl {
 	uint64_t	def_nh;		/**< Default next hop */
 	uint64_t	*tbl8;		/**< tbl8 table. */
 	uint64_t	*tbl8_idxes;	/**< bitmap containing free tbl8 idxes*/
+	rte_spinlock_t	tbl8_lock;	/**< tbl8 idxes bitmap lock */
+	uint64_t	*txn_dirty;	/**< bitmap of the ranges to rebuild */
+	/* RCU config. */
+	enum rte_fib_qsbr_mode	rcu_mode;	/* Blocking, defer queue. */
+	struct rte_rcu_qsbr	*v;		/* RCU QSBR variable. */
+	struct rte_rcu_qsbr_dq	*dq;		/* RCU QSBR defer queue. */
 	/* tbl24 table. */
 	__extension__ uint64_t	tbl24[0] __rte_cache_aligned;
 };
@@ -248,4 +262,18 @@ int
 dir24_8_modify(struct rte_fib *fib, uint32_t ip, uint8_t depth,
 	uint64_t next_hop, int op);
 
+int
+dir24_8_rcu_qsbr_add(struct dir24_8_tbl *dp, struct rte_fib_rcu_config *cfg,
+	const char *name);
+
+int
+dir24_8_txn_begin(struct dir24_8_tbl *dp);
+
+int
+dir24_8_txn_apply(struct dir24_8_tbl *dp, struct rte_rib *rib,
+	unsigned int part, unsigned int nb_parts);
+
+int
+dir24_8_txn_commit(struct dir24_8_tbl *dp, struct rte_rib *rib);
+
 #endif /* _DIR24_8_H_ */
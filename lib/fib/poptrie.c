@@ -0,0 +1,948 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 agent <agent@local>
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_debug.h>
+#include <rte_malloc.h>
+#include <rte_errno.h>
+#include <rte_memory.h>
+#include <rte_rcu_qsbr.h>
+#include <rte_vect.h>
+
+#include <rte_rib.h>
+#include <rte_rib6.h>
+#include <rte_fib.h>
+#include "poptrie.h"
+
+#ifdef CC_POPTRIE_AVX512_SUPPORT
+
+#include "poptrie_avx512.h"
+
+#endif /* CC_POPTRIE_AVX512_SUPPORT */
+
+#define POPTRIE_NAMESIZE	64
+#define POPTRIE_FREE_END	UINT32_MAX
+/* Number of bits of the VRF id prefixing the address in the RIB keys */
+#define POPTRIE_VRF_BITS	16
+
+enum poptrie_pool_type {
+	POPTRIE_POOL_NODE,
+	POPTRIE_POOL_LEAF,
+};
+
+static inline bool
+vector_supported(void)
+{
+#ifdef CC_POPTRIE_AVX512_SUPPORT
+	if ((rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512F) <= 0) ||
+			(rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512DQ) <= 0) ||
+			(rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512VPOPCNTDQ) <=
+			0) ||
+			(rte_vect_get_max_simd_bitwidth() < RTE_VECT_SIMD_512))
+		return false;
+
+	return true;
+#endif
+	return false;
+}
+
+static inline rte_fib_lookup_fn_t
+get_vector_fn(void)
+{
+#ifdef CC_POPTRIE_AVX512_SUPPORT
+	if (vector_supported())
+		return rte_poptrie_vec_lookup_bulk;
+#endif
+	return NULL;
+}
+
+static inline rte_fib_vrf_lookup_fn_t
+get_vrf_vector_fn(void)
+{
+#ifdef CC_POPTRIE_AVX512_SUPPORT
+	if (vector_supported())
+		return rte_poptrie_vec_vrf_lookup_bulk;
+#endif
+	return NULL;
+}
+
+rte_fib_lookup_fn_t
+poptrie_get_lookup_fn(void *p, enum rte_fib_lookup_type type)
+{
+	rte_fib_lookup_fn_t ret_fn;
+
+	if (p == NULL)
+		return NULL;
+
+	switch (type) {
+	case RTE_FIB_LOOKUP_POPTRIE_SCALAR:
+		return poptrie_lookup_bulk;
+	case RTE_FIB_LOOKUP_POPTRIE_VECTOR_AVX512:
+		return get_vector_fn();
+	case RTE_FIB_LOOKUP_DEFAULT:
+		ret_fn = get_vector_fn();
+		return (ret_fn != NULL) ? ret_fn : poptrie_lookup_bulk;
+	default:
+		return NULL;
+	}
+
+	return NULL;
+}
+
+rte_fib_vrf_lookup_fn_t
+poptrie_get_vrf_lookup_fn(void *p, enum rte_fib_lookup_type type)
+{
+	rte_fib_vrf_lookup_fn_t ret_fn;
+
+	if (p == NULL)
+		return NULL;
+
+	switch (type) {
+	case RTE_FIB_LOOKUP_POPTRIE_SCALAR:
+		return poptrie_vrf_lookup_bulk;
+	case RTE_FIB_LOOKUP_POPTRIE_VECTOR_AVX512:
+		return get_vrf_vector_fn();
+	case RTE_FIB_LOOKUP_DEFAULT:
+		ret_fn = get_vrf_vector_fn();
+		return (ret_fn != NULL) ? ret_fn : poptrie_vrf_lookup_bulk;
+	default:
+		return NULL;
+	}
+
+	return NULL;
+}
+
+/*
+ * The free blocks are linked through their first element,
+ * a node base0 or a leaf.
+ */
+static inline uint32_t *
+pool_link(struct poptrie_tbl *dp, enum poptrie_pool_type type, uint32_t idx)
+{
+	return (type == POPTRIE_POOL_NODE) ? &dp->nodes[idx].base0 :
+		&dp->leaves[idx];
+}
+
+static inline struct poptrie_pool *
+get_pool(struct poptrie_tbl *dp, enum poptrie_pool_type type)
+{
+	return (type == POPTRIE_POOL_NODE) ? &dp->node_pool : &dp->leaf_pool;
+}
+
+static void
+pool_push(struct poptrie_tbl *dp, enum poptrie_pool_type type, uint32_t idx,
+	uint32_t n)
+{
+	struct poptrie_pool *pool = get_pool(dp, type);
+
+	*pool_link(dp, type, idx) = pool->free[n];
+	pool->free[n] = idx;
+}
+
+/* Free block of a pool, while merging the free blocks */
+struct poptrie_free_blk {
+	uint32_t	idx;
+	uint32_t	n;
+};
+
+static int
+free_blk_cmp(const void *a, const void *b)
+{
+	const struct poptrie_free_blk *x = a;
+	const struct poptrie_free_blk *y = b;
+
+	return (x->idx > y->idx) - (x->idx < y->idx);
+}
+
+/*
+ * Merge the adjacent free blocks of a pool, whatever their size lists.
+ * The merged blocks are cut again in blocks of at most
+ * POPTRIE_STRIDE_NUM_ENT elements, the one ending at the top of the pool
+ * gives its elements back to the never allocated area.
+ */
+static int
+pool_compact(struct poptrie_tbl *dp, enum poptrie_pool_type type)
+{
+	struct poptrie_pool *pool = get_pool(dp, type);
+	struct poptrie_free_blk *blks;
+	uint32_t i, j, n, nb_blks = 0, idx, len;
+
+	for (n = 1; n <= POPTRIE_STRIDE_NUM_ENT; n++)
+		for (idx = pool->free[n]; idx != POPTRIE_FREE_END;
+				idx = *pool_link(dp, type, idx))
+			nb_blks++;
+	if (nb_blks == 0)
+		return -ENOSPC;
+
+	blks = rte_malloc(NULL, nb_blks * sizeof(*blks), 0);
+	if (blks == NULL)
+		return -ENOMEM;
+
+	i = 0;
+	for (n = 1; n <= POPTRIE_STRIDE_NUM_ENT; n++) {
+		for (idx = pool->free[n]; idx != POPTRIE_FREE_END;
+				idx = *pool_link(dp, type, idx)) {
+			blks[i].idx = idx;
+			blks[i].n = n;
+			i++;
+		}
+		pool->free[n] = POPTRIE_FREE_END;
+	}
+	qsort(blks, nb_blks, sizeof(*blks), free_blk_cmp);
+
+	for (i = 0; i < nb_blks; i = j) {
+		idx = blks[i].idx;
+		len = blks[i].n;
+		for (j = i + 1; (j < nb_blks) && (blks[j].idx == idx + len);
+				j++)
+			len += blks[j].n;
+		if (idx + len == pool->top) {
+			pool->top = idx;
+			break;
+		}
+		for (; len > POPTRIE_STRIDE_NUM_ENT;
+				len -= POPTRIE_STRIDE_NUM_ENT) {
+			pool_push(dp, type, idx, POPTRIE_STRIDE_NUM_ENT);
+			idx += POPTRIE_STRIDE_NUM_ENT;
+		}
+		pool_push(dp, type, idx, len);
+	}
+
+	rte_free(blks);
+	return 0;
+}
+
+/*
+ * Take a block of the requested size from its free list, from the never
+ * allocated area, or split from a larger free block.
+ */
+static int64_t
+pool_take(struct poptrie_tbl *dp, enum poptrie_pool_type type, uint32_t n)
+{
+	struct poptrie_pool *pool = get_pool(dp, type);
+	uint32_t idx, m;
+
+	idx = pool->free[n];
+	if (idx != POPTRIE_FREE_END) {
+		pool->free[n] = *pool_link(dp, type, idx);
+		return idx;
+	}
+
+	if (pool->size - pool->top >= n) {
+		idx = pool->top;
+		pool->top += n;
+		return idx;
+	}
+
+	for (m = n + 1; m <= POPTRIE_STRIDE_NUM_ENT; m++) {
+		idx = pool->free[m];
+		if (idx == POPTRIE_FREE_END)
+			continue;
+		pool->free[m] = *pool_link(dp, type, idx);
+		pool_push(dp, type, idx + n, m - n);
+		return idx;
+	}
+
+	return -ENOSPC;
+}
+
+static int64_t
+pool_get(struct poptrie_tbl *dp, enum poptrie_pool_type type, uint32_t n)
+{
+	int64_t idx;
+
+	idx = pool_take(dp, type, n);
+	/* The free blocks may be too fragmented, merge them and retry */
+	if ((idx < 0) && (pool_compact(dp, type) == 0))
+		idx = pool_take(dp, type, n);
+
+	return idx;
+}
+
+static int64_t
+pool_alloc(struct poptrie_tbl *dp, enum poptrie_pool_type type, uint32_t n)
+{
+	struct poptrie_pool *pool = get_pool(dp, type);
+	unsigned int freed;
+	int64_t idx;
+
+	idx = pool_get(dp, type, n);
+	/* If the pool is exhausted, try to reclaim the released subtrees */
+	while ((idx < 0) && (dp->dq != NULL) &&
+			(rte_rcu_qsbr_dq_reclaim(dp->dq,
+				RTE_FIB_RCU_DQ_RECLAIM_MAX, &freed,
+				NULL, NULL) == 0) && (freed != 0))
+		idx = pool_get(dp, type, n);
+	if (idx < 0)
+		return -ENOSPC;
+	pool->used += n;
+
+	return idx;
+}
+
+static void
+pool_free(struct poptrie_tbl *dp, enum poptrie_pool_type type, uint32_t idx,
+	uint32_t n)
+{
+	struct poptrie_pool *pool = get_pool(dp, type);
+
+	if (n == 0)
+		return;
+
+	pool_push(dp, type, idx, n);
+	pool->used -= n;
+}
+
+static void
+pool_init(struct poptrie_pool *pool, uint32_t size)
+{
+	unsigned int i;
+
+	pool->size = size;
+	pool->top = 0;
+	pool->used = 0;
+	for (i = 0; i <= POPTRIE_STRIDE_NUM_ENT; i++)
+		pool->free[i] = POPTRIE_FREE_END;
+}
+
+/* Free the children and leaves of a node, not the node itself */
+static void
+free_node(struct poptrie_tbl *dp, struct poptrie_node *node)
+{
+	uint32_t i, nb_nodes;
+
+	nb_nodes = __builtin_popcountll(node->vector);
+	for (i = 0; i < nb_nodes; i++)
+		free_node(dp, &dp->nodes[node->base1 + i]);
+	pool_free(dp, POPTRIE_POOL_NODE, node->base1, nb_nodes);
+	pool_free(dp, POPTRIE_POOL_LEAF, node->base0,
+		__builtin_popcountll(node->leafvec));
+}
+
+/*
+ * Routes of the VRF being updated, in the IPv4 RIB of a single VRF FIB or in
+ * the IPv6 RIB of a multi VRF FIB, keyed by the VRF id followed by the address
+ */
+struct poptrie_routes {
+	struct rte_rib	*rib;
+	struct rte_rib6	*rib6;
+	uint16_t	vrf_id;
+};
+
+static inline void
+get_vrf_key(uint8_t key[RTE_RIB6_IPV6_ADDR_SIZE], uint16_t vrf_id,
+	uint32_t ip)
+{
+	memset(key, 0, RTE_RIB6_IPV6_ADDR_SIZE);
+	key[0] = vrf_id >> 8;
+	key[1] = vrf_id;
+	key[2] = ip >> 24;
+	key[3] = ip >> 16;
+	key[4] = ip >> 8;
+	key[5] = ip;
+}
+
+static inline uint32_t
+get_vrf_key_ip(const uint8_t key[RTE_RIB6_IPV6_ADDR_SIZE])
+{
+	return (uint32_t)key[2] << 24 | (uint32_t)key[3] << 16 |
+		(uint32_t)key[4] << 8 | key[5];
+}
+
+static uint32_t
+get_nh(struct poptrie_tbl *dp, const struct poptrie_routes *rt, uint32_t ip)
+{
+	uint8_t key[RTE_RIB6_IPV6_ADDR_SIZE];
+	struct rte_rib_node *node;
+	struct rte_rib6_node *node6;
+	uint64_t nh;
+
+	if (rt->rib != NULL) {
+		node = rte_rib_lookup(rt->rib, ip);
+		if (node == NULL)
+			return dp->def_nh;
+		rte_rib_get_nh(node, &nh);
+		return nh;
+	}
+
+	get_vrf_key(key, rt->vrf_id, ip);
+	node6 = rte_rib6_lookup(rt->rib6, key);
+	if (node6 == NULL)
+		return dp->def_nh;
+	rte_rib6_get_nh(node6, &nh);
+	return nh;
+}
+
+/*
+ * Get the next route more specific than a prefix, not covered by another one.
+ * Returns NULL once all of them were returned.
+ */
+static const void *
+get_nxt_cover(const struct poptrie_routes *rt, uint32_t ip, uint8_t depth,
+	const void *last, uint32_t *nxt_ip, uint8_t *nxt_depth)
+{
+	uint8_t key[RTE_RIB6_IPV6_ADDR_SIZE];
+	struct rte_rib_node *node;
+	struct rte_rib6_node *node6;
+
+	if (rt->rib != NULL) {
+		node = rte_rib_get_nxt(rt->rib, ip, depth,
+			(struct rte_rib_node *)(uintptr_t)last,
+			RTE_RIB_GET_NXT_COVER);
+		if (node != NULL) {
+			rte_rib_get_ip(node, nxt_ip);
+			rte_rib_get_depth(node, nxt_depth);
+		}
+		return node;
+	}
+
+	get_vrf_key(key, rt->vrf_id, ip);
+	node6 = rte_rib6_get_nxt(rt->rib6, key, depth + POPTRIE_VRF_BITS,
+		(struct rte_rib6_node *)(uintptr_t)last,
+		RTE_RIB6_GET_NXT_COVER);
+	if (node6 != NULL) {
+		rte_rib6_get_ip(node6, key);
+		rte_rib6_get_depth(node6, nxt_depth);
+		*nxt_ip = get_vrf_key_ip(key);
+		*nxt_depth -= POPTRIE_VRF_BITS;
+	}
+	return node6;
+}
+
+static inline bool
+has_subroutes(const struct poptrie_routes *rt, uint32_t ip, uint8_t depth)
+{
+	uint32_t nxt_ip;
+	uint8_t nxt_depth;
+
+	return get_nxt_cover(rt, ip, depth, NULL, &nxt_ip, &nxt_depth) != NULL;
+}
+
+/*
+ * Build from the RIB the node resolving the stride after the prefix.
+ * The node is kept consistent on failure so that it can be freed.
+ */
+static int
+build_node(struct poptrie_tbl *dp, const struct poptrie_routes *rt,
+	uint32_t ip, uint8_t depth, struct poptrie_node *node)
+{
+	uint32_t leaves[POPTRIE_STRIDE_NUM_ENT];
+	uint32_t child_ip[POPTRIE_STRIDE_NUM_ENT];
+	uint64_t vector = 0, leafvec = 0, covered = 0;
+	uint32_t i, nb_nodes = 0, nb_leaves = 0;
+	uint32_t tmp_ip, nb_covered;
+	uint8_t child_depth, tmp_depth;
+	int64_t base0, base1 = 0, nh = -1;
+	const void *tmp = NULL;
+	int ret;
+
+	child_depth = RTE_MIN(depth + POPTRIE_STRIDE, 32);
+
+	/*
+	 * Walk the more specific routes once: a child holding one of them
+	 * deeper than the child is a node, a child covered by one of them
+	 * is resolved from the RIB, the other children all share the next hop
+	 * of the prefix.
+	 */
+	while ((tmp = get_nxt_cover(rt, ip, depth, tmp, &tmp_ip,
+			&tmp_depth)) != NULL) {
+		/* The last stride goes beyond the address, padded with 0 */
+		if (depth + POPTRIE_STRIDE <= 32)
+			i = (tmp_ip - ip) >> (32 - depth - POPTRIE_STRIDE);
+		else
+			i = (tmp_ip - ip) << (depth + POPTRIE_STRIDE - 32);
+		if (tmp_depth > child_depth) {
+			vector |= 1ULL << i;
+			continue;
+		}
+		nb_covered = 1U << (depth + POPTRIE_STRIDE - tmp_depth);
+		covered |= ((1ULL << nb_covered) - 1) << i;
+	}
+
+	for (i = 0; i < POPTRIE_STRIDE_NUM_ENT; i++) {
+		if (depth + POPTRIE_STRIDE <= 32)
+			child_ip[i] = ip +
+				(i << (32 - depth - POPTRIE_STRIDE));
+		else
+			child_ip[i] = ip +
+				(i >> (depth + POPTRIE_STRIDE - 32));
+
+		if (vector & (1ULL << i)) {
+			nb_nodes++;
+			continue;
+		}
+		if ((covered & (1ULL << i)) == 0) {
+			if (nh < 0)
+				nh = get_nh(dp, rt, child_ip[i]);
+			leaves[nb_leaves] = nh;
+		} else if ((child_depth < 32) &&
+				has_subroutes(rt, child_ip[i], child_depth)) {
+			vector |= 1ULL << i;
+			nb_nodes++;
+			continue;
+		} else
+			leaves[nb_leaves] = get_nh(dp, rt, child_ip[i]);
+		if ((nb_leaves == 0) ||
+				(leaves[nb_leaves] != leaves[nb_leaves - 1])) {
+			leafvec |= 1ULL << i;
+			nb_leaves++;
+		}
+	}
+
+	base0 = pool_alloc(dp, POPTRIE_POOL_LEAF, nb_leaves);
+	if (base0 < 0)
+		return base0;
+	memcpy(&dp->leaves[base0], leaves, nb_leaves * sizeof(leaves[0]));
+
+	if (nb_nodes != 0) {
+		base1 = pool_alloc(dp, POPTRIE_POOL_NODE, nb_nodes);
+		if (base1 < 0) {
+			pool_free(dp, POPTRIE_POOL_LEAF, base0, nb_leaves);
+			return base1;
+		}
+		memset(&dp->nodes[base1], 0, nb_nodes * sizeof(*node));
+	}
+
+	node->vector = vector;
+	node->leafvec = leafvec;
+	node->base0 = base0;
+	node->base1 = base1;
+
+	for (i = 0; vector != 0; vector &= vector - 1, i++) {
+		ret = build_node(dp, rt,
+			child_ip[__builtin_ctzll(vector)], child_depth,
+			&dp->nodes[base1 + i]);
+		if (ret != 0)
+			return ret;
+	}
+
+	return 0;
+}
+
+/* Free a subtree with its root node */
+static void
+subtree_cleanup(struct poptrie_tbl *dp, uint32_t node_idx)
+{
+	free_node(dp, &dp->nodes[node_idx]);
+	pool_free(dp, POPTRIE_POOL_NODE, node_idx, 1);
+}
+
+static void
+__rcu_qsbr_free_resource(void *p, void *data, unsigned int n)
+{
+	struct poptrie_tbl *dp = p;
+	uint32_t node_idx = *(uint32_t *)data;
+
+	RTE_SET_USED(n);
+	subtree_cleanup(dp, node_idx);
+}
+
+/*
+ * Free a subtree no longer referenced by the direct pointing array. Its
+ * blocks are linked in the free lists, so with RCU it is kept unchanged
+ * until the lookup threads can't be walking it anymore.
+ */
+static void
+subtree_free(struct poptrie_tbl *dp, uint32_t node_idx)
+{
+	if (dp->v == NULL) {
+		subtree_cleanup(dp, node_idx);
+	} else if (dp->rcu_mode == RTE_FIB_QSBR_MODE_SYNC) {
+		/* Wait for quiescent state change. */
+		rte_rcu_qsbr_synchronize(dp->v, RTE_QSBR_THRID_INVALID);
+		subtree_cleanup(dp, node_idx);
+	} else if (dp->rcu_mode == RTE_FIB_QSBR_MODE_DQ) {
+		/* Push into QSBR defer queue. */
+		if (rte_rcu_qsbr_dq_enqueue(dp->dq, &node_idx) != 0) {
+			/* defer queue full, fall back to blocking mode */
+			rte_rcu_qsbr_synchronize(dp->v,
+				RTE_QSBR_THRID_INVALID);
+			subtree_cleanup(dp, node_idx);
+		}
+	}
+}
+
+static void
+set_dir_ent(struct poptrie_tbl *dp, uint32_t *ent, uint32_t new_ent)
+{
+	uint32_t old_ent = *ent;
+
+	/* publish the new subtree before releasing the previous one */
+	__atomic_store_n(ent, new_ent, __ATOMIC_RELEASE);
+
+	if (old_ent & POPTRIE_NODE_ENT)
+		subtree_free(dp, old_ent & ~POPTRIE_NODE_ENT);
+}
+
+static inline uint32_t *
+get_dir_ent(struct poptrie_tbl *dp, const struct poptrie_routes *rt,
+	uint32_t idx)
+{
+	return &dp->dir[((uint32_t)rt->vrf_id << POPTRIE_DIR_BITS) | idx];
+}
+
+/*
+ * Rebuild the subtree of a direct pointing entry from the RIB,
+ * then replace the previous one.
+ */
+static int
+update_dir_ent(struct poptrie_tbl *dp, const struct poptrie_routes *rt,
+	uint32_t idx)
+{
+	uint32_t ip = idx << (32 - POPTRIE_DIR_BITS);
+	int64_t node_idx;
+	int ret;
+
+	if (!has_subroutes(rt, ip, POPTRIE_DIR_BITS)) {
+		set_dir_ent(dp, get_dir_ent(dp, rt, idx), get_nh(dp, rt, ip));
+		return 0;
+	}
+
+	node_idx = pool_alloc(dp, POPTRIE_POOL_NODE, 1);
+	if (node_idx < 0)
+		return node_idx;
+	memset(&dp->nodes[node_idx], 0, sizeof(dp->nodes[0]));
+	ret = build_node(dp, rt, ip, POPTRIE_DIR_BITS, &dp->nodes[node_idx]);
+	if (ret != 0) {
+		/* never published, no lookup can be walking it */
+		subtree_cleanup(dp, node_idx);
+		return ret;
+	}
+	set_dir_ent(dp, get_dir_ent(dp, rt, idx), node_idx | POPTRIE_NODE_ENT);
+
+	return 0;
+}
+
+/*
+ * Fill the direct pointing entries holding no route more specific than
+ * the updated prefix, they all resolve to the same next hop.
+ */
+static void
+fill_dir_range(struct poptrie_tbl *dp, const struct poptrie_routes *rt,
+	uint32_t first, uint32_t last, int64_t *nh)
+{
+	if (first >= last)
+		return;
+
+	if (*nh < 0)
+		*nh = get_nh(dp, rt, first << (32 - POPTRIE_DIR_BITS));
+	for (; first < last; first++)
+		set_dir_ent(dp, get_dir_ent(dp, rt, first), *nh);
+}
+
+/*
+ * Update the direct pointing entries covered by a prefix. Only the entries
+ * holding more specific routes are rebuilt from the RIB, the ranges
+ * entirely covered by more specific routes are skipped.
+ */
+static int
+modify_fib(struct poptrie_tbl *dp, const struct poptrie_routes *rt,
+	uint32_t ip, uint8_t depth)
+{
+	const void *tmp = NULL;
+	uint32_t tmp_ip, first, last, idx;
+	uint8_t tmp_depth;
+	int64_t nh = -1;
+	int ret;
+
+	first = ip >> (32 - POPTRIE_DIR_BITS);
+	if (depth >= POPTRIE_DIR_BITS)
+		return update_dir_ent(dp, rt, first);
+
+	last = first + (1 << (POPTRIE_DIR_BITS - depth));
+	while ((tmp = get_nxt_cover(rt, ip, depth, tmp, &tmp_ip,
+			&tmp_depth)) != NULL) {
+		idx = tmp_ip >> (32 - POPTRIE_DIR_BITS);
+		/* several routes may share the entry already rebuilt */
+		if (idx < first)
+			continue;
+		fill_dir_range(dp, rt, first, idx, &nh);
+		if (tmp_depth <= POPTRIE_DIR_BITS) {
+			first = idx + (1 << (POPTRIE_DIR_BITS - tmp_depth));
+			continue;
+		}
+		ret = update_dir_ent(dp, rt, idx);
+		if (ret != 0)
+			return ret;
+		first = idx + 1;
+	}
+	fill_dir_range(dp, rt, first, last, &nh);
+
+	return 0;
+}
+
+int
+poptrie_modify(struct rte_fib *fib, uint32_t ip, uint8_t depth,
+	uint64_t next_hop, int op)
+{
+	struct poptrie_tbl *dp;
+	struct rte_rib *rib;
+	struct rte_rib_node *node;
+	struct rte_rib_node *parent;
+	struct poptrie_routes rt = {0};
+	uint64_t par_nh, node_nh;
+	int ret;
+
+	if ((fib == NULL) || (depth > RTE_FIB_MAXDEPTH))
+		return -EINVAL;
+
+	dp = rte_fib_get_dp(fib);
+	rib = rte_fib_get_rib(fib);
+	RTE_ASSERT((dp != NULL) && (rib != NULL));
+
+	if (next_hop > POPTRIE_MAX_NH)
+		return -EINVAL;
+
+	ip &= rte_rib_depth_to_mask(depth);
+	rt.rib = rib;
+
+	node = rte_rib_lookup_exact(rib, ip, depth);
+	switch (op) {
+	case RTE_FIB_ADD:
+		if (node != NULL) {
+			rte_rib_get_nh(node, &node_nh);
+			if (node_nh == next_hop)
+				return 0;
+			rte_rib_set_nh(node, next_hop);
+			ret = modify_fib(dp, &rt, ip, depth);
+			if (ret != 0) {
+				rte_rib_set_nh(node, node_nh);
+				modify_fib(dp, &rt, ip, depth);
+			}
+			return ret;
+		}
+		node = rte_rib_insert(rib, ip, depth);
+		if (node == NULL)
+			return -rte_errno;
+		rte_rib_set_nh(node, next_hop);
+		parent = rte_rib_lookup_parent(node);
+		if (parent != NULL) {
+			rte_rib_get_nh(parent, &par_nh);
+			if (par_nh == next_hop)
+				return 0;
+		}
+		ret = modify_fib(dp, &rt, ip, depth);
+		if (ret != 0) {
+			rte_rib_remove(rib, ip, depth);
+			modify_fib(dp, &rt, ip, depth);
+		}
+		return ret;
+	case RTE_FIB_DEL:
+		if (node == NULL)
+			return -ENOENT;
+
+		rte_rib_get_nh(node, &node_nh);
+		rte_rib_remove(rib, ip, depth);
+		ret = modify_fib(dp, &rt, ip, depth);
+		if (ret != 0) {
+			node = rte_rib_insert(rib, ip, depth);
+			if (node != NULL) {
+				rte_rib_set_nh(node, node_nh);
+				modify_fib(dp, &rt, ip, depth);
+			}
+		}
+		return ret;
+	default:
+		break;
+	}
+	return -EINVAL;
+}
+
+int
+poptrie_vrf_modify(struct poptrie_tbl *dp, struct rte_rib6 *rib,
+	uint16_t vrf_id, uint32_t ip, uint8_t depth, uint64_t next_hop, int op)
+{
+	uint8_t key[RTE_RIB6_IPV6_ADDR_SIZE];
+	struct rte_rib6_node *node;
+	struct rte_rib6_node *parent;
+	struct poptrie_routes rt = {0};
+	uint64_t par_nh, node_nh;
+	uint8_t key_depth;
+	int ret;
+
+	if ((dp == NULL) || (rib == NULL) || (vrf_id >= dp->num_vrfs) ||
+			(depth > RTE_FIB_MAXDEPTH) ||
+			(next_hop > POPTRIE_MAX_NH))
+		return -EINVAL;
+
+	ip &= rte_rib_depth_to_mask(depth);
+	get_vrf_key(key, vrf_id, ip);
+	key_depth = depth + POPTRIE_VRF_BITS;
+	rt.rib6 = rib;
+	rt.vrf_id = vrf_id;
+
+	node = rte_rib6_lookup_exact(rib, key, key_depth);
+	switch (op) {
+	case RTE_FIB_ADD:
+		if (node != NULL) {
+			rte_rib6_get_nh(node, &node_nh);
+			if (node_nh == next_hop)
+				return 0;
+			rte_rib6_set_nh(node, next_hop);
+			ret = modify_fib(dp, &rt, ip, depth);
+			if (ret != 0) {
+				rte_rib6_set_nh(node, node_nh);
+				modify_fib(dp, &rt, ip, depth);
+			}
+			return ret;
+		}
+		node = rte_rib6_insert(rib, key, key_depth);
+		if (node == NULL)
+			return -rte_errno;
+		rte_rib6_set_nh(node, next_hop);
+		parent = rte_rib6_lookup_parent(node);
+		if (parent != NULL) {
+			rte_rib6_get_nh(parent, &par_nh);
+			if (par_nh == next_hop)
+				return 0;
+		}
+		ret = modify_fib(dp, &rt, ip, depth);
+		if (ret != 0) {
+			rte_rib6_remove(rib, key, key_depth);
+			modify_fib(dp, &rt, ip, depth);
+		}
+		return ret;
+	case RTE_FIB_DEL:
+		if (node == NULL)
+			return -ENOENT;
+
+		rte_rib6_get_nh(node, &node_nh);
+		rte_rib6_remove(rib, key, key_depth);
+		ret = modify_fib(dp, &rt, ip, depth);
+		if (ret != 0) {
+			node = rte_rib6_insert(rib, key, key_depth);
+			if (node != NULL) {
+				rte_rib6_set_nh(node, node_nh);
+				modify_fib(dp, &rt, ip, depth);
+			}
+		}
+		return ret;
+	default:
+		break;
+	}
+	return -EINVAL;
+}
+
+void *
+poptrie_create(const char *name, int socket_id, struct rte_fib_conf *fib_conf,
+	uint32_t num_vrfs)
+{
+	char mem_name[POPTRIE_NAMESIZE];
+	struct poptrie_tbl *dp;
+	size_t i;
+
+	if ((name == NULL) || (fib_conf == NULL) ||
+			(fib_conf->poptrie.num_nodes == 0) ||
+			(fib_conf->poptrie.num_nodes > POPTRIE_MAX_NH) ||
+			(fib_conf->poptrie.num_leaves == 0) ||
+			(fib_conf->default_nh > POPTRIE_MAX_NH)) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	snprintf(mem_name, sizeof(mem_name), "DP_%s", name);
+	dp = rte_zmalloc_socket(mem_name, sizeof(struct poptrie_tbl) +
+		(size_t)num_vrfs * POPTRIE_DIR_NUM_ENT * sizeof(dp->dir[0]),
+		RTE_CACHE_LINE_SIZE, socket_id);
+	if (dp == NULL) {
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+
+	dp->def_nh = fib_conf->default_nh;
+	dp->num_vrfs = num_vrfs;
+	for (i = 0; i < (size_t)num_vrfs * POPTRIE_DIR_NUM_ENT; i++)
+		dp->dir[i] = dp->def_nh;
+
+	snprintf(mem_name, sizeof(mem_name), "NODES_%p", dp);
+	dp->nodes = rte_zmalloc_socket(mem_name,
+		sizeof(struct poptrie_node) * fib_conf->poptrie.num_nodes,
+		RTE_CACHE_LINE_SIZE, socket_id);
+	if (dp->nodes == NULL) {
+		rte_errno = ENOMEM;
+		rte_free(dp);
+		return NULL;
+	}
+
+	snprintf(mem_name, sizeof(mem_name), "LEAVES_%p", dp);
+	dp->leaves = rte_zmalloc_socket(mem_name,
+		sizeof(uint32_t) * fib_conf->poptrie.num_leaves,
+		RTE_CACHE_LINE_SIZE, socket_id);
+	if (dp->leaves == NULL) {
+		rte_errno = ENOMEM;
+		rte_free(dp->nodes);
+		rte_free(dp);
+		return NULL;
+	}
+
+	pool_init(&dp->node_pool, fib_conf->poptrie.num_nodes);
+	pool_init(&dp->leaf_pool, fib_conf->poptrie.num_leaves);
+
+	return dp;
+}
+
+void
+poptrie_free(void *p)
+{
+	struct poptrie_tbl *dp = (struct poptrie_tbl *)p;
+
+	if (dp->dq != NULL)
+		rte_rcu_qsbr_dq_delete(dp->dq);
+	rte_free(dp->leaves);
+	rte_free(dp->nodes);
+	rte_free(dp);
+}
+
+int
+poptrie_rcu_qsbr_add(struct poptrie_tbl *dp, struct rte_fib_rcu_config *cfg,
+	const char *name)
+{
+	struct rte_rcu_qsbr_dq_parameters params = {0};
+	char rcu_dq_name[RTE_RCU_QSBR_DQ_NAMESIZE];
+
+	if (dp == NULL || cfg == NULL || cfg->v == NULL)
+		return -EINVAL;
+
+	if (dp->v != NULL)
+		return -EEXIST;
+
+	switch (cfg->mode) {
+	case RTE_FIB_QSBR_MODE_DQ:
+		/* Init QSBR defer queue. */
+		snprintf(rcu_dq_name, sizeof(rcu_dq_name),
+				"FIB_RCU_%s", name);
+		params.name = rcu_dq_name;
+		params.size = cfg->dq_size;
+		/* each released subtree holds at least its root node */
+		if (params.size == 0)
+			params.size = dp->node_pool.size;
+		params.trigger_reclaim_limit = cfg->reclaim_thd;
+		params.max_reclaim_size = cfg->reclaim_max;
+		if (params.max_reclaim_size == 0)
+			params.max_reclaim_size = RTE_FIB_RCU_DQ_RECLAIM_MAX;
+		params.esize = sizeof(uint32_t);	/* subtree root node */
+		params.free_fn = __rcu_qsbr_free_resource;
+		params.p = dp;
+		params.v = cfg->v;
+		dp->dq = rte_rcu_qsbr_dq_create(&params);
+		if (dp->dq == NULL)
+			return -rte_errno;
+		break;
+	case RTE_FIB_QSBR_MODE_SYNC:
+		/* No other things to do. */
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	dp->rcu_mode = cfg->mode;
+	dp->v = cfg->v;
+
+	return 0;
+}
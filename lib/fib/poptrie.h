@@ -0,0 +1,160 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 agent <agent@local>
+ */
+
+#ifndef _POPTRIE_H_
+#define _POPTRIE_H_
+
+#include <rte_prefetch.h>
+#include <rte_branch_prediction.h>
+
+struct rte_rib6;
+
+/**
+ * @file
+ * Poptrie algorithm
+ *
+ * Multibit trie whose nodes are compressed with population counts:
+ * a node keeps one bitmap of its child nodes and one bitmap of the starts
+ * of its runs of identical leaves, the children and leaves of a node being
+ * stored contiguously. The top POPTRIE_DIR_BITS bits of the address are
+ * resolved by a direct pointing array, one per VRF, the VRFs sharing the
+ * nodes and leaves.
+ */
+
+/* Number of address bits resolved by the direct pointing array */
+#define POPTRIE_DIR_BITS	16
+#define POPTRIE_DIR_NUM_ENT	(1 << POPTRIE_DIR_BITS)
+/* Number of address bits resolved by a node */
+#define POPTRIE_STRIDE		6
+#define POPTRIE_STRIDE_NUM_ENT	(1 << POPTRIE_STRIDE)
+/* Direct pointing entry pointing to a node, next hop otherwise */
+#define POPTRIE_NODE_ENT	(1U << 31)
+#define POPTRIE_MAX_NH		(POPTRIE_NODE_ENT - 1)
+
+struct poptrie_node {
+	uint64_t	vector;		/**< bitmap of the child nodes */
+	uint64_t	leafvec;	/**< bitmap of the leaf runs starts */
+	uint32_t	base0;		/**< index of the first leaf */
+	uint32_t	base1;		/**< index of the first child node */
+};
+
+/* Pool of contiguous blocks of up to POPTRIE_STRIDE_NUM_ENT elements */
+struct poptrie_pool {
+	uint32_t	size;		/**< Total number of elements */
+	uint32_t	top;		/**< First never allocated element */
+	uint32_t	used;		/**< Number of allocated elements */
+	/** First free block for each block size */
+	uint32_t	free[POPTRIE_STRIDE_NUM_ENT + 1];
+};
+
+struct poptrie_tbl {
+	uint32_t	def_nh;		/**< Default next hop */
+	uint32_t	num_vrfs;	/**< Number of VRFs */
+	struct poptrie_node	*nodes;	/**< nodes table */
+	uint32_t	*leaves;	/**< leaves table */
+	struct poptrie_pool	node_pool;
+	struct poptrie_pool	leaf_pool;
+	/* RCU config. */
+	enum rte_fib_qsbr_mode	rcu_mode;	/* Blocking, defer queue. */
+	struct rte_rcu_qsbr	*v;		/* RCU QSBR variable. */
+	struct rte_rcu_qsbr_dq	*dq;		/* RCU QSBR defer queue. */
+	/* direct pointing tables of all the VRFs */
+	__extension__ uint32_t	dir[0] __rte_cache_aligned;
+};
+
+static inline uint32_t
+poptrie_lookup(const struct poptrie_tbl *dp, uint16_t vrf_id, uint32_t ip)
+{
+	const struct poptrie_node *node;
+	uint64_t key = (uint64_t)ip << 32;
+	uint64_t bit, msk;
+	uint32_t ent;
+	unsigned int shift;
+
+	ent = dp->dir[((uint32_t)vrf_id << POPTRIE_DIR_BITS) |
+		(ip >> (32 - POPTRIE_DIR_BITS))];
+	if (likely((ent & POPTRIE_NODE_ENT) == 0))
+		return ent;
+
+	node = &dp->nodes[ent & ~POPTRIE_NODE_ENT];
+	/* the key is padded with zeros beyond the 32 bits of the address */
+	shift = 64 - POPTRIE_DIR_BITS - POPTRIE_STRIDE;
+	while (1) {
+		bit = 1ULL << ((key >> shift) & (POPTRIE_STRIDE_NUM_ENT - 1));
+		msk = (bit << 1) - 1;
+		if ((node->vector & bit) == 0)
+			return dp->leaves[node->base0 +
+				__builtin_popcountll(node->leafvec & msk) - 1];
+		node = &dp->nodes[node->base1 +
+			__builtin_popcountll(node->vector & msk) - 1];
+		shift -= POPTRIE_STRIDE;
+	}
+}
+
+static inline void
+poptrie_lookup_bulk(void *p, const uint32_t *ips,
+	uint64_t *next_hops, const unsigned int n)
+{
+	struct poptrie_tbl *dp = (struct poptrie_tbl *)p;
+	uint32_t i;
+	uint32_t prefetch_offset = RTE_MIN(15U, n);
+
+	for (i = 0; i < prefetch_offset; i++)
+		rte_prefetch0(&dp->dir[ips[i] >> (32 - POPTRIE_DIR_BITS)]);
+	for (i = 0; i < (n - prefetch_offset); i++) {
+		rte_prefetch0(&dp->dir[ips[i + prefetch_offset] >>
+			(32 - POPTRIE_DIR_BITS)]);
+		next_hops[i] = poptrie_lookup(dp, 0, ips[i]);
+	}
+	for (; i < n; i++)
+		next_hops[i] = poptrie_lookup(dp, 0, ips[i]);
+}
+
+static inline void
+poptrie_vrf_lookup_bulk(void *p, const uint16_t *vrf_ids, const uint32_t *ips,
+	uint64_t *next_hops, const unsigned int n)
+{
+	struct poptrie_tbl *dp = (struct poptrie_tbl *)p;
+	uint32_t i;
+	uint32_t prefetch_offset = RTE_MIN(15U, n);
+
+	for (i = 0; i < prefetch_offset; i++)
+		rte_prefetch0(&dp->dir[((uint32_t)vrf_ids[i] <<
+			POPTRIE_DIR_BITS) | (ips[i] >> (32 - POPTRIE_DIR_BITS))]);
+	for (i = 0; i < (n - prefetch_offset); i++) {
+		rte_prefetch0(&dp->dir[((uint32_t)vrf_ids[i + prefetch_offset] <<
+			POPTRIE_DIR_BITS) |
+			(ips[i + prefetch_offset] >> (32 - POPTRIE_DIR_BITS))]);
+		next_hops[i] = poptrie_lookup(dp, vrf_ids[i], ips[i]);
+	}
+	for (; i < n; i++)
+		next_hops[i] = poptrie_lookup(dp, vrf_ids[i], ips[i]);
+}
+
+void *
+poptrie_create(const char *name, int socket_id, struct rte_fib_conf *conf,
+	uint32_t num_vrfs);
+
+void
+poptrie_free(void *p);
+
+rte_fib_lookup_fn_t
+poptrie_get_lookup_fn(void *p, enum rte_fib_lookup_type type);
+
+rte_fib_vrf_lookup_fn_t
+poptrie_get_vrf_lookup_fn(void *p, enum rte_fib_lookup_type type);
+
+int
+poptrie_modify(struct rte_fib *fib, uint32_t ip, uint8_t depth,
+	uint64_t next_hop, int op);
+
+int
+poptrie_rcu_qsbr_add(struct poptrie_tbl *dp, struct rte_fib_rcu_config *cfg,
+	const char *name);
+
+int
+poptrie_vrf_modify(struct poptrie_tbl *dp, struct rte_rib6 *rib,
+	uint16_t vrf_id, uint32_t ip, uint8_t depth, uint64_t next_hop, int op);
+
+#endif /* _POPTRIE_H_ */
@@ -0,0 +1,111 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 agent <agent@local>
+ */
+
+#include <rte_vect.h>
+#include <rte_fib.h>
+
+#include "poptrie.h"
+#include "poptrie_avx512.h"
+
+static __rte_always_inline void
+poptrie_vec_lookup_x8(void *p, const uint16_t *vrf_ids, const uint32_t *ips,
+	uint64_t *next_hops)
+{
+	struct poptrie_tbl *dp = (struct poptrie_tbl *)p;
+	const __m512i zero = _mm512_set1_epi64(0);
+	const __m512i one = _mm512_set1_epi64(1);
+	const __m512i two = _mm512_set1_epi64(2);
+	const __m512i stride_msk = _mm512_set1_epi64(POPTRIE_STRIDE_NUM_ENT - 1);
+	const __m512i node_ent = _mm512_set1_epi64(POPTRIE_NODE_ENT);
+	const __m512i lo32_msk = _mm512_set1_epi64(UINT32_MAX);
+	__m512i ip_vec, key, res, node, off, vector, leafvec, bases;
+	__m512i bit, msk, idxes;
+	__m256i leaves;
+	__mmask8 msk_node, msk_child;
+	unsigned int shift;
+
+	ip_vec = _mm512_cvtepu32_epi64(_mm256_loadu_si256((const void *)ips));
+
+	/* lookup in the direct pointing table */
+	idxes = _mm512_srli_epi64(ip_vec, 32 - POPTRIE_DIR_BITS);
+	if (vrf_ids != NULL)
+		idxes = _mm512_or_si512(idxes, _mm512_slli_epi64(
+			_mm512_cvtepu16_epi64(_mm_loadu_si128(
+			(const void *)vrf_ids)), POPTRIE_DIR_BITS));
+	res = _mm512_cvtepu32_epi64(_mm512_i64gather_epi32(idxes,
+		(const int *)dp->dir, 4));
+	msk_node = _mm512_test_epi64_mask(res, node_ent);
+	node = _mm512_andnot_si512(node_ent, res);
+
+	/* the key is padded with zeros beyond the 32 bits of the address */
+	key = _mm512_slli_epi64(ip_vec, 32);
+	shift = 64 - POPTRIE_DIR_BITS - POPTRIE_STRIDE;
+
+	/* all the lanes still in the trie are at the same level */
+	while (msk_node != 0) {
+		/* nodes are 3 x 64 bits */
+		off = _mm512_add_epi64(node, _mm512_slli_epi64(node, 1));
+		vector = _mm512_mask_i64gather_epi64(zero, msk_node, off,
+			(const void *)&dp->nodes->vector, 8);
+		leafvec = _mm512_mask_i64gather_epi64(zero, msk_node, off,
+			(const void *)&dp->nodes->leafvec, 8);
+		bases = _mm512_mask_i64gather_epi64(zero, msk_node, off,
+			(const void *)&dp->nodes->base0, 8);
+
+		idxes = _mm512_and_si512(_mm512_srl_epi64(key,
+			_mm_cvtsi32_si128(shift)), stride_msk);
+		bit = _mm512_sllv_epi64(one, idxes);
+		msk = _mm512_sub_epi64(_mm512_sllv_epi64(two, idxes), one);
+
+		msk_child = _mm512_mask_test_epi64_mask(msk_node, vector, bit);
+
+		/* resolve the lanes ending on a leaf */
+		if (msk_child != msk_node) {
+			idxes = _mm512_popcnt_epi64(_mm512_and_si512(leafvec,
+				msk));
+			idxes = _mm512_add_epi64(_mm512_and_si512(bases,
+				lo32_msk), _mm512_sub_epi64(idxes, one));
+			leaves = _mm512_mask_i64gather_epi32(
+				_mm256_setzero_si256(), msk_node & ~msk_child,
+				idxes, (const int *)dp->leaves, 4);
+			res = _mm512_mask_blend_epi64(msk_node & ~msk_child,
+				res, _mm512_cvtepu32_epi64(leaves));
+		}
+
+		/* move down the other lanes */
+		idxes = _mm512_popcnt_epi64(_mm512_and_si512(vector, msk));
+		node = _mm512_add_epi64(_mm512_srli_epi64(bases, 32),
+			_mm512_sub_epi64(idxes, one));
+		msk_node = msk_child;
+		shift -= POPTRIE_STRIDE;
+	}
+
+	_mm512_storeu_si512(next_hops, res);
+}
+
+void
+rte_poptrie_vec_lookup_bulk(void *p, const uint32_t *ips,
+	uint64_t *next_hops, const unsigned int n)
+{
+	uint32_t i;
+
+	for (i = 0; i < (n / 8); i++)
+		poptrie_vec_lookup_x8(p, NULL, ips + i * 8, next_hops + i * 8);
+
+	poptrie_lookup_bulk(p, ips + i * 8, next_hops + i * 8, n - i * 8);
+}
+
+void
+rte_poptrie_vec_vrf_lookup_bulk(void *p, const uint16_t *vrf_ids,
+	const uint32_t *ips, uint64_t *next_hops, const unsigned int n)
+{
+	uint32_t i;
+
+	for (i = 0; i < (n / 8); i++)
+		poptrie_vec_lookup_x8(p, vrf_ids + i * 8, ips + i * 8,
+			next_hops + i * 8);
+
+	poptrie_vrf_lookup_bulk(p, vrf_ids + i * 8, ips + i * 8,
+		next_hops + i * 8, n - i * 8);
+}
@@ -15,9 +15,11 @@
 #include <rte_tailq.h>
 
 #include <rte_rib.h>
+#include <rte_rib6.h>
 #include <rte_fib.h>
 
 #include "dir24_8.h"
+#include "poptrie.h"
 
 TAILQ_HEAD(rte_fib_list, rte_tailq_entry);
 static struct rte_tailq_elem rte_fib_tailq = {
@@ -41,10 +43,14 @@ struct rte_fib {
 	char			name[RTE_FIB_NAMESIZE];
 	enum rte_fib_type	type;	/**< Type of FIB struct */
 	struct rte_rib		*rib;	/**< RIB helper datastruct */
+	/** RIB of a multi VRF FIB, keyed by VRF id and address */
+	struct rte_rib6		*vrf_rib;
 	void			*dp;	/**< pointer to the dataplane struct*/
 	rte_fib_lookup_fn_t	lookup;	/**< fib lookup function */
+	rte_fib_vrf_lookup_fn_t	vrf_lookup; /**< multi VRF lookup function */
 	rte_fib_modify_fn_t	modify; /**< modify fib datastruct */
 	uint64_t		def_nh;
+	uint32_t		max_vrfs;
 };
 
 static void
@@ -90,6 +96,27 @@ dummy_modify(struct rte_fib *fib, uint32_t ip, uint8_t depth,
 	return -EINVAL;
 }
 
+static int
+vrf_modify(struct rte_fib *fib, uint16_t vrf_id, uint32_t ip, uint8_t depth,
+	uint64_t next_hop, int op)
+{
+	switch (fib->type) {
+	case RTE_FIB_POPTRIE:
+		return poptrie_vrf_modify(fib->dp, fib->vrf_rib, vrf_id, ip,
+			depth, next_hop, op);
+	default:
+		return -EINVAL;
+	}
+}
+
+/* modify function of multi VRF FIBs, for the VRF 0 */
+static int
+vrf0_modify(struct rte_fib *fib, uint32_t ip, uint8_t depth,
+	uint64_t next_hop, int op)
+{
+	return vrf_modify(fib, 0, ip, depth, next_hop, op);
+}
+
 static int
 init_dataplane(struct rte_fib *fib, __rte_unused int socket_id,
 	struct rte_fib_conf *conf)
@@ -111,12 +138,87 @@ init_dataplane(struct rte_fib *fib, __rte_unused int socket_id,
 			RTE_FIB_LOOKUP_DEFAULT);
 		fib->modify = dir24_8_modify;
 		return 0;
+	case RTE_FIB_POPTRIE:
+		fib->dp = poptrie_create(dp_name, socket_id, conf,
+			fib->max_vrfs);
+		if (fib->dp == NULL)
+			return -rte_errno;
+		fib->lookup = poptrie_get_lookup_fn(fib->dp,
+			RTE_FIB_LOOKUP_DEFAULT);
+		fib->modify = poptrie_modify;
+		if (fib->vrf_rib != NULL) {
+			fib->vrf_lookup = poptrie_get_vrf_lookup_fn(fib->dp,
+				RTE_FIB_LOOKUP_DEFAULT);
+			fib->modify = vrf0_modify;
+		}
+		return 0;
 	default:
 		return -EINVAL;
 	}
 	return 0;
 }
 
+int
+rte_fib_rcu_qsbr_add(struct rte_fib *fib, struct rte_fib_rcu_config *cfg)
+{
+	if ((fib == NULL) || (cfg == NULL))
+		return -EINVAL;
+
+	switch (fib->type) {
+	case RTE_FIB_DIR24_8:
+		return dir24_8_rcu_qsbr_add(fib->dp, cfg, fib->name);
+	case RTE_FIB_POPTRIE:
+		return poptrie_rcu_qsbr_add(fib->dp, cfg, fib->name);
+	default:
+		return -ENOTSUP;
+	}
+}
+
+int
+rte_fib_txn_begin(struct rte_fib *fib)
+{
+	if (fib == NULL)
+		return -EINVAL;
+
+	switch (fib->type) {
+	case RTE_FIB_DIR24_8:
+		return dir24_8_txn_begin(fib->dp);
+	default:
+		return -ENOTSUP;
+	}
+}
+
+int
+rte_fib_txn_apply(struct rte_fib *fib, unsigned int part,
+	unsigned int nb_parts)
+{
+	if ((fib == NULL) || (nb_parts == 0) ||
+			(nb_parts > RTE_FIB_TXN_MAX_PARTS) ||
+			(part >= nb_parts))
+		return -EINVAL;
+
+	switch (fib->type) {
+	case RTE_FIB_DIR24_8:
+		return dir24_8_txn_apply(fib->dp, fib->rib, part, nb_parts);
+	default:
+		return -ENOTSUP;
+	}
+}
+
+int
+rte_fib_txn_commit(struct rte_fib *fib)
+{
+	if (fib == NULL)
+		return -EINVAL;
+
+	switch (fib->type) {
+	case RTE_FIB_DIR24_8:
+		return dir24_8_txn_commit(fib->dp, fib->rib);
+	default:
+		return -ENOTSUP;
+	}
+}
+
 int
 rte_fib_add(struct rte_fib *fib, uint32_t ip, uint8_t depth, uint64_t next_hop)
 {
@@ -146,32 +248,99 @@ rte_fib_lookup_bulk(struct rte_fib *fib, uint32_t *ips,
 	return 0;
 }
 
+int
+rte_fib_vrf_add(struct rte_fib *fib, uint16_t vrf_id, uint32_t ip,
+	uint8_t depth, uint64_t next_hop)
+{
+	if ((fib == NULL) || (fib->modify == NULL) ||
+			(vrf_id >= fib->max_vrfs) ||
+			(depth > RTE_FIB_MAXDEPTH))
+		return -EINVAL;
+	if (fib->vrf_rib == NULL)
+		return fib->modify(fib, ip, depth, next_hop, RTE_FIB_ADD);
+	return vrf_modify(fib, vrf_id, ip, depth, next_hop, RTE_FIB_ADD);
+}
+
+int
+rte_fib_vrf_delete(struct rte_fib *fib, uint16_t vrf_id, uint32_t ip,
+	uint8_t depth)
+{
+	if ((fib == NULL) || (fib->modify == NULL) ||
+			(vrf_id >= fib->max_vrfs) ||
+			(depth > RTE_FIB_MAXDEPTH))
+		return -EINVAL;
+	if (fib->vrf_rib == NULL)
+		return fib->modify(fib, ip, depth, 0, RTE_FIB_DEL);
+	return vrf_modify(fib, vrf_id, ip, depth, 0, RTE_FIB_DEL);
+}
+
+int
+rte_fib_vrf_lookup_bulk(struct rte_fib *fib, const uint16_t *vrf_ids,
+	const uint32_t *ips, uint64_t *next_hops, int n)
+{
+	FIB_RETURN_IF_TRUE(((fib == NULL) || (vrf_ids == NULL) ||
+		(ips == NULL) || (next_hops == NULL)), -EINVAL);
+
+	if (fib->vrf_lookup == NULL)
+		return -ENOTSUP;
+
+	fib->vrf_lookup(fib->dp, vrf_ids, ips, next_hops, n);
+	return 0;
+}
+
 struct rte_fib *
 rte_fib_create(const char *name, int socket_id, struct rte_fib_conf *conf)
+{
+	return rte_fib_vrf_create(name, socket_id, conf, 0);
+}
+
+struct rte_fib *
+rte_fib_vrf_create(const char *name, int socket_id, struct rte_fib_conf *conf,
+	uint32_t max_vrfs)
 {
 	char mem_name[RTE_FIB_NAMESIZE];
 	int ret;
 	struct rte_fib *fib = NULL;
 	struct rte_rib *rib = NULL;
+	struct rte_rib6 *vrf_rib = NULL;
 	struct rte_tailq_entry *te;
 	struct rte_fib_list *fib_list;
 	struct rte_rib_conf rib_conf;
+	struct rte_rib6_conf vrf_rib_conf;
 
 	/* Check user arguments. */
 	if ((name == NULL) || (conf == NULL) ||	(conf->max_routes < 0) ||
-			(conf->type > RTE_FIB_DIR24_8)) {
+			(conf->type > RTE_FIB_POPTRIE) ||
+			(max_vrfs > RTE_FIB_MAX_VRFS) ||
+			((max_vrfs > 1) &&
+			(conf->type != RTE_FIB_POPTRIE))) {
 		rte_errno = EINVAL;
 		return NULL;
 	}
 
-	rib_conf.ext_sz = conf->rib_ext_sz;
-	rib_conf.max_nodes = conf->max_routes * 2;
-
-	rib = rte_rib_create(name, socket_id, &rib_conf);
-	if (rib == NULL) {
-		RTE_LOG(ERR, LPM,
-			"Can not allocate RIB %s\n", name);
-		return NULL;
+	if (max_vrfs > 1) {
+		/* The routes of all the VRFs share one RIB, keyed by VRF id
+		 * followed by the address
+		 */
+		vrf_rib_conf.ext_sz = conf->rib_ext_sz;
+		vrf_rib_conf.max_nodes = conf->max_routes * 2;
+
+		vrf_rib = rte_rib6_create(name, socket_id, &vrf_rib_conf);
+		if (vrf_rib == NULL) {
+			RTE_LOG(ERR, LPM,
+				"Can not allocate RIB %s\n", name);
+			return NULL;
+		}
+	} else {
+		rib_conf.ext_sz = conf->rib_ext_sz;
+		rib_conf.max_nodes = conf->max_routes * 2;
+
+		rib = rte_rib_create(name, socket_id, &rib_conf);
+		if (rib == NULL) {
+			RTE_LOG(ERR, LPM,
+				"Can not allocate RIB %s\n", name);
+			return NULL;
+		}
 	}
 
 	snprintf(mem_name, sizeof(mem_name), "FIB_%s", name);
@@ -211,8 +380,10 @@ rte_fib_create(const char *name, int socket_id, struct rte_fib_conf *conf)
 
 	rte_strlcpy(fib->name, name, sizeof(fib->name));
 	fib->rib = rib;
+	fib->vrf_rib = vrf_rib;
 	fib->type = conf->type;
 	fib->def_nh = conf->default_nh;
+	fib->max_vrfs = RTE_MAX(max_vrfs, 1U);
 	ret = init_dataplane(fib, socket_id, conf);
 	if (ret < 0) {
 		RTE_LOG(ERR, LPM,
@@ -235,7 +406,10 @@ rte_fib_create(const char *name, int socket_id, struct rte_fib_conf *conf)
 	rte_free(te);
 exit:
 	rte_mcfg_tailq_write_unlock();
-	rte_rib_free(rib);
+	if (vrf_rib != NULL)
+		rte_rib6_free(vrf_rib);
+	else
+		rte_rib_free(rib);
 
 	return NULL;
 }
@@ -273,6 +447,10 @@ free_dataplane(struct rte_fib *fib)
 		return;
 	case RTE_FIB_DIR24_8:
 		dir24_8_free(fib->dp);
+		return;
+	case RTE_FIB_POPTRIE:
+		poptrie_free(fib->dp);
+		return;
 	default:
 		return;
 	}
@@ -302,7 +480,10 @@ rte_fib_free(struct rte_fib *fib)
 	rte_mcfg_tailq_write_unlock();
 
 	free_dataplane(fib);
-	rte_rib_free(fib->rib);
+	if (fib->vrf_rib != NULL)
+		rte_rib6_free(fib->vrf_rib);
+	else
+		rte_rib_free(fib->rib);
 	rte_free(fib);
 	rte_free(te);
 }
@@ -324,6 +505,7 @@ rte_fib_select_lookup(struct rte_fib *fib,
 	enum rte_fib_lookup_type type)
 {
 	rte_fib_lookup_fn_t fn;
+	rte_fib_vrf_lookup_fn_t vrf_fn;
 
 	switch (fib->type) {
 	case RTE_FIB_DIR24_8:
@@ -332,6 +514,18 @@ rte_fib_select_lookup(struct rte_fib *fib,
 			return -EINVAL;
 		fib->lookup = fn;
 		return 0;
+	case RTE_FIB_POPTRIE:
+		fn = poptrie_get_lookup_fn(fib->dp, type);
+		if (fn == NULL)
+			return -EINVAL;
+		if (fib->vrf_rib != NULL) {
+			vrf_fn = poptrie_get_vrf_lookup_fn(fib->dp, type);
+			if (vrf_fn == NULL)
+				return -EINVAL;
+			fib->vrf_lookup = vrf_fn;
+		}
+		fib->lookup = fn;
+		return 0;
 	default:
 		return -EINVAL;
 	}
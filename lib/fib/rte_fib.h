@@ -18,6 +18,7 @@
 #include <stdint.h>
 
 #include <rte_compat.h>
+#include <rte_rcu_qsbr.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -29,10 +30,28 @@ struct rte_rib;
 /** Maximum depth value possible for IPv4 FIB. */
 #define RTE_FIB_MAXDEPTH	32
 
+/** Maximum number of VRFs of a FIB. */
+#define RTE_FIB_MAX_VRFS	(UINT16_MAX + 1)
+
+/** Maximum number of parts of a batched update applied concurrently. */
+#define RTE_FIB_TXN_MAX_PARTS	256U
+
+/** @internal Default RCU defer queue entries to reclaim in one go. */
+#define RTE_FIB_RCU_DQ_RECLAIM_MAX	16
+
+/** RCU reclamation modes */
+enum rte_fib_qsbr_mode {
+	/** Create defer queue for reclaim. */
+	RTE_FIB_QSBR_MODE_DQ = 0,
+	/** Use blocking mode reclaim. No defer queue created. */
+	RTE_FIB_QSBR_MODE_SYNC
+};
+
 /** Type of FIB struct */
 enum rte_fib_type {
 	RTE_FIB_DUMMY,		/**< RIB tree based FIB */
-	RTE_FIB_DIR24_8		/**< DIR24_8 based FIB */
+	RTE_FIB_DIR24_8,	/**< DIR24_8 based FIB */
+	RTE_FIB_POPTRIE		/**< Poptrie based FIB */
 };
 
 /** Modify FIB function */
@@ -41,6 +60,9 @@ typedef int (*rte_fib_modify_fn_t)(struct rte_fib *fib, uint32_t ip,
 /** FIB bulk lookup function */
 typedef void (*rte_fib_lookup_fn_t)(void *fib, const uint32_t *ips,
 	uint64_t *next_hops, const unsigned int n);
+/** FIB bulk lookup function with a VRF per address */
+typedef void (*rte_fib_vrf_lookup_fn_t)(void *fib, const uint16_t *vrf_ids,
+	const uint32_t *ips, uint64_t *next_hops, const unsigned int n);
 
 enum rte_fib_op {
 	RTE_FIB_ADD,
@@ -70,8 +92,12 @@ enum rte_fib_lookup_type {
 	/**<
 	 * Unified lookup function for all next hop sizes
 	 */
-	RTE_FIB_LOOKUP_DIR24_8_VECTOR_AVX512
+	RTE_FIB_LOOKUP_DIR24_8_VECTOR_AVX512,
 	/**< Vector implementation using AVX512 */
+	RTE_FIB_LOOKUP_POPTRIE_SCALAR,
+	/**< Scalar Poptrie lookup function */
+	RTE_FIB_LOOKUP_POPTRIE_VECTOR_AVX512
+	/**< Vector Poptrie implementation using AVX512 */
 };
 
 /** FIB configuration structure */
@@ -87,9 +113,32 @@ struct rte_fib_conf {
 			enum rte_fib_dir24_8_nh_sz nh_sz;
 			uint32_t	num_tbl8;
 		} dir24_8;
+		struct {
+			/** Number of internal nodes */
+			uint32_t	num_nodes;
+			/** Number of leaves */
+			uint32_t	num_leaves;
+		} poptrie;
 	};
 };
 
+/** FIB RCU QSBR configuration structure. */
+struct rte_fib_rcu_config {
+	struct rte_rcu_qsbr *v;	/* RCU QSBR variable. */
+	/* Mode of RCU QSBR. RTE_FIB_QSBR_MODE_xxx
+	 * '0' for default: create defer queue for reclaim.
+	 */
+	enum rte_fib_qsbr_mode mode;
+	uint32_t dq_size;	/* RCU defer queue size.
+				 * default: number of tbl8s of the FIB,
+				 * number of nodes for POPTRIE.
+				 */
+	uint32_t reclaim_thd;	/* Threshold to trigger auto reclaim. */
+	uint32_t reclaim_max;	/* Max entries to reclaim in one go.
+				 * default: RTE_FIB_RCU_DQ_RECLAIM_MAX.
+				 */
+};
+
 /**
  * Create FIB
  *
@@ -106,6 +155,32 @@ struct rte_fib_conf {
 struct rte_fib *
 rte_fib_create(const char *name, int socket_id, struct rte_fib_conf *conf);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Create a FIB holding the routes of several VRFs.
+ * Multiple VRFs are only supported by RTE_FIB_POPTRIE FIBs, the max_routes
+ * routes of the configuration are then shared by all the VRFs.
+ *
+ * @param name
+ *  FIB name
+ * @param socket_id
+ *  NUMA socket ID for FIB table memory allocation
+ * @param conf
+ *  Structure containing the configuration
+ * @param max_vrfs
+ *  Number of VRFs, up to RTE_FIB_MAX_VRFS.
+ *  0 or 1 creates a single VRF FIB, like rte_fib_create().
+ * @return
+ *  Handle to the FIB object on success
+ *  NULL otherwise with rte_errno set to an appropriate values.
+ */
+__rte_experimental
+struct rte_fib *
+rte_fib_vrf_create(const char *name, int socket_id, struct rte_fib_conf *conf,
+	uint32_t max_vrfs);
+
 /**
  * Find an existing FIB object and return a pointer to it.
  *
@@ -130,6 +205,31 @@ rte_fib_find_existing(const char *name);
 void
 rte_fib_free(struct rte_fib *fib);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Associate RCU QSBR variable with a FIB object.
+ * The tbl8 groups, or the POPTRIE subtrees, freed by route updates are
+ * then reused only once the lookup threads reported a quiescent state, so
+ * the lookups don't need to be stopped during the updates.
+ * Only supported by RTE_FIB_DIR24_8 and RTE_FIB_POPTRIE FIBs.
+ *
+ * @param fib
+ *   FIB object handle
+ * @param cfg
+ *   RCU QSBR configuration
+ * @return
+ *   0 on success, negative value otherwise:
+ *   - -EINVAL - invalid pointer or mode
+ *   - -ENOTSUP - FIB type without memory to reclaim
+ *   - -EEXIST - already added QSBR
+ *   - -ENOMEM - memory allocation failure
+ */
+__rte_experimental
+int
+rte_fib_rcu_qsbr_add(struct rte_fib *fib, struct rte_fib_rcu_config *cfg);
+
 /**
  * Add a route to the FIB.
  *
@@ -162,6 +262,77 @@ rte_fib_add(struct rte_fib *fib, uint32_t ip, uint8_t depth, uint64_t next_hop);
 int
 rte_fib_delete(struct rte_fib *fib, uint32_t ip, uint8_t depth);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Start a batch of route updates.
+ * Until rte_fib_txn_commit(), rte_fib_add() and rte_fib_delete() only
+ * update the RIB and record the modified address ranges, the lookups keep
+ * using the routes in place before the batch. The commit then rewrites
+ * each modified range once from the RIB, however many updates hit it.
+ * Only supported by RTE_FIB_DIR24_8 FIBs.
+ *
+ * @param fib
+ *   FIB object handle
+ * @return
+ *   0 on success, negative value otherwise:
+ *   - -EINVAL - invalid pointer
+ *   - -ENOTSUP - FIB type without batched updates
+ *   - -EBUSY - a batch is already started
+ *   - -ENOMEM - memory allocation failure
+ */
+__rte_experimental
+int
+rte_fib_txn_begin(struct rte_fib *fib);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Apply part of the batched route updates to the FIB.
+ * The IPv4 address space is split into nb_parts ranges of consecutive /8
+ * prefixes, this applies the updates of the range number part.
+ * Distinct parts can be applied concurrently by several threads,
+ * no other FIB update may run meanwhile.
+ *
+ * @param fib
+ *   FIB object handle
+ * @param part
+ *   Index of the part to apply, lower than nb_parts
+ * @param nb_parts
+ *   Number of parts, up to RTE_FIB_TXN_MAX_PARTS
+ * @return
+ *   0 on success, negative value otherwise:
+ *   - -EINVAL - invalid parameters or no batch started
+ *   - -ENOTSUP - FIB type without batched updates
+ *   - -ENOSPC - not enough tbl8 groups, the part stays partially applied
+ */
+__rte_experimental
+int
+rte_fib_txn_apply(struct rte_fib *fib, unsigned int part,
+	unsigned int nb_parts);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Apply the remaining batched route updates and end the batch.
+ * On failure the batch stays started, so the commit can be retried,
+ * e.g. once some routes were deleted.
+ *
+ * @param fib
+ *   FIB object handle
+ * @return
+ *   0 on success, negative value otherwise:
+ *   - -EINVAL - invalid pointer or no batch started
+ *   - -ENOTSUP - FIB type without batched updates
+ *   - -ENOSPC - not enough tbl8 groups
+ */
+__rte_experimental
+int
+rte_fib_txn_commit(struct rte_fib *fib);
+
 /**
  * Lookup multiple IP addresses in the FIB.
  *
@@ -182,6 +353,83 @@ rte_fib_delete(struct rte_fib *fib, uint32_t ip, uint8_t depth);
 int
 rte_fib_lookup_bulk(struct rte_fib *fib, uint32_t *ips,
 		uint64_t *next_hops, int n);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Add a route to a VRF of the FIB.
+ * rte_fib_add() adds routes to the VRF 0.
+ *
+ * @param fib
+ *   FIB object handle
+ * @param vrf_id
+ *   VRF id, lower than the number of VRFs of the FIB
+ * @param ip
+ *   IPv4 prefix address to be added to the FIB
+ * @param depth
+ *   Prefix length
+ * @param next_hop
+ *   Next hop to be added to the FIB
+ * @return
+ *   0 on success, negative value otherwise
+ */
+__rte_experimental
+int
+rte_fib_vrf_add(struct rte_fib *fib, uint16_t vrf_id, uint32_t ip,
+	uint8_t depth, uint64_t next_hop);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Delete a route from a VRF of the FIB.
+ * rte_fib_delete() deletes routes from the VRF 0.
+ *
+ * @param fib
+ *   FIB object handle
+ * @param vrf_id
+ *   VRF id, lower than the number of VRFs of the FIB
+ * @param ip
+ *   IPv4 prefix address to be deleted from the FIB
+ * @param depth
+ *   Prefix length
+ * @return
+ *   0 on success, negative value otherwise
+ */
+__rte_experimental
+int
+rte_fib_vrf_delete(struct rte_fib *fib, uint16_t vrf_id, uint32_t ip,
+	uint8_t depth);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Lookup multiple IP addresses, each in its own VRF of the FIB.
+ * rte_fib_lookup_bulk() looks up the addresses in the VRF 0.
+ *
+ * @param fib
+ *   FIB object handle
+ * @param vrf_ids
+ *   Array of VRF ids, lower than the number of VRFs of the FIB
+ * @param ips
+ *   Array of IPs to be looked up in the FIB
+ * @param next_hops
+ *   Next hop of the most specific rule found for IP in its VRF.
+ *   This is an array of eight byte values.
+ *   If the lookup for the given IP failed, then corresponding element would
+ *   contain default nexthop value configured for a FIB.
+ * @param n
+ *   Number of elements in vrf_ids, ips (and next_hops) array to lookup.
+ *  @return
+ *   -EINVAL for incorrect arguments, -ENOTSUP for a single VRF FIB,
+ *   otherwise 0
+ */
+__rte_experimental
+int
+rte_fib_vrf_lookup_bulk(struct rte_fib *fib, const uint16_t *vrf_ids,
+	const uint32_t *ips, uint64_t *next_hops, int n);
 /**
  * Get pointer to the dataplane specific struct
  *
@@ -197,6 +445,9 @@ rte_fib_get_dp(struct rte_fib *fib);
 /**
  * Get pointer to the RIB
  *
+ * The routes of a multi VRF FIB are not kept in an IPv4 RIB,
+ * NULL is returned for such a FIB.
+ *
  * @param fib
  *   FIB object handle
  * @return
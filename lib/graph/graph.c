@@ -354,6 +354,165 @@ rte_graph_create(const char *name, struct rte_graph_param *prm)
 	return RTE_GRAPH_ID_INVALID;
 }
 
+static int
+graph_clone_name(struct graph *graph, struct graph *parent_graph,
+		 const char *name)
+{
+	ssize_t sz, rc;
+
+#define SZ RTE_GRAPH_NAMESIZE
+	rc = rte_strscpy(graph->name, parent_graph->name, SZ);
+	if (rc < 0)
+		goto fail;
+	sz = rc;
+	rc = rte_strscpy(graph->name + sz, "-", RTE_MAX((int16_t)(SZ - sz), 0));
+	if (rc < 0)
+		goto fail;
+	sz += rc;
+	sz = rte_strscpy(graph->name + sz, name, RTE_MAX((int16_t)(SZ - sz), 0));
+	if (sz < 0)
+		goto fail;
+
+	return 0;
+fail:
+	rte_errno = E2BIG;
+	return -rte_errno;
+}
+
+static int
+graph_clone_layout_check(struct graph *graph, struct graph *parent_graph)
+{
+	struct rte_node *node, *parent_node;
+	rte_graph_off_t off;
+	rte_node_t count;
+
+	/* Streams are scheduled across the graphs by node offset */
+	if (graph->mem_sz != parent_graph->mem_sz)
+		SET_ERR_JMP(EINVAL, fail, "Graph %s nodes edges changed",
+			    parent_graph->name);
+
+	rte_graph_foreach_node(count, off, graph->graph, node) {
+		parent_node = RTE_PTR_ADD(parent_graph->graph, off);
+		if (node->id != parent_node->id)
+			SET_ERR_JMP(EINVAL, fail, "Node %s edges changed",
+				    node->name);
+	}
+
+	return 0;
+fail:
+	return -rte_errno;
+}
+
+static rte_graph_t
+graph_clone(struct graph *parent_graph, const char *name)
+{
+	struct graph_node *graph_node;
+	struct graph *graph, *tmp;
+
+	/* Don't allow to clone a graph from a cloned graph */
+	if (parent_graph->graph->parent_id != RTE_GRAPH_ID_INVALID)
+		SET_ERR_JMP(EEXIST, fail, "Graph %s is a clone",
+			    parent_graph->name);
+
+	/* Create graph object */
+	graph = calloc(1, sizeof(*graph));
+	if (graph == NULL)
+		SET_ERR_JMP(ENOMEM, fail, "Failed to calloc graph object");
+
+	/* Naming ceremony of the new graph. name is parent name + "-" + name */
+	STAILQ_INIT(&graph->node_list);
+	if (graph_clone_name(graph, parent_graph, name))
+		SET_ERR_JMP(E2BIG, free, "Too big name=%s", name);
+
+	/* Check for existence of duplicate graph */
+	STAILQ_FOREACH(tmp, &graph_list, next)
+		if (strncmp(graph->name, tmp->name, RTE_GRAPH_NAMESIZE) == 0)
+			SET_ERR_JMP(EEXIST, free, "Found duplicate graph %s",
+				    graph->name);
+
+	/* Add the nodes in the parent order to get the same node layout */
+	STAILQ_FOREACH(graph_node, &parent_graph->node_list, next)
+		if (graph_node_add(graph, graph_node->node))
+			goto graph_cleanup;
+
+	/* Update adjacency list of all nodes in the graph */
+	if (graph_adjacency_list_update(graph))
+		goto graph_cleanup;
+
+	/* Initialize graph object */
+	graph->socket = parent_graph->socket;
+	graph->src_node_count = parent_graph->src_node_count;
+	graph->node_count = parent_graph->node_count;
+	graph->id = graph_id;
+
+	/* Allocate the Graph fast path memory and populate the data */
+	if (graph_fp_mem_create(graph))
+		goto graph_cleanup;
+
+	if (graph_clone_layout_check(graph, parent_graph))
+		goto graph_mem_destroy;
+
+	/* Share the run queue of the parent graph */
+	graph->graph->parent_id = parent_graph->id;
+	graph->graph->model = parent_graph->graph->model;
+	graph->graph->hist = parent_graph->graph->hist;
+	graph->graph->rq = parent_graph->graph->rq;
+
+	/* Call init() of the all the nodes in the graph */
+	if (graph_node_init(graph))
+		goto graph_mem_destroy;
+
+	/* All good, Lets add the graph to the list */
+	graph_id++;
+	STAILQ_INSERT_TAIL(&graph_list, graph, next);
+
+	return graph->id;
+
+graph_mem_destroy:
+	graph_fp_mem_destroy(graph);
+graph_cleanup:
+	graph_cleanup(graph);
+free:
+	free(graph);
+fail:
+	return RTE_GRAPH_ID_INVALID;
+}
+
+rte_graph_t
+rte_graph_clone(rte_graph_t id, const char *name)
+{
+	rte_graph_t rc = RTE_GRAPH_ID_INVALID;
+	struct graph *graph;
+
+	graph_spinlock_lock();
+
+	GRAPH_ID_CHECK(id);
+	if (name == NULL)
+		SET_ERR_JMP(EINVAL, fail, "Graph name should not be NULL");
+
+	STAILQ_FOREACH(graph, &graph_list, next)
+		if (graph->id == id) {
+			rc = graph_clone(graph, name);
+			break;
+		}
+fail:
+	graph_spinlock_unlock();
+	return rc;
+}
+
+static bool
+graph_has_clone(struct graph *parent_graph)
+{
+	struct graph *graph;
+
+	STAILQ_FOREACH(graph, &graph_list, next)
+		if (graph != parent_graph &&
+		    graph->graph->rq == &parent_graph->graph->rq_head)
+			return true;
+
+	return false;
+}
+
 int
 rte_graph_destroy(rte_graph_t id)
 {
@@ -366,6 +525,14 @@ rte_graph_destroy(rte_graph_t id)
 	while (graph != NULL) {
 		tmp = STAILQ_NEXT(graph, next);
 		if (graph->id == id) {
+			/* Clones share the run queue of the parent graph */
+			if (graph_has_clone(graph)) {
+				rc = -EBUSY;
+				SET_ERR_JMP(EBUSY, done, "Graph %s has clones",
+					    graph->name);
+			}
+			/* Unbind the graph from its lcore in dispatch model */
+			graph_sched_wq_destroy(graph);
 			/* Call fini() of the all the nodes in the graph */
 			graph_node_fini(graph);
 			/* Destroy graph fast path memory */
@@ -457,6 +624,50 @@ rte_graph_node_get_by_name(const char *graph_name, const char *node_name)
 	return NULL;
 }
 
+int
+rte_node_coalesce_set(const char *name, uint16_t nb_objs, uint64_t cycles)
+{
+	struct rte_node *graph_node;
+	struct graph *graph;
+	rte_graph_off_t off;
+	struct node *node;
+	rte_node_t count;
+	int rc = -EINVAL;
+
+	if (name == NULL || nb_objs > RTE_GRAPH_BURST_SIZE)
+		SET_ERR_JMP(EINVAL, fail, "Invalid node or objs %u", nb_objs);
+
+	graph_spinlock_lock();
+
+	node = node_from_name(name);
+	if (node == NULL || (node->flags & RTE_NODE_SOURCE_F))
+		goto unlock;
+
+	node->coalesce_objs = nb_objs;
+	node->coalesce_cycles = cycles;
+	STAILQ_FOREACH(graph, &graph_list, next) {
+		graph->graph->coalesce = false;
+		rte_graph_foreach_node(count, off, graph->graph, graph_node) {
+			if (!strncmp(graph_node->name, name,
+				     RTE_NODE_NAMESIZE)) {
+				graph_node->coalesce_objs = nb_objs;
+				graph_node->coalesce_cycles = cycles;
+				graph_node->coalesce_start = 0;
+			}
+			/* Walk with the coalescing policies if any */
+			if (graph_node->coalesce_objs)
+				graph->graph->coalesce = true;
+		}
+	}
+	rc = 0;
+
+unlock:
+	graph_spinlock_unlock();
+	return rc;
+fail:
+	return -rte_errno;
+}
+
 void __rte_noinline
 __rte_node_stream_alloc(struct rte_graph *graph, struct rte_node *node)
 {
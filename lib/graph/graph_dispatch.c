@@ -0,0 +1,294 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 agent <agent@local>
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_errno.h>
+#include <rte_lcore.h>
+#include <rte_mempool.h>
+#include <rte_ring.h>
+
+#include "graph_private.h"
+
+/* Work queue entries per node of the graph */
+#define GRAPH_SCHED_WQ_SIZE_MULTIPLIER 8
+#define GRAPH_SCHED_WQ_SIZE(nb_nodes)                                          \
+	rte_align32pow2((nb_nodes) * GRAPH_SCHED_WQ_SIZE_MULTIPLIER)
+#define GRAPH_SCHED_WQ_CACHE_SIZE(size)                                        \
+	RTE_MIN((unsigned int)RTE_MEMPOOL_CACHE_MAX_SIZE, (size) / 4)
+/* Work queue entries moved to the pending streams per walk */
+#define GRAPH_SCHED_WQ_BURST 32
+
+/**
+ * @internal
+ *
+ * Work queue entry holding a part of the stream of a node scheduled to the
+ * graph of another lcore.
+ */
+struct graph_sched_wq_node {
+	rte_graph_off_t node_off; /**< Offset of the node in the graph reel. */
+	uint16_t nb_objs;	  /**< Number of objects. */
+	void *objs[RTE_GRAPH_BURST_SIZE]; /**< Array of object pointers. */
+} __rte_cache_aligned;
+
+static struct graph *
+graph_from_id(rte_graph_t id)
+{
+	struct graph *graph;
+
+	STAILQ_FOREACH(graph, graph_list_head_get(), next)
+		if (graph->id == id)
+			return graph;
+
+	return NULL;
+}
+
+static int
+graph_sched_wq_create(struct graph *_graph)
+{
+	struct rte_graph *graph = _graph->graph;
+	char name[RTE_MEMPOOL_NAMESIZE];
+	unsigned int wq_size, cache_size;
+
+	wq_size = GRAPH_SCHED_WQ_SIZE(_graph->node_count);
+	cache_size = GRAPH_SCHED_WQ_CACHE_SIZE(wq_size);
+
+	/* The graph memory address is unique amongst the existing graphs */
+	snprintf(name, sizeof(name), "gwq_%p", graph);
+	graph->wq = rte_ring_create(name, wq_size, _graph->socket,
+				    RING_F_SC_DEQ | RING_F_EXACT_SZ);
+	if (graph->wq == NULL)
+		SET_ERR_JMP(ENOMEM, fail, "Failed to create work queue %s",
+			    name);
+
+	/* The entries held in the lcore caches must not starve the work
+	 * queue.
+	 */
+	snprintf(name, sizeof(name), "gmp_%p", graph);
+	graph->mp = rte_mempool_create(name,
+				       wq_size + rte_lcore_count() * cache_size,
+				       sizeof(struct graph_sched_wq_node),
+				       cache_size, 0,
+				       NULL, NULL, NULL, NULL, _graph->socket,
+				       0);
+	if (graph->mp == NULL)
+		SET_ERR_JMP(ENOMEM, wq_free, "Failed to create mempool %s",
+			    name);
+
+	return 0;
+wq_free:
+	rte_ring_free(graph->wq);
+	graph->wq = NULL;
+fail:
+	return -rte_errno;
+}
+
+void
+graph_sched_wq_destroy(struct graph *_graph)
+{
+	struct rte_graph *graph = _graph->graph;
+
+	if (graph == NULL || graph->wq == NULL)
+		return;
+
+	SLIST_REMOVE(graph->rq, graph, rte_graph, rq_next);
+	graph->lcore_id = RTE_MAX_LCORE;
+	rte_ring_free(graph->wq);
+	graph->wq = NULL;
+	rte_mempool_free(graph->mp);
+	graph->mp = NULL;
+}
+
+int
+rte_graph_worker_model_set(rte_graph_t id, uint8_t model)
+{
+	struct graph *graph;
+	int rc = -EINVAL;
+
+	if (model != RTE_GRAPH_MODEL_RTC && model != RTE_GRAPH_MODEL_DISPATCH)
+		SET_ERR_JMP(EINVAL, fail, "Invalid model %u", model);
+
+	graph_spinlock_lock();
+	graph = graph_from_id(id);
+	if (graph != NULL) {
+		graph->graph->model = model;
+		rc = 0;
+	}
+	graph_spinlock_unlock();
+
+	return rc;
+fail:
+	return -rte_errno;
+}
+
+int
+rte_graph_model_dispatch_core_bind(rte_graph_t id, int lcore)
+{
+	struct rte_graph *tmp;
+	struct graph *graph;
+	int rc = -EINVAL;
+
+	if (lcore < 0 || lcore >= RTE_MAX_LCORE ||
+	    !rte_lcore_is_enabled(lcore))
+		SET_ERR_JMP(EINVAL, fail, "Invalid lcore %d", lcore);
+
+	graph_spinlock_lock();
+
+	graph = graph_from_id(id);
+	if (graph == NULL)
+		goto unlock;
+
+	SLIST_FOREACH(tmp, graph->graph->rq, rq_next)
+		if (tmp != graph->graph && tmp->lcore_id == (unsigned int)lcore) {
+			rc = -EEXIST;
+			graph_err("Graph %s already bound to lcore %d",
+				  tmp->name, lcore);
+			goto unlock;
+		}
+
+	/* Rebind the graph if it is already bound */
+	graph_sched_wq_destroy(graph);
+	rc = graph_sched_wq_create(graph);
+	if (rc)
+		goto unlock;
+
+	graph->graph->lcore_id = lcore;
+	SLIST_INSERT_HEAD(graph->graph->rq, graph->graph, rq_next);
+
+unlock:
+	graph_spinlock_unlock();
+	return rc;
+fail:
+	return -rte_errno;
+}
+
+void
+rte_graph_model_dispatch_core_unbind(rte_graph_t id)
+{
+	struct graph *graph;
+
+	graph_spinlock_lock();
+	graph = graph_from_id(id);
+	if (graph != NULL)
+		graph_sched_wq_destroy(graph);
+	graph_spinlock_unlock();
+}
+
+int
+rte_graph_model_dispatch_lcore_affinity_set(const char *name,
+					    unsigned int lcore_id)
+{
+	struct rte_node *graph_node;
+	struct graph *graph;
+	struct node *node;
+	int rc = -EINVAL;
+
+	if (name == NULL || lcore_id > RTE_MAX_LCORE ||
+	    (lcore_id != RTE_MAX_LCORE && !rte_lcore_is_enabled(lcore_id)))
+		SET_ERR_JMP(EINVAL, fail, "Invalid node or lcore %u", lcore_id);
+
+	graph_spinlock_lock();
+
+	node = node_from_name(name);
+	if (node == NULL)
+		goto unlock;
+
+	node->lcore_id = lcore_id;
+	STAILQ_FOREACH(graph, graph_list_head_get(), next) {
+		graph_node = graph_node_name_to_ptr(graph->graph, name);
+		if (graph_node != NULL)
+			graph_node->lcore_id = lcore_id;
+	}
+	rc = 0;
+
+unlock:
+	graph_spinlock_unlock();
+	return rc;
+fail:
+	return -rte_errno;
+}
+
+static bool
+graph_sched_node_enqueue(struct rte_node *node, struct rte_graph *graph)
+{
+	struct graph_sched_wq_node *wq_node;
+	uint16_t off = 0, size;
+
+	while (off < node->idx) {
+		size = RTE_MIN(node->idx - off, RTE_GRAPH_BURST_SIZE);
+		if (rte_mempool_get(graph->mp, (void **)&wq_node) < 0)
+			goto fail;
+
+		wq_node->node_off = node->off;
+		wq_node->nb_objs = size;
+		rte_memcpy(wq_node->objs, &node->objs[off],
+			   size * sizeof(void *));
+		if (rte_ring_mp_enqueue(graph->wq, wq_node) < 0) {
+			rte_mempool_put(graph->mp, wq_node);
+			goto fail;
+		}
+		off += size;
+	}
+
+	node->total_sched_objs += off;
+	node->idx = 0;
+	return true;
+
+fail:
+	/* Keep the objects not scheduled for the local processing */
+	node->total_sched_objs += off;
+	node->total_sched_fail += node->idx - off;
+	if (off != 0)
+		memmove(node->objs, &node->objs[off],
+			(node->idx - off) * sizeof(void *));
+	node->idx -= off;
+	return false;
+}
+
+bool __rte_noinline
+__rte_graph_sched_node_enqueue(struct rte_node *node,
+			       struct rte_graph_rq_head *rq)
+{
+	struct rte_graph *graph;
+
+	SLIST_FOREACH(graph, rq, rq_next)
+		if (graph->lcore_id == node->lcore_id)
+			return graph_sched_node_enqueue(node, graph);
+
+	/* No graph bound to the lcore, process the stream locally */
+	return false;
+}
+
+void __rte_noinline
+__rte_graph_sched_wq_process(struct rte_graph *graph)
+{
+	struct graph_sched_wq_node *wq_nodes[GRAPH_SCHED_WQ_BURST];
+	struct graph_sched_wq_node *wq_node;
+	struct rte_node *node;
+	unsigned int i, n;
+	uint16_t idx;
+
+	n = rte_ring_sc_dequeue_burst(graph->wq, (void **)wq_nodes,
+				      RTE_DIM(wq_nodes), NULL);
+	if (n == 0)
+		return;
+
+	for (i = 0; i < n; i++) {
+		wq_node = wq_nodes[i];
+		node = RTE_PTR_ADD(graph, wq_node->node_off);
+		RTE_ASSERT(node->fence == RTE_GRAPH_FENCE);
+		idx = node->idx;
+
+		__rte_node_enqueue_prologue(graph, node, idx, wq_node->nb_objs);
+
+		rte_memcpy(&node->objs[idx], wq_node->objs,
+			   wq_node->nb_objs * sizeof(void *));
+		node->idx = idx + wq_node->nb_objs;
+	}
+
+	rte_mempool_put_bulk(graph->mp, (void **)wq_nodes, n);
+}
@@ -58,6 +58,16 @@ graph_header_popluate(struct graph *_graph)
 	graph->nodes_start = _graph->nodes_start;
 	graph->socket = _graph->socket;
 	graph->id = _graph->id;
+	graph->model = RTE_GRAPH_MODEL_RTC;
+	graph->hist = false;
+	graph->coalesce = false;
+	graph->defer_head = 0;
+	graph->parent_id = RTE_GRAPH_ID_INVALID;
+	graph->lcore_id = RTE_MAX_LCORE;
+	graph->wq = NULL;
+	graph->mp = NULL;
+	SLIST_INIT(&graph->rq_head);
+	graph->rq = &graph->rq_head;
 	memcpy(graph->name, _graph->name, RTE_GRAPH_NAMESIZE);
 	graph->fence = RTE_GRAPH_FENCE;
 }
@@ -86,6 +96,11 @@ graph_nodes_populate(struct graph *_graph)
 		}
 		node->id = graph_node->node->id;
 		node->parent_id = pid;
+		node->lcore_id = graph_node->node->lcore_id;
+		node->coalesce_objs = graph_node->node->coalesce_objs;
+		node->coalesce_cycles = graph_node->node->coalesce_cycles;
+		if (node->coalesce_objs)
+			graph->coalesce = true;
 		nb_edges = graph_node->node->nb_edges;
 		node->nb_edges = nb_edges;
 		off += sizeof(struct rte_node);
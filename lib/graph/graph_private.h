@@ -55,6 +55,9 @@ struct node {
 	rte_node_t id;		      /**< Allocated identifier for the node. */
 	rte_node_t parent_id;	      /**< Parent node identifier. */
 	rte_edge_t nb_edges;	      /**< Number of edges from this node. */
+	unsigned int lcore_id;	      /**< Lcore affinity in dispatch model. */
+	uint16_t coalesce_objs;	      /**< Objects to accumulate, 0 if none. */
+	uint64_t coalesce_cycles;     /**< Cycles a stream may be deferred for. */
 	char next_nodes[][RTE_NODE_NAMESIZE]; /**< Names of next nodes. */
 };
 
@@ -286,6 +289,18 @@ int graph_fp_mem_create(struct graph *graph);
  */
 int graph_fp_mem_destroy(struct graph *graph);
 
+/* Dispatch model functions */
+
+/**
+ * @internal
+ *
+ * Unbind the graph from its lcore and free its work queue.
+ *
+ * @param graph
+ *   Pointer to the internal graph object.
+ */
+void graph_sched_wq_destroy(struct graph *graph);
+
 /* Lookup functions */
 /**
  * @internal
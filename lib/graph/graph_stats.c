@@ -8,6 +8,7 @@
 #include <rte_common.h>
 #include <rte_errno.h>
 #include <rte_malloc.h>
+#include <rte_telemetry.h>
 
 #include "graph_private.h"
 
@@ -82,6 +83,44 @@ print_node(FILE *f, const struct rte_graph_cluster_node_stats *stat)
 		objs_per_sec, cycles_per_call);
 }
 
+static inline uint64_t
+hist_bucket_min(unsigned int bucket)
+{
+	return bucket ? UINT64_C(1) << (bucket - 1) : 0;
+}
+
+static inline void
+print_hist(FILE *f, const char *name, const uint64_t *hist,
+	   unsigned int nb_buckets)
+{
+	unsigned int i;
+
+	fprintf(f, "|  %-29s|", name);
+	for (i = 0; i < nb_buckets; i++)
+		if (hist[i])
+			fprintf(f, " %" PRIu64 "%s:%" PRIu64,
+				hist_bucket_min(i),
+				i == nb_buckets - 1 ? "+" : "", hist[i]);
+	fprintf(f, "\n");
+}
+
+static inline void
+print_node_hist(FILE *f, const struct rte_graph_cluster_node_stats *stat)
+{
+	unsigned int i;
+
+	for (i = 0; i < RTE_GRAPH_HIST_OBJS_BUCKETS; i++)
+		if (stat->hist_objs[i])
+			break;
+	if (i == RTE_GRAPH_HIST_OBJS_BUCKETS)
+		return;
+
+	print_hist(f, "objs/call", stat->hist_objs,
+		   RTE_GRAPH_HIST_OBJS_BUCKETS);
+	print_hist(f, "cycles/obj", stat->hist_cycles,
+		   RTE_GRAPH_HIST_CYCLES_BUCKETS);
+}
+
 static int
 graph_cluster_stats_cb(bool is_first, bool is_last, void *cookie,
 		       const struct rte_graph_cluster_node_stats *stat)
@@ -90,8 +129,10 @@ graph_cluster_stats_cb(bool is_first, bool is_last, void *cookie,
 
 	if (unlikely(is_first))
 		print_banner(f);
-	if (stat->objs)
+	if (stat->objs) {
 		print_node(f, stat);
+		print_node_hist(f, stat);
+	}
 	if (unlikely(is_last))
 		boarder();
 
@@ -335,7 +376,10 @@ cluster_node_arregate_stats(struct cluster_node *cluster)
 	struct rte_graph_cluster_node_stats *stat = &cluster->stat;
 	struct rte_node *node;
 	rte_node_t count;
+	unsigned int i;
 
+	memset(stat->hist_objs, 0, sizeof(stat->hist_objs));
+	memset(stat->hist_cycles, 0, sizeof(stat->hist_cycles));
 	for (count = 0; count < cluster->nb_nodes; count++) {
 		node = cluster->nodes[count];
 
@@ -343,6 +387,10 @@ cluster_node_arregate_stats(struct cluster_node *cluster)
 		objs += node->total_objs;
 		cycles += node->total_cycles;
 		realloc_count += node->realloc_count;
+		for (i = 0; i < RTE_GRAPH_HIST_OBJS_BUCKETS; i++)
+			stat->hist_objs[i] += node->hist_objs[i];
+		for (i = 0; i < RTE_GRAPH_HIST_CYCLES_BUCKETS; i++)
+			stat->hist_cycles[i] += node->hist_cycles[i];
 	}
 
 	stat->calls = calls;
@@ -404,6 +452,154 @@ rte_graph_cluster_stats_reset(struct rte_graph_cluster_stats *stat)
 		node->prev_objs = 0;
 		node->prev_cycles = 0;
 		node->realloc_count = 0;
+		memset(node->hist_objs, 0, sizeof(node->hist_objs));
+		memset(node->hist_cycles, 0, sizeof(node->hist_cycles));
 		cluster = RTE_PTR_ADD(cluster, stat->cluster_node_size);
 	}
 }
+
+int
+rte_graph_stats_hist_enable(rte_graph_t id, bool enable)
+{
+	struct graph *graph;
+	int rc = -EINVAL;
+
+	if (!rte_graph_has_stats_feature())
+		SET_ERR_JMP(ENOTSUP, fail, "Stats feature is not enabled");
+
+	graph_spinlock_lock();
+	STAILQ_FOREACH(graph, graph_list_head_get(), next)
+		if (graph->id == id) {
+			graph->graph->hist = enable;
+			rc = 0;
+			break;
+		}
+	graph_spinlock_unlock();
+
+	return rc;
+fail:
+	return -rte_errno;
+}
+
+static struct graph *
+graph_from_tel_name(const char *name)
+{
+	struct graph *graph;
+
+	STAILQ_FOREACH(graph, graph_list_head_get(), next)
+		if (strncmp(graph->name, name, RTE_GRAPH_NAMESIZE) == 0)
+			return graph;
+
+	return NULL;
+}
+
+static void
+graph_tel_add_hist(struct rte_tel_data *d, const char *name,
+		   const uint64_t *hist, unsigned int nb_buckets)
+{
+	struct rte_tel_data *h = rte_tel_data_alloc();
+	unsigned int i;
+
+	if (h == NULL)
+		return;
+
+	rte_tel_data_start_array(h, RTE_TEL_U64_VAL);
+	for (i = 0; i < nb_buckets; i++)
+		rte_tel_data_add_array_u64(h, hist[i]);
+	rte_tel_data_add_dict_container(d, name, h, 0);
+}
+
+static int
+graph_handle_list(const char *cmd __rte_unused, const char *params __rte_unused,
+		  struct rte_tel_data *d)
+{
+	struct graph *graph;
+
+	rte_tel_data_start_array(d, RTE_TEL_STRING_VAL);
+	graph_spinlock_lock();
+	STAILQ_FOREACH(graph, graph_list_head_get(), next)
+		rte_tel_data_add_array_string(d, graph->name);
+	graph_spinlock_unlock();
+
+	return 0;
+}
+
+static int
+graph_handle_node_list(const char *cmd __rte_unused, const char *params,
+		       struct rte_tel_data *d)
+{
+	struct graph_node *graph_node;
+	struct graph *graph;
+	int rc = -EINVAL;
+
+	if (params == NULL || strlen(params) == 0)
+		return -EINVAL;
+
+	graph_spinlock_lock();
+	graph = graph_from_tel_name(params);
+	if (graph != NULL) {
+		rte_tel_data_start_array(d, RTE_TEL_STRING_VAL);
+		STAILQ_FOREACH(graph_node, &graph->node_list, next)
+			rte_tel_data_add_array_string(d,
+						      graph_node->node->name);
+		rc = 0;
+	}
+	graph_spinlock_unlock();
+
+	return rc;
+}
+
+static int
+graph_handle_node_stats(const char *cmd __rte_unused, const char *params,
+			struct rte_tel_data *d)
+{
+	char name[RTE_GRAPH_NAMESIZE];
+	const char *node_name;
+	struct rte_node *node;
+	struct graph *graph;
+	int rc = -EINVAL;
+
+	if (params == NULL)
+		return -EINVAL;
+
+	node_name = strchr(params, ',');
+	if (node_name == NULL || node_name == params ||
+	    (size_t)(node_name - params) >= sizeof(name))
+		return -EINVAL;
+	memcpy(name, params, node_name - params);
+	name[node_name - params] = '\0';
+	node_name++;
+
+	graph_spinlock_lock();
+	graph = graph_from_tel_name(name);
+	if (graph == NULL)
+		goto unlock;
+	node = graph_node_name_to_ptr(graph->graph, node_name);
+	if (node == NULL)
+		goto unlock;
+
+	rte_tel_data_start_dict(d);
+	rte_tel_data_add_dict_u64(d, "calls", node->total_calls);
+	rte_tel_data_add_dict_u64(d, "objs", node->total_objs);
+	rte_tel_data_add_dict_u64(d, "cycles", node->total_cycles);
+	rte_tel_data_add_dict_u64(d, "realloc_count", node->realloc_count);
+	graph_tel_add_hist(d, "objs_per_call_hist", node->hist_objs,
+			   RTE_GRAPH_HIST_OBJS_BUCKETS);
+	graph_tel_add_hist(d, "cycles_per_obj_hist", node->hist_cycles,
+			   RTE_GRAPH_HIST_CYCLES_BUCKETS);
+	rc = 0;
+
+unlock:
+	graph_spinlock_unlock();
+	return rc;
+}
+
+RTE_INIT(graph_init_telemetry)
+{
+	rte_telemetry_register_cmd("/graph/list", graph_handle_list,
+		"Returns list of available graphs. Takes no parameters");
+	rte_telemetry_register_cmd("/graph/node_list", graph_handle_node_list,
+		"Returns list of nodes of a graph. Parameters: graph_name");
+	rte_telemetry_register_cmd("/graph/node_stats", graph_handle_node_stats,
+		"Returns stats and histograms of a node of a graph. Parameters: graph_name,node_name");
+}
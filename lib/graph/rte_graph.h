@@ -41,6 +41,12 @@ extern "C" {
 #define RTE_GRAPH_ID_INVALID UINT16_MAX  /**< Invalid graph id. */
 #define RTE_GRAPH_FENCE 0xdeadbeef12345678ULL /**< Graph fence data. */
 
+#define RTE_GRAPH_MODEL_RTC 0 /**< Run-to-completion worker model. */
+#define RTE_GRAPH_MODEL_DISPATCH 1 /**< Multi-core dispatch worker model. */
+
+#define RTE_GRAPH_HIST_OBJS_BUCKETS 12	 /**< Buckets of objs/call histogram. */
+#define RTE_GRAPH_HIST_CYCLES_BUCKETS 16 /**< Buckets of cycles/obj histogram. */
+
 typedef uint32_t rte_graph_off_t;  /**< Graph offset type. */
 typedef uint32_t rte_node_t;       /**< Node id type. */
 typedef uint16_t rte_edge_t;       /**< Edge id type. */
@@ -206,6 +212,11 @@ struct rte_graph_cluster_node_stats {
 
 	uint64_t realloc_count; /**< Realloc count. */
 
+	uint64_t hist_objs[RTE_GRAPH_HIST_OBJS_BUCKETS];
+	/**< Histogram of the number of objs processed per call. */
+	uint64_t hist_cycles[RTE_GRAPH_HIST_CYCLES_BUCKETS];
+	/**< Histogram of the cycles per obj of the calls processing objs. */
+
 	rte_node_t id;	/**< Node identifier of stats. */
 	uint64_t hz;	/**< Cycles per seconds. */
 	char name[RTE_NODE_NAMESIZE];	/**< Name of the node. */
@@ -242,6 +253,96 @@ rte_graph_t rte_graph_create(const char *name, struct rte_graph_param *prm);
 __rte_experimental
 int rte_graph_destroy(rte_graph_t id);
 
+/**
+ * Clone Graph.
+ *
+ * Create a new graph with the same nodes as the parent graph, sharing the
+ * run queue of the parent graph in dispatch model. The node init() functions
+ * are invoked for the nodes of the new graph.
+ *
+ * @param id
+ *   Identifier of the graph to clone from.
+ * @param name
+ *   Name of the new graph. The library prepends the parent graph name to the
+ * user-specified name. The final graph name will be,
+ * "parent graph name" + "-" + name.
+ *
+ * @return
+ *   Valid graph id on success, RTE_GRAPH_ID_INVALID otherwise.
+ */
+__rte_experimental
+rte_graph_t rte_graph_clone(rte_graph_t id, const char *name);
+
+/**
+ * Set the worker model of a graph.
+ *
+ * The graphs cloned afterwards from this graph inherit the model.
+ *
+ * @param id
+ *   Graph id to set the model of.
+ * @param model
+ *   RTE_GRAPH_MODEL_RTC or RTE_GRAPH_MODEL_DISPATCH.
+ *
+ * @return
+ *   0 on success, -EINVAL on invalid graph id or model.
+ *
+ * @see rte_graph_walk()
+ */
+__rte_experimental
+int rte_graph_worker_model_set(rte_graph_t id, uint8_t model);
+
+/**
+ * Bind a graph to an lcore in dispatch model.
+ *
+ * Create the work queue through which the other graphs of the run queue
+ * schedule the streams of the nodes affinitized to the lcore. The graph must
+ * be walked on this lcore only. Must not be called while the graphs of the
+ * run queue are being walked.
+ *
+ * @param id
+ *   Graph id to bind.
+ * @param lcore
+ *   Lcore to bind the graph to.
+ *
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid graph id or lcore.
+ *   - -EEXIST: Another graph of the run queue is bound to the lcore.
+ *   - -ENOMEM: Not enough memory for the work queue.
+ */
+__rte_experimental
+int rte_graph_model_dispatch_core_bind(rte_graph_t id, int lcore);
+
+/**
+ * Unbind a graph from its lcore in dispatch model.
+ *
+ * Must not be called while the graphs of the run queue are being walked.
+ *
+ * @param id
+ *   Graph id to unbind.
+ */
+__rte_experimental
+void rte_graph_model_dispatch_core_unbind(rte_graph_t id);
+
+/**
+ * Set the lcore affinity of a node in dispatch model.
+ *
+ * The affinity applies to the graphs created afterwards and to the existing
+ * graphs. Must not be called while the graphs are being walked.
+ *
+ * @param name
+ *   Valid node name. In the case of the cloned node, the name will be
+ * "parent node name" + "-" + name.
+ * @param lcore_id
+ *   Enabled lcore to run the node on, RTE_MAX_LCORE to remove the affinity.
+ *
+ * @return
+ *   0 on success, -EINVAL on invalid node name, or on lcore not enabled.
+ */
+__rte_experimental
+int rte_graph_model_dispatch_lcore_affinity_set(const char *name,
+						unsigned int lcore_id);
+
 /**
  * Get graph id from graph name.
  *
@@ -419,6 +520,32 @@ void rte_graph_cluster_stats_get(struct rte_graph_cluster_stats *stat,
 __rte_experimental
 void rte_graph_cluster_stats_reset(struct rte_graph_cluster_stats *stat);
 
+/**
+ * Enable or disable the node histograms of a graph.
+ *
+ * When enabled, each call to a node of the graph is counted in the histogram
+ * of the number of objs processed per call and, if it processed objs, in the
+ * histogram of the cycles spent per obj. Bucket 0 of a histogram counts the
+ * value 0 and bucket n > 0 the values in [2^(n - 1), 2^n - 1], the last bucket
+ * also counting the greater values.
+ *
+ * The histograms are aggregated in struct rte_graph_cluster_node_stats and
+ * reported by the /graph/node_stats telemetry command.
+ *
+ * The graphs cloned afterwards from this graph inherit the setting.
+ *
+ * @param id
+ *   Graph id.
+ * @param enable
+ *   true to enable the histograms, false to disable them.
+ *
+ * @return
+ *   0 on success, -EINVAL on invalid graph id, -ENOTSUP if the stats feature
+ *   is disabled.
+ */
+__rte_experimental
+int rte_graph_stats_hist_enable(rte_graph_t id, bool enable);
+
 /**
  * Structure defines the node registration parameters.
  *
@@ -572,6 +699,36 @@ rte_edge_t rte_node_edge_shrink(rte_node_t id, rte_edge_t size);
 __rte_experimental
 rte_node_t rte_node_edge_get(rte_node_t id, char *next_nodes[]);
 
+/**
+ * Set the burst coalescing policy of a node.
+ *
+ * The graph walk defers the processing of the stream of the node to the
+ * next walks until the stream holds nb_objs objects or the cycles budget,
+ * counted from the first deferral, has elapsed. It lets the node process
+ * larger bursts when its previous nodes enqueue few objects to it per walk,
+ * at the expense of latency. A budget of 0 cycles defers the stream for one
+ * walk at most. Source nodes cannot be coalesced.
+ *
+ * The policy applies to the graphs created afterwards and to the existing
+ * graphs, in both worker models. Must not be called while the graphs are
+ * being walked.
+ *
+ * @param name
+ *   Valid node name. In the case of the cloned node, the name will be
+ * "parent node name" + "-" + name.
+ * @param nb_objs
+ *   Number of objects to accumulate, up to RTE_GRAPH_BURST_SIZE. 0 removes
+ *   the policy.
+ * @param cycles
+ *   Maximum number of cycles the stream of the node may be deferred for.
+ *
+ * @return
+ *   0 on success, -EINVAL on invalid or source node name or nb_objs.
+ */
+__rte_experimental
+int rte_node_coalesce_set(const char *name, uint16_t nb_objs,
+			  uint64_t cycles);
+
 /**
  * Get maximum nodes available.
  *
@@ -16,6 +16,8 @@
  * process, enqueue and move streams of objects to the next nodes.
  */
 
+#include <sys/queue.h>
+
 #include <rte_common.h>
 #include <rte_cycles.h>
 #include <rte_prefetch.h>
@@ -28,6 +30,16 @@
 extern "C" {
 #endif
 
+struct rte_ring;
+struct rte_mempool;
+
+/**
+ * @internal
+ *
+ * Head of the run queue of the graphs sharing the nodes in dispatch model.
+ */
+SLIST_HEAD(rte_graph_rq_head, rte_graph);
+
 /**
  * @internal
  *
@@ -42,6 +54,17 @@ struct rte_graph {
 	rte_graph_off_t nodes_start; /**< Offset at which node memory starts. */
 	rte_graph_t id;	/**< Graph identifier. */
 	int socket;	/**< Socket ID where memory is allocated. */
+	uint8_t model;	/**< Graph worker model. */
+	bool hist;	/**< Node histograms enabled. */
+	bool coalesce;	/**< Nodes with a coalescing policy in the graph. */
+	rte_graph_off_t defer_head; /**< First node deferred by the walk. */
+	rte_graph_t parent_id;	/**< Parent graph identifier, if cloned. */
+	unsigned int lcore_id;	/**< Lcore the graph is bound to. */
+	struct rte_ring *wq;	/**< Work queue of streams from other lcores. */
+	struct rte_mempool *mp;	/**< Pool of the work queue entries. */
+	struct rte_graph_rq_head *rq;	/**< Run queue of the graph. */
+	struct rte_graph_rq_head rq_head; /**< Run queue head, if parent. */
+	SLIST_ENTRY(rte_graph) rq_next;	/**< Next graph in the run queue. */
 	char name[RTE_GRAPH_NAMESIZE];	/**< Name of the graph. */
 	uint64_t fence;			/**< Fence. */
 } __rte_cache_aligned;
@@ -59,6 +82,17 @@ struct rte_node {
 	rte_node_t parent_id;	/**< Parent Node identifier. */
 	rte_edge_t nb_edges;	/**< Number of edges from this node. */
 	uint32_t realloc_count;	/**< Number of times realloced. */
+	unsigned int lcore_id;	/**< Lcore affinity in dispatch model. */
+	uint64_t total_sched_objs; /**< Objects scheduled to other lcores. */
+	uint64_t total_sched_fail; /**< Objects failed to be scheduled. */
+	uint16_t coalesce_objs;	/**< Objects to accumulate before process. */
+	rte_graph_off_t defer_next; /**< Next node deferred by the walk. */
+	uint64_t coalesce_cycles; /**< Cycles a stream may be deferred for. */
+	uint64_t coalesce_start; /**< Cycles at the first deferral, 0 if none. */
+	/** Histogram of objects processed per call. */
+	uint64_t hist_objs[RTE_GRAPH_HIST_OBJS_BUCKETS];
+	/** Histogram of cycles per object. */
+	uint64_t hist_cycles[RTE_GRAPH_HIST_CYCLES_BUCKETS];
 
 	char parent[RTE_NODE_NAMESIZE];	/**< Parent node name. */
 	char name[RTE_NODE_NAMESIZE];	/**< Name of the node. */
@@ -118,6 +152,240 @@ __rte_experimental
 void __rte_node_stream_alloc_size(struct rte_graph *graph,
 				  struct rte_node *node, uint16_t req_size);
 
+/**
+ * @internal
+ *
+ * Count a call of a node in its histograms.
+ *
+ * @param node
+ *   Pointer to the node object.
+ * @param objs
+ *   Number of objects processed by the call.
+ * @param cycles
+ *   Cycles spent in the call.
+ */
+static __rte_always_inline void
+__rte_node_hist_update(struct rte_node *node, uint16_t objs, uint64_t cycles)
+{
+	node->hist_objs[RTE_MIN(rte_fls_u32(objs),
+				RTE_GRAPH_HIST_OBJS_BUCKETS - 1)]++;
+	if (likely(objs))
+		node->hist_cycles[RTE_MIN(rte_fls_u64(cycles / objs),
+					  RTE_GRAPH_HIST_CYCLES_BUCKETS - 1)]++;
+}
+
+/**
+ * @internal
+ *
+ * Process the stream of a node from a graph walk and collect the stats.
+ *
+ * @param graph
+ *   Pointer to the graph object.
+ * @param node
+ *   Pointer to the node object.
+ */
+static __rte_always_inline void
+__rte_node_process(struct rte_graph *graph, struct rte_node *node)
+{
+	uint64_t start, cycles;
+	uint16_t rc;
+	void **objs;
+
+	RTE_ASSERT(node->fence == RTE_GRAPH_FENCE);
+	objs = node->objs;
+	rte_prefetch0(objs);
+
+	if (rte_graph_has_stats_feature()) {
+		start = rte_rdtsc();
+		rc = node->process(graph, node, objs, node->idx);
+		cycles = rte_rdtsc() - start;
+		node->total_cycles += cycles;
+		node->total_calls++;
+		node->total_objs += rc;
+		if (unlikely(graph->hist))
+			__rte_node_hist_update(node, rc, cycles);
+	} else {
+		node->process(graph, node, objs, node->idx);
+	}
+	node->idx = 0;
+}
+
+/**
+ * @internal
+ *
+ * Apply the coalescing policy of a pending node.
+ *
+ * Defer the processing of the stream of the node to a later walk while it
+ * holds less than the number of objects of the policy and the cycle budget
+ * counted from its first deferral has not elapsed.
+ *
+ * @param graph
+ *   Pointer to the graph object.
+ * @param node
+ *   Pointer to the pending node object.
+ *
+ * @return
+ *   true if the node is deferred, false if it must be processed.
+ */
+static __rte_always_inline bool
+__rte_node_coalesce_defer(struct rte_graph *graph, struct rte_node *node)
+{
+	uint64_t now;
+
+	if (node->idx >= node->coalesce_objs)
+		goto process;
+
+	now = rte_rdtsc();
+	if (node->coalesce_start == 0)
+		node->coalesce_start = now;
+	else if (now - node->coalesce_start >= node->coalesce_cycles)
+		goto process;
+
+	node->defer_next = graph->defer_head;
+	graph->defer_head = node->off;
+	return true;
+
+process:
+	node->coalesce_start = 0;
+	return false;
+}
+
+/**
+ * @internal
+ *
+ * Move the nodes deferred by the walk back to the pending streams, for the
+ * next walk to reconsider them. Their stream being not empty, they would not
+ * be added again on enqueue.
+ *
+ * @param graph
+ *   Pointer to the graph object.
+ */
+static __rte_always_inline void
+__rte_graph_coalesce_pend(struct rte_graph *graph)
+{
+	rte_graph_off_t off = graph->defer_head;
+	uint32_t tail = graph->tail;
+	struct rte_node *node;
+
+	graph->defer_head = 0;
+	while (off != 0) {
+		node = RTE_PTR_ADD(graph, off);
+		off = node->defer_next;
+		graph->cir_start[tail++] = node->off;
+		tail &= graph->cir_mask;
+	}
+	graph->tail = tail;
+}
+
+/**
+ * @internal
+ *
+ * Move the streams enqueued by the other lcores to the work queue of the
+ * graph to the pending streams of the graph.
+ *
+ * @param graph
+ *   Pointer to the graph object.
+ */
+__rte_experimental
+void __rte_graph_sched_wq_process(struct rte_graph *graph);
+
+/**
+ * @internal
+ *
+ * Schedule the stream of a node to the work queue of the graph in the run
+ * queue bound to the lcore the node is affinitized to.
+ *
+ * @param node
+ *   Pointer to the node object.
+ * @param rq
+ *   Pointer to the run queue of the graph of the node.
+ *
+ * @return
+ *   true if the whole stream is scheduled, false if the remaining objects
+ *   of the stream must be processed by the calling lcore.
+ */
+__rte_experimental
+bool __rte_graph_sched_node_enqueue(struct rte_node *node,
+				    struct rte_graph_rq_head *rq);
+
+/**
+ * @internal
+ *
+ * Perform graph walk in dispatch model.
+ *
+ * Same as the run-to-completion walk, except that the source nodes only run
+ * on the lcore they are affinitized to, on the lcore of the parent graph if
+ * they have no affinity, and that the streams of the nodes affinitized to
+ * another lcore are scheduled to the work queue of the graph of that lcore.
+ *
+ * @param graph
+ *   Graph pointer returned from rte_graph_lookup function.
+ */
+static inline void
+__rte_graph_walk_dispatch(struct rte_graph *graph)
+{
+	const rte_graph_off_t *cir_start = graph->cir_start;
+	const rte_node_t mask = graph->cir_mask;
+	const unsigned int lcore_id = graph->lcore_id;
+	uint32_t head;
+	struct rte_node *node;
+
+	if (graph->wq != NULL)
+		__rte_graph_sched_wq_process(graph);
+
+	head = graph->head;
+	while (likely(head != graph->tail)) {
+		node = RTE_PTR_ADD(graph, cir_start[(int32_t)head++]);
+
+		if ((int32_t)head <= 0) { /* Source node */
+			if (node->lcore_id == lcore_id ||
+			    (node->lcore_id == RTE_MAX_LCORE &&
+			     graph->parent_id == RTE_GRAPH_ID_INVALID))
+				__rte_node_process(graph, node);
+		} else if (unlikely(graph->coalesce) &&
+			   __rte_node_coalesce_defer(graph, node)) {
+			/* Stream left pending for a later walk */
+		} else if (node->lcore_id == RTE_MAX_LCORE ||
+			   node->lcore_id == lcore_id ||
+			   !__rte_graph_sched_node_enqueue(node, graph->rq)) {
+			__rte_node_process(graph, node);
+		}
+		head = likely((int32_t)head > 0) ? head & mask : head;
+	}
+	graph->tail = 0;
+	if (unlikely(graph->coalesce))
+		__rte_graph_coalesce_pend(graph);
+}
+
+/**
+ * @internal
+ *
+ * Perform graph walk in run-to-completion model, honoring the coalescing
+ * policy of the nodes.
+ *
+ * @param graph
+ *   Graph pointer returned from rte_graph_lookup function.
+ */
+static inline void
+__rte_graph_walk_coalesce(struct rte_graph *graph)
+{
+	const rte_graph_off_t *cir_start = graph->cir_start;
+	const rte_node_t mask = graph->cir_mask;
+	uint32_t head = graph->head;
+	struct rte_node *node;
+
+	while (likely(head != graph->tail)) {
+		node = RTE_PTR_ADD(graph, cir_start[(int32_t)head++]);
+		/* Source nodes are not coalesced */
+		if ((int32_t)head <= 0 ||
+		    !__rte_node_coalesce_defer(graph, node))
+			__rte_node_process(graph, node);
+		head = likely((int32_t)head > 0) ? head & mask : head;
+	}
+	graph->tail = 0;
+	__rte_graph_coalesce_pend(graph);
+}
+
 /**
  * Perform graph walk on the circular buffer and invoke the process function
  * of the nodes and collect the stats.
@@ -126,6 +394,8 @@ void __rte_node_stream_alloc_size(struct rte_graph *graph,
  *   Graph pointer returned from rte_graph_lookup function.
  *
  * @see rte_graph_lookup()
+ * @see rte_graph_worker_model_set()
+ * @see rte_node_coalesce_set()
  */
 __rte_experimental
 static inline void
@@ -135,9 +405,16 @@ rte_graph_walk(struct rte_graph *graph)
 	const rte_node_t mask = graph->cir_mask;
 	uint32_t head = graph->head;
 	struct rte_node *node;
-	uint64_t start;
-	uint16_t rc;
-	void **objs;
+
+	if (unlikely(graph->model == RTE_GRAPH_MODEL_DISPATCH)) {
+		__rte_graph_walk_dispatch(graph);
+		return;
+	}
+
+	if (unlikely(graph->coalesce)) {
+		__rte_graph_walk_coalesce(graph);
+		return;
+	}
 
 	/*
 	 * Walk on the source node(s) ((cir_start - head) -> cir_start) and then
@@ -156,20 +433,7 @@ rte_graph_walk(struct rte_graph *graph)
 	 */
 	while (likely(head != graph->tail)) {
 		node = RTE_PTR_ADD(graph, cir_start[(int32_t)head++]);
-		RTE_ASSERT(node->fence == RTE_GRAPH_FENCE);
-		objs = node->objs;
-		rte_prefetch0(objs);
-
-		if (rte_graph_has_stats_feature()) {
-			start = rte_rdtsc();
-			rc = node->process(graph, node, objs, node->idx);
-			node->total_cycles += rte_rdtsc() - start;
-			node->total_calls++;
-			node->total_objs += rc;
-		} else {
-			node->process(graph, node, objs, node->idx);
-		}
-		node->idx = 0;
+		__rte_node_process(graph, node);
 		head = likely((int32_t)head > 0) ? head & mask : head;
 	}
 	graph->tail = 0;
@@ -28,6 +28,7 @@
 #include <rte_compat.h>
 #include <rte_vect.h>
 #include <rte_tailq.h>
+#include <rte_telemetry.h>
 
 #include "rte_hash.h"
 #include "rte_cuckoo_hash.h"
@@ -38,7 +39,8 @@
 				   RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY | \
 				   RTE_HASH_EXTRA_FLAGS_EXT_TABLE |	\
 				   RTE_HASH_EXTRA_FLAGS_NO_FREE_ON_DEL | \
-				   RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF)
+				   RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF | \
+				   RTE_HASH_EXTRA_FLAGS_RESIZABLE)
 
 #define FOR_EACH_BUCKET(CURRENT_BKT, START_BUCKET)                            \
 	for (CURRENT_BKT = START_BUCKET;                                      \
@@ -134,6 +136,105 @@ get_alt_bucket_index(const struct rte_hash *h,
 	return (cur_bkt_idx ^ sig) & h->bucket_bitmask;
 }
 
+/*
+ * Return the key store entry of a key index. The key store of a resizable
+ * table is made of segments, each new segment doubling its size, so that
+ * key indexes (and so key positions) never change when the table grows.
+ */
+static inline struct rte_hash_key *
+get_key_slot(const struct rte_hash *h, uint32_t key_idx)
+{
+	uint32_t seg, seg_start;
+
+	if (likely(!h->resizable || key_idx <= (1U << h->key_seg_shift)))
+		return RTE_PTR_ADD(h->key_store,
+				(uint64_t)key_idx * h->key_entry_size);
+
+	seg = 32 - __builtin_clz((key_idx - 1) >> h->key_seg_shift);
+	seg_start = ((1U << h->key_seg_shift) << (seg - 1)) + 1;
+	return RTE_PTR_ADD(h->key_segs[seg],
+			(uint64_t)(key_idx - seg_start) * h->key_entry_size);
+}
+
+/*
+ * Split the lcores in groups of RTE_HASH_LCORES_PER_SHARD lcores of the same
+ * NUMA node, each group sharing a shard of the free slots. Return the number
+ * of shards and the NUMA node of each of them.
+ */
+static uint32_t
+hash_slot_shards_map(uint8_t *lcore_shard, int *shard_socket)
+{
+	uint32_t socket_lcores[RTE_MAX_NUMA_NODES] = {0};
+	uint32_t shard_key[RTE_HASH_SLOT_SHARDS_MAX];
+	uint32_t n_shards = 0, n_groups = 0;
+	uint32_t lcore_id, socket_id, key, i;
+
+	memset(lcore_shard, 0, RTE_MAX_LCORE);
+	RTE_LCORE_FOREACH(lcore_id) {
+		socket_id = rte_lcore_to_socket_id(lcore_id) %
+				RTE_MAX_NUMA_NODES;
+		key = (socket_id << 16) |
+			(socket_lcores[socket_id]++ / RTE_HASH_LCORES_PER_SHARD);
+
+		for (i = 0; i < n_shards; i++)
+			if (shard_key[i] == key)
+				break;
+		if (i == n_shards) {
+			if (n_shards < RTE_HASH_SLOT_SHARDS_MAX) {
+				shard_key[n_shards] = key;
+				shard_socket[n_shards] = socket_id;
+				n_shards++;
+			} else
+				/* Too many groups, some have to share shards */
+				i = n_groups % RTE_HASH_SLOT_SHARDS_MAX;
+			n_groups++;
+		}
+		lcore_shard[lcore_id] = i;
+	}
+
+	return n_shards;
+}
+
+/*
+ * Enqueue the free slot indexes, spread evenly between the shards if any.
+ * Entry zero is reserved for key misses.
+ */
+static void
+populate_free_slots(const struct rte_hash *h, uint32_t num_slots)
+{
+	uint32_t per_shard, shard, i;
+
+	if (h->num_slot_shards == 0) {
+		for (i = 1; i <= num_slots; i++)
+			rte_ring_sp_enqueue_elem(h->free_slots, &i,
+						 sizeof(uint32_t));
+		return;
+	}
+
+	per_shard = num_slots / h->num_slot_shards;
+	for (i = 1; i <= num_slots; i++) {
+		shard = (i - 1) / per_shard;
+		if (shard >= h->num_slot_shards ||
+				rte_ring_sp_enqueue_elem(h->slot_shards[shard],
+						&i, sizeof(uint32_t)) != 0)
+			rte_ring_sp_enqueue_elem(h->free_slots, &i,
+						 sizeof(uint32_t));
+	}
+}
+
+/* Number of free slots in the rings (lcore caches not included) */
+static uint32_t
+free_slots_count(const struct rte_hash *h)
+{
+	uint32_t count = rte_ring_count(h->free_slots);
+	uint32_t i;
+
+	for (i = 0; i < h->num_slot_shards; i++)
+		count += rte_ring_count(h->slot_shards[i]);
+
+	return count;
+}
+
 struct rte_hash *
 rte_hash_create(const struct rte_hash_parameters *params)
 {
@@ -158,7 +259,14 @@ rte_hash_create(const struct rte_hash_parameters *params)
 	uint32_t *tbl_chng_cnt = NULL;
 	struct lcore_cache *local_free_slots = NULL;
 	unsigned int readwrite_concur_lf_support = 0;
+	unsigned int resizable = 0;
+	struct rte_hash_bkt_tbl *tbl = NULL;
+	uint32_t entries;
 	uint32_t i;
+	struct rte_ring *slot_shards[RTE_HASH_SLOT_SHARDS_MAX] = {NULL};
+	uint8_t lcore_slot_shard[RTE_MAX_LCORE];
+	int shard_socket[RTE_HASH_SLOT_SHARDS_MAX];
+	uint32_t num_slot_shards = 0;
 
 	rte_hash_function default_hash_func = (rte_hash_function)rte_jhash;
 
@@ -193,6 +301,17 @@ rte_hash_create(const struct rte_hash_parameters *params)
 		return NULL;
 	}
 
+	if ((params->extra_flag & RTE_HASH_EXTRA_FLAGS_RESIZABLE) &&
+	    (params->extra_flag & (RTE_HASH_EXTRA_FLAGS_MULTI_WRITER_ADD |
+				   RTE_HASH_EXTRA_FLAGS_TRANS_MEM_SUPPORT |
+				   RTE_HASH_EXTRA_FLAGS_EXT_TABLE))) {
+		rte_errno = EINVAL;
+		RTE_LOG(ERR, HASH, "rte_hash_create: resizable table does not "
+			"support multi writer, transactional memory or "
+			"extendable buckets\n");
+		return NULL;
+	}
+
 	/* Check extra flags field to check extra options. */
 	if (params->extra_flag & RTE_HASH_EXTRA_FLAGS_TRANS_MEM_SUPPORT)
 		hw_trans_mem_support = 1;
@@ -222,6 +341,13 @@ rte_hash_create(const struct rte_hash_parameters *params)
 		no_free_on_del = 1;
 	}
 
+	entries = params->entries;
+	if (params->extra_flag & RTE_HASH_EXTRA_FLAGS_RESIZABLE) {
+		resizable = 1;
+		/* Key store segments double the size of the table */
+		entries = rte_align32pow2(params->entries);
+	}
+
 	/* Store all keys and leave the first entry as a dummy entry for lookup_bulk */
 	if (use_local_cache)
 		/*
@@ -229,10 +355,10 @@ rte_hash_create(const struct rte_hash_parameters *params)
 		 * that can be stored in the lcore caches
 		 * except for the first cache
 		 */
-		num_key_slots = params->entries + (RTE_MAX_LCORE - 1) *
+		num_key_slots = entries + (RTE_MAX_LCORE - 1) *
 					(LCORE_CACHE_SIZE - 1) + 1;
 	else
-		num_key_slots = params->entries + 1;
+		num_key_slots = entries + 1;
 
 	snprintf(ring_name, sizeof(ring_name), "HT_%s", params->name);
 	/* Create ring (Dummy slot index is not enqueued) */
@@ -261,6 +387,33 @@ rte_hash_create(const struct rte_hash_parameters *params)
 		}
 	}
 
+	/*
+	 * Shard the free slots between groups of lcores, so that refilling
+	 * the lcore caches does not serialize all writers on a single ring.
+	 * The shards have room for their share of the slots plus the caches
+	 * of their lcores, the ring above keeps any slot beyond.
+	 */
+	if (use_local_cache) {
+		num_slot_shards = hash_slot_shards_map(lcore_slot_shard,
+						       shard_socket);
+		if (num_slot_shards == 1)
+			num_slot_shards = 0;
+		for (i = 0; i < num_slot_shards; i++) {
+			snprintf(ring_name, sizeof(ring_name), "HTS%u_%s", i,
+				 params->name);
+			slot_shards[i] = rte_ring_create_elem(ring_name,
+					sizeof(uint32_t), rte_align32pow2(
+					(num_key_slots - 1) / num_slot_shards +
+					RTE_HASH_LCORES_PER_SHARD *
+					LCORE_CACHE_SIZE + 1),
+					shard_socket[i], 0);
+			if (slot_shards[i] == NULL) {
+				RTE_LOG(ERR, HASH, "free slots shard allocation failed\n");
+				goto err;
+			}
+		}
+	}
+
 	snprintf(hash_name, sizeof(hash_name), "HT_%s", params->name);
 
 	rte_mcfg_tailq_write_lock();
@@ -293,7 +446,18 @@ rte_hash_create(const struct rte_hash_parameters *params)
 		goto err_unlock;
 	}
 
-	buckets = rte_zmalloc_socket(NULL,
+	if (resizable) {
+		/* Buckets are swapped as a whole with their size on resize */
+		tbl = rte_zmalloc_socket(NULL, sizeof(struct rte_hash_bkt_tbl) +
+				num_buckets * sizeof(struct rte_hash_bucket),
+				RTE_CACHE_LINE_SIZE, params->socket_id);
+		if (tbl != NULL) {
+			tbl->num_buckets = num_buckets;
+			tbl->bucket_bitmask = num_buckets - 1;
+			buckets = tbl->buckets;
+		}
+	} else
+		buckets = rte_zmalloc_socket(NULL,
 				num_buckets * sizeof(struct rte_hash_bucket),
 				RTE_CACHE_LINE_SIZE, params->socket_id);
 
@@ -399,6 +563,11 @@ rte_hash_create(const struct rte_hash_parameters *params)
 			RTE_LOG(ERR, HASH, "local free slots memory allocation failed\n");
 			goto err_unlock;
 		}
+
+		h->num_slot_shards = num_slot_shards;
+		memcpy(h->slot_shards, slot_shards, sizeof(slot_shards));
+		memcpy(h->lcore_slot_shard, lcore_slot_shard,
+		       sizeof(lcore_slot_shard));
 	}
 
 	/* Default hash function */
@@ -410,7 +579,7 @@ rte_hash_create(const struct rte_hash_parameters *params)
 #endif
 	/* Setup hash context */
 	strlcpy(h->name, params->name, sizeof(h->name));
-	h->entries = params->entries;
+	h->entries = entries;
 	h->key_len = params->key_len;
 	h->key_entry_size = key_entry_size;
 	h->hash_func_init_val = params->hash_func_init_val;
@@ -435,6 +604,13 @@ rte_hash_create(const struct rte_hash_parameters *params)
 	h->writer_takes_lock = writer_takes_lock;
 	h->no_free_on_del = no_free_on_del;
 	h->readwrite_concur_lf_support = readwrite_concur_lf_support;
+	h->resizable = resizable;
+	h->tbl_cur = tbl;
+	h->min_buckets = num_buckets;
+	h->key_seg_shift = resizable ? rte_log2_u32(entries) : 0;
+	h->key_segs[0] = k;
+	h->num_key_segs = 1;
+	h->socket_id = params->socket_id;
 
 #if defined(RTE_ARCH_X86)
 	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_SSE2))
@@ -461,8 +637,7 @@ rte_hash_create(const struct rte_hash_parameters *params)
 	}
 
 	/* Populate free slots ring. Entry zero is reserved for key misses. */
-	for (i = 1; i < num_key_slots; i++)
-		rte_ring_sp_enqueue_elem(r, &i, sizeof(uint32_t));
+	populate_free_slots(h, num_key_slots - 1);
 
 	te->data = (void *) h;
 	TAILQ_INSERT_TAIL(hash_list, te, next);
@@ -476,8 +651,13 @@ rte_hash_create(const struct rte_hash_parameters *params)
 	rte_ring_free(r_ext);
 	rte_free(te);
 	rte_free(local_free_slots);
+	for (i = 0; i < num_slot_shards; i++)
+		rte_ring_free(slot_shards[i]);
 	rte_free(h);
-	rte_free(buckets);
+	if (tbl != NULL)
+		rte_free(tbl);
+	else
+		rte_free(buckets);
 	rte_free(buckets_ext);
 	rte_free(k);
 	rte_free(tbl_chng_cnt);
@@ -490,6 +670,7 @@ rte_hash_free(struct rte_hash *h)
 {
 	struct rte_tailq_entry *te;
 	struct rte_hash_list *hash_list;
+	uint32_t i;
 
 	if (h == NULL)
 		return;
@@ -521,9 +702,17 @@ rte_hash_free(struct rte_hash *h)
 	if (h->writer_takes_lock)
 		rte_free(h->readwrite_lock);
 	rte_ring_free(h->free_slots);
+	for (i = 0; i < h->num_slot_shards; i++)
+		rte_ring_free(h->slot_shards[i]);
 	rte_ring_free(h->free_ext_bkts);
-	rte_free(h->key_store);
-	rte_free(h->buckets);
+	for (i = 0; i < h->num_key_segs; i++)
+		rte_free(h->key_segs[i]);
+	if (h->resizable) {
+		rte_free(h->tbl_cur);
+		rte_free(h->tbl_old);
+		rte_free(h->tbl_retired);
+	} else
+		rte_free(h->buckets);
 	rte_free(h->buckets_ext);
 	rte_free(h->tbl_chng_cnt);
 	rte_free(h->ext_bkt_to_free);
@@ -568,8 +757,7 @@ rte_hash_count(const struct rte_hash *h)
 		for (i = 0; i < RTE_MAX_LCORE; i++)
 			cached_cnt += h->local_free_slots[i].len;
 
-		ret = tot_ring_cnt - rte_ring_count(h->free_slots) -
-								cached_cnt;
+		ret = tot_ring_cnt - free_slots_count(h) - cached_cnt;
 	} else {
 		tot_ring_cnt = h->entries;
 		ret = tot_ring_cnt - rte_ring_count(h->free_slots);
@@ -632,12 +820,28 @@ rte_hash_reset(struct rte_hash *h)
 			RTE_LOG(ERR, HASH, "RCU reclaim all resources failed\n");
 	}
 
+	if (h->resizable) {
+		/* Drop an ongoing resize, the application guarantees that
+		 * no reader is referencing the table.
+		 */
+		rte_free(h->tbl_old);
+		rte_free(h->tbl_retired);
+		h->tbl_old = NULL;
+		h->tbl_retired = NULL;
+		for (i = 1; i < h->num_key_segs; i++)
+			memset(h->key_segs[i], 0, (uint64_t)h->key_entry_size *
+				((1U << h->key_seg_shift) << (i - 1)));
+		memset(h->key_store, 0, (uint64_t)h->key_entry_size *
+				((1U << h->key_seg_shift) + 1));
+	} else
+		memset(h->key_store, 0, h->key_entry_size * (h->entries + 1));
 	memset(h->buckets, 0, h->num_buckets * sizeof(struct rte_hash_bucket));
-	memset(h->key_store, 0, h->key_entry_size * (h->entries + 1));
 	*h->tbl_chng_cnt = 0;
 
 	/* reset the free ring */
 	rte_ring_reset(h->free_slots);
+	for (i = 0; i < h->num_slot_shards; i++)
+		rte_ring_reset(h->slot_shards[i]);
 
 	/* flush free extendable bucket ring and memory */
 	if (h->ext_table_support) {
@@ -653,8 +857,7 @@ rte_hash_reset(struct rte_hash *h)
 	else
 		tot_ring_cnt = h->entries;
 
-	for (i = 1; i < tot_ring_cnt + 1; i++)
-		rte_ring_sp_enqueue_elem(h->free_slots, &i, sizeof(uint32_t));
+	populate_free_slots(h, tot_ring_cnt);
 
 	/* Repopulate the free ext bkt ring. */
 	if (h->ext_table_support) {
@@ -697,12 +900,11 @@ search_and_update(const struct rte_hash *h, void *data, const void *key,
 	struct rte_hash_bucket *bkt, uint16_t sig)
 {
 	int i;
-	struct rte_hash_key *k, *keys = h->key_store;
+	struct rte_hash_key *k;
 
 	for (i = 0; i < RTE_HASH_BUCKET_ENTRIES; i++) {
 		if (bkt->sig_current[i] == sig) {
-			k = (struct rte_hash_key *) ((char *)keys +
-					bkt->key_idx[i] * h->key_entry_size);
+			k = get_key_slot(h, bkt->key_idx[i]);
 			if (rte_hash_cmp_eq(key, k->key, h) == 0) {
 				/* The store to application data at *data
 				 * should not leak after the store to pdata
@@ -724,6 +926,29 @@ search_and_update(const struct rte_hash *h, void *data, const void *key,
 	return -1;
 }
 
+/* Search a key in the bucket table being drained by a resize and update
+ * its data. Writer holds the lock before calling this.
+ */
+static inline int32_t
+search_old_tbl_and_update(const struct rte_hash *h, void *data,
+	const void *key, hash_sig_t sig)
+{
+	struct rte_hash_bkt_tbl *old = h->tbl_old;
+	uint32_t prim_bucket_idx, sec_bucket_idx;
+	uint16_t short_sig = get_short_sig(sig);
+	int32_t ret;
+
+	prim_bucket_idx = sig & old->bucket_bitmask;
+	sec_bucket_idx = (prim_bucket_idx ^ short_sig) & old->bucket_bitmask;
+	ret = search_and_update(h, data, key, &old->buckets[prim_bucket_idx],
+			short_sig);
+	if (ret != -1)
+		return ret;
+
+	return search_and_update(h, data, key, &old->buckets[sec_bucket_idx],
+			short_sig);
+}
+
 /* Only tries to insert at one bucket (@prim_bkt) without trying to push
  * buckets around.
  * return 1 if matching existing key, return 0 if succeeds, return -1 for no
@@ -972,6 +1197,77 @@ rte_hash_cuckoo_make_space_mw(const struct rte_hash *h,
 	return -ENOSPC;
 }
 
+/*
+ * Refill an empty lcore cache: from the shard of the lcore first, then from
+ * the slots the shards could not hold, and last by stealing from the other
+ * shards.
+ */
+static inline unsigned int
+refill_slot_cache(const struct rte_hash *h, struct lcore_cache *cache)
+{
+	unsigned int n_slots, shard = 0, i;
+
+	if (h->num_slot_shards != 0) {
+		shard = h->lcore_slot_shard[cache - h->local_free_slots];
+		n_slots = rte_ring_mc_dequeue_burst_elem(
+				h->slot_shards[shard], cache->objs,
+				sizeof(uint32_t), LCORE_CACHE_SIZE, NULL);
+		if (n_slots != 0) {
+			cache->stats.refills++;
+			return n_slots;
+		}
+	}
+
+	n_slots = rte_ring_mc_dequeue_burst_elem(h->free_slots, cache->objs,
+			sizeof(uint32_t), LCORE_CACHE_SIZE, NULL);
+	if (n_slots != 0) {
+		if (h->num_slot_shards != 0)
+			cache->stats.overflow_refills++;
+		else
+			cache->stats.refills++;
+		return n_slots;
+	}
+
+	for (i = 1; i < h->num_slot_shards; i++) {
+		n_slots = rte_ring_mc_dequeue_burst_elem(
+			h->slot_shards[(shard + i) % h->num_slot_shards],
+			cache->objs, sizeof(uint32_t), LCORE_CACHE_SIZE, NULL);
+		if (n_slots != 0) {
+			cache->stats.steals++;
+			return n_slots;
+		}
+	}
+
+	cache->stats.refill_fails++;
+	return 0;
+}
+
+/*
+ * Flush a full lcore cache to the shard of the lcore, spilling to the ring
+ * of slots the shards cannot hold if the shard is full.
+ */
+static inline unsigned int
+flush_slot_cache(const struct rte_hash *h, struct lcore_cache *cache)
+{
+	unsigned int n_slots = 0, shard;
+
+	cache->stats.flushes++;
+	if (h->num_slot_shards != 0) {
+		shard = h->lcore_slot_shard[cache - h->local_free_slots];
+		n_slots = rte_ring_mp_enqueue_burst_elem(
+				h->slot_shards[shard], cache->objs,
+				sizeof(uint32_t), cache->len, NULL);
+		if (n_slots == cache->len)
+			return n_slots;
+		cache->stats.overflow_flushes++;
+	}
+
+	n_slots += rte_ring_mp_enqueue_burst_elem(h->free_slots,
+			&cache->objs[n_slots], sizeof(uint32_t),
+			cache->len - n_slots, NULL);
+	return n_slots;
+}
+
 static inline uint32_t
 alloc_slot(const struct rte_hash *h, struct lcore_cache *cached_free_slots)
 {
@@ -981,11 +1277,8 @@ alloc_slot(const struct rte_hash *h, struct lcore_cache *cached_free_slots)
 	if (h->use_local_cache) {
 		/* Try to get a free slot from the local cache */
 		if (cached_free_slots->len == 0) {
-			/* Need to get another burst of free slots from global ring */
-			n_slots = rte_ring_mc_dequeue_burst_elem(h->free_slots,
-					cached_free_slots->objs,
-					sizeof(uint32_t),
-					LCORE_CACHE_SIZE, NULL);
+			/* Need to get another burst of free slots */
+			n_slots = refill_slot_cache(h, cached_free_slots);
 			if (n_slots == 0)
 				return EMPTY_SLOT;
 
@@ -1004,6 +1297,336 @@ alloc_slot(const struct rte_hash *h, struct lcore_cache *cached_free_slots)
 	return slot_id;
 }
 
+/*
+ * Free a drained bucket table once no reader can reference it anymore.
+ * Lock free readers do not take any lock, so RCU is used to find out
+ * when they stopped walking the table.
+ */
+static void
+__rte_hash_tbl_retire(struct rte_hash *h, struct rte_hash_bkt_tbl *tbl)
+{
+	if (!h->readwrite_concur_lf_support) {
+		rte_free(tbl);
+		return;
+	}
+
+	if (h->hash_rcu_cfg->mode == RTE_HASH_QSBR_MODE_SYNC) {
+		rte_rcu_qsbr_synchronize(h->hash_rcu_cfg->v,
+					 RTE_QSBR_THRID_INVALID);
+		rte_free(tbl);
+		return;
+	}
+
+	h->tbl_retired = tbl;
+	h->tbl_retired_token = rte_rcu_qsbr_start(h->hash_rcu_cfg->v);
+}
+
+/* Free the retired bucket table if the readers have quiesced. */
+static int
+__rte_hash_tbl_reclaim(struct rte_hash *h)
+{
+	if (h->tbl_retired == NULL)
+		return 0;
+
+	if (rte_rcu_qsbr_check(h->hash_rcu_cfg->v, h->tbl_retired_token,
+			       false) != 1)
+		return -EBUSY;
+
+	rte_free(h->tbl_retired);
+	h->tbl_retired = NULL;
+	return 0;
+}
+
+/*
+ * Double the key store by adding a segment, and move the free slots
+ * to a ring large enough to also hold the slots of the new segment.
+ */
+static int
+__rte_hash_key_seg_add(struct rte_hash *h)
+{
+	char ring_name[RTE_RING_NAMESIZE];
+	const uint32_t seg = h->num_key_segs;
+	const uint32_t n = h->entries;
+	struct rte_ring *r;
+	uint32_t slot_id, i;
+	void *k;
+
+	if (seg == RTE_HASH_KEY_SEGS_MAX || n > RTE_HASH_ENTRIES_MAX / 2)
+		return -ENOSPC;
+
+	k = rte_zmalloc_socket(NULL, (uint64_t)n * h->key_entry_size,
+			RTE_CACHE_LINE_SIZE, h->socket_id);
+	if (k == NULL) {
+		RTE_LOG(ERR, HASH, "key store segment allocation failed\n");
+		return -ENOMEM;
+	}
+
+	snprintf(ring_name, sizeof(ring_name), "HT%u_%s", seg, h->name);
+	r = rte_ring_create_elem(ring_name, sizeof(uint32_t),
+			rte_align32pow2(2 * n + 1), h->socket_id, 0);
+	if (r == NULL) {
+		RTE_LOG(ERR, HASH, "free slots ring allocation failed\n");
+		rte_free(k);
+		return -ENOMEM;
+	}
+
+	while (rte_ring_sc_dequeue_elem(h->free_slots, &slot_id,
+					sizeof(uint32_t)) == 0)
+		rte_ring_sp_enqueue_elem(r, &slot_id, sizeof(uint32_t));
+
+	/* Segment must be visible before any of its slots is handed out */
+	__atomic_store_n(&h->key_segs[seg], k, __ATOMIC_RELEASE);
+	for (i = 1; i <= n; i++) {
+		slot_id = n + i;
+		rte_ring_sp_enqueue_elem(r, &slot_id, sizeof(uint32_t));
+	}
+
+	rte_ring_free(h->free_slots);
+	h->free_slots = r;
+	h->num_key_segs++;
+	h->entries += n;
+
+	return 0;
+}
+
+/*
+ * Allocate a bucket table of num_buckets buckets and make it the table new
+ * entries are added to. The previous table is kept for lookups until all
+ * its entries are migrated by __rte_hash_resize_step().
+ */
+static int
+__rte_hash_resize_start(struct rte_hash *h, uint32_t num_buckets)
+{
+	struct rte_hash_bkt_tbl *tbl;
+	int ret;
+
+	if (h->tbl_old != NULL)
+		return -EBUSY;
+
+	if (h->readwrite_concur_lf_support && h->hash_rcu_cfg == NULL)
+		return -ENOTSUP;
+
+	if (__rte_hash_tbl_reclaim(h) != 0)
+		return -EBUSY;
+
+	/* Every bucket entry has to be backed by a key store slot */
+	while (h->entries < num_buckets * RTE_HASH_BUCKET_ENTRIES) {
+		ret = __rte_hash_key_seg_add(h);
+		if (ret != 0)
+			return ret;
+	}
+
+	tbl = rte_zmalloc_socket(NULL, sizeof(struct rte_hash_bkt_tbl) +
+			num_buckets * sizeof(struct rte_hash_bucket),
+			RTE_CACHE_LINE_SIZE, h->socket_id);
+	if (tbl == NULL) {
+		RTE_LOG(ERR, HASH, "buckets memory allocation failed\n");
+		return -ENOMEM;
+	}
+	tbl->num_buckets = num_buckets;
+	tbl->bucket_bitmask = num_buckets - 1;
+
+	__hash_rw_writer_lock(h);
+	/* Readers search the old table first, so it must be published
+	 * before the table change counter and the new table.
+	 */
+	__atomic_store_n(&h->tbl_old, h->tbl_cur, __ATOMIC_RELEASE);
+	if (h->readwrite_concur_lf_support) {
+		/* Inform the readers that the table has changed.
+		 * Since there is one writer, load acquire on
+		 * tbl_chng_cnt is not required.
+		 */
+		__atomic_store_n(h->tbl_chng_cnt,
+				 *h->tbl_chng_cnt + 1,
+				 __ATOMIC_RELEASE);
+		/* The store to tbl_cur should not move above the
+		 * store to tbl_chng_cnt.
+		 */
+		__atomic_thread_fence(__ATOMIC_RELEASE);
+	}
+	h->migrate_next = 0;
+	h->buckets = tbl->buckets;
+	h->num_buckets = num_buckets;
+	h->bucket_bitmask = num_buckets - 1;
+	__atomic_store_n(&h->tbl_cur, tbl, __ATOMIC_RELEASE);
+	__hash_rw_writer_unlock(h);
+
+	return 0;
+}
+
+/*
+ * Move the entries of one bucket of the table being drained to the current
+ * table. An entry is added to the current table before it is removed from
+ * the old one and readers search the old table first, so a lookup always
+ * finds it in one of the two. Only the bucket entries move, the key store
+ * and so the key positions are left untouched.
+ */
+static int
+__rte_hash_migrate_bucket(struct rte_hash *h, struct rte_hash_bucket *bkt)
+{
+	uint32_t prim_bucket_idx, sec_bucket_idx, key_idx;
+	struct rte_hash_bucket *prim_bkt, *sec_bkt;
+	struct rte_hash_key *k;
+	const void *key;
+	uint16_t short_sig;
+	hash_sig_t sig;
+	int32_t ret_val;
+	unsigned int i;
+	int ret;
+
+	for (i = 0; i < RTE_HASH_BUCKET_ENTRIES; i++) {
+		key_idx = bkt->key_idx[i];
+		if (key_idx == EMPTY_SLOT)
+			continue;
+
+		/* Buckets only keep 16 bits of the hash */
+		k = get_key_slot(h, key_idx);
+		key = k->key;
+		sig = rte_hash_hash(h, key);
+		short_sig = get_short_sig(sig);
+		prim_bucket_idx = get_prim_bucket_index(h, sig);
+		sec_bucket_idx = get_alt_bucket_index(h, prim_bucket_idx,
+						      short_sig);
+		prim_bkt = &h->buckets[prim_bucket_idx];
+		sec_bkt = &h->buckets[sec_bucket_idx];
+
+		ret = rte_hash_cuckoo_insert_mw(h, prim_bkt, sec_bkt, key,
+				k->pdata, short_sig, key_idx, &ret_val);
+		if (ret == -1)
+			ret = rte_hash_cuckoo_make_space_mw(h, prim_bkt,
+					sec_bkt, key, k->pdata, short_sig,
+					prim_bucket_idx, key_idx, &ret_val);
+		if (ret < 0)
+			ret = rte_hash_cuckoo_make_space_mw(h, sec_bkt,
+					prim_bkt, key, k->pdata, short_sig,
+					sec_bucket_idx, key_idx, &ret_val);
+		if (ret < 0)
+			return -ENOSPC;
+
+		__hash_rw_writer_lock(h);
+		if (h->readwrite_concur_lf_support) {
+			/* Inform the readers that the table has changed.
+			 * Since there is one writer, load acquire on
+			 * tbl_chng_cnt is not required.
+			 */
+			__atomic_store_n(h->tbl_chng_cnt,
+					 *h->tbl_chng_cnt + 1,
+					 __ATOMIC_RELEASE);
+			/* The store to sig_current should not move above
+			 * the store to tbl_chng_cnt.
+			 */
+			__atomic_thread_fence(__ATOMIC_RELEASE);
+		}
+		bkt->sig_current[i] = NULL_SIGNATURE;
+		__atomic_store_n(&bkt->key_idx[i],
+				 EMPTY_SLOT,
+				 __ATOMIC_RELEASE);
+		__hash_rw_writer_unlock(h);
+	}
+
+	return 0;
+}
+
+/*
+ * Abort a shrink whose migration ran out of space, as keys were added to the
+ * smaller table meanwhile: the larger table being drained becomes the current
+ * table again, and the entries already moved to the smaller table are
+ * migrated back to it.
+ */
+static int
+__rte_hash_resize_abort(struct rte_hash *h)
+{
+	struct rte_hash_bkt_tbl *old = h->tbl_old;
+	struct rte_hash_bkt_tbl *cur = h->tbl_cur;
+
+	/* Only a shrink can be reverted into a larger table */
+	if (old->num_buckets <= cur->num_buckets)
+		return -ENOSPC;
+
+	__hash_rw_writer_lock(h);
+	/* Same publication order as when the resize was started */
+	__atomic_store_n(&h->tbl_old, cur, __ATOMIC_RELEASE);
+	if (h->readwrite_concur_lf_support) {
+		/* Inform the readers that the table has changed.
+		 * Since there is one writer, load acquire on
+		 * tbl_chng_cnt is not required.
+		 */
+		__atomic_store_n(h->tbl_chng_cnt,
+				 *h->tbl_chng_cnt + 1,
+				 __ATOMIC_RELEASE);
+		/* The store to tbl_cur should not move above the
+		 * store to tbl_chng_cnt.
+		 */
+		__atomic_thread_fence(__ATOMIC_RELEASE);
+	}
+	h->migrate_next = 0;
+	h->buckets = old->buckets;
+	h->num_buckets = old->num_buckets;
+	h->bucket_bitmask = old->bucket_bitmask;
+	__atomic_store_n(&h->tbl_cur, old, __ATOMIC_RELEASE);
+	__hash_rw_writer_unlock(h);
+
+	return 0;
+}
+
+/*
+ * Migrate up to n_buckets buckets of the table being drained, and release
+ * it once empty. Return the number of buckets left to migrate.
+ */
+static int
+__rte_hash_resize_step(struct rte_hash *h, uint32_t n_buckets)
+{
+	struct rte_hash_bkt_tbl *old = h->tbl_old;
+
+	if (old == NULL) {
+		__rte_hash_tbl_reclaim(h);
+		return 0;
+	}
+
+	while (n_buckets > 0 && h->migrate_next < old->num_buckets) {
+		if (__rte_hash_migrate_bucket(h,
+				&old->buckets[h->migrate_next]) != 0) {
+			if (__rte_hash_resize_abort(h) != 0)
+				return -ENOSPC;
+			old = h->tbl_old;
+			continue;
+		}
+		h->migrate_next++;
+		n_buckets--;
+	}
+
+	if (h->migrate_next < old->num_buckets)
+		return old->num_buckets - h->migrate_next;
+
+	/* All entries moved, readers only need the current table now */
+	__hash_rw_writer_lock(h);
+	__atomic_store_n(&h->tbl_old, NULL, __ATOMIC_RELEASE);
+	__hash_rw_writer_unlock(h);
+	__rte_hash_tbl_retire(h, old);
+
+	return 0;
+}
+
+/* Start doubling the bucket table after a key could not be inserted. */
+static int
+__rte_hash_grow(struct rte_hash *h)
+{
+	uint32_t num_buckets = h->num_buckets;
+
+	/* A table has a single predecessor, complete the ongoing resize */
+	if (h->tbl_old != NULL && __rte_hash_resize_step(h, UINT32_MAX) != 0)
+		return -ENOSPC;
+
+	/* An aborted shrink already brought the larger table back */
+	if (h->num_buckets > num_buckets)
+		return 0;
+
+	if (h->num_buckets * RTE_HASH_BUCKET_ENTRIES >= RTE_HASH_ENTRIES_MAX)
+		return -ENOSPC;
+
+	return __rte_hash_resize_start(h, h->num_buckets * 2);
+}
+
 static inline int32_t
 __rte_hash_add_key_with_hash(const struct rte_hash *h, const void *key,
 						hash_sig_t sig, void *data)
@@ -1011,7 +1634,7 @@ __rte_hash_add_key_with_hash(const struct rte_hash *h, const void *key,
 	uint16_t short_sig;
 	uint32_t prim_bucket_idx, sec_bucket_idx;
 	struct rte_hash_bucket *prim_bkt, *sec_bkt, *cur_bkt;
-	struct rte_hash_key *new_k, *keys = h->key_store;
+	struct rte_hash_key *new_k;
 	uint32_t ext_bkt_id = 0;
 	uint32_t slot_id;
 	int ret;
@@ -1046,6 +1669,15 @@ __rte_hash_add_key_with_hash(const struct rte_hash *h, const void *key,
 		}
 	}
 
+	/* Check if key is in the table being drained by a resize */
+	if (h->tbl_old != NULL) {
+		ret = search_old_tbl_and_update(h, data, key, sig);
+		if (ret != -1) {
+			__hash_rw_writer_unlock(h);
+			return ret;
+		}
+	}
+
 	__hash_rw_writer_unlock(h);
 
 	/* Did not find a match, so get a new slot for storing the new key */
@@ -1068,7 +1700,7 @@ __rte_hash_add_key_with_hash(const struct rte_hash *h, const void *key,
 			return -ENOSPC;
 	}
 
-	new_k = RTE_PTR_ADD(keys, slot_id * h->key_entry_size);
+	new_k = get_key_slot(h, slot_id);
 	/* The store to application data (by the application) at *data should
 	 * not leak after the store of pdata in the key store. i.e. pdata is
 	 * the guard variable. Release the application data to the readers.
@@ -1197,19 +1829,43 @@ __rte_hash_add_key_with_hash(const struct rte_hash *h, const void *key,
 
 }
 
+/*
+ * Add a key to a resizable table: move a few buckets of an ongoing resize
+ * first, and double the table when the key does not fit.
+ */
+static inline int32_t
+__rte_hash_add_key(const struct rte_hash *h, const void *key,
+		hash_sig_t sig, void *data)
+{
+	struct rte_hash *ht = (struct rte_hash *)(uintptr_t)h;
+	int32_t ret;
+
+	if (likely(!h->resizable))
+		return __rte_hash_add_key_with_hash(h, key, sig, data);
+
+	if (h->tbl_old != NULL || h->tbl_retired != NULL)
+		__rte_hash_resize_step(ht, RTE_HASH_RESIZE_STEP_BUCKETS);
+
+	ret = __rte_hash_add_key_with_hash(h, key, sig, data);
+	while (ret == -ENOSPC && __rte_hash_grow(ht) == 0)
+		ret = __rte_hash_add_key_with_hash(h, key, sig, data);
+
+	return ret;
+}
+
 int32_t
 rte_hash_add_key_with_hash(const struct rte_hash *h,
 			const void *key, hash_sig_t sig)
 {
 	RETURN_IF_TRUE(((h == NULL) || (key == NULL)), -EINVAL);
-	return __rte_hash_add_key_with_hash(h, key, sig, 0);
+	return __rte_hash_add_key(h, key, sig, 0);
 }
 
 int32_t
 rte_hash_add_key(const struct rte_hash *h, const void *key)
 {
 	RETURN_IF_TRUE(((h == NULL) || (key == NULL)), -EINVAL);
-	return __rte_hash_add_key_with_hash(h, key, rte_hash_hash(h, key), 0);
+	return __rte_hash_add_key(h, key, rte_hash_hash(h, key), 0);
 }
 
 int
@@ -1219,7 +1875,7 @@ rte_hash_add_key_with_hash_data(const struct rte_hash *h,
 	int ret;
 
 	RETURN_IF_TRUE(((h == NULL) || (key == NULL)), -EINVAL);
-	ret = __rte_hash_add_key_with_hash(h, key, sig, data);
+	ret = __rte_hash_add_key(h, key, sig, data);
 	if (ret >= 0)
 		return 0;
 	else
@@ -1233,7 +1889,7 @@ rte_hash_add_key_data(const struct rte_hash *h, const void *key, void *data)
 
 	RETURN_IF_TRUE(((h == NULL) || (key == NULL)), -EINVAL);
 
-	ret = __rte_hash_add_key_with_hash(h, key, rte_hash_hash(h, key), data);
+	ret = __rte_hash_add_key(h, key, rte_hash_hash(h, key), data);
 	if (ret >= 0)
 		return 0;
 	else
@@ -1247,13 +1903,12 @@ search_one_bucket_l(const struct rte_hash *h, const void *key,
 		const struct rte_hash_bucket *bkt)
 {
 	int i;
-	struct rte_hash_key *k, *keys = h->key_store;
+	struct rte_hash_key *k;
 
 	for (i = 0; i < RTE_HASH_BUCKET_ENTRIES; i++) {
 		if (bkt->sig_current[i] == sig &&
 				bkt->key_idx[i] != EMPTY_SLOT) {
-			k = (struct rte_hash_key *) ((char *)keys +
-					bkt->key_idx[i] * h->key_entry_size);
+			k = get_key_slot(h, bkt->key_idx[i]);
 
 			if (rte_hash_cmp_eq(key, k->key, h) == 0) {
 				if (data != NULL)
@@ -1276,7 +1931,7 @@ search_one_bucket_lf(const struct rte_hash *h, const void *key, uint16_t sig,
 {
 	int i;
 	uint32_t key_idx;
-	struct rte_hash_key *k, *keys = h->key_store;
+	struct rte_hash_key *k;
 
 	for (i = 0; i < RTE_HASH_BUCKET_ENTRIES; i++) {
 		/* Signature comparison is done before the acquire-load
@@ -1290,8 +1945,7 @@ search_one_bucket_lf(const struct rte_hash *h, const void *key, uint16_t sig,
 			key_idx = __atomic_load_n(&bkt->key_idx[i],
 					  __ATOMIC_ACQUIRE);
 			if (key_idx != EMPTY_SLOT) {
-				k = (struct rte_hash_key *) ((char *)keys +
-						key_idx * h->key_entry_size);
+				k = get_key_slot(h, key_idx);
 
 				if (rte_hash_cmp_eq(key, k->key, h) == 0) {
 					if (data != NULL) {
@@ -1409,11 +2063,85 @@ __rte_hash_lookup_with_hash_lf(const struct rte_hash *h, const void *key,
 	return -ENOENT;
 }
 
+/* Search a key in the primary and secondary buckets of a bucket table */
+static inline int32_t
+search_bkt_tbl_lf(const struct rte_hash *h, const void *key, hash_sig_t sig,
+			void **data, const struct rte_hash_bkt_tbl *tbl)
+{
+	uint32_t prim_bucket_idx, sec_bucket_idx;
+	uint16_t short_sig = get_short_sig(sig);
+	int32_t ret;
+
+	prim_bucket_idx = sig & tbl->bucket_bitmask;
+	sec_bucket_idx = (prim_bucket_idx ^ short_sig) & tbl->bucket_bitmask;
+
+	ret = search_one_bucket_lf(h, key, short_sig, data,
+				   &tbl->buckets[prim_bucket_idx]);
+	if (ret != -1)
+		return ret;
+
+	return search_one_bucket_lf(h, key, short_sig, data,
+				    &tbl->buckets[sec_bucket_idx]);
+}
+
+/*
+ * Lookup in a resizable table. While a resize is in progress, entries are
+ * moved from the old table to the current one, always added to the current
+ * table before being removed from the old one. Searching the old table
+ * first guarantees the key is found in one of them.
+ */
+static inline int32_t
+__rte_hash_lookup_with_hash_rsz(const struct rte_hash *h, const void *key,
+					hash_sig_t sig, void **data)
+{
+	const struct rte_hash_bkt_tbl *tbl;
+	uint32_t cnt_b = 0, cnt_a = 0;
+	int32_t ret = -ENOENT;
+
+	__hash_rw_reader_lock(h);
+	do {
+		/* Load the table change counter before the lookup
+		 * starts. Acquire semantics will make sure that
+		 * the loads of the tables are not hoisted.
+		 */
+		if (h->readwrite_concur_lf_support)
+			cnt_b = __atomic_load_n(h->tbl_chng_cnt,
+					__ATOMIC_ACQUIRE);
+
+		tbl = __atomic_load_n(&h->tbl_old, __ATOMIC_ACQUIRE);
+		if (tbl != NULL) {
+			ret = search_bkt_tbl_lf(h, key, sig, data, tbl);
+			if (ret != -1)
+				break;
+		}
+
+		tbl = __atomic_load_n(&h->tbl_cur, __ATOMIC_ACQUIRE);
+		ret = search_bkt_tbl_lf(h, key, sig, data, tbl);
+		if (ret != -1)
+			break;
+		ret = -ENOENT;
+
+		if (h->readwrite_concur_lf_support) {
+			/* The loads of sig_current in search_one_bucket
+			 * should not move below the load from tbl_chng_cnt.
+			 */
+			__atomic_thread_fence(__ATOMIC_ACQUIRE);
+			cnt_a = __atomic_load_n(h->tbl_chng_cnt,
+					__ATOMIC_ACQUIRE);
+		}
+	} while (cnt_b != cnt_a);
+	__hash_rw_reader_unlock(h);
+
+	return ret;
+}
+
 static inline int32_t
 __rte_hash_lookup_with_hash(const struct rte_hash *h, const void *key,
 					hash_sig_t sig, void **data)
 {
-	if (h->readwrite_concur_lf_support)
+	if (h->resizable)
+		return __rte_hash_lookup_with_hash_rsz(h, key, sig, data);
+	else if (h->readwrite_concur_lf_support)
 		return __rte_hash_lookup_with_hash_lf(h, key, sig, data);
 	else
 		return __rte_hash_lookup_with_hash_l(h, key, sig, data);
@@ -1462,10 +2190,7 @@ free_slot(const struct rte_hash *h, uint32_t slot_id)
 		/* Cache full, need to free it. */
 		if (cached_free_slots->len == LCORE_CACHE_SIZE) {
 			/* Need to enqueue the free slots in global ring. */
-			n_slots = rte_ring_mp_enqueue_burst_elem(h->free_slots,
-						cached_free_slots->objs,
-						sizeof(uint32_t),
-						LCORE_CACHE_SIZE, NULL);
+			n_slots = flush_slot_cache(h, cached_free_slots);
 			RETURN_IF_TRUE((n_slots == 0), -EFAULT);
 			cached_free_slots->len -= n_slots;
 		}
@@ -1480,16 +2205,14 @@ __hash_rcu_qsbr_free_resource(void *p, void *e, unsigned int n)
 {
 	void *key_data = NULL;
 	int ret;
-	struct rte_hash_key *keys, *k;
+	struct rte_hash_key *k;
 	struct rte_hash *h = (struct rte_hash *)p;
 	struct __rte_hash_rcu_dq_entry rcu_dq_entry =
 			*((struct __rte_hash_rcu_dq_entry *)e);
 
 	RTE_SET_USED(n);
-	keys = h->key_store;
 
-	k = (struct rte_hash_key *) ((char *)keys +
-				rcu_dq_entry.key_idx * h->key_entry_size);
+	k = get_key_slot(h, rcu_dq_entry.key_idx);
 	key_data = k->pdata;
 	if (h->hash_rcu_cfg->free_key_data_func)
 		h->hash_rcu_cfg->free_key_data_func(h->hash_rcu_cfg->key_data_ptr,
@@ -1578,6 +2301,45 @@ rte_hash_rcu_qsbr_add(struct rte_hash *h, struct rte_hash_rcu_config *cfg)
 	return 0;
 }
 
+int
+rte_hash_resize(const struct rte_hash *h, uint32_t entries)
+{
+	struct rte_hash *ht = (struct rte_hash *)(uintptr_t)h;
+	uint32_t num_buckets;
+
+	if (h == NULL || entries == 0 || entries > RTE_HASH_ENTRIES_MAX)
+		return -EINVAL;
+
+	if (!h->resizable)
+		return -ENOTSUP;
+
+	entries = rte_align32pow2(entries);
+	num_buckets = RTE_MAX(entries / RTE_HASH_BUCKET_ENTRIES, 1U);
+	if (num_buckets == h->num_buckets)
+		return 0;
+
+	if (h->tbl_old != NULL)
+		return -EBUSY;
+
+	if ((uint32_t)rte_hash_count(h) > entries)
+		return -ENOSPC;
+
+	return __rte_hash_resize_start(ht, num_buckets);
+}
+
+int
+rte_hash_resize_step(const struct rte_hash *h, uint32_t n_buckets)
+{
+	if (h == NULL)
+		return -EINVAL;
+
+	if (!h->resizable)
+		return -ENOTSUP;
+
+	return __rte_hash_resize_step((struct rte_hash *)(uintptr_t)h,
+				      n_buckets);
+}
+
 static inline void
 remove_entry(const struct rte_hash *h, struct rte_hash_bucket *bkt,
 		unsigned int i)
@@ -1641,7 +2403,7 @@ static inline int32_t
 search_and_remove(const struct rte_hash *h, const void *key,
 			struct rte_hash_bucket *bkt, uint16_t sig, int *pos)
 {
-	struct rte_hash_key *k, *keys = h->key_store;
+	struct rte_hash_key *k;
 	unsigned int i;
 	uint32_t key_idx;
 
@@ -1650,8 +2412,7 @@ search_and_remove(const struct rte_hash *h, const void *key,
 		key_idx = __atomic_load_n(&bkt->key_idx[i],
 					  __ATOMIC_ACQUIRE);
 		if (bkt->sig_current[i] == sig && key_idx != EMPTY_SLOT) {
-			k = (struct rte_hash_key *) ((char *)keys +
-					key_idx * h->key_entry_size);
+			k = get_key_slot(h, key_idx);
 			if (rte_hash_cmp_eq(key, k->key, h) == 0) {
 				bkt->sig_current[i] = NULL_SIGNATURE;
 				/* Free the key store index if
@@ -1717,6 +2478,24 @@ __rte_hash_del_key_with_hash(const struct rte_hash *h, const void *key,
 		}
 	}
 
+	/* Look for key in the table being drained by a resize */
+	if (h->tbl_old != NULL) {
+		prim_bucket_idx = sig & h->tbl_old->bucket_bitmask;
+		sec_bucket_idx = (prim_bucket_idx ^ short_sig) &
+					h->tbl_old->bucket_bitmask;
+		ret = search_and_remove(h, key,
+				&h->tbl_old->buckets[prim_bucket_idx],
+				short_sig, &pos);
+		if (ret == -1)
+			ret = search_and_remove(h, key,
+					&h->tbl_old->buckets[sec_bucket_idx],
+					short_sig, &pos);
+		if (ret != -1) {
+			last_bkt = NULL;
+			goto return_bkt;
+		}
+	}
+
 	__hash_rw_writer_unlock(h);
 	return -ENOENT;
 
@@ -1781,19 +2560,45 @@ __rte_hash_del_key_with_hash(const struct rte_hash *h, const void *key,
 	return ret;
 }
 
+/*
+ * Delete a key from a resizable table: move a few buckets of an ongoing
+ * resize first, and halve the table when it gets sparse.
+ */
+static inline int32_t
+__rte_hash_del_key(const struct rte_hash *h, const void *key, hash_sig_t sig)
+{
+	struct rte_hash *ht = (struct rte_hash *)(uintptr_t)h;
+	int32_t ret;
+
+	if (likely(!h->resizable))
+		return __rte_hash_del_key_with_hash(h, key, sig);
+
+	if (h->tbl_old != NULL || h->tbl_retired != NULL)
+		__rte_hash_resize_step(ht, RTE_HASH_RESIZE_STEP_BUCKETS);
+
+	ret = __rte_hash_del_key_with_hash(h, key, sig);
+	if (ret >= 0 && h->tbl_old == NULL &&
+			h->num_buckets > h->min_buckets &&
+			(uint32_t)rte_hash_count(h) < h->num_buckets *
+			RTE_HASH_BUCKET_ENTRIES / RTE_HASH_RESIZE_SHRINK_RATIO)
+		__rte_hash_resize_start(ht, h->num_buckets / 2);
+
+	return ret;
+}
+
 int32_t
 rte_hash_del_key_with_hash(const struct rte_hash *h,
 			const void *key, hash_sig_t sig)
 {
 	RETURN_IF_TRUE(((h == NULL) || (key == NULL)), -EINVAL);
-	return __rte_hash_del_key_with_hash(h, key, sig);
+	return __rte_hash_del_key(h, key, sig);
 }
 
 int32_t
 rte_hash_del_key(const struct rte_hash *h, const void *key)
 {
 	RETURN_IF_TRUE(((h == NULL) || (key == NULL)), -EINVAL);
-	return __rte_hash_del_key_with_hash(h, key, rte_hash_hash(h, key));
+	return __rte_hash_del_key(h, key, rte_hash_hash(h, key));
 }
 
 int
@@ -1802,9 +2607,13 @@ rte_hash_get_key_with_position(const struct rte_hash *h, const int32_t position,
 {
 	RETURN_IF_TRUE(((h == NULL) || (key == NULL)), -EINVAL);
 
-	struct rte_hash_key *k, *keys = h->key_store;
-	k = (struct rte_hash_key *) ((char *) keys + (position + 1) *
-				     h->key_entry_size);
+	struct rte_hash_key *k;
+
+	/* Key store segments beyond the current size are not allocated */
+	if (h->resizable && (uint32_t)position >= h->entries)
+		return -EINVAL;
+
+	k = get_key_slot(h, position + 1);
 	*key = k->key;
 
 	if (position !=
@@ -2312,12 +3121,44 @@ __rte_hash_lookup_bulk_lf(const struct rte_hash *h, const void **keys,
 		positions, hit_mask, data);
 }
 
+/*
+ * Bulk lookup in a resizable table, the keys are searched one by one since
+ * they may be spread over two bucket tables.
+ */
+static inline void
+__rte_hash_lookup_bulk_rsz(const struct rte_hash *h, const void **keys,
+			const hash_sig_t *prim_hash, int32_t num_keys,
+			int32_t *positions, uint64_t *hit_mask, void *data[])
+{
+	uint64_t hits = 0;
+	hash_sig_t sig;
+	int32_t i;
+
+	for (i = 0; i < num_keys; i++)
+		rte_prefetch0(keys[i]);
+
+	for (i = 0; i < num_keys; i++) {
+		sig = prim_hash != NULL ? prim_hash[i] :
+				rte_hash_hash(h, keys[i]);
+		positions[i] = __rte_hash_lookup_with_hash_rsz(h, keys[i],
+				sig, data != NULL ? &data[i] : NULL);
+		if (positions[i] >= 0)
+			hits |= 1ULL << i;
+	}
+
+	if (hit_mask != NULL)
+		*hit_mask = hits;
+}
+
 static inline void
 __rte_hash_lookup_bulk(const struct rte_hash *h, const void **keys,
 			int32_t num_keys, int32_t *positions,
 			uint64_t *hit_mask, void *data[])
 {
-	if (h->readwrite_concur_lf_support)
+	if (h->resizable)
+		__rte_hash_lookup_bulk_rsz(h, keys, NULL, num_keys, positions,
+					   hit_mask, data);
+	else if (h->readwrite_concur_lf_support)
 		__rte_hash_lookup_bulk_lf(h, keys, num_keys, positions,
 					  hit_mask, data);
 	else
@@ -2429,7 +3270,10 @@ __rte_hash_lookup_with_hash_bulk(const struct rte_hash *h, const void **keys,
 			hash_sig_t *prim_hash, int32_t num_keys,
 			int32_t *positions, uint64_t *hit_mask, void *data[])
 {
-	if (h->readwrite_concur_lf_support)
+	if (h->resizable)
+		__rte_hash_lookup_bulk_rsz(h, keys, prim_hash, num_keys,
+					   positions, hit_mask, data);
+	else if (h->readwrite_concur_lf_support)
 		__rte_hash_lookup_with_hash_bulk_lf(h, keys, prim_hash,
 				num_keys, positions, hit_mask, data);
 	else
@@ -2470,6 +3314,264 @@ rte_hash_lookup_with_hash_bulk_data(const struct rte_hash *h,
 	return __builtin_popcountl(*hit_mask);
 }
 
+/*
+ * Number of keys between two stages of the pipelined bulk lookup: the
+ * buckets of a key are prefetched BULK_PIPELINE_DIST keys before their
+ * signatures are compared, and its key slot BULK_PIPELINE_DIST keys before
+ * the key comparison. It bounds the number of outstanding prefetches to
+ * what the core can keep in flight.
+ */
+#define BULK_PIPELINE_DIST 4
+
+/* Compare a key against the bucket entries whose signature matched */
+static inline int
+__bulk_pipeline_cmp_keys(const struct rte_hash *h, const void *key,
+			const struct rte_hash_bucket *bkt, uint32_t hitmask,
+			void **data)
+{
+	const struct rte_hash_key *key_slot;
+	uint32_t hit_index, key_idx;
+
+	while (hitmask) {
+		hit_index = __builtin_ctzl(hitmask) >> 1;
+		key_idx = __atomic_load_n(&bkt->key_idx[hit_index],
+					  __ATOMIC_ACQUIRE);
+		key_slot = (const struct rte_hash_key *)(
+				(const char *)h->key_store +
+				key_idx * h->key_entry_size);
+		/*
+		 * If key index is 0, do not compare key,
+		 * as it is checking the dummy slot
+		 */
+		if (!!key_idx & !rte_hash_cmp_eq(key_slot->key, key, h)) {
+			if (data != NULL)
+				*data = __atomic_load_n(&key_slot->pdata,
+							__ATOMIC_ACQUIRE);
+			return 1;
+		}
+		hitmask &= ~(3U << (hit_index << 1));
+	}
+
+	return 0;
+}
+
+/*
+ * Software pipelined lookup of the keys set in todo. Each key goes through
+ * three stages, each one BULK_PIPELINE_DIST keys behind the previous one:
+ * - stage 0 computes the buckets from the hash and prefetches them,
+ * - stage 1 compares the signatures and prefetches the first key slot hit,
+ * - stage 2 compares the keys.
+ * Keys not found in their buckets are then searched in the extendable
+ * buckets. Return the mask of keys found.
+ */
+static inline uint64_t
+__bulk_lookup_pipeline(const struct rte_hash *h, const void **keys,
+		const hash_sig_t *prim_hash, int32_t num_keys, uint64_t todo,
+		void *data[])
+{
+	const struct rte_hash_bucket *prim_bkt[RTE_HASH_LOOKUP_BULK_MAX];
+	const struct rte_hash_bucket *sec_bkt[RTE_HASH_LOOKUP_BULK_MAX];
+	uint32_t prim_hitmask[RTE_HASH_LOOKUP_BULK_MAX];
+	uint32_t sec_hitmask[RTE_HASH_LOOKUP_BULK_MAX];
+	uint16_t sig[RTE_HASH_LOOKUP_BULK_MAX];
+	const struct rte_hash_key *key_slot;
+	struct rte_hash_bucket *cur_bkt, *next_bkt;
+	uint32_t prim_index, first_hit, key_idx;
+	uint64_t hits = 0;
+	int32_t i, k, ret;
+
+	for (i = 0; i < num_keys + 2 * BULK_PIPELINE_DIST; i++) {
+		/* Stage 0: locate the buckets and prefetch them */
+		k = i;
+		if (k < num_keys && (todo & (1ULL << k))) {
+			rte_prefetch0(keys[k]);
+			sig[k] = get_short_sig(prim_hash[k]);
+			prim_index = get_prim_bucket_index(h, prim_hash[k]);
+			prim_bkt[k] = &h->buckets[prim_index];
+			sec_bkt[k] = &h->buckets[get_alt_bucket_index(h,
+						prim_index, sig[k])];
+			rte_prefetch0(prim_bkt[k]);
+			rte_prefetch0(sec_bkt[k]);
+		}
+
+		/* Stage 1: compare signatures, prefetch first key slot hit */
+		k = i - BULK_PIPELINE_DIST;
+		if (k >= 0 && k < num_keys && (todo & (1ULL << k))) {
+			prim_hitmask[k] = 0;
+			sec_hitmask[k] = 0;
+			compare_signatures(&prim_hitmask[k], &sec_hitmask[k],
+				prim_bkt[k], sec_bkt[k], sig[k],
+				h->sig_cmp_fn);
+			key_idx = EMPTY_SLOT;
+			if (prim_hitmask[k]) {
+				first_hit = __builtin_ctzl(prim_hitmask[k]) >> 1;
+				key_idx = prim_bkt[k]->key_idx[first_hit];
+			} else if (sec_hitmask[k]) {
+				first_hit = __builtin_ctzl(sec_hitmask[k]) >> 1;
+				key_idx = sec_bkt[k]->key_idx[first_hit];
+			}
+			if (key_idx != EMPTY_SLOT) {
+				key_slot = (const struct rte_hash_key *)(
+						(const char *)h->key_store +
+						key_idx * h->key_entry_size);
+				rte_prefetch0(key_slot);
+			}
+		}
+
+		/* Stage 2: compare keys, hits in primary first */
+		k = i - 2 * BULK_PIPELINE_DIST;
+		if (k >= 0 && (todo & (1ULL << k))) {
+			if (__bulk_pipeline_cmp_keys(h, keys[k], prim_bkt[k],
+					prim_hitmask[k],
+					data != NULL ? &data[k] : NULL) ||
+			    __bulk_pipeline_cmp_keys(h, keys[k], sec_bkt[k],
+					sec_hitmask[k],
+					data != NULL ? &data[k] : NULL))
+				hits |= 1ULL << k;
+		}
+	}
+
+	if (!h->ext_table_support || hits == todo)
+		return hits;
+
+	/* need to check ext buckets for match */
+	for (k = 0; k < num_keys; k++) {
+		if (!(todo & (1ULL << k)) || (hits & (1ULL << k)))
+			continue;
+		next_bkt = sec_bkt[k]->next;
+		FOR_EACH_BUCKET(cur_bkt, next_bkt) {
+			ret = search_one_bucket_lf(h, keys[k], sig[k],
+					data != NULL ? &data[k] : NULL,
+					cur_bkt);
+			if (ret != -1) {
+				hits |= 1ULL << k;
+				break;
+			}
+		}
+	}
+
+	return hits;
+}
+
+int
+rte_hash_lookup_with_hash_bulk_pipeline(const struct rte_hash *h,
+		const void **keys, hash_sig_t *prim_hash,
+		uint32_t num_keys, uint64_t *hit_mask, void *data[])
+{
+	const uint64_t all = num_keys == RTE_HASH_LOOKUP_BULK_MAX ?
+			UINT64_MAX : (1ULL << num_keys) - 1;
+	uint32_t cnt_b, cnt_a;
+	uint64_t hits = 0;
+
+	RETURN_IF_TRUE(((h == NULL) || (keys == NULL) ||
+			(prim_hash == NULL) || (num_keys == 0) ||
+			(num_keys > RTE_HASH_LOOKUP_BULK_MAX) ||
+			(hit_mask == NULL)), -EINVAL);
+
+	if (h->resizable) {
+		int32_t positions[num_keys];
+
+		__rte_hash_lookup_bulk_rsz(h, keys, prim_hash, num_keys,
+					   positions, hit_mask, data);
+		return __builtin_popcountll(*hit_mask);
+	}
+
+	if (!h->readwrite_concur_lf_support) {
+		__hash_rw_reader_lock(h);
+		hits = __bulk_lookup_pipeline(h, keys, prim_hash, num_keys,
+					      all, data);
+		__hash_rw_reader_unlock(h);
+		*hit_mask = hits;
+		return __builtin_popcountll(hits);
+	}
+
+	do {
+		/* Load the table change counter before the lookup
+		 * starts. Acquire semantics will make sure that
+		 * loads in compare_signatures are not hoisted.
+		 */
+		cnt_b = __atomic_load_n(h->tbl_chng_cnt,
+					__ATOMIC_ACQUIRE);
+
+		/* Keys found are valid, only look for the misses again */
+		hits |= __bulk_lookup_pipeline(h, keys, prim_hash, num_keys,
+					       all & ~hits, data);
+		if (hits == all)
+			break;
+
+		/* The loads of sig_current in compare_signatures
+		 * should not move below the load from tbl_chng_cnt.
+		 */
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		/* Re-read the table change counter to check if the
+		 * table has changed during search. If yes, re-do
+		 * the search.
+		 */
+		cnt_a = __atomic_load_n(h->tbl_chng_cnt,
+					__ATOMIC_ACQUIRE);
+	} while (cnt_b != cnt_a);
+
+	*hit_mask = hits;
+	return __builtin_popcountll(hits);
+}
+
+/*
+ * Iterate over a resizable table: the current bucket table first, then the
+ * table being drained if a resize is in progress. Entries moved by the
+ * resize while iterating can be missed or returned twice.
+ */
+static int32_t
+__rte_hash_iterate_rsz(const struct rte_hash *h, const void **key,
+			void **data, uint32_t *next)
+{
+	const struct rte_hash_bkt_tbl *tbl;
+	struct rte_hash_key *next_key;
+	uint32_t total_entries, position;
+
+	__hash_rw_reader_lock(h);
+	tbl = h->tbl_cur;
+	total_entries = tbl->num_buckets * RTE_HASH_BUCKET_ENTRIES;
+	if (*next >= total_entries) {
+		*next -= total_entries;
+		tbl = h->tbl_old;
+	} else
+		total_entries = 0;
+
+	while (tbl != NULL) {
+		const uint32_t tbl_entries = tbl->num_buckets *
+						RTE_HASH_BUCKET_ENTRIES;
+
+		for (; *next < tbl_entries; (*next)++) {
+			position = __atomic_load_n(
+				&tbl->buckets[*next / RTE_HASH_BUCKET_ENTRIES]
+					.key_idx[*next % RTE_HASH_BUCKET_ENTRIES],
+				__ATOMIC_ACQUIRE);
+			if (position == EMPTY_SLOT)
+				continue;
+
+			next_key = get_key_slot(h, position);
+			/* Return key and data */
+			*key = next_key->key;
+			*data = next_key->pdata;
+			/* Increment iterator */
+			*next += total_entries + 1;
+			__hash_rw_reader_unlock(h);
+			return position - 1;
+		}
+
+		if (total_entries != 0)
+			break;
+		/* Continue with the table being drained */
+		total_entries = tbl_entries;
+		*next = 0;
+		tbl = h->tbl_old;
+	}
+	*next += total_entries;
+	__hash_rw_reader_unlock(h);
+
+	return -ENOENT;
+}
+
 int32_t
 rte_hash_iterate(const struct rte_hash *h, const void **key, void **data, uint32_t *next)
 {
@@ -2478,6 +3580,9 @@ rte_hash_iterate(const struct rte_hash *h, const void **key, void **data, uint32
 
 	RETURN_IF_TRUE(((h == NULL) || (next == NULL)), -EINVAL);
 
+	if (h->resizable)
+		return __rte_hash_iterate_rsz(h, key, data, next);
+
 	const uint32_t total_entries_main = h->num_buckets *
 							RTE_HASH_BUCKET_ENTRIES;
 	const uint32_t total_entries = total_entries_main << 1;
@@ -2545,3 +3650,93 @@ rte_hash_iterate(const struct rte_hash *h, const void **key, void **data, uint32
 	(*next)++;
 	return position - 1;
 }
+
+static int
+hash_handle_list(const char *cmd __rte_unused,
+		 const char *params __rte_unused, struct rte_tel_data *d)
+{
+	struct rte_hash_list *hash_list;
+	struct rte_tailq_entry *te;
+
+	hash_list = RTE_TAILQ_CAST(rte_hash_tailq.head, rte_hash_list);
+
+	rte_tel_data_start_array(d, RTE_TEL_STRING_VAL);
+	rte_mcfg_tailq_read_lock();
+	TAILQ_FOREACH(te, hash_list, next)
+		rte_tel_data_add_array_string(d,
+				((struct rte_hash *)te->data)->name);
+	rte_mcfg_tailq_read_unlock();
+
+	return 0;
+}
+
+static int
+hash_handle_info(const char *cmd __rte_unused, const char *params,
+		 struct rte_tel_data *d)
+{
+	struct lcore_cache_stats stats = {0};
+	const struct lcore_cache_stats *s;
+	struct rte_tel_data *shards;
+	const struct rte_hash *h;
+	uint32_t i;
+
+	if (params == NULL || strlen(params) == 0)
+		return -EINVAL;
+
+	h = rte_hash_find_existing(params);
+	if (h == NULL)
+		return -EINVAL;
+
+	rte_tel_data_start_dict(d);
+	rte_tel_data_add_dict_string(d, "name", h->name);
+	rte_tel_data_add_dict_int(d, "entries", h->entries);
+	rte_tel_data_add_dict_int(d, "count", rte_hash_count(h));
+	rte_tel_data_add_dict_int(d, "key_len", h->key_len);
+	rte_tel_data_add_dict_int(d, "buckets", h->num_buckets);
+	if (!h->use_local_cache)
+		return 0;
+
+	/* Free slots allocation of multi-writer tables */
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		s = &h->local_free_slots[i].stats;
+		stats.refills += s->refills;
+		stats.steals += s->steals;
+		stats.overflow_refills += s->overflow_refills;
+		stats.refill_fails += s->refill_fails;
+		stats.flushes += s->flushes;
+		stats.overflow_flushes += s->overflow_flushes;
+	}
+	rte_tel_data_add_dict_u64(d, "slot_refills", stats.refills);
+	rte_tel_data_add_dict_u64(d, "slot_steals", stats.steals);
+	rte_tel_data_add_dict_u64(d, "slot_overflow_refills",
+				  stats.overflow_refills);
+	rte_tel_data_add_dict_u64(d, "slot_refill_fails", stats.refill_fails);
+	rte_tel_data_add_dict_u64(d, "slot_flushes", stats.flushes);
+	rte_tel_data_add_dict_u64(d, "slot_overflow_flushes",
+				  stats.overflow_flushes);
+	rte_tel_data_add_dict_int(d, "slot_shards", h->num_slot_shards);
+	rte_tel_data_add_dict_int(d, "slot_overflow_free",
+				  rte_ring_count(h->free_slots));
+
+	if (h->num_slot_shards == 0)
+		return 0;
+
+	shards = rte_tel_data_alloc();
+	if (shards == NULL)
+		return -ENOMEM;
+	rte_tel_data_start_array(shards, RTE_TEL_INT_VAL);
+	for (i = 0; i < h->num_slot_shards; i++)
+		rte_tel_data_add_array_int(shards,
+				rte_ring_count(h->slot_shards[i]));
+	rte_tel_data_add_dict_container(d, "slot_shards_free", shards, 0);
+
+	return 0;
+}
+
+RTE_INIT(hash_init_telemetry)
+{
+	rte_telemetry_register_cmd("/hash/list", hash_handle_list,
+		"Returns list of available hash tables. Takes no parameters");
+	rte_telemetry_register_cmd("/hash/info", hash_handle_info,
+		"Returns hash table info, with free slots allocation statistics of multi-writer tables. Parameters: hash table name");
+}
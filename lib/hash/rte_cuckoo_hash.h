@@ -128,9 +128,37 @@ const rte_hash_cmp_eq_t cmp_jump_table[NUM_KEY_CMP_CASES] = {
 
 #define RTE_HASH_TSX_MAX_RETRY  10
 
+/* Max number of key store segments of a resizable table */
+#define RTE_HASH_KEY_SEGS_MAX		32
+
+/* Buckets migrated by each add/delete while a resize is in progress */
+#define RTE_HASH_RESIZE_STEP_BUCKETS	8
+
+/* A resizable table shrinks when less than 1/N of its entries are used */
+#define RTE_HASH_RESIZE_SHRINK_RATIO	8
+
+/* Max number of free slots shards of a multi-writer table */
+#define RTE_HASH_SLOT_SHARDS_MAX	8
+
+/* Number of lcores of a NUMA node sharing a free slots shard */
+#define RTE_HASH_LCORES_PER_SHARD 8
+
+/* Free slots allocation statistics of an lcore, exposed via telemetry */
+struct lcore_cache_stats {
+	uint64_t refills;	/**< Cache refills from the lcore shard */
+	uint64_t steals;	/**< Cache refills from another shard */
+	uint64_t overflow_refills;
+	/**< Cache refills from the ring of slots the shards can't hold */
+	uint64_t refill_fails;	/**< Cache refills finding no free slot */
+	uint64_t flushes;	/**< Cache flushes to the lcore shard */
+	uint64_t overflow_flushes;
+	/**< Cache flushes spilling to the ring of slots the shards can't hold */
+};
+
 struct lcore_cache {
 	unsigned len; /**< Cache len */
 	uint32_t objs[LCORE_CACHE_SIZE]; /**< Cache objects */
+	struct lcore_cache_stats stats; /**< Allocation statistics */
 } __rte_cache_aligned;
 
 /* Structure that stores key-value pair */
@@ -162,6 +190,13 @@ struct rte_hash_bucket {
 	void *next;
 } __rte_cache_aligned;
 
+/** Bucket table of a resizable hash, published to readers as a whole. */
+struct rte_hash_bkt_tbl {
+	uint32_t num_buckets;		/**< Number of buckets in table. */
+	uint32_t bucket_bitmask;	/**< Bitmask for getting bucket index. */
+	struct rte_hash_bucket buckets[0]; /**< Buckets of the table. */
+};
+
 /** A hash table structure. */
 struct rte_hash {
 	char name[RTE_HASH_NAMESIZE];   /**< Name of the hash. */
@@ -202,6 +237,8 @@ struct rte_hash {
 	/**< If read-write concurrency lock free support is enabled */
 	uint8_t writer_takes_lock;
 	/**< Indicates if the writer threads need to take lock */
+	uint8_t resizable;
+	/**< If the bucket table and key store can be resized online */
 	rte_hash_function hash_func;    /**< Function used to calculate hash. */
 	uint32_t hash_func_init_val;    /**< Init value used by hash_func. */
 	rte_hash_cmp_eq_t rte_hash_custom_cmp_eq;
@@ -231,6 +268,34 @@ struct rte_hash {
 	uint32_t *ext_bkt_to_free;
 	uint32_t *tbl_chng_cnt;
 	/**< Indicates if the hash table changed from last read. */
+
+	/* Fields used by resizable tables only */
+	struct rte_hash_bkt_tbl *tbl_cur;
+	/**< Bucket table new entries are added to (buckets above point to it) */
+	struct rte_hash_bkt_tbl *tbl_old;
+	/**< Bucket table being drained by an ongoing resize, or NULL */
+	struct rte_hash_bkt_tbl *tbl_retired;
+	/**< Drained bucket table waiting for the readers to quiesce */
+	uint64_t tbl_retired_token;	/**< RCU QSBR token of tbl_retired */
+	uint32_t migrate_next;		/**< Next bucket of tbl_old to migrate */
+	uint32_t min_buckets;		/**< Table never shrinks below this */
+	uint32_t key_seg_shift;		/**< log2 of entries in key_store */
+	uint32_t num_key_segs;		/**< Number of key store segments */
+	void *key_segs[RTE_HASH_KEY_SEGS_MAX];
+	/**< Key store segments, segment n > 0 holds the entries in
+	 * ((1 << key_seg_shift) << (n - 1), (1 << key_seg_shift) << n]
+	 */
+	int socket_id;			/**< NUMA socket of the table memory */
+
+	/* Fields used by multi-writer tables only */
+	uint32_t num_slot_shards;
+	/**< Number of free slots shards, 0 if the lcores share free_slots */
+	struct rte_ring *slot_shards[RTE_HASH_SLOT_SHARDS_MAX];
+	/**< Free slots shared by a group of lcores of the same NUMA node.
+	 * free_slots keeps the slots the shards cannot hold.
+	 */
+	uint8_t lcore_slot_shard[RTE_MAX_LCORE];
+	/**< Free slots shard of each lcore */
 } __rte_cache_aligned;
 
 struct queue_node {
@@ -56,6 +56,25 @@ extern "C" {
  */
 #define RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF 0x20
 
+/** Flag to let the table grow and shrink online.
+ * The number of entries passed at creation is rounded up to a power of 2
+ * and is the initial (and minimum automatic) size of the table. When a key
+ * cannot be inserted, a bucket table twice as large is allocated and the
+ * existing entries are migrated to it a few buckets at a time by the
+ * subsequent add/delete calls (or rte_hash_resize_step()). Lookups search
+ * both tables while a migration is in progress and never block.
+ * Key positions are preserved across resizes, rte_hash_max_key_id() grows
+ * with the table.
+ * This flag cannot be combined with RTE_HASH_EXTRA_FLAGS_MULTI_WRITER_ADD,
+ * RTE_HASH_EXTRA_FLAGS_TRANS_MEM_SUPPORT or RTE_HASH_EXTRA_FLAGS_EXT_TABLE.
+ * With RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF, resizing only takes place
+ * once an RCU QSBR variable has been attached with rte_hash_rcu_qsbr_add(),
+ * which is used to free the drained bucket tables. The defer queue size
+ * given to rte_hash_rcu_qsbr_add() should then account for the largest size
+ * the table may grow to.
+ */
+#define RTE_HASH_EXTRA_FLAGS_RESIZABLE 0x40
+
 /**
  * The type of hash value of a key.
  * It should be a value of at least 32bit with fully random pattern.
@@ -608,6 +627,43 @@ rte_hash_lookup_with_hash_bulk_data(const struct rte_hash *h,
 		const void **keys, hash_sig_t *sig,
 		uint32_t num_keys, uint64_t *hit_mask, void *data[]);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Find multiple keys in the hash table with precomputed hash value array,
+ * using a software pipeline. The bucket prefetch, signature comparison and
+ * key comparison of the keys are interleaved so that the memory accesses of
+ * each key overlap with the processing of the previous ones. This is faster
+ * than rte_hash_lookup_with_hash_bulk_data() when the table does not fit in
+ * the CPU caches.
+ * This operation is multi-thread safe with regarding to other lookup threads.
+ * Read-write concurrency can be enabled by setting flag during
+ * table creation.
+ *
+ * @param h
+ *   Hash table to look in.
+ * @param keys
+ *   A pointer to a list of keys to look for.
+ * @param prim_hash
+ *   A pointer to a list of precomputed hash values for keys, as returned by
+ *   rte_hash_hash(). The key signatures are derived from them.
+ * @param num_keys
+ *   How many keys are in the keys list (less than RTE_HASH_LOOKUP_BULK_MAX).
+ * @param hit_mask
+ *   Output containing a bitmask with all successful lookups.
+ * @param data
+ *   Output containing array of data returned from all the successful lookups.
+ *   Can be NULL.
+ * @return
+ *   -EINVAL if there's an error, otherwise number of successful lookups.
+ */
+__rte_experimental
+int
+rte_hash_lookup_with_hash_bulk_pipeline(const struct rte_hash *h,
+		const void **keys, hash_sig_t *prim_hash,
+		uint32_t num_keys, uint64_t *hit_mask, void *data[]);
+
 /**
  * Find multiple keys in the hash table.
  * This operation is multi-thread safe with regarding to other lookup threads.
@@ -674,6 +730,58 @@ rte_hash_iterate(const struct rte_hash *h, const void **key, void **data, uint32
  */
 int rte_hash_rcu_qsbr_add(struct rte_hash *h, struct rte_hash_rcu_config *cfg);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Start resizing a table created with RTE_HASH_EXTRA_FLAGS_RESIZABLE so it
+ * can hold at least the given number of entries.
+ * The entries are migrated to the new bucket table incrementally,
+ * see rte_hash_resize_step().
+ * This operation has the same thread safety requirements as
+ * rte_hash_add_key().
+ *
+ * @param h
+ *   Hash table to resize.
+ * @param entries
+ *   New number of entries, rounded up to a power of 2.
+ * @return
+ *   - 0 if the resize was started (or the table already has this size).
+ *   - -EINVAL if the parameters are invalid.
+ *   - -ENOTSUP if the table is not resizable, or is lock free and has no
+ *     RCU QSBR variable attached.
+ *   - -EBUSY if a previous resize is still in progress.
+ *   - -ENOSPC if the table holds more keys than the requested size.
+ *   - -ENOMEM if the new bucket table could not be allocated.
+ */
+__rte_experimental
+int
+rte_hash_resize(const struct rte_hash *h, uint32_t entries);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Migrate up to n_buckets buckets of an ongoing resize to the new bucket
+ * table. Resizes also progress on every key add and delete, this function
+ * allows a control thread to complete a resize while the table is idle.
+ * This operation has the same thread safety requirements as
+ * rte_hash_add_key().
+ *
+ * @param h
+ *   Hash table to work on.
+ * @param n_buckets
+ *   Maximum number of buckets to migrate, 0 only queries the state.
+ * @return
+ *   - The number of buckets left to migrate, 0 if no resize is in progress.
+ *   - -EINVAL if the parameters are invalid.
+ *   - -ENOTSUP if the table is not resizable.
+ *   - -ENOSPC if an entry could not be placed in the new bucket table.
+ */
+__rte_experimental
+int
+rte_hash_resize_step(const struct rte_hash *h, uint32_t n_buckets);
+
 #ifdef __cplusplus
 }
 #endif
@@ -26,10 +26,12 @@
 #include <rte_mempool.h>
 #include <rte_mbuf.h>
 #include <rte_mbuf_pool_ops.h>
+#include <rte_mempool_zc.h>
 #include <rte_string_fns.h>
 #include <rte_hexdump.h>
 #include <rte_errno.h>
 #include <rte_memcpy.h>
+#include <rte_vect.h>
 
 /*
  * pktmbuf pool constructor, given as a callback function to
@@ -492,30 +494,196 @@ __rte_pktmbuf_free_seg_via_array(struct rte_mbuf *m,
  */
 #define RTE_PKTMBUF_FREE_PENDING_SZ 64
 
+/**
+ * @internal Classify a burst of at most 64 packet mbufs to be freed.
+ *
+ * The direct, single segment mbufs with a reference count of one can be
+ * put back in their mempool as they are, without going through
+ * rte_pktmbuf_prefree_seg(). On x86-64, all these fields are in the 16
+ * bytes of the rearm data and offload flags, checked at once.
+ *
+ * @param mbufs
+ *  Array of packet mbufs, possibly NULL.
+ * @param n
+ *  Number of mbufs in the array, at most 64.
+ * @param pools
+ *  Array of 64 entries, filled with the mempool of each mbuf, NULL for
+ *  the NULL mbufs.
+ * @return
+ *  A bit mask, with the bit of each mbuf which can be put as is set.
+ */
+static inline uint64_t
+__rte_pktmbuf_free_classify(struct rte_mbuf * const *mbufs, unsigned int n,
+	struct rte_mempool ** const pools)
+{
+#if defined(RTE_ARCH_X86_64)
+	const __m128i mask = _mm_set_epi64x(
+		RTE_MBUF_F_INDIRECT | RTE_MBUF_F_EXTERNAL,
+		(uint64_t)UINT16_MAX << 16 | (uint64_t)UINT16_MAX << 32);
+	const __m128i direct = _mm_set_epi64x(0,
+		(uint64_t)1 << 16 | (uint64_t)1 << 32);
+	__m128i v;
+#endif
+	const struct rte_mbuf *m;
+	uint64_t fast = 0;
+	unsigned int i;
+
+#if defined(RTE_ARCH_X86_64)
+	RTE_BUILD_BUG_ON(offsetof(struct rte_mbuf, refcnt) !=
+			 offsetof(struct rte_mbuf, rearm_data) + 2);
+	RTE_BUILD_BUG_ON(offsetof(struct rte_mbuf, nb_segs) !=
+			 offsetof(struct rte_mbuf, rearm_data) + 4);
+	RTE_BUILD_BUG_ON(offsetof(struct rte_mbuf, ol_flags) !=
+			 offsetof(struct rte_mbuf, rearm_data) + 8);
+
+	/* The mempools are compared by pairs */
+	if (n & 1)
+		pools[n] = NULL;
+#endif
+	for (i = 0; i < n; i++) {
+		m = mbufs[i];
+		if (unlikely(m == NULL)) {
+			pools[i] = NULL;
+			continue;
+		}
+		__rte_mbuf_sanity_check(m, 1);
+		pools[i] = m->pool;
+#if defined(RTE_ARCH_X86_64)
+		v = _mm_loadu_si128((const __m128i *)&m->rearm_data);
+		v = _mm_xor_si128(_mm_and_si128(v, mask), direct);
+		fast |= (uint64_t)_mm_testz_si128(v, v) << i;
+#else
+		fast |= (uint64_t)(rte_mbuf_refcnt_read(m) == 1 &&
+				m->nb_segs == 1 && RTE_MBUF_DIRECT(m)) << i;
+#endif
+	}
+
+	return fast;
+}
+
+/**
+ * @internal Get the mbufs of a burst belonging to a mempool.
+ *
+ * @param pools
+ *  Array of the mempools of the mbufs, as filled by
+ *  __rte_pktmbuf_free_classify().
+ * @param n
+ *  Number of mbufs in the burst.
+ * @param mp
+ *  The mempool to look for.
+ * @return
+ *  A bit mask, with the bit of each mbuf of the mempool set.
+ */
+static inline uint64_t
+__rte_pktmbuf_free_pool_mask(struct rte_mempool * const *pools,
+	unsigned int n, const struct rte_mempool *mp)
+{
+	uint64_t match = 0;
+	unsigned int i;
+#if defined(RTE_ARCH_X86_64)
+	/* Two 64-bit mempool pointers per vector */
+	const __m128i v_mp = _mm_set1_epi64x((uintptr_t)mp);
+	__m128i v;
+
+	for (i = 0; i < n; i += 2) {
+		v = _mm_loadu_si128((const __m128i *)&pools[i]);
+		v = _mm_cmpeq_epi64(v, v_mp);
+		match |= (uint64_t)_mm_movemask_pd(_mm_castsi128_pd(v)) << i;
+	}
+#else
+	for (i = 0; i < n; i++)
+		match |= (uint64_t)(pools[i] == mp) << i;
+#endif
+
+	return match;
+}
+
+/* Copy the mbufs of a burst selected by a bit mask */
+static inline void
+__rte_pktmbuf_free_gather(struct rte_mbuf **dst,
+	struct rte_mbuf * const *mbufs, uint64_t match)
+{
+	unsigned int n = 0;
+
+	for (; match != 0; match &= match - 1)
+		dst[n++] = mbufs[rte_bsf64(match)];
+}
+
 /* Free a bulk of packet mbufs back into their original mempools. */
 void rte_pktmbuf_free_bulk(struct rte_mbuf **mbufs, unsigned int count)
 {
 	struct rte_mbuf *m, *m_next, *pending[RTE_PKTMBUF_FREE_PENDING_SZ];
-	unsigned int idx, nb_pending = 0;
+	struct rte_mempool *pools[64];
+	unsigned int idx, i, n, nb_fast, nb_pending = 0;
+	uint64_t all, fast, left, match;
+	struct rte_mempool_cache *cache;
+	struct rte_mempool *mp;
+	void **slots;
 
-	for (idx = 0; idx < count; idx++) {
-		m = mbufs[idx];
-		if (unlikely(m == NULL))
-			continue;
+	RTE_BUILD_BUG_ON(RTE_PKTMBUF_FREE_PENDING_SZ < 64);
 
-		__rte_mbuf_sanity_check(m, 1);
+	for (idx = 0; idx < count; idx += n) {
+		n = RTE_MIN(count - idx, 64U);
+		all = n == 64 ? UINT64_MAX : (UINT64_C(1) << n) - 1;
 
-		do {
-			m_next = m->next;
-			__rte_pktmbuf_free_seg_via_array(m,
-					pending, &nb_pending,
-					RTE_PKTMBUF_FREE_PENDING_SZ);
-			m = m_next;
-		} while (m != NULL);
-	}
+		/*
+		 * Put the direct single segment mbufs with one mempool
+		 * operation per mempool.
+		 */
+		fast = __rte_pktmbuf_free_classify(&mbufs[idx], n, pools);
+		left = fast;
+		while (left != 0) {
+			mp = pools[rte_bsf64(left)];
+			match = __rte_pktmbuf_free_pool_mask(pools, n, mp) &
+				left;
+			left &= ~match;
+			if (match == all) {
+				rte_mempool_put_bulk(mp, (void **)&mbufs[idx],
+						     n);
+				break;
+			}
+			nb_fast = __builtin_popcountll(match);
+			cache = rte_mempool_default_cache(mp, rte_lcore_id());
+			slots = cache == NULL ? NULL :
+				rte_mempool_cache_zc_put_bulk_start(cache, mp,
+								    nb_fast);
+			if (slots == NULL) {
+				__rte_pktmbuf_free_gather(pending,
+						&mbufs[idx], match);
+				rte_mempool_put_bulk(mp, (void **)pending,
+						     nb_fast);
+				continue;
+			}
+			__rte_pktmbuf_free_gather((struct rte_mbuf **)slots,
+					&mbufs[idx], match);
+			rte_mempool_cache_zc_put_finish(cache, mp, nb_fast);
+		}
+		if (likely(fast == all))
+			continue;
 
-	if (nb_pending > 0)
-		rte_mempool_put_bulk(pending[0]->pool, (void **)pending, nb_pending);
+		/*
+		 * Free the other mbufs segment by segment, putting the
+		 * consecutive segments of a mempool together.
+		 */
+		for (i = 0; i < n; i++) {
+			m = mbufs[idx + i];
+			if (fast & (UINT64_C(1) << i) || unlikely(m == NULL))
+				continue;
+
+			do {
+				m_next = m->next;
+				__rte_pktmbuf_free_seg_via_array(m,
+						pending, &nb_pending,
+						RTE_PKTMBUF_FREE_PENDING_SZ);
+				m = m_next;
+			} while (m != NULL);
+		}
+		if (nb_pending > 0) {
+			rte_mempool_put_bulk(pending[0]->pool,
+					     (void **)pending, nb_pending);
+			nb_pending = 0;
+		}
+	}
 }
 
 /* Creates a shallow copy of mbuf */
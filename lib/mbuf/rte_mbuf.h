@@ -1395,6 +1395,10 @@ static inline void rte_pktmbuf_free(struct rte_mbuf *m)
  * Free a bulk of mbufs, and all their segments in case of chained buffers.
  * Each segment is added back into its original mempool.
  *
+ * The segments are gathered per mempool, so that a burst interleaving
+ * mbufs of a few mempools is put back with one mempool operation per
+ * mempool.
+ *
  *  @param mbufs
  *    Array of pointers to packet mbufs.
  *    The array may contain NULL pointers.
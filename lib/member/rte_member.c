@@ -15,6 +15,8 @@
 #include "rte_member.h"
 #include "rte_member_ht.h"
 #include "rte_member_vbf.h"
+#include "rte_member_sketch.h"
+#include "rte_member_cf.h"
 
 TAILQ_HEAD(rte_member_list, rte_tailq_entry);
 static struct rte_tailq_elem rte_member_tailq = {
@@ -74,6 +76,12 @@ rte_member_free(struct rte_member_setsum *setsum)
 	case RTE_MEMBER_TYPE_VBF:
 		rte_member_free_vbf(setsum);
 		break;
+	case RTE_MEMBER_TYPE_SKETCH:
+		rte_member_free_sketch(setsum);
+		break;
+	case RTE_MEMBER_TYPE_CF:
+		rte_member_free_cf(setsum);
+		break;
 	default:
 		break;
 	}
@@ -147,6 +155,12 @@ rte_member_create(const struct rte_member_parameters *params)
 	case RTE_MEMBER_TYPE_VBF:
 		ret = rte_member_create_vbf(setsum, params);
 		break;
+	case RTE_MEMBER_TYPE_SKETCH:
+		ret = rte_member_create_sketch(setsum, params);
+		break;
+	case RTE_MEMBER_TYPE_CF:
+		ret = rte_member_create_cf(setsum, params);
+		break;
 	default:
 		goto error_unlock_exit;
 	}
@@ -180,6 +194,10 @@ rte_member_add(const struct rte_member_setsum *setsum, const void *key,
 		return rte_member_add_ht(setsum, key, set_id);
 	case RTE_MEMBER_TYPE_VBF:
 		return rte_member_add_vbf(setsum, key, set_id);
+	case RTE_MEMBER_TYPE_SKETCH:
+		return rte_member_add_sketch(setsum, key, 1);
+	case RTE_MEMBER_TYPE_CF:
+		return rte_member_add_cf(setsum, key, set_id);
 	default:
 		return -EINVAL;
 	}
@@ -197,6 +215,10 @@ rte_member_lookup(const struct rte_member_setsum *setsum, const void *key,
 		return rte_member_lookup_ht(setsum, key, set_id);
 	case RTE_MEMBER_TYPE_VBF:
 		return rte_member_lookup_vbf(setsum, key, set_id);
+	case RTE_MEMBER_TYPE_SKETCH:
+		return rte_member_lookup_sketch(setsum, key, set_id);
+	case RTE_MEMBER_TYPE_CF:
+		return rte_member_lookup_cf(setsum, key, set_id);
 	default:
 		return -EINVAL;
 	}
@@ -217,6 +239,12 @@ rte_member_lookup_bulk(const struct rte_member_setsum *setsum,
 	case RTE_MEMBER_TYPE_VBF:
 		return rte_member_lookup_bulk_vbf(setsum, keys, num_keys,
 				set_ids);
+	case RTE_MEMBER_TYPE_SKETCH:
+		return rte_member_lookup_bulk_sketch(setsum, keys, num_keys,
+				set_ids);
+	case RTE_MEMBER_TYPE_CF:
+		return rte_member_lookup_bulk_cf(setsum, keys, num_keys,
+				set_ids);
 	default:
 		return -EINVAL;
 	}
@@ -236,6 +264,9 @@ rte_member_lookup_multi(const struct rte_member_setsum *setsum, const void *key,
 	case RTE_MEMBER_TYPE_VBF:
 		return rte_member_lookup_multi_vbf(setsum, key, match_per_key,
 				set_id);
+	case RTE_MEMBER_TYPE_CF:
+		return rte_member_lookup_multi_cf(setsum, key, match_per_key,
+				set_id);
 	default:
 		return -EINVAL;
 	}
@@ -258,6 +289,9 @@ rte_member_lookup_multi_bulk(const struct rte_member_setsum *setsum,
 	case RTE_MEMBER_TYPE_VBF:
 		return rte_member_lookup_multi_bulk_vbf(setsum, keys, num_keys,
 				max_match_per_key, match_count, set_ids);
+	case RTE_MEMBER_TYPE_CF:
+		return rte_member_lookup_multi_bulk_cf(setsum, keys, num_keys,
+				max_match_per_key, match_count, set_ids);
 	default:
 		return -EINVAL;
 	}
@@ -273,8 +307,11 @@ rte_member_delete(const struct rte_member_setsum *setsum, const void *key,
 	switch (setsum->type) {
 	case RTE_MEMBER_TYPE_HT:
 		return rte_member_delete_ht(setsum, key, set_id);
-	/* current vBF implementation does not support delete function */
+	case RTE_MEMBER_TYPE_CF:
+		return rte_member_delete_cf(setsum, key, set_id);
+	/* current vBF and sketch implementations do not support delete */
 	case RTE_MEMBER_TYPE_VBF:
+	case RTE_MEMBER_TYPE_SKETCH:
 	default:
 		return -EINVAL;
 	}
@@ -292,9 +329,85 @@ rte_member_reset(const struct rte_member_setsum *setsum)
 	case RTE_MEMBER_TYPE_VBF:
 		rte_member_reset_vbf(setsum);
 		return;
+	case RTE_MEMBER_TYPE_SKETCH:
+		rte_member_reset_sketch(setsum);
+		return;
+	case RTE_MEMBER_TYPE_CF:
+		rte_member_reset_cf(setsum);
+		return;
 	default:
 		return;
 	}
 }
 
+int
+rte_member_add_count(const struct rte_member_setsum *setsum, const void *key,
+			uint32_t count)
+{
+	if (setsum == NULL || key == NULL ||
+			setsum->type != RTE_MEMBER_TYPE_SKETCH)
+		return -EINVAL;
+
+	return rte_member_add_sketch(setsum, key, count);
+}
+
+int
+rte_member_add_count_bulk(const struct rte_member_setsum *setsum,
+			const void **keys, uint32_t num_keys,
+			const uint32_t *counts)
+{
+	if (setsum == NULL || keys == NULL ||
+			num_keys > RTE_MEMBER_LOOKUP_BULK_MAX ||
+			setsum->type != RTE_MEMBER_TYPE_SKETCH)
+		return -EINVAL;
+
+	return rte_member_add_bulk_sketch(setsum, keys, num_keys, counts);
+}
+
+int
+rte_member_query_count(const struct rte_member_setsum *setsum,
+			const void *key, uint64_t *count)
+{
+	if (setsum == NULL || key == NULL || count == NULL ||
+			setsum->type != RTE_MEMBER_TYPE_SKETCH)
+		return -EINVAL;
+
+	return rte_member_query_sketch(setsum, key, count);
+}
+
+int
+rte_member_query_count_bulk(const struct rte_member_setsum *setsum,
+			const void **keys, uint32_t num_keys,
+			uint64_t *counts)
+{
+	if (setsum == NULL || keys == NULL || counts == NULL ||
+			num_keys > RTE_MEMBER_LOOKUP_BULK_MAX ||
+			setsum->type != RTE_MEMBER_TYPE_SKETCH)
+		return -EINVAL;
+
+	return rte_member_query_bulk_sketch(setsum, keys, num_keys, counts);
+}
+
+int
+rte_member_report_heavyhitter(const struct rte_member_setsum *setsum,
+			void **keys, uint64_t *counts)
+{
+	if (setsum == NULL || keys == NULL || counts == NULL ||
+			setsum->type != RTE_MEMBER_TYPE_SKETCH)
+		return -EINVAL;
+
+	return rte_member_report_heavyhitter_sketch(setsum, keys, counts);
+}
+
+int
+rte_member_decay_count(const struct rte_member_setsum *setsum,
+			uint32_t shift)
+{
+	if (setsum == NULL || setsum->type != RTE_MEMBER_TYPE_SKETCH)
+		return -EINVAL;
+
+	rte_member_decay_sketch(setsum, shift);
+	return 0;
+}
+
 RTE_LOG_REGISTER_DEFAULT(librte_member_logtype, DEBUG);
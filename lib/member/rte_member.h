@@ -15,6 +15,11 @@
  * bloom filter (vBF). For HT setsummary, two subtypes or modes are available,
  * cache and non-cache modes. The table below summarize some properties of
  * the different implementations.
+ * A third type, the count-min sketch, estimates how often each key was
+ * added, and keeps track of the most frequent keys (heavy hitters).
+ * A fourth type, the cuckoo filter (CF), packs a fingerprint of a
+ * configurable width and a set id in each entry, so it supports deletion
+ * with a lower false positive rate than vBF for the same memory.
  *
  * @warning
  * @b EXPERIMENTAL: this API may change without prior notice
@@ -52,6 +57,7 @@ extern "C" {
 #include <stdint.h>
 
 #include <rte_common.h>
+#include <rte_compat.h>
 #include <rte_config.h>
 
 /** The set ID type that stored internally in hash table based set summary. */
@@ -66,6 +72,16 @@ typedef uint16_t member_set_t;
 #define RTE_MEMBER_BUCKET_ENTRIES 16
 /** Maximum number of characters in setsum name. */
 #define RTE_MEMBER_NAMESIZE 32
+/** Maximum number of counter rows in sketch mode. */
+#define RTE_MEMBER_SKETCH_MAX_ROW 16
+/** Maximum number of heavy hitters tracked in sketch mode. */
+#define RTE_MEMBER_SKETCH_TOPK_MAX 4096
+/** Entry count per bucket in cuckoo filter mode. */
+#define RTE_MEMBER_CF_BUCKET_ENTRIES 4
+/** Minimum number of bits of a fingerprint in cuckoo filter mode. */
+#define RTE_MEMBER_CF_FP_BITS_MIN 8
+/** Maximum number of bits of an entry (fingerprint and set id) in CF mode. */
+#define RTE_MEMBER_CF_ENTRY_BITS_MAX 16
 
 /** @internal Hash function used by membership library. */
 #if defined(RTE_ARCH_X86) || defined(__ARM_FEATURE_CRC32)
@@ -105,6 +121,8 @@ struct rte_member_parameters;
 enum rte_member_setsum_type {
 	RTE_MEMBER_TYPE_HT = 0,  /**< Hash table based set summary. */
 	RTE_MEMBER_TYPE_VBF,     /**< Vector of bloom filters. */
+	RTE_MEMBER_TYPE_SKETCH,  /**< Count-min sketch. */
+	RTE_MEMBER_TYPE_CF,      /**< Cuckoo filter. */
 	RTE_MEMBER_NUM_TYPE
 };
 
@@ -138,11 +156,15 @@ struct rte_member_setsum {
 	uint32_t mul_shift;  /* vbf internal variable used during bit test. */
 	uint32_t div_shift;  /* vbf internal variable used during bit test. */
 
-	void *table;	/* This is the handler of hash table or vBF array. */
+	void *table;	/* This is the handler of hash table, vBF, sketch or CF. */
 
 
 	/* Second cache line should start here. */
 	uint32_t socket_id;          /* NUMA Socket ID for memory. */
+
+	/* Cuckoo filter, buckets are counted by bucket_cnt. */
+	uint32_t fp_bits;	/* Number of bits of a fingerprint. */
+	uint32_t entry_bits;	/* Number of bits of fingerprint and set id. */
 	char name[RTE_MEMBER_NAMESIZE]; /* Name of this set summary. */
 } __rte_cache_aligned;
 
@@ -167,6 +189,15 @@ struct rte_member_parameters {
 	 *
 	 * vBF setsummary is a vector of bloom filters. It is used when number
 	 * of sets is not big (less than 32 for current implementation).
+	 *
+	 * Sketch setsummary counts the keys rather than storing their set.
+	 * It is used to estimate the number of packets or bytes of each flow
+	 * and to find the largest flows, with a memory size that does not
+	 * depend on the number of flows.
+	 *
+	 * CF setsummary is a cuckoo filter storing a fingerprint and a set id
+	 * per key. It is used instead of vBF when keys need to be deleted,
+	 * or when a lower false positive rate is needed for the same memory.
 	 */
 	enum rte_member_setsum_type type;
 
@@ -206,6 +237,10 @@ struct rte_member_parameters {
 	 * number of bits we need for each BF. User does not specify the size of
 	 * each BF directly because the optimal size depends on the num_keys
 	 * and false positive rate.
+	 *
+	 * For CF, num_keys is the number of keys the filter must be able to
+	 * hold. The buckets are sized for num_keys at a 93% load, past which
+	 * adding a key may fail.
 	 */
 	uint32_t num_keys;
 
@@ -223,6 +258,9 @@ struct rte_member_parameters {
 	 * summary. If other number of sets are needed, for example 5, the user
 	 * should allocate the minimum available value that larger than 5,
 	 * which is 8.
+	 *
+	 * For CF, num_set is the largest set id, which may be any value.
+	 * Each entry stores the set id in ceil(log2(num_set)) bits.
 	 */
 	uint32_t num_set;
 
@@ -244,6 +282,9 @@ struct rte_member_parameters {
 	 * to number of entries (num_keys) divided by entry count per bucket
 	 * (RTE_MEMBER_BUCKET_ENTRIES). Thus, the false_positive_rate is not
 	 * directly set by users for HT mode.
+	 *
+	 * For CF, false_positive_rate sets the number of bits of the
+	 * fingerprints if fingerprint_bits is 0, see fingerprint_bits.
 	 */
 	float false_positive_rate;
 
@@ -263,6 +304,47 @@ struct rte_member_parameters {
 	uint32_t sec_hash_seed;
 
 	int socket_id;			/**< NUMA Socket ID for memory. */
+
+	/**
+	 * error_rate, error_prob and top_k are only used for sketch.
+	 *
+	 * The count the sketch estimates for a key exceeds the actual count
+	 * of this key by at most error_rate times the total count of all the
+	 * keys, with a probability of at least 1 - error_prob. That takes
+	 * ceil(ln(1 / error_prob)) rows of e / error_rate counters, the number
+	 * of counters per row being rounded up to a power of 2, and the
+	 * number of rows being at most RTE_MEMBER_SKETCH_MAX_ROW.
+	 */
+	float error_rate;
+
+	/**
+	 * The probability that the estimated count of a key exceeds the
+	 * error_rate bound, see error_rate.
+	 */
+	float error_prob;
+
+	/**
+	 * The number of heavy hitters the sketch keeps track of: the keys with
+	 * the largest estimated counts, reported by
+	 * rte_member_report_heavyhitter() and matched by rte_member_lookup().
+	 * 0 disables the tracking. At most RTE_MEMBER_SKETCH_TOPK_MAX.
+	 */
+	uint32_t top_k;
+
+	/**
+	 * fingerprint_bits is only used for CF.
+	 *
+	 * A key not in the filter is a false positive if one of the entries of
+	 * its two buckets has its fingerprint, which happens with a probability
+	 * of about 2 * RTE_MEMBER_CF_BUCKET_ENTRIES * load / 2^fingerprint_bits.
+	 * Each additional bit halves the false positive rate.
+	 * If 0, it is the smallest number of bits giving false_positive_rate.
+	 * It is at least RTE_MEMBER_CF_FP_BITS_MIN, as shorter fingerprints
+	 * also lower the load the filter can reach, and together with the bits
+	 * of the set id, at most RTE_MEMBER_CF_ENTRY_BITS_MAX. As the entries
+	 * take an even number of bits, the fingerprint gets any spare bit.
+	 */
+	uint32_t fingerprint_bits;
 };
 
 /**
@@ -302,6 +384,7 @@ rte_member_create(const struct rte_member_parameters *params);
  *
  * Lookup key in set-summary (SS).
  * Single key lookup and return as soon as the first match found
+ * For sketch, a key matches set id 1 if it is one of the heavy hitters.
  *
  * @param setsum
  *   Pointer of a setsummary.
@@ -418,8 +501,8 @@ rte_member_lookup_multi_bulk(const struct rte_member_setsum *setsum,
  *   supports different set_id ranges. 0 cannot be used as set_id since
  *   RTE_MEMBER_NO_MATCH by default is set as 0.
  *   For HT mode, the set_id has range as [1, 0x7FFF], MSB is reserved.
- *   For vBF mode the set id is limited by the num_set parameter when create
- *   the set-summary.
+ *   For vBF and CF modes the set id is limited by the num_set parameter when
+ *   create the set-summary.
  * @return
  *   HT (cache mode) and vBF should never fail unless the set_id is not in the
  *   valid range. In such case -EINVAL is returned.
@@ -428,9 +511,11 @@ rte_member_lookup_multi_bulk(const struct rte_member_setsum *setsum,
  *   For success it returns different values for different modes to provide
  *   extra information for users.
  *   Return 0 for HT (cache mode) if the add does not cause
- *   eviction, return 1 otherwise. Return 0 for non-cache mode if success,
- *   -ENOSPC for full, and 1 if cuckoo eviction happens.
+ *   eviction, return 1 otherwise. Return 0 for non-cache mode and CF if
+ *   success, -ENOSPC for full, and 1 if cuckoo eviction happens.
  *   Always returns 0 for vBF mode.
+ *   For sketch, the key is counted once and set_id is ignored, see
+ *   rte_member_add_count(). It returns 0.
  */
 int
 rte_member_add(const struct rte_member_setsum *setsum, const void *key,
@@ -465,24 +550,164 @@ rte_member_reset(const struct rte_member_setsum *setsum);
  * @warning
  * @b EXPERIMENTAL: this API may change without prior notice
  *
- * Delete items from the set-summary. Note that vBF does not support deletion
- * in current implementation. For vBF, error code of -EINVAL will be returned.
+ * Delete items from the set-summary. Note that vBF and sketch do not support
+ * deletion in current implementation. For them, error code of -EINVAL will
+ * be returned.
  *
  * @param setsum
  *   Pointer to the set-summary.
  * @param key
  *   Pointer of the key to be deleted.
  * @param set_id
- *   For HT mode, we need both key and its corresponding set_id to
+ *   For HT and CF modes, we need both key and its corresponding set_id to
  *   properly delete the key. Without set_id, we may delete other keys with the
- *   same signature.
+ *   same signature. RTE_MEMBER_NO_MATCH is not a valid set_id.
+ *   Deleting a key which was not added may delete another key with the same
+ *   signature, which then gets a false negative.
  * @return
- *   If no entry found to delete, an error code of -ENOENT could be returned.
+ *   0 on success. If no entry found to delete, an error code of -ENOENT
+ *   could be returned, and -EINVAL for an invalid set_id.
  */
 int
 rte_member_delete(const struct rte_member_setsum *setsum, const void *key,
 			member_set_t set_id);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Count a key in a sketch set-summary: add count, e.g. the number of
+ * packets or bytes seen for the flow, to the counters of the key.
+ * The heavy hitters are updated with the new estimated count of the key.
+ *
+ * @param setsum
+ *   Pointer of a sketch set-summary.
+ * @param key
+ *   Pointer of the key to count.
+ * @param count
+ *   Value to add to the count of the key.
+ * @return
+ *   0 on success, -EINVAL if the set-summary is not a sketch.
+ */
+__rte_experimental
+int
+rte_member_add_count(const struct rte_member_setsum *setsum, const void *key,
+			uint32_t count);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Count a bulk of keys in a sketch set-summary, as rte_member_add_count()
+ * does for each of them in turn. The counters of the whole bulk are
+ * prefetched before being updated.
+ *
+ * @param setsum
+ *   Pointer of a sketch set-summary.
+ * @param keys
+ *   Pointer of the bulk of keys to count.
+ * @param num_keys
+ *   Number of keys to count, at most RTE_MEMBER_LOOKUP_BULK_MAX.
+ * @param counts
+ *   Value to add to the count of each key, NULL to count each key once.
+ * @return
+ *   0 on success, -EINVAL if the parameters are invalid.
+ */
+__rte_experimental
+int
+rte_member_add_count_bulk(const struct rte_member_setsum *setsum,
+			const void **keys, uint32_t num_keys,
+			const uint32_t *counts);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Estimate the count of a key in a sketch set-summary.
+ * The estimate is never lower than the actual count of the key.
+ *
+ * @param setsum
+ *   Pointer of a sketch set-summary.
+ * @param key
+ *   Pointer of the key to query.
+ * @param count
+ *   Output the estimated count of the key.
+ * @return
+ *   0 on success, -EINVAL if the set-summary is not a sketch.
+ */
+__rte_experimental
+int
+rte_member_query_count(const struct rte_member_setsum *setsum,
+			const void *key, uint64_t *count);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Estimate the count of a bulk of keys in a sketch set-summary.
+ *
+ * @param setsum
+ *   Pointer of a sketch set-summary.
+ * @param keys
+ *   Pointer of the bulk of keys to query.
+ * @param num_keys
+ *   Number of keys to query, at most RTE_MEMBER_LOOKUP_BULK_MAX.
+ * @param counts
+ *   Output the estimated count of each key.
+ * @return
+ *   0 on success, -EINVAL if the parameters are invalid.
+ */
+__rte_experimental
+int
+rte_member_query_count_bulk(const struct rte_member_setsum *setsum,
+			const void **keys, uint32_t num_keys,
+			uint64_t *counts);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Report the heavy hitters of a sketch set-summary: the keys with the
+ * largest estimated counts, in decreasing order of count.
+ *
+ * @param setsum
+ *   Pointer of a sketch set-summary.
+ * @param keys
+ *   Output pointers to the heavy hitter keys, sized by the top_k
+ *   parameter of the set-summary. The keys are kept by the set-summary,
+ *   they stay valid until it is next updated, decayed or reset.
+ * @param counts
+ *   Output the estimated count of each heavy hitter, sized by top_k.
+ * @return
+ *   The number of heavy hitters reported, -EINVAL if the set-summary is
+ *   not a sketch.
+ */
+__rte_experimental
+int
+rte_member_report_heavyhitter(const struct rte_member_setsum *setsum,
+			void **keys, uint64_t *counts);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Decay all the counts of a sketch set-summary, dividing them by 2^shift,
+ * so that the old traffic weighs less than the recent one. For example,
+ * calling it with a shift of 1 every second makes the counts an
+ * exponentially weighted moving sum with a half-life of one second.
+ *
+ * @param setsum
+ *   Pointer of a sketch set-summary.
+ * @param shift
+ *   Number of bits to shift the counts right by, 64 or more zeroes them.
+ * @return
+ *   0 on success, -EINVAL if the set-summary is not a sketch.
+ */
+__rte_experimental
+int
+rte_member_decay_count(const struct rte_member_setsum *setsum,
+			uint32_t shift);
+
 #ifdef __cplusplus
 }
 #endif
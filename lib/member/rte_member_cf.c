@@ -0,0 +1,445 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 agent <agent@local>
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include <rte_byteorder.h>
+#include <rte_errno.h>
+#include <rte_malloc.h>
+#include <rte_prefetch.h>
+#include <rte_random.h>
+#include <rte_log.h>
+
+#include "rte_member.h"
+#include "rte_member_cf.h"
+
+/*
+ * Cuckoo filter [B. Fan et al., "Cuckoo Filter: Practically Better Than
+ * Bloom"]: each key is stored as an entry of entry_bits bits, made of a
+ * fingerprint of fp_bits bits and of the set id minus 1 above it, in one
+ * of its two buckets of RTE_MEMBER_CF_BUCKET_ENTRIES entries. An entry with
+ * a zero fingerprint is free, so a fingerprint is never 0.
+ *
+ * The alternative bucket of an entry is derived from its current bucket
+ * and its fingerprint, so entries are moved between their two buckets to
+ * make room for a new key, and deleted, without the full key.
+ *
+ * The entries of a bucket are packed in entry_bits / 2 bytes, entry_bits
+ * being even, and read as a little endian 64-bit word, the bits past the
+ * bucket belonging to the next buckets. The table is padded for the word
+ * of the last bucket. All the fingerprints of a bucket are compared at once
+ * with arithmetic on this word, so the bucket count needs not be a power
+ * of 2 and the filter is sized to the number of keys.
+ */
+
+/* Load of the buckets holding num_keys keys, in percent */
+#define CF_LOAD_PERCENT 93
+/* Multiplier hashing a fingerprint to the offset of its alternative bucket */
+#define CF_FP_HASH_MUL 0x9e3779b1U
+
+static inline uint32_t
+cf_bucket_size(const struct rte_member_setsum *ss)
+{
+	return ss->entry_bits * RTE_MEMBER_CF_BUCKET_ENTRIES / 8;
+}
+
+static inline const uint8_t *
+cf_bucket(const struct rte_member_setsum *ss, uint32_t bkt)
+{
+	return (const uint8_t *)ss->table + (size_t)bkt * cf_bucket_size(ss);
+}
+
+static inline uint64_t
+cf_load(const struct rte_member_setsum *ss, uint32_t bkt)
+{
+	uint64_t word;
+
+	memcpy(&word, cf_bucket(ss, bkt), sizeof(word));
+	return rte_le_to_cpu_64(word);
+}
+
+/* Store a bucket, the bits of the next buckets in word being unchanged */
+static inline void
+cf_store(const struct rte_member_setsum *ss, uint32_t bkt, uint64_t word)
+{
+	word = rte_cpu_to_le_64(word);
+	memcpy((uint8_t *)(uintptr_t)cf_bucket(ss, bkt), &word, sizeof(word));
+}
+
+/* Map a 32-bit hash to a bucket, without division */
+static inline uint32_t
+cf_reduce(const struct rte_member_setsum *ss, uint32_t hash)
+{
+	return ((uint64_t)hash * ss->bucket_cnt) >> 32;
+}
+
+/* The other bucket of an entry with fingerprint fp in bucket bkt */
+static inline uint32_t
+cf_alt_bucket(const struct rte_member_setsum *ss, uint32_t bkt, uint32_t fp)
+{
+	uint32_t off = cf_reduce(ss, fp * CF_FP_HASH_MUL);
+
+	/* (off - bkt) modulo bucket_cnt, which maps back to bkt */
+	return off >= bkt ? off - bkt : off + ss->bucket_cnt - bkt;
+}
+
+static inline void
+cf_hash(const struct rte_member_setsum *ss, const void *key, uint32_t *bkt,
+		uint32_t *fp)
+{
+	uint32_t first_hash = MEMBER_HASH_FUNC(key, ss->key_len,
+						ss->prim_hash_seed);
+	uint32_t sec_hash = MEMBER_HASH_FUNC(&first_hash, sizeof(uint32_t),
+						ss->sec_hash_seed);
+
+	*bkt = cf_reduce(ss, first_hash);
+	*fp = sec_hash & RTE_LEN2MASK(ss->fp_bits, uint32_t);
+	*fp += (*fp == 0);
+}
+
+/*
+ * Return the top fingerprint bit of each entry of the bucket word with
+ * fingerprint fp, set in a single pass over the whole word: the low
+ * fingerprint bits of an entry added to all ones carry into its top bit
+ * unless they are all zeroes, and no carry crosses an entry.
+ */
+static inline uint64_t
+cf_match(const struct rte_member_setsum *ss, uint64_t word, uint32_t fp)
+{
+	uint32_t w = ss->entry_bits;
+	uint64_t ones = 1 | 1ULL << w | 1ULL << (2 * w) | 1ULL << (3 * w);
+	uint64_t top = ones << (ss->fp_bits - 1);
+	uint64_t low = top - ones;
+	uint64_t x = word ^ (ones * fp);
+
+	return ~(((x & low) + low) | x) & top;
+}
+
+/* Bit position of the first entry matched by a cf_match() mask */
+static inline uint32_t
+cf_match_pos(const struct rte_member_setsum *ss, uint64_t match)
+{
+	return __builtin_ctzll(match) - (ss->fp_bits - 1);
+}
+
+static inline member_set_t
+cf_entry_set(const struct rte_member_setsum *ss, uint64_t word, uint32_t pos)
+{
+	/* there may be no set id bits */
+	return ((word >> pos >> ss->fp_bits) &
+		((1U << (ss->entry_bits - ss->fp_bits)) - 1)) + 1;
+}
+
+static inline uint32_t
+cf_entry(const struct rte_member_setsum *ss, uint32_t fp, member_set_t set_id)
+{
+	return fp | (uint32_t)(set_id - 1) << ss->fp_bits;
+}
+
+static inline uint32_t
+cf_entry_fp(const struct rte_member_setsum *ss, uint32_t entry)
+{
+	return entry & RTE_LEN2MASK(ss->fp_bits, uint32_t);
+}
+
+static inline uint32_t
+cf_get_entry(const struct rte_member_setsum *ss, uint64_t word, uint32_t pos)
+{
+	return (word >> pos) & RTE_LEN2MASK(ss->entry_bits, uint64_t);
+}
+
+static inline uint64_t
+cf_set_entry(const struct rte_member_setsum *ss, uint64_t word, uint32_t pos,
+		uint32_t entry)
+{
+	word &= ~(RTE_LEN2MASK(ss->entry_bits, uint64_t) << pos);
+	return word | (uint64_t)entry << pos;
+}
+
+int
+rte_member_create_cf(struct rte_member_setsum *ss,
+		const struct rte_member_parameters *params)
+{
+	uint32_t set_bits, fp_bits, entry_bits;
+	uint64_t num_buckets;
+	size_t size;
+
+	if (params->num_keys == 0 || params->num_keys > RTE_MEMBER_ENTRIES_MAX ||
+			params->num_set == 0 ||
+			(params->fingerprint_bits != 0 &&
+			 params->fingerprint_bits < RTE_MEMBER_CF_FP_BITS_MIN) ||
+			(params->fingerprint_bits == 0 &&
+			 (params->false_positive_rate <= 0 ||
+			  params->false_positive_rate >= 1))) {
+		rte_errno = EINVAL;
+		RTE_MEMBER_LOG(ERR, "Membership CF create with invalid parameters\n");
+		return -EINVAL;
+	}
+
+	set_bits = params->num_set > 1 ?
+		32 - __builtin_clz(params->num_set - 1) : 0;
+	fp_bits = params->fingerprint_bits;
+	if (fp_bits == 0) {
+		fp_bits = ceil(log2(2 * RTE_MEMBER_CF_BUCKET_ENTRIES /
+			params->false_positive_rate + 1));
+		fp_bits = RTE_MAX(fp_bits, (uint32_t)RTE_MEMBER_CF_FP_BITS_MIN);
+	}
+	entry_bits = RTE_ALIGN_CEIL(fp_bits + set_bits, 2);
+	if (entry_bits > RTE_MEMBER_CF_ENTRY_BITS_MAX) {
+		rte_errno = EINVAL;
+		RTE_MEMBER_LOG(ERR, "Membership CF create with %u set id bits "
+			"and %u fingerprint bits, more than %u bits per entry\n",
+			set_bits, fp_bits, RTE_MEMBER_CF_ENTRY_BITS_MAX);
+		return -EINVAL;
+	}
+
+	num_buckets = ((uint64_t)params->num_keys * 100 + CF_LOAD_PERCENT *
+		RTE_MEMBER_CF_BUCKET_ENTRIES - 1) /
+		(CF_LOAD_PERCENT * RTE_MEMBER_CF_BUCKET_ENTRIES);
+	ss->bucket_cnt = num_buckets;
+	ss->fp_bits = entry_bits - set_bits;
+	ss->entry_bits = entry_bits;
+
+	/* the last bucket is read as a whole 64-bit word */
+	size = (size_t)num_buckets * cf_bucket_size(ss) + sizeof(uint64_t);
+	ss->table = rte_zmalloc_socket(NULL, size, RTE_CACHE_LINE_SIZE,
+			ss->socket_id);
+	if (ss->table == NULL) {
+		RTE_MEMBER_LOG(ERR, "memory allocation failed for CF "
+						"setsummary\n");
+		return -ENOMEM;
+	}
+
+	RTE_MEMBER_LOG(DEBUG, "Cuckoo filter created, %u buckets of %u "
+		"entries with %u-bit fingerprints and %u-bit set ids, "
+		"%zu bytes\n", ss->bucket_cnt, RTE_MEMBER_CF_BUCKET_ENTRIES,
+		ss->fp_bits, set_bits, size);
+	return 0;
+}
+
+static inline int
+search_bucket_single(const struct rte_member_setsum *ss, uint32_t bkt,
+		uint32_t fp, member_set_t *set_id)
+{
+	uint64_t word = cf_load(ss, bkt);
+	uint64_t match = cf_match(ss, word, fp);
+
+	if (match == 0)
+		return 0;
+	*set_id = cf_entry_set(ss, word, cf_match_pos(ss, match));
+	return 1;
+}
+
+static inline void
+search_bucket_multi(const struct rte_member_setsum *ss, uint32_t bkt,
+		uint32_t fp, uint32_t *counter, uint32_t match_per_key,
+		member_set_t *set_id)
+{
+	uint64_t word = cf_load(ss, bkt);
+	uint64_t match = cf_match(ss, word, fp);
+
+	while (match != 0 && *counter < match_per_key) {
+		set_id[(*counter)++] = cf_entry_set(ss, word,
+				cf_match_pos(ss, match));
+		match &= match - 1;
+	}
+}
+
+int
+rte_member_lookup_cf(const struct rte_member_setsum *ss, const void *key,
+		member_set_t *set_id)
+{
+	uint32_t bkt, fp;
+
+	cf_hash(ss, key, &bkt, &fp);
+	if (search_bucket_single(ss, bkt, fp, set_id) ||
+			search_bucket_single(ss, cf_alt_bucket(ss, bkt, fp),
+				fp, set_id))
+		return 1;
+
+	*set_id = RTE_MEMBER_NO_MATCH;
+	return 0;
+}
+
+uint32_t
+rte_member_lookup_bulk_cf(const struct rte_member_setsum *ss,
+		const void **keys, uint32_t num_keys, member_set_t *set_ids)
+{
+	uint32_t i;
+	uint32_t num_matches = 0;
+	uint32_t fp[RTE_MEMBER_LOOKUP_BULK_MAX];
+	uint32_t prim_buckets[RTE_MEMBER_LOOKUP_BULK_MAX];
+	uint32_t sec_buckets[RTE_MEMBER_LOOKUP_BULK_MAX];
+
+	for (i = 0; i < num_keys; i++) {
+		cf_hash(ss, keys[i], &prim_buckets[i], &fp[i]);
+		sec_buckets[i] = cf_alt_bucket(ss, prim_buckets[i], fp[i]);
+		rte_prefetch0(cf_bucket(ss, prim_buckets[i]));
+		rte_prefetch0(cf_bucket(ss, sec_buckets[i]));
+	}
+
+	for (i = 0; i < num_keys; i++) {
+		if (search_bucket_single(ss, prim_buckets[i], fp[i],
+				&set_ids[i]) ||
+				search_bucket_single(ss, sec_buckets[i], fp[i],
+					&set_ids[i]))
+			num_matches++;
+		else
+			set_ids[i] = RTE_MEMBER_NO_MATCH;
+	}
+	return num_matches;
+}
+
+uint32_t
+rte_member_lookup_multi_cf(const struct rte_member_setsum *ss,
+		const void *key, uint32_t match_per_key, member_set_t *set_id)
+{
+	uint32_t num_matches = 0;
+	uint32_t bkt, fp;
+
+	cf_hash(ss, key, &bkt, &fp);
+	search_bucket_multi(ss, bkt, fp, &num_matches, match_per_key, set_id);
+	search_bucket_multi(ss, cf_alt_bucket(ss, bkt, fp), fp, &num_matches,
+			match_per_key, set_id);
+	return num_matches;
+}
+
+uint32_t
+rte_member_lookup_multi_bulk_cf(const struct rte_member_setsum *ss,
+		const void **keys, uint32_t num_keys, uint32_t match_per_key,
+		uint32_t *match_count, member_set_t *set_ids)
+{
+	uint32_t i;
+	uint32_t num_matches = 0;
+	uint32_t match_cnt_tmp;
+	uint32_t fp[RTE_MEMBER_LOOKUP_BULK_MAX];
+	uint32_t prim_buckets[RTE_MEMBER_LOOKUP_BULK_MAX];
+	uint32_t sec_buckets[RTE_MEMBER_LOOKUP_BULK_MAX];
+
+	for (i = 0; i < num_keys; i++) {
+		cf_hash(ss, keys[i], &prim_buckets[i], &fp[i]);
+		sec_buckets[i] = cf_alt_bucket(ss, prim_buckets[i], fp[i]);
+		rte_prefetch0(cf_bucket(ss, prim_buckets[i]));
+		rte_prefetch0(cf_bucket(ss, sec_buckets[i]));
+	}
+
+	for (i = 0; i < num_keys; i++) {
+		match_cnt_tmp = 0;
+		search_bucket_multi(ss, prim_buckets[i], fp[i], &match_cnt_tmp,
+				match_per_key, &set_ids[i * match_per_key]);
+		search_bucket_multi(ss, sec_buckets[i], fp[i], &match_cnt_tmp,
+				match_per_key, &set_ids[i * match_per_key]);
+		match_count[i] = match_cnt_tmp;
+		if (match_cnt_tmp != 0)
+			num_matches++;
+	}
+	return num_matches;
+}
+
+/* Store entry in a free slot of bucket bkt, if any */
+static inline int
+try_insert(const struct rte_member_setsum *ss, uint32_t bkt, uint32_t entry)
+{
+	uint64_t word = cf_load(ss, bkt);
+	uint64_t free_slots = cf_match(ss, word, 0);
+
+	if (free_slots == 0)
+		return 0;
+	cf_store(ss, bkt, cf_set_entry(ss, word,
+			cf_match_pos(ss, free_slots), entry));
+	return 1;
+}
+
+/* Swap entry with the one in a slot of bucket bkt, returning the latter */
+static inline uint32_t
+swap_entry(const struct rte_member_setsum *ss, uint32_t bkt, uint32_t pos,
+		uint32_t entry)
+{
+	uint64_t word = cf_load(ss, bkt);
+	uint32_t victim = cf_get_entry(ss, word, pos);
+
+	cf_store(ss, bkt, cf_set_entry(ss, word, pos, entry));
+	return victim;
+}
+
+int
+rte_member_add_cf(const struct rte_member_setsum *ss, const void *key,
+		member_set_t set_id)
+{
+	uint32_t kick_bkt[RTE_MEMBER_CF_MAX_KICKS];
+	uint8_t kick_pos[RTE_MEMBER_CF_MAX_KICKS];
+	uint32_t bkt, alt, fp, entry;
+	int i;
+
+	if (set_id == RTE_MEMBER_NO_MATCH || set_id > ss->num_set)
+		return -EINVAL;
+
+	cf_hash(ss, key, &bkt, &fp);
+	entry = cf_entry(ss, fp, set_id);
+	alt = cf_alt_bucket(ss, bkt, fp);
+	if (try_insert(ss, bkt, entry) || try_insert(ss, alt, entry))
+		return 0;
+
+	/*
+	 * Both buckets are full: move a random entry of a random one of them
+	 * to its other bucket, and so on until an entry finds a free slot.
+	 */
+	if (rte_rand() & 1)
+		bkt = alt;
+	for (i = 0; i < RTE_MEMBER_CF_MAX_KICKS; i++) {
+		kick_bkt[i] = bkt;
+		kick_pos[i] = (rte_rand() % RTE_MEMBER_CF_BUCKET_ENTRIES) *
+			ss->entry_bits;
+		entry = swap_entry(ss, bkt, kick_pos[i], entry);
+		bkt = cf_alt_bucket(ss, bkt, cf_entry_fp(ss, entry));
+		if (try_insert(ss, bkt, entry))
+			return 1;
+	}
+
+	/* Undo the moves, so that no key is lost */
+	while (--i >= 0)
+		entry = swap_entry(ss, kick_bkt[i], kick_pos[i], entry);
+	return -ENOSPC;
+}
+
+void
+rte_member_free_cf(struct rte_member_setsum *ss)
+{
+	rte_free(ss->table);
+}
+
+int
+rte_member_delete_cf(const struct rte_member_setsum *ss, const void *key,
+		member_set_t set_id)
+{
+	uint32_t bkt, fp, i, pos;
+	uint64_t word, match;
+
+	if (set_id == RTE_MEMBER_NO_MATCH || set_id > ss->num_set)
+		return -EINVAL;
+
+	cf_hash(ss, key, &bkt, &fp);
+	for (i = 0; i < 2; i++) {
+		word = cf_load(ss, bkt);
+		for (match = cf_match(ss, word, fp); match != 0;
+				match &= match - 1) {
+			pos = cf_match_pos(ss, match);
+			if (cf_entry_set(ss, word, pos) == set_id) {
+				cf_store(ss, bkt, cf_set_entry(ss, word, pos,
+						0));
+				return 0;
+			}
+		}
+		bkt = cf_alt_bucket(ss, bkt, fp);
+	}
+	return -ENOENT;
+}
+
+void
+rte_member_reset_cf(const struct rte_member_setsum *ss)
+{
+	memset(ss->table, 0, (size_t)ss->bucket_cnt * cf_bucket_size(ss) +
+			sizeof(uint64_t));
+}
@@ -33,6 +33,24 @@ update_entry_search(uint32_t bucket_id, member_sig_t tmp_sig,
 	return 0;
 }
 
+/* Search bucket for entry with tmp_sig and set_id and delete it */
+static inline int
+delete_entry_search(uint32_t bucket_id, member_sig_t tmp_sig,
+		struct member_ht_bucket *buckets,
+		member_set_t set_id)
+{
+	uint32_t i;
+
+	for (i = 0; i < RTE_MEMBER_BUCKET_ENTRIES; i++) {
+		if (buckets[bucket_id].sigs[i] == tmp_sig &&
+				buckets[bucket_id].sets[i] == set_id) {
+			buckets[bucket_id].sets[i] = RTE_MEMBER_NO_MATCH;
+			return 1;
+		}
+	}
+	return 0;
+}
+
 static inline int
 search_bucket_single(uint32_t bucket_id, member_sig_t tmp_sig,
 		struct member_ht_bucket *buckets,
@@ -493,7 +511,7 @@ rte_member_add_ht(const struct rte_member_setsum *ss,
 		return ret;
 
 	/* Random pick prim or sec for recursive displacement */
-	uint32_t select_bucket = (tmp_sig && 1U) ? prim_bucket : sec_bucket;
+	uint32_t select_bucket = (tmp_sig & 1U) ? prim_bucket : sec_bucket;
 	if (ss->cache) {
 		ret = evict_from_bucket();
 		buckets[select_bucket].sigs[ret] = tmp_sig;
@@ -521,27 +539,31 @@ int
 rte_member_delete_ht(const struct rte_member_setsum *ss, const void *key,
 		member_set_t set_id)
 {
-	int i;
 	uint32_t prim_bucket, sec_bucket;
 	member_sig_t tmp_sig;
 	struct member_ht_bucket *buckets = ss->table;
 
+	if (set_id == RTE_MEMBER_NO_MATCH)
+		return -EINVAL;
+
 	get_buckets_index(ss, key, &prim_bucket, &sec_bucket, &tmp_sig);
 
-	for (i = 0; i < RTE_MEMBER_BUCKET_ENTRIES; i++) {
-		if (tmp_sig == buckets[prim_bucket].sigs[i] &&
-				set_id == buckets[prim_bucket].sets[i]) {
-			buckets[prim_bucket].sets[i] = RTE_MEMBER_NO_MATCH;
+	switch (ss->sig_cmp_fn) {
+#if defined(RTE_ARCH_X86) && defined(__AVX2__)
+	case RTE_MEMBER_COMPARE_AVX2:
+		if (delete_entry_search_avx(prim_bucket, tmp_sig, buckets,
+				set_id) ||
+				delete_entry_search_avx(sec_bucket, tmp_sig,
+					buckets, set_id))
 			return 0;
-		}
-	}
-
-	for (i = 0; i < RTE_MEMBER_BUCKET_ENTRIES; i++) {
-		if (tmp_sig == buckets[sec_bucket].sigs[i] &&
-				set_id == buckets[sec_bucket].sets[i]) {
-			buckets[sec_bucket].sets[i] = RTE_MEMBER_NO_MATCH;
+		break;
+#endif
+	default:
+		if (delete_entry_search(prim_bucket, tmp_sig, buckets,
+				set_id) ||
+				delete_entry_search(sec_bucket, tmp_sig,
+					buckets, set_id))
 			return 0;
-		}
 	}
 	return -ENOENT;
 }
@@ -0,0 +1,494 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 agent <agent@local>
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include <rte_errno.h>
+#include <rte_malloc.h>
+#include <rte_prefetch.h>
+#include <rte_log.h>
+#include <rte_vect.h>
+
+#include "rte_member.h"
+#include "rte_member_sketch.h"
+
+#if defined(RTE_ARCH_X86)
+#include "rte_member_x86.h"
+#endif
+
+/*
+ * Count-min sketch: num_row rows of num_col counters, each row indexed by
+ * a different hash of the key. Counting a key adds to its counter in
+ * each row, the estimated count of the key being the minimum of them:
+ * the other keys sharing a counter can only make it larger.
+ * Like vBF, the row hashes are derived from the two hashes of the key.
+ *
+ * The heavy hitters are kept in a min-heap by estimated count, so a key
+ * counted past the smallest of them replaces it. An open addressing index
+ * by key hash finds the heap entry of a key.
+ */
+
+#define SKETCH_IDX_NONE	UINT32_MAX
+
+static inline void
+sketch_hash(const struct rte_member_setsum *ss, const void *key,
+		uint32_t *h1, uint32_t *h2)
+{
+	*h1 = MEMBER_HASH_FUNC(key, ss->key_len, ss->prim_hash_seed);
+	/* an odd step gives a different counter in each row */
+	*h2 = MEMBER_HASH_FUNC(h1, sizeof(uint32_t), ss->sec_hash_seed) | 1;
+}
+
+static inline void
+sketch_row_index(const struct member_sketch *sk, uint32_t h1, uint32_t h2,
+		uint32_t idx[RTE_MEMBER_SKETCH_MAX_ROW])
+{
+	uint32_t r;
+
+	/* a sketch has at least one row, set out of the loop for the compiler */
+	idx[0] = h1 & sk->col_mask;
+	for (r = 1; r < sk->num_row; r++)
+		idx[r] = ((h1 + r * h2) & sk->col_mask) + r * sk->num_col;
+}
+
+static inline uint64_t
+sketch_min(const struct member_sketch *sk,
+		const uint32_t idx[RTE_MEMBER_SKETCH_MAX_ROW])
+{
+	uint32_t r;
+	uint64_t min;
+
+	min = sk->counters[idx[0]];
+	for (r = 1; r < sk->num_row; r++)
+		min = RTE_MIN(min, sk->counters[idx[r]]);
+	return min;
+}
+
+static inline void
+get_row_index(const struct rte_member_setsum *ss, uint32_t h1, uint32_t h2,
+		uint32_t idx[RTE_MEMBER_SKETCH_MAX_ROW])
+{
+	switch (ss->sig_cmp_fn) {
+#if defined(RTE_ARCH_X86) && defined(__AVX2__)
+	case RTE_MEMBER_COMPARE_AVX2:
+		sketch_row_index_avx(ss->table, h1, h2, idx);
+		break;
+#endif
+	default:
+		sketch_row_index(ss->table, h1, h2, idx);
+	}
+}
+
+static inline uint64_t
+get_min(const struct rte_member_setsum *ss,
+		const uint32_t idx[RTE_MEMBER_SKETCH_MAX_ROW])
+{
+	switch (ss->sig_cmp_fn) {
+#if defined(RTE_ARCH_X86) && defined(__AVX2__)
+	case RTE_MEMBER_COMPARE_AVX2:
+		return sketch_min_avx(ss->table, idx);
+#endif
+	default:
+		return sketch_min(ss->table, idx);
+	}
+}
+
+static inline uint8_t *
+sketch_key(const struct rte_member_setsum *ss, const struct member_sketch *sk,
+		uint32_t key_idx)
+{
+	return sk->keys + (size_t)key_idx * ss->key_len;
+}
+
+/* Find the heap position of a heavy hitter key, SKETCH_IDX_NONE if none */
+static uint32_t
+sketch_hh_find(const struct rte_member_setsum *ss,
+		const struct member_sketch *sk, const void *key, uint32_t hash)
+{
+	uint32_t s, pos;
+
+	for (s = hash & sk->idx_mask; sk->idx[s] != 0;
+			s = (s + 1) & sk->idx_mask) {
+		pos = sk->idx[s] - 1;
+		if (sk->hh[pos].hash == hash && memcmp(key,
+				sketch_key(ss, sk, sk->hh[pos].key_idx),
+				ss->key_len) == 0)
+			return pos;
+	}
+	return SKETCH_IDX_NONE;
+}
+
+static void
+sketch_idx_add(struct member_sketch *sk, uint32_t pos)
+{
+	uint32_t s;
+
+	for (s = sk->hh[pos].hash & sk->idx_mask; sk->idx[s] != 0;
+			s = (s + 1) & sk->idx_mask)
+		;
+	sk->idx[s] = pos + 1;
+	sk->hh[pos].slot = s;
+}
+
+/* Free a slot of the index, moving back the entries probed past it */
+static void
+sketch_idx_del(struct member_sketch *sk, uint32_t s)
+{
+	uint32_t i, home;
+
+	for (i = (s + 1) & sk->idx_mask; sk->idx[i] != 0;
+			i = (i + 1) & sk->idx_mask) {
+		home = sk->hh[sk->idx[i] - 1].hash & sk->idx_mask;
+		/* the hole is between the home slot of the entry and it */
+		if (((i - home) & sk->idx_mask) >= ((i - s) & sk->idx_mask)) {
+			sk->idx[s] = sk->idx[i];
+			sk->hh[sk->idx[s] - 1].slot = s;
+			s = i;
+		}
+	}
+	sk->idx[s] = 0;
+}
+
+static inline void
+sketch_heap_swap(struct member_sketch *sk, uint32_t a, uint32_t b)
+{
+	struct member_sketch_hh tmp;
+
+	tmp = sk->hh[a];
+	sk->hh[a] = sk->hh[b];
+	sk->hh[b] = tmp;
+	sk->idx[sk->hh[a].slot] = a + 1;
+	sk->idx[sk->hh[b].slot] = b + 1;
+}
+
+static void
+sketch_heap_up(struct member_sketch *sk, uint32_t pos)
+{
+	uint32_t parent;
+
+	while (pos != 0) {
+		parent = (pos - 1) / 2;
+		if (sk->hh[parent].count <= sk->hh[pos].count)
+			break;
+		sketch_heap_swap(sk, parent, pos);
+		pos = parent;
+	}
+}
+
+static void
+sketch_heap_down(struct member_sketch *sk, uint32_t pos)
+{
+	uint32_t child, min;
+
+	for (;;) {
+		min = pos;
+		child = 2 * pos + 1;
+		if (child < sk->num_hh &&
+				sk->hh[child].count < sk->hh[min].count)
+			min = child;
+		child++;
+		if (child < sk->num_hh &&
+				sk->hh[child].count < sk->hh[min].count)
+			min = child;
+		if (min == pos)
+			break;
+		sketch_heap_swap(sk, pos, min);
+		pos = min;
+	}
+}
+
+/* Update the heavy hitters with the new estimated count of a key */
+static void
+sketch_hh_update(const struct rte_member_setsum *ss, const void *key,
+		uint32_t hash, uint64_t count)
+{
+	uint32_t pos, key_idx;
+	struct member_sketch *sk = ss->table;
+
+	/* most keys are counted less than the smallest heavy hitter */
+	if (sk->top_k == 0 ||
+			(sk->num_hh == sk->top_k && count <= sk->hh[0].count))
+		return;
+
+	pos = sketch_hh_find(ss, sk, key, hash);
+	if (pos != SKETCH_IDX_NONE) {
+		sk->hh[pos].count = count;
+		sketch_heap_down(sk, pos);
+		return;
+	}
+
+	if (sk->num_hh < sk->top_k) {
+		/* append a new heavy hitter */
+		pos = sk->num_hh++;
+		key_idx = pos;
+	} else {
+		/* replace the smallest heavy hitter */
+		pos = 0;
+		key_idx = sk->hh[0].key_idx;
+		sketch_idx_del(sk, sk->hh[0].slot);
+	}
+
+	memcpy(sketch_key(ss, sk, key_idx), key, ss->key_len);
+	sk->hh[pos].count = count;
+	sk->hh[pos].hash = hash;
+	sk->hh[pos].key_idx = key_idx;
+	sketch_idx_add(sk, pos);
+
+	if (pos == 0)
+		sketch_heap_down(sk, pos);
+	else
+		sketch_heap_up(sk, pos);
+}
+
+int
+rte_member_create_sketch(struct rte_member_setsum *ss,
+		const struct rte_member_parameters *params)
+{
+	struct member_sketch *sk;
+	uint32_t num_row, num_col, idx_size;
+	size_t sz_sk, sz_cnt, sz_hh, sz_idx, size;
+
+	if (!(params->error_rate > 0 && params->error_rate < 1) ||
+			!(params->error_prob > 0 && params->error_prob < 1) ||
+			params->top_k > RTE_MEMBER_SKETCH_TOPK_MAX ||
+			ceil(M_E / params->error_rate) > RTE_MEMBER_ENTRIES_MAX) {
+		rte_errno = EINVAL;
+		RTE_MEMBER_LOG(ERR,
+			"Membership sketch create with invalid parameters\n");
+		return -EINVAL;
+	}
+
+	num_col = rte_align32pow2(ceil(M_E / params->error_rate));
+	num_row = ceil(log(1 / params->error_prob));
+	num_row = RTE_MIN(RTE_MAX(num_row, 1U),
+			(uint32_t)RTE_MEMBER_SKETCH_MAX_ROW);
+
+	/* AVX2 gathers the counters with 32-bit signed indexes */
+	if ((uint64_t)num_row * num_col > INT32_MAX) {
+		rte_errno = EINVAL;
+		RTE_MEMBER_LOG(ERR, "Membership sketch is too large\n");
+		return -EINVAL;
+	}
+
+	/* the index is kept at most half full */
+	idx_size = rte_align32pow2(2 * RTE_MAX(params->top_k, 1U));
+
+	sz_sk = RTE_ALIGN_CEIL(sizeof(*sk), RTE_CACHE_LINE_SIZE);
+	sz_cnt = (size_t)num_row * num_col * sizeof(sk->counters[0]);
+	sz_hh = RTE_ALIGN_CEIL(params->top_k * sizeof(sk->hh[0]),
+			RTE_CACHE_LINE_SIZE);
+	sz_idx = RTE_ALIGN_CEIL(idx_size * sizeof(sk->idx[0]),
+			RTE_CACHE_LINE_SIZE);
+	size = sz_sk + sz_cnt + 2 * sz_hh + sz_idx +
+			(size_t)params->top_k * ss->key_len;
+
+	sk = rte_zmalloc_socket(NULL, size, RTE_CACHE_LINE_SIZE,
+			ss->socket_id);
+	if (sk == NULL) {
+		RTE_MEMBER_LOG(ERR, "memory allocation failed for sketch "
+						"setsummary\n");
+		return -ENOMEM;
+	}
+
+	sk->num_row = num_row;
+	sk->num_col = num_col;
+	sk->col_mask = num_col - 1;
+	sk->top_k = params->top_k;
+	sk->idx_mask = idx_size - 1;
+	sk->counters = (uint64_t *)((uintptr_t)sk + sz_sk);
+	sk->hh = (struct member_sketch_hh *)((uintptr_t)sk->counters + sz_cnt);
+	sk->sorted = (struct member_sketch_hh *)((uintptr_t)sk->hh + sz_hh);
+	sk->idx = (uint32_t *)((uintptr_t)sk->sorted + sz_hh);
+	sk->keys = (uint8_t *)((uintptr_t)sk->idx + sz_idx);
+	sk->size = size;
+
+	ss->table = sk;
+
+#if defined(RTE_ARCH_X86)
+	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX2) &&
+			rte_vect_get_max_simd_bitwidth() >= RTE_VECT_SIMD_256)
+		ss->sig_cmp_fn = RTE_MEMBER_COMPARE_AVX2;
+	else
+#endif
+		ss->sig_cmp_fn = RTE_MEMBER_COMPARE_SCALAR;
+
+	RTE_MEMBER_LOG(DEBUG, "count-min sketch created, "
+		"%u rows of %u counters, tracking %u heavy hitters, "
+		"%zu bytes\n", num_row, num_col, sk->top_k, size);
+	return 0;
+}
+
+int
+rte_member_lookup_sketch(const struct rte_member_setsum *ss,
+		const void *key, member_set_t *set_id)
+{
+	uint32_t h1;
+	struct member_sketch *sk = ss->table;
+
+	h1 = MEMBER_HASH_FUNC(key, ss->key_len, ss->prim_hash_seed);
+	if (sk->num_hh != 0 &&
+			sketch_hh_find(ss, sk, key, h1) != SKETCH_IDX_NONE) {
+		*set_id = 1;
+		return 1;
+	}
+
+	*set_id = RTE_MEMBER_NO_MATCH;
+	return 0;
+}
+
+uint32_t
+rte_member_lookup_bulk_sketch(const struct rte_member_setsum *ss,
+		const void **keys, uint32_t num_keys, member_set_t *set_ids)
+{
+	uint32_t i, num_matches = 0;
+
+	for (i = 0; i < num_keys; i++)
+		num_matches += rte_member_lookup_sketch(ss, keys[i],
+				&set_ids[i]);
+	return num_matches;
+}
+
+int
+rte_member_add_sketch(const struct rte_member_setsum *ss,
+		const void *key, uint32_t count)
+{
+	uint32_t r, h1, h2;
+	uint32_t idx[RTE_MEMBER_SKETCH_MAX_ROW];
+	struct member_sketch *sk = ss->table;
+
+	sketch_hash(ss, key, &h1, &h2);
+	get_row_index(ss, h1, h2, idx);
+
+	for (r = 0; r < sk->num_row; r++)
+		sk->counters[idx[r]] += count;
+
+	sketch_hh_update(ss, key, h1, get_min(ss, idx));
+	return 0;
+}
+
+int
+rte_member_add_bulk_sketch(const struct rte_member_setsum *ss,
+		const void **keys, uint32_t num_keys, const uint32_t *counts)
+{
+	uint32_t i, r, h2, count;
+	uint32_t h1[RTE_MEMBER_LOOKUP_BULK_MAX];
+	uint32_t idx[RTE_MEMBER_LOOKUP_BULK_MAX][RTE_MEMBER_SKETCH_MAX_ROW];
+	struct member_sketch *sk = ss->table;
+
+	/* get the counters of all the keys in the cache first */
+	for (i = 0; i < num_keys; i++) {
+		sketch_hash(ss, keys[i], &h1[i], &h2);
+		get_row_index(ss, h1[i], h2, idx[i]);
+		for (r = 0; r < sk->num_row; r++)
+			rte_prefetch0(&sk->counters[idx[i][r]]);
+	}
+
+	for (i = 0; i < num_keys; i++) {
+		count = (counts != NULL) ? counts[i] : 1;
+		for (r = 0; r < sk->num_row; r++)
+			sk->counters[idx[i][r]] += count;
+		sketch_hh_update(ss, keys[i], h1[i], get_min(ss, idx[i]));
+	}
+
+	return 0;
+}
+
+int
+rte_member_query_sketch(const struct rte_member_setsum *ss,
+		const void *key, uint64_t *count)
+{
+	uint32_t h1, h2;
+	uint32_t idx[RTE_MEMBER_SKETCH_MAX_ROW];
+
+	sketch_hash(ss, key, &h1, &h2);
+	get_row_index(ss, h1, h2, idx);
+	*count = get_min(ss, idx);
+	return 0;
+}
+
+int
+rte_member_query_bulk_sketch(const struct rte_member_setsum *ss,
+		const void **keys, uint32_t num_keys, uint64_t *counts)
+{
+	uint32_t i, r, h1, h2;
+	uint32_t idx[RTE_MEMBER_LOOKUP_BULK_MAX][RTE_MEMBER_SKETCH_MAX_ROW];
+	struct member_sketch *sk = ss->table;
+
+	for (i = 0; i < num_keys; i++) {
+		sketch_hash(ss, keys[i], &h1, &h2);
+		get_row_index(ss, h1, h2, idx[i]);
+		for (r = 0; r < sk->num_row; r++)
+			rte_prefetch0(&sk->counters[idx[i][r]]);
+	}
+
+	for (i = 0; i < num_keys; i++)
+		counts[i] = get_min(ss, idx[i]);
+
+	return 0;
+}
+
+static int
+sketch_hh_cmp(const void *a, const void *b)
+{
+	const struct member_sketch_hh *x = a, *y = b;
+
+	/* decreasing order of count */
+	return (x->count < y->count) - (x->count > y->count);
+}
+
+int
+rte_member_report_heavyhitter_sketch(const struct rte_member_setsum *ss,
+		void **keys, uint64_t *counts)
+{
+	uint32_t i;
+	struct member_sketch *sk = ss->table;
+
+	memcpy(sk->sorted, sk->hh, sk->num_hh * sizeof(sk->hh[0]));
+	qsort(sk->sorted, sk->num_hh, sizeof(sk->sorted[0]), sketch_hh_cmp);
+
+	for (i = 0; i < sk->num_hh; i++) {
+		keys[i] = sketch_key(ss, sk, sk->sorted[i].key_idx);
+		counts[i] = sk->sorted[i].count;
+	}
+
+	return sk->num_hh;
+}
+
+void
+rte_member_decay_sketch(const struct rte_member_setsum *ss, uint32_t shift)
+{
+	uint32_t i;
+	size_t n, num;
+	struct member_sketch *sk = ss->table;
+
+	if (shift >= sizeof(sk->counters[0]) * CHAR_BIT) {
+		rte_member_reset_sketch(ss);
+		return;
+	}
+
+	/* the heap order holds as all the counts get divided alike */
+	num = (size_t)sk->num_row * sk->num_col;
+	for (n = 0; n < num; n++)
+		sk->counters[n] >>= shift;
+	for (i = 0; i < sk->num_hh; i++)
+		sk->hh[i].count >>= shift;
+}
+
+void
+rte_member_free_sketch(struct rte_member_setsum *ss)
+{
+	rte_free(ss->table);
+}
+
+void
+rte_member_reset_sketch(const struct rte_member_setsum *ss)
+{
+	struct member_sketch *sk = ss->table;
+
+	memset(sk->counters, 0,
+		(size_t)sk->num_row * sk->num_col * sizeof(sk->counters[0]));
+	memset(sk->idx, 0, (sk->idx_mask + 1) * sizeof(sk->idx[0]));
+	sk->num_hh = 0;
+}
@@ -0,0 +1,84 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 agent <agent@local>
+ */
+
+#ifndef _RTE_MEMBER_SKETCH_H_
+#define _RTE_MEMBER_SKETCH_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Heavy hitter entry, in a min-heap of the heavy hitters by count. */
+struct member_sketch_hh {
+	uint64_t count;		/* Estimated count of the key. */
+	uint32_t hash;		/* Primary hash of the key. */
+	uint32_t slot;		/* Slot of the entry in the index. */
+	uint32_t key_idx;	/* Index of the copy of the key. */
+};
+
+/* The sketch struct for sketch setsum */
+struct member_sketch {
+	uint32_t num_row;	/* Number of counter rows. */
+	uint32_t num_col;	/* Number of counters per row, power of 2. */
+	uint32_t col_mask;	/* Bit mask to get a counter in a row. */
+	uint32_t top_k;		/* Maximum number of heavy hitters. */
+	uint32_t num_hh;	/* Number of heavy hitters. */
+	uint32_t idx_mask;	/* Bit mask to get a slot of the index. */
+	/* Heavy hitter index: heap position + 1 in each used slot. */
+	uint32_t *idx;
+	struct member_sketch_hh *hh;	/* Heavy hitter heap. */
+	struct member_sketch_hh *sorted; /* Heavy hitters to report. */
+	uint8_t *keys;		/* Copies of the heavy hitter keys. */
+	uint64_t *counters;	/* num_row rows of num_col counters. */
+	size_t size;		/* Memory size of the sketch. */
+};
+
+int
+rte_member_create_sketch(struct rte_member_setsum *ss,
+		const struct rte_member_parameters *params);
+
+int
+rte_member_lookup_sketch(const struct rte_member_setsum *setsum,
+		const void *key, member_set_t *set_id);
+
+uint32_t
+rte_member_lookup_bulk_sketch(const struct rte_member_setsum *setsum,
+		const void **keys, uint32_t num_keys,
+		member_set_t *set_ids);
+
+int
+rte_member_add_sketch(const struct rte_member_setsum *setsum,
+		const void *key, uint32_t count);
+
+int
+rte_member_add_bulk_sketch(const struct rte_member_setsum *setsum,
+		const void **keys, uint32_t num_keys, const uint32_t *counts);
+
+int
+rte_member_query_sketch(const struct rte_member_setsum *setsum,
+		const void *key, uint64_t *count);
+
+int
+rte_member_query_bulk_sketch(const struct rte_member_setsum *setsum,
+		const void **keys, uint32_t num_keys, uint64_t *counts);
+
+int
+rte_member_report_heavyhitter_sketch(const struct rte_member_setsum *setsum,
+		void **keys, uint64_t *counts);
+
+void
+rte_member_decay_sketch(const struct rte_member_setsum *setsum,
+		uint32_t shift);
+
+void
+rte_member_free_sketch(struct rte_member_setsum *ss);
+
+void
+rte_member_reset_sketch(const struct rte_member_setsum *setsum);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_MEMBER_SKETCH_H_ */
@@ -11,6 +11,9 @@ extern "C" {
 
 #include <x86intrin.h>
 
+#include "rte_member_ht.h"
+#include "rte_member_sketch.h"
+
 #if defined(__AVX2__)
 
 static inline int
@@ -29,6 +32,26 @@ update_entry_search_avx(uint32_t bucket_id, member_sig_t tmp_sig,
 	return 0;
 }
 
+static inline int
+delete_entry_search_avx(uint32_t bucket_id, member_sig_t tmp_sig,
+		struct member_ht_bucket *buckets,
+		member_set_t set_id)
+{
+	uint32_t hitmask = _mm256_movemask_epi8(_mm256_and_si256(
+		_mm256_cmpeq_epi16(_mm256_load_si256(
+			(__m256i const *)buckets[bucket_id].sigs),
+			_mm256_set1_epi16(tmp_sig)),
+		_mm256_cmpeq_epi16(_mm256_load_si256(
+			(__m256i const *)buckets[bucket_id].sets),
+			_mm256_set1_epi16(set_id))));
+	if (hitmask) {
+		uint32_t hit_idx = __builtin_ctzl(hitmask) >> 1;
+		buckets[bucket_id].sets[hit_idx] = RTE_MEMBER_NO_MATCH;
+		return 1;
+	}
+	return 0;
+}
+
 static inline int
 search_bucket_single_avx(uint32_t bucket_id, member_sig_t tmp_sig,
 		struct member_ht_bucket *buckets,
@@ -69,6 +92,58 @@ search_bucket_multi_avx(uint32_t bucket_id, member_sig_t tmp_sig,
 		hitmask &= ~(3U << ((hit_idx) << 1));
 	}
 }
+
+/*
+ * Counter index of the key in each row of the sketch, 8 rows at a time.
+ * Rows past the last one get the index of the first row, so they don't
+ * change the minimum of the counters.
+ */
+static inline void
+sketch_row_index_avx(const struct member_sketch *sk, uint32_t h1,
+		uint32_t h2, uint32_t idx[RTE_MEMBER_SKETCH_MAX_ROW])
+{
+	uint32_t r;
+	__m256i rows, x, first;
+	const __m256i eight = _mm256_set1_epi32(8);
+	const __m256i num_row = _mm256_set1_epi32(sk->num_row);
+	const __m256i num_col = _mm256_set1_epi32(sk->num_col);
+	const __m256i col_mask = _mm256_set1_epi32(sk->col_mask);
+	const __m256i vh1 = _mm256_set1_epi32(h1);
+	const __m256i vh2 = _mm256_set1_epi32(h2);
+
+	first = _mm256_set1_epi32(h1 & sk->col_mask);
+	rows = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+	for (r = 0; r < sk->num_row; r += 8) {
+		x = _mm256_and_si256(_mm256_add_epi32(vh1,
+			_mm256_mullo_epi32(rows, vh2)), col_mask);
+		x = _mm256_add_epi32(x, _mm256_mullo_epi32(rows, num_col));
+		x = _mm256_blendv_epi8(first, x,
+			_mm256_cmpgt_epi32(num_row, rows));
+		_mm256_storeu_si256((__m256i *)(idx + r), x);
+		rows = _mm256_add_epi32(rows, eight);
+	}
+}
+
+/* Minimum of the counters of the key, gathering 4 rows at a time. */
+static inline uint64_t
+sketch_min_avx(const struct member_sketch *sk,
+		const uint32_t idx[RTE_MEMBER_SKETCH_MAX_ROW])
+{
+	uint32_t r;
+	__m256i v, min;
+	uint64_t m[4];
+
+	min = _mm256_set1_epi64x(INT64_MAX);
+	for (r = 0; r < sk->num_row; r += 4) {
+		v = _mm256_i32gather_epi64((const long long *)sk->counters,
+			_mm_loadu_si128((const __m128i *)(idx + r)),
+			sizeof(uint64_t));
+		min = _mm256_blendv_epi8(min, v, _mm256_cmpgt_epi64(min, v));
+	}
+
+	_mm256_storeu_si256((__m256i *)m, min);
+	return RTE_MIN(RTE_MIN(m[0], m[1]), RTE_MIN(m[2], m[3]));
+}
 #endif
 
 #ifdef __cplusplus
@@ -77,3 +77,15 @@ RTE_TRACE_POINT_REGISTER(rte_mempool_trace_ops_free,
 
 RTE_TRACE_POINT_REGISTER(rte_mempool_trace_set_ops_byname,
 	lib.mempool.set.ops.byname)
+
+RTE_TRACE_POINT_REGISTER(rte_mempool_trace_cache_zc_put_bulk_start,
+	lib.mempool.cache.zc.put.bulk.start)
+
+RTE_TRACE_POINT_REGISTER(rte_mempool_trace_cache_zc_put_finish,
+	lib.mempool.cache.zc.put.finish)
+
+RTE_TRACE_POINT_REGISTER(rte_mempool_trace_cache_zc_get_bulk_start,
+	lib.mempool.cache.zc.get.bulk.start)
+
+RTE_TRACE_POINT_REGISTER(rte_mempool_trace_cache_zc_get_finish,
+	lib.mempool.cache.zc.get.finish)
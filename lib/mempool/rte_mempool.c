@@ -926,9 +926,13 @@ rte_mempool_create_empty(const char *name, unsigned n, unsigned elt_size,
 
 	/* Init all default caches. */
 	if (cache_size != 0) {
-		for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++)
+		for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
 			mempool_cache_init(&mp->local_cache[lcore_id],
 					   cache_size);
+			if (flags & RTE_MEMPOOL_F_CACHE_ADAPTIVE)
+				mp->local_cache[lcore_id].adapt_max_size =
+					cache_size;
+		}
 	}
 
 	te->data = mp;
@@ -1037,20 +1041,29 @@ rte_mempool_in_use_count(const struct rte_mempool *mp)
 static unsigned
 rte_mempool_dump_cache(FILE *f, const struct rte_mempool *mp)
 {
+	const struct rte_mempool_cache *cache;
 	unsigned lcore_id;
 	unsigned count = 0;
 	unsigned cache_count;
 
 	fprintf(f, "  internal cache infos:\n");
 	fprintf(f, "    cache_size=%"PRIu32"\n", mp->cache_size);
+	if (mp->flags & RTE_MEMPOOL_F_CACHE_ADAPTIVE)
+		fprintf(f, "    cache_adaptive=1\n");
 
 	if (mp->cache_size == 0)
 		return count;
 
 	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
-		cache_count = mp->local_cache[lcore_id].len;
+		cache = &mp->local_cache[lcore_id];
+		cache_count = cache->len;
 		fprintf(f, "    cache_count[%u]=%"PRIu32"\n",
 			lcore_id, cache_count);
+		if (cache->adapt_max_size != 0 && cache->adapt_resizes != 0)
+			fprintf(f, "    cache_adapt[%u]: size=%"PRIu32
+				" flushthresh=%"PRIu32" resizes=%"PRIu32"\n",
+				lcore_id, cache->size, cache->flushthresh,
+				cache->adapt_resizes);
 		count += cache_count;
 	}
 	fprintf(f, "    total_cache_count=%u\n", count);
@@ -1270,6 +1283,8 @@ rte_mempool_dump(FILE *f, struct rte_mempool *mp)
 	if ((cache_count + common_count) > mp->size)
 		common_count = mp->size - cache_count;
 	fprintf(f, "  common_pool_count=%u\n", common_count);
+	if (ops != NULL && ops->dump != NULL)
+		ops->dump(f, mp);
 
 	/* sum and dump statistics */
 #ifdef RTE_LIBRTE_MEMPOOL_DEBUG
@@ -1507,6 +1522,43 @@ struct mempool_info_cb_arg {
 	struct rte_tel_data *d;
 };
 
+/* Per lcore size, flush threshold and resizes of adaptive caches */
+static void
+mempool_info_cache_adapt(const struct rte_mempool *mp, struct rte_tel_data *d)
+{
+	struct rte_tel_data *sizes, *thresholds, *resizes;
+	const struct rte_mempool_cache *cache;
+	char lcore_name[RTE_TEL_MAX_STRING_LEN];
+	unsigned int lcore_id;
+
+	sizes = rte_tel_data_alloc();
+	thresholds = rte_tel_data_alloc();
+	resizes = rte_tel_data_alloc();
+	if (sizes == NULL || thresholds == NULL || resizes == NULL) {
+		rte_tel_data_free(sizes);
+		rte_tel_data_free(thresholds);
+		rte_tel_data_free(resizes);
+		return;
+	}
+
+	rte_tel_data_start_dict(sizes);
+	rte_tel_data_start_dict(thresholds);
+	rte_tel_data_start_dict(resizes);
+	RTE_LCORE_FOREACH(lcore_id) {
+		cache = &mp->local_cache[lcore_id];
+		snprintf(lcore_name, sizeof(lcore_name), "%u", lcore_id);
+		rte_tel_data_add_dict_int(sizes, lcore_name, cache->size);
+		rte_tel_data_add_dict_int(thresholds, lcore_name,
+					  cache->flushthresh);
+		rte_tel_data_add_dict_int(resizes, lcore_name,
+					  cache->adapt_resizes);
+	}
+	rte_tel_data_add_dict_container(d, "lcore_cache_size", sizes, 0);
+	rte_tel_data_add_dict_container(d, "lcore_cache_flushthresh",
+					thresholds, 0);
+	rte_tel_data_add_dict_container(d, "lcore_cache_resizes", resizes, 0);
+}
+
 static void
 mempool_info_cb(struct rte_mempool *mp, void *arg)
 {
@@ -1538,6 +1590,9 @@ mempool_info_cb(struct rte_mempool *mp, void *arg)
 				  mz->hugepage_sz);
 	rte_tel_data_add_dict_int(info->d, "mz_socket_id", mz->socket_id);
 	rte_tel_data_add_dict_int(info->d, "mz_flags", mz->flags);
+
+	if (mp->cache_size != 0 && (mp->flags & RTE_MEMPOOL_F_CACHE_ADAPTIVE))
+		mempool_info_cache_adapt(mp, info->d);
 }
 
 static int
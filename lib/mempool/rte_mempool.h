@@ -95,6 +95,17 @@ struct rte_mempool_cache {
 	 * cases to avoid needless emptying of cache.
 	 */
 	void *objs[RTE_MEMPOOL_CACHE_MAX_SIZE * 3]; /**< Cache objects */
+	/*
+	 * Adaptive sizing, see RTE_MEMPOOL_F_CACHE_ADAPTIVE. These fields
+	 * are after the objects, in the padding of the structure, so that
+	 * the offsets used by the inline functions do not change.
+	 */
+	uint32_t adapt_max_size; /**< Maximum size, zero if not adaptive. */
+	uint32_t adapt_calls;    /**< Gets and puts in the current period. */
+	uint32_t adapt_get_objs; /**< Objects got in the current period. */
+	uint32_t adapt_put_objs; /**< Objects put in the current period. */
+	uint32_t adapt_misses;   /**< Backing store accesses in the period. */
+	uint32_t adapt_resizes;  /**< Number of size changes. */
 } __rte_cache_aligned;
 
 /**
@@ -290,6 +301,8 @@ struct rte_mempool {
 #define MEMPOOL_F_NO_IOVA_CONTIG	RTE_MEMPOOL_F_NO_IOVA_CONTIG
 /** Internal: no object from the pool can be used for device IO (DMA). */
 #define RTE_MEMPOOL_F_NON_IO		0x0040
+/** Tune the size of the default caches from the lcores usage. */
+#define RTE_MEMPOOL_F_CACHE_ADAPTIVE	0x0080
 
 /**
  * This macro lists all the mempool flags an application may request.
@@ -299,6 +312,7 @@ struct rte_mempool {
 	| RTE_MEMPOOL_F_SP_PUT \
 	| RTE_MEMPOOL_F_SC_GET \
 	| RTE_MEMPOOL_F_NO_IOVA_CONTIG \
+	| RTE_MEMPOOL_F_CACHE_ADAPTIVE \
 	)
 /**
  * @internal When debug is enabled, store some statistics.
@@ -646,6 +660,11 @@ int rte_mempool_op_populate_default(struct rte_mempool *mp,
 typedef int (*rte_mempool_get_info_t)(const struct rte_mempool *mp,
 		struct rte_mempool_info *info);
 
+/**
+ * Dump the driver specific state of a mempool, e.g. its statistics.
+ */
+typedef void (*rte_mempool_dump_t)(FILE *f, const struct rte_mempool *mp);
+
 
 /** Structure defining mempool operations structure */
 struct rte_mempool_ops {
@@ -673,6 +692,11 @@ struct rte_mempool_ops {
 	 * Dequeue a number of contiguous object blocks.
 	 */
 	rte_mempool_dequeue_contig_blocks_t dequeue_contig_blocks;
+	/**
+	 * Optional callback to dump the driver specific state, called
+	 * by rte_mempool_dump().
+	 */
+	rte_mempool_dump_t dump;
 } __rte_cache_aligned;
 
 #define RTE_MEMPOOL_MAX_OPS_IDX 16  /**< Max registered ops structs */
@@ -1037,6 +1061,11 @@ typedef void (rte_mempool_ctor_t)(struct rte_mempool *, void *);
  *     "single-consumer". Otherwise, it is "multi-consumers".
  *   - RTE_MEMPOOL_F_NO_IOVA_CONTIG: If set, allocated objects won't
  *     necessarily be contiguous in IO memory.
+ *   - RTE_MEMPOOL_F_CACHE_ADAPTIVE: If set, the size and flush threshold
+ *     of each default cache are tuned from the gets and puts of its lcore,
+ *     *cache_size* being the maximum size. A cache often accessing the
+ *     common pool grows, a cache which does not shrinks, and a cache
+ *     mostly used to put objects keeps few of them after a flush.
  * @return
  *   The pointer to the new allocated mempool, on success. NULL on error
  *   with rte_errno set appropriately. Possible rte_errno values include:
@@ -1318,6 +1347,88 @@ rte_mempool_cache_flush(struct rte_mempool_cache *cache,
 	cache->len = 0;
 }
 
+/** Number of gets and puts between two resizes of an adaptive cache. */
+#define RTE_MEMPOOL_CACHE_ADAPT_PERIOD 1024
+
+/**
+ * @internal Resize an adaptive cache from the gets and puts of the period.
+ *
+ * A cache accessing the common pool in more than 1/32 of its gets and
+ * puts doubles its size, up to its maximum size, and a cache which did
+ * not access it halves its size, down to 1/8 of the maximum. A cache mostly
+ * used to put objects keeps the minimum size, so that few objects stay
+ * in it after a flush, but flushes bursts of half the maximum size.
+ *
+ * The objects above the new size of a shrunk cache go back to the common
+ * pool, so that a smaller cache also holds fewer objects.
+ */
+static inline void
+rte_mempool_cache_adapt(struct rte_mempool_cache *cache,
+		struct rte_mempool *mp)
+{
+	uint32_t max_size = cache->adapt_max_size;
+	uint32_t min_size = RTE_MAX(max_size / 8, 1U);
+	uint32_t size = cache->size;
+	uint32_t flushthresh;
+
+	if (cache->adapt_put_objs > 4 * cache->adapt_get_objs) {
+		size = min_size;
+		flushthresh = size + max_size / 2;
+	} else {
+		if (cache->adapt_misses * 32 > RTE_MEMPOOL_CACHE_ADAPT_PERIOD)
+			size = RTE_MIN(size * 2, max_size);
+		else if (cache->adapt_misses == 0)
+			size = RTE_MAX(size / 2, min_size);
+		flushthresh = size * 3 / 2;
+	}
+
+	if (size != cache->size || flushthresh != cache->flushthresh) {
+		cache->size = size;
+		cache->flushthresh = flushthresh;
+		cache->adapt_resizes++;
+	}
+
+	if (cache->len > size) {
+		rte_mempool_ops_enqueue_bulk(mp, &cache->objs[size],
+				cache->len - size);
+		cache->len = size;
+	}
+
+	cache->adapt_calls = 0;
+	cache->adapt_get_objs = 0;
+	cache->adapt_put_objs = 0;
+	cache->adapt_misses = 0;
+}
+
+/**
+ * @internal Account a get or put on a cache, resizing it at the end of
+ * the period if it is adaptive.
+ *
+ * @param cache
+ *   A pointer to the mempool cache.
+ * @param mp
+ *   A pointer to the mempool the cache belongs to.
+ * @param get_objs
+ *   The number of objects got.
+ * @param put_objs
+ *   The number of objects put.
+ * @param misses
+ *   The number of accesses to the common pool.
+ */
+static __rte_always_inline void
+rte_mempool_cache_adapt_count(struct rte_mempool_cache *cache,
+		struct rte_mempool *mp, uint32_t get_objs, uint32_t put_objs, uint32_t misses)
+{
+	if (likely(cache->adapt_max_size == 0))
+		return;
+
+	cache->adapt_get_objs += get_objs;
+	cache->adapt_put_objs += put_objs;
+	cache->adapt_misses += misses;
+	if (unlikely(++cache->adapt_calls == RTE_MEMPOOL_CACHE_ADAPT_PERIOD))
+		rte_mempool_cache_adapt(cache, mp);
+}
+
 /**
  * @internal Put several objects back in the mempool; used internally.
  * @param mp
@@ -1362,6 +1473,9 @@ rte_mempool_do_generic_put(struct rte_mempool *mp, void * const *obj_table,
 		rte_mempool_ops_enqueue_bulk(mp, &cache->objs[cache->size],
 				cache->len - cache->size);
 		cache->len = cache->size;
+		rte_mempool_cache_adapt_count(cache, mp, 0, n, 1);
+	} else {
+		rte_mempool_cache_adapt_count(cache, mp, 0, n, 0);
 	}
 
 	return;
@@ -1460,7 +1574,7 @@ rte_mempool_do_generic_get(struct rte_mempool *mp, void **obj_table,
 			   unsigned int n, struct rte_mempool_cache *cache)
 {
 	int ret;
-	uint32_t index, len;
+	uint32_t index, len, misses = 0;
 	void **cache_objs;
 
 	/* No cache provided or cannot be satisfied from cache */
@@ -1488,6 +1602,7 @@ rte_mempool_do_generic_get(struct rte_mempool *mp, void **obj_table,
 		}
 
 		cache->len += req;
+		misses = 1;
 	}
 
 	/* Now fill in the response ... */
@@ -1495,6 +1610,7 @@ rte_mempool_do_generic_get(struct rte_mempool *mp, void **obj_table,
 		*obj_table = cache_objs[len];
 
 	cache->len -= n;
+	rte_mempool_cache_adapt_count(cache, mp, n, 0, misses);
 
 	RTE_MEMPOOL_STAT_ADD(mp, get_success_bulk, 1);
 	RTE_MEMPOOL_STAT_ADD(mp, get_success_objs, n);
@@ -1505,6 +1621,8 @@ rte_mempool_do_generic_get(struct rte_mempool *mp, void **obj_table,
 
 	/* get remaining objects from ring */
 	ret = rte_mempool_ops_dequeue_bulk(mp, obj_table, n);
+	if (cache != NULL)
+		rte_mempool_cache_adapt_count(cache, mp, n, 0, 1);
 
 	if (ret < 0) {
 		RTE_MEMPOOL_STAT_ADD(mp, get_fail_bulk, 1);
@@ -0,0 +1,214 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 agent <agent@local>
+ */
+
+#ifndef _RTE_MEMPOOL_ZC_H_
+#define _RTE_MEMPOOL_ZC_H_
+
+/**
+ * @file
+ * RTE Mempool Cache Zero Copy APIs
+ *
+ * These APIs make it possible to split a put or a get of objects through
+ * a mempool cache into 3 parts:
+ * - reserve slots in the cache (put) or borrow objects of the cache (get),
+ * - copy the object pointers to/from the cache slots,
+ * - commit the put or get.
+ * The application, e.g. a PMD refilling an Rx ring or completing Tx
+ * descriptors, can then write or read the object pointers straight in the
+ * cache instead of going through a temporary array.
+ *
+ * The flush and refill of the cache are the same as with
+ * rte_mempool_generic_put() and rte_mempool_generic_get(): a put flushing
+ * the cache does it at commit time, a get needing a refill does it at
+ * borrow time.
+ *
+ * No other operation must be done on the cache between the start and the
+ * finish calls. The caches being per lcore, the same applies between
+ * threads sharing a cache.
+ *
+ * Example, freeing the mbufs of completed Tx descriptors:
+ *
+ * objs = rte_mempool_cache_zc_put_bulk_start(cache, mp, n);
+ * if (objs != NULL) {
+ *	for (i = 0; i < n; i++)
+ *		objs[i] = txq->sw_ring[idx + i].mbuf;
+ *	rte_mempool_cache_zc_put_finish(cache, mp, n);
+ * } else {
+ *	// Fall back to rte_mempool_generic_put()
+ * }
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <rte_compat.h>
+#include <rte_mempool.h>
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Reserve slots in a mempool cache to put objects in it.
+ *
+ * The object pointers must be written in the returned slots, then the
+ * put committed with rte_mempool_cache_zc_put_finish().
+ *
+ * @param cache
+ *   A pointer to the mempool cache, must not be NULL.
+ * @param mp
+ *   A pointer to the mempool the objects belong to.
+ * @param n
+ *   The number of slots to reserve.
+ * @return
+ *   A pointer to the n reserved slots, or NULL if n is larger than
+ *   RTE_MEMPOOL_CACHE_MAX_SIZE: the objects have to be put with
+ *   rte_mempool_generic_put() then.
+ */
+__rte_experimental
+static __rte_always_inline void **
+rte_mempool_cache_zc_put_bulk_start(struct rte_mempool_cache *cache,
+		struct rte_mempool *mp, unsigned int n)
+{
+	RTE_ASSERT(cache != NULL);
+
+	rte_mempool_trace_cache_zc_put_bulk_start(cache, mp, n);
+
+	/* Same limit as the put into the cache of rte_mempool_generic_put() */
+	if (unlikely(n > RTE_MEMPOOL_CACHE_MAX_SIZE))
+		return NULL;
+
+	return &cache->objs[cache->len];
+}
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Commit a put started with rte_mempool_cache_zc_put_bulk_start().
+ *
+ * The cache is flushed to the mempool the way rte_mempool_generic_put()
+ * does if it goes above its flush threshold.
+ *
+ * @param cache
+ *   A pointer to the mempool cache.
+ * @param mp
+ *   A pointer to the mempool the objects belong to.
+ * @param n
+ *   The number of objects written in the slots, at most the number of
+ *   reserved slots.
+ */
+__rte_experimental
+static __rte_always_inline void
+rte_mempool_cache_zc_put_finish(struct rte_mempool_cache *cache,
+		struct rte_mempool *mp, unsigned int n)
+{
+	RTE_MEMPOOL_CHECK_COOKIES(mp, &cache->objs[cache->len], n, 0);
+	rte_mempool_trace_cache_zc_put_finish(cache, mp, n);
+	RTE_MEMPOOL_STAT_ADD(mp, put_bulk, 1);
+	RTE_MEMPOOL_STAT_ADD(mp, put_objs, n);
+
+	cache->len += n;
+
+	if (cache->len >= cache->flushthresh) {
+		rte_mempool_ops_enqueue_bulk(mp, &cache->objs[cache->size],
+				cache->len - cache->size);
+		cache->len = cache->size;
+		rte_mempool_cache_adapt_count(cache, mp, 0, n, 1);
+	} else {
+		rte_mempool_cache_adapt_count(cache, mp, 0, n, 0);
+	}
+}
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Borrow objects from a mempool cache, refilling it from the mempool
+ * if it holds less than n objects.
+ *
+ * The object pointers must be read from the returned slots, then the
+ * get committed with rte_mempool_cache_zc_get_finish().
+ *
+ * @param cache
+ *   A pointer to the mempool cache, must not be NULL.
+ * @param mp
+ *   A pointer to the mempool.
+ * @param n
+ *   The number of objects to borrow.
+ * @return
+ *   A pointer to the n borrowed objects, or NULL if n is not smaller than
+ *   the cache size or if the mempool does not have enough objects to refill
+ *   the cache: the objects have to be got with rte_mempool_generic_get()
+ *   then.
+ */
+__rte_experimental
+static __rte_always_inline void **
+rte_mempool_cache_zc_get_bulk_start(struct rte_mempool_cache *cache,
+		struct rte_mempool *mp, unsigned int n)
+{
+	uint32_t req;
+
+	RTE_ASSERT(cache != NULL);
+
+	rte_mempool_trace_cache_zc_get_bulk_start(cache, mp, n);
+
+	/* Same limit as the get from the cache of rte_mempool_generic_get() */
+	if (unlikely(n >= cache->size))
+		return NULL;
+
+	if (cache->len < n) {
+		/* Backfill the cache like rte_mempool_generic_get() */
+		req = n + (cache->size - cache->len);
+		if (unlikely(rte_mempool_ops_dequeue_bulk(mp,
+				&cache->objs[cache->len], req) < 0)) {
+			RTE_MEMPOOL_STAT_ADD(mp, get_fail_bulk, 1);
+			RTE_MEMPOOL_STAT_ADD(mp, get_fail_objs, n);
+			rte_mempool_cache_adapt_count(cache, mp, 0, 0, 1);
+			return NULL;
+		}
+		cache->len += req;
+		/*
+		 * Accounted with the get at finish time: resizing the cache
+		 * now could flush the borrowed objects.
+		 */
+		cache->adapt_misses++;
+	}
+
+	return &cache->objs[cache->len - n];
+}
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Commit a get started with rte_mempool_cache_zc_get_bulk_start().
+ *
+ * @param cache
+ *   A pointer to the mempool cache.
+ * @param mp
+ *   A pointer to the mempool.
+ * @param n
+ *   The number of objects borrowed with
+ *   rte_mempool_cache_zc_get_bulk_start().
+ */
+__rte_experimental
+static __rte_always_inline void
+rte_mempool_cache_zc_get_finish(struct rte_mempool_cache *cache,
+		struct rte_mempool *mp, unsigned int n)
+{
+	cache->len -= n;
+
+	RTE_MEMPOOL_CHECK_COOKIES(mp, &cache->objs[cache->len], n, 1);
+	rte_mempool_trace_cache_zc_get_finish(cache, mp, n);
+	RTE_MEMPOOL_STAT_ADD(mp, get_success_bulk, 1);
+	RTE_MEMPOOL_STAT_ADD(mp, get_success_objs, n);
+	rte_mempool_cache_adapt_count(cache, mp, n, 0, 0);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_MEMPOOL_ZC_H_ */
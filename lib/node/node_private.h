@@ -26,10 +26,10 @@ extern int rte_node_logtype;
  */
 struct node_mbuf_priv1 {
 	union {
-		/* IP4 rewrite */
+		/* IP4/IP6 rewrite */
 		struct {
 			uint16_t nh;
-			uint16_t ttl;
+			uint16_t ttl; /* TTL or IPv6 hop limit */
 			uint32_t cksum;
 		};
 
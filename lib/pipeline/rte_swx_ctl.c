@@ -233,6 +233,12 @@ table_params_get(struct rte_swx_ctl_pipeline *ctl, uint32_t table_id)
 		if (n_match_fields_em == table->info.n_match_fields)
 			match_type = RTE_SWX_TABLE_MATCH_EXACT;
 
+		if ((table->info.n_match_fields == 1) &&
+		    (first->match_type == RTE_SWX_TABLE_MATCH_LPM) &&
+		    first->is_header &&
+		    (first->n_bits == 32))
+			match_type = RTE_SWX_TABLE_MATCH_LPM;
+
 		/* key_offset. */
 		key_offset = first->offset / 8;
 
@@ -7182,8 +7182,10 @@ rte_swx_pipeline_table_type_register(struct rte_swx_pipeline *p,
 }
 
 static int
-table_match_type_resolve(struct rte_swx_match_field_params *fields,
+table_match_type_resolve(struct rte_swx_pipeline *p,
+			 struct rte_swx_match_field_params *fields,
 			 uint32_t n_fields,
+			 struct header *header,
 			 enum rte_swx_table_match_type *match_type)
 {
 	uint32_t n_fields_em = 0, n_fields_lpm = 0, i;
@@ -7202,6 +7204,20 @@ table_match_type_resolve(struct rte_swx_match_field_params *fields,
 	    (n_fields_lpm && (n_fields_em != n_fields - 1)))
 		return -EINVAL;
 
+	/* A single 32-bit LPM field stored in network byte order, i.e. a header
+	 * field, can be handled by a dedicated LPM table.
+	 */
+	if ((n_fields == 1) && n_fields_lpm && header) {
+		struct header *h;
+		struct field *hf;
+
+		hf = header_field_parse(p, fields[0].name, &h);
+		if (hf && (hf->n_bits == 32)) {
+			*match_type = RTE_SWX_TABLE_MATCH_LPM;
+			return 0;
+		}
+	}
+
 	*match_type = (n_fields_em == n_fields) ?
 		       RTE_SWX_TABLE_MATCH_EXACT :
 		       RTE_SWX_TABLE_MATCH_WILDCARD;
@@ -7367,11 +7383,31 @@ rte_swx_pipeline_table_config(struct rte_swx_pipeline *p,
 	if (params->n_fields) {
 		enum rte_swx_table_match_type match_type;
 
-		status = table_match_type_resolve(params->fields, params->n_fields, &match_type);
+		status = table_match_type_resolve(p,
+						  params->fields,
+						  params->n_fields,
+						  header,
+						  &match_type);
 		if (status)
 			return status;
 
 		type = table_type_resolve(p, recommended_table_type_name, match_type);
+
+		/* Any LPM table can also be implemented as a wildcard table, which
+		 * is used when no LPM table type is registered or when explicitly
+		 * recommended.
+		 */
+		if (match_type == RTE_SWX_TABLE_MATCH_LPM) {
+			struct table_type *wm_type;
+
+			wm_type = table_type_resolve(p,
+						     recommended_table_type_name,
+						     RTE_SWX_TABLE_MATCH_WILDCARD);
+			if (!type ||
+			    (wm_type && recommended_table_type_name &&
+			     !strcmp(wm_type->name, recommended_table_type_name)))
+				type = wm_type;
+		}
 		CHECK(type, EINVAL);
 	} else {
 		type = NULL;
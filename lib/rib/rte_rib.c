@@ -10,7 +10,7 @@
 #include <rte_eal_memconfig.h>
 #include <rte_errno.h>
 #include <rte_malloc.h>
-#include <rte_mempool.h>
+#include <rte_prefetch.h>
 #include <rte_rwlock.h>
 #include <rte_string_fns.h>
 #include <rte_tailq.h>
@@ -43,7 +43,11 @@ struct rte_rib_node {
 struct rte_rib {
 	char		name[RTE_RIB_NAMESIZE];
 	struct rte_rib_node	*tree;
-	struct rte_mempool	*node_pool;
+	/* nodes pool, each node in its own cache line sized block */
+	uint8_t			*nodes;
+	struct rte_rib_node	*free_nodes;
+	uint32_t		node_sz;
+	uint32_t		top_node;
 	uint32_t		cur_nodes;
 	uint32_t		cur_routes;
 	uint32_t		max_nodes;
@@ -80,10 +84,15 @@ static struct rte_rib_node *
 node_alloc(struct rte_rib *rib)
 {
 	struct rte_rib_node *ent;
-	int ret;
 
-	ret = rte_mempool_get(rib->node_pool, (void *)&ent);
-	if (unlikely(ret != 0))
+	/* freed nodes are chained through their left pointer */
+	if (rib->free_nodes != NULL) {
+		ent = rib->free_nodes;
+		rib->free_nodes = ent->left;
+	} else if (rib->top_node < rib->max_nodes) {
+		ent = (struct rte_rib_node *)(rib->nodes +
+			(size_t)rib->top_node++ * rib->node_sz);
+	} else
 		return NULL;
 	++rib->cur_nodes;
 	return ent;
@@ -93,13 +102,14 @@ static void
 node_free(struct rte_rib *rib, struct rte_rib_node *ent)
 {
 	--rib->cur_nodes;
-	rte_mempool_put(rib->node_pool, ent);
+	ent->left = rib->free_nodes;
+	rib->free_nodes = ent;
 }
 
 struct rte_rib_node *
 rte_rib_lookup(struct rte_rib *rib, uint32_t ip)
 {
-	struct rte_rib_node *cur, *prev = NULL;
+	struct rte_rib_node *cur, *nxt, *prev = NULL;
 
 	if (rib == NULL) {
 		rte_errno = EINVAL;
@@ -108,9 +118,12 @@ rte_rib_lookup(struct rte_rib *rib, uint32_t ip)
 
 	cur = rib->tree;
 	while ((cur != NULL) && is_covered(ip, cur->ip, cur->depth)) {
+		nxt = get_nxt_node(cur, ip);
+		/* fetch the next node while checking the current one */
+		rte_prefetch0(nxt);
 		if (is_valid_node(cur))
 			prev = cur;
-		cur = get_nxt_node(cur, ip);
+		cur = nxt;
 	}
 	return prev;
 }
@@ -163,17 +176,12 @@ rte_rib_lookup_exact(struct rte_rib *rib, uint32_t ip, uint8_t depth)
  *  for a given in args ip/depth prefix
  *  last = NULL means the first invocation
  */
-struct rte_rib_node *
-rte_rib_get_nxt(struct rte_rib *rib, uint32_t ip,
+static struct rte_rib_node *
+__rib_get_nxt(struct rte_rib *rib, uint32_t ip,
 	uint8_t depth, struct rte_rib_node *last, int flag)
 {
 	struct rte_rib_node *tmp, *prev = NULL;
 
-	if ((rib == NULL) || (depth > RIB_MAXDEPTH)) {
-		rte_errno = EINVAL;
-		return NULL;
-	}
-
 	if (last == NULL) {
 		tmp = rib->tree;
 		while ((tmp) && (tmp->depth < depth))
@@ -203,6 +211,63 @@ rte_rib_get_nxt(struct rte_rib *rib, uint32_t ip,
 	return prev;
 }
 
+struct rte_rib_node *
+rte_rib_get_nxt(struct rte_rib *rib, uint32_t ip,
+	uint8_t depth, struct rte_rib_node *last, int flag)
+{
+	if ((rib == NULL) || (depth > RIB_MAXDEPTH)) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	return __rib_get_nxt(rib, ip, depth, last, flag);
+}
+
+int
+rte_rib_iter_init(struct rte_rib_iter *iter, struct rte_rib *rib,
+	uint32_t ip, uint8_t depth, int flag)
+{
+	if ((iter == NULL) || (rib == NULL) || (depth > RIB_MAXDEPTH) ||
+			((flag != RTE_RIB_GET_NXT_ALL) &&
+			(flag != RTE_RIB_GET_NXT_COVER))) {
+		rte_errno = EINVAL;
+		return -1;
+	}
+
+	iter->rib = rib;
+	iter->last = NULL;
+	iter->ip = ip & rte_rib_depth_to_mask(depth);
+	iter->depth = depth;
+	iter->flag = flag;
+	iter->done = 0;
+
+	return 0;
+}
+
+unsigned int
+rte_rib_iter_next_bulk(struct rte_rib_iter *iter,
+	struct rte_rib_node **nodes, unsigned int n)
+{
+	struct rte_rib_node *tmp = iter->last;
+	unsigned int i;
+
+	if (iter->done)
+		return 0;
+
+	for (i = 0; i < n; i++) {
+		tmp = __rib_get_nxt(iter->rib, iter->ip, iter->depth, tmp,
+			iter->flag);
+		if (tmp == NULL) {
+			iter->done = 1;
+			break;
+		}
+		nodes[i] = tmp;
+	}
+	iter->last = tmp;
+
+	return i;
+}
+
 void
 rte_rib_remove(struct rte_rib *rib, uint32_t ip, uint8_t depth)
 {
@@ -398,7 +463,8 @@ rte_rib_create(const char *name, int socket_id, const struct rte_rib_conf *conf)
 	struct rte_rib *rib = NULL;
 	struct rte_tailq_entry *te;
 	struct rte_rib_list *rib_list;
-	struct rte_mempool *node_pool;
+	uint8_t *nodes;
+	uint32_t node_sz;
 
 	/* Check user arguments. */
 	if (name == NULL || conf == NULL || conf->max_nodes <= 0) {
@@ -406,14 +472,15 @@ rte_rib_create(const char *name, int socket_id, const struct rte_rib_conf *conf)
 		return NULL;
 	}
 
-	snprintf(mem_name, sizeof(mem_name), "MP_%s", name);
-	node_pool = rte_mempool_create(mem_name, conf->max_nodes,
-		sizeof(struct rte_rib_node) + conf->ext_sz, 0, 0,
-		NULL, NULL, NULL, NULL, socket_id, 0);
-
-	if (node_pool == NULL) {
+	node_sz = RTE_ALIGN_CEIL(sizeof(struct rte_rib_node) + conf->ext_sz,
+		RTE_CACHE_LINE_SIZE);
+	snprintf(mem_name, sizeof(mem_name), "RIBN_%s", name);
+	nodes = rte_malloc_socket(mem_name, (size_t)conf->max_nodes * node_sz,
+		RTE_CACHE_LINE_SIZE, socket_id);
+	if (nodes == NULL) {
 		RTE_LOG(ERR, LPM,
-			"Can not allocate mempool for RIB %s\n", name);
+			"Can not allocate nodes for RIB %s\n", name);
+		rte_errno = ENOMEM;
 		return NULL;
 	}
 
@@ -455,7 +522,8 @@ rte_rib_create(const char *name, int socket_id, const struct rte_rib_conf *conf)
 	rte_strlcpy(rib->name, name, sizeof(rib->name));
 	rib->tree = NULL;
 	rib->max_nodes = conf->max_nodes;
-	rib->node_pool = node_pool;
+	rib->nodes = nodes;
+	rib->node_sz = node_sz;
 	te->data = (void *)rib;
 	TAILQ_INSERT_TAIL(rib_list, te, next);
 
@@ -467,7 +535,7 @@ rte_rib_create(const char *name, int socket_id, const struct rte_rib_conf *conf)
 	rte_free(te);
 exit:
 	rte_mcfg_tailq_write_unlock();
-	rte_mempool_free(node_pool);
+	rte_free(nodes);
 
 	return NULL;
 }
@@ -502,7 +570,6 @@ rte_rib_free(struct rte_rib *rib)
 {
 	struct rte_tailq_entry *te;
 	struct rte_rib_list *rib_list;
-	struct rte_rib_node *tmp = NULL;
 
 	if (rib == NULL)
 		return;
@@ -521,11 +588,7 @@ rte_rib_free(struct rte_rib *rib)
 
 	rte_mcfg_tailq_write_unlock();
 
-	while ((tmp = rte_rib_get_nxt(rib, 0, 0, tmp,
-			RTE_RIB_GET_NXT_ALL)) != NULL)
-		rte_rib_remove(rib, tmp->ip, tmp->depth);
-
-	rte_mempool_free(rib->node_pool);
+	rte_free(rib->nodes);
 	rte_free(rib);
 	rte_free(te);
 }
@@ -48,6 +48,19 @@ struct rte_rib_conf {
 	int	max_nodes;
 };
 
+/**
+ * Iterator over the more specific routes of a prefix,
+ * initialized by rte_rib_iter_init().
+ */
+struct rte_rib_iter {
+	struct rte_rib		*rib;	/**< RIB walked through */
+	struct rte_rib_node	*last;	/**< Last returned route */
+	uint32_t		ip;	/**< Supernet prefix */
+	uint8_t			depth;	/**< Supernet prefix length */
+	uint8_t			done;	/**< All the routes were returned */
+	int			flag;	/**< rte_rib_get_nxt() flag */
+};
+
 /**
  * Get an IPv4 mask from prefix length
  * It is caller responsibility to make sure depth is not bigger than 32
@@ -133,6 +146,56 @@ struct rte_rib_node *
 rte_rib_get_nxt(struct rte_rib *rib, uint32_t ip, uint8_t depth,
 	struct rte_rib_node *last, int flag);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Initialize an iterator over the more specific prefixes
+ * covered by ip/depth supernet, see rte_rib_get_nxt().
+ * The RIB must not be modified while it is walked through.
+ *
+ * @param iter
+ *  iterator to initialize
+ * @param rib
+ *  RIB object handle
+ * @param ip
+ *  net address of supernet prefix that covers returned more specific prefixes
+ * @param depth
+ *  supernet prefix length
+ * @param flag
+ *  -RTE_RIB_GET_NXT_ALL
+ *   get all prefixes from subtrie
+ *  -RTE_RIB_GET_NXT_COVER
+ *   get only first more specific prefix even if it have more specifics
+ * @return
+ *  0 on success, -1 with rte_errno set to EINVAL otherwise
+ */
+__rte_experimental
+int
+rte_rib_iter_init(struct rte_rib_iter *iter, struct rte_rib *rib,
+	uint32_t ip, uint8_t depth, int flag);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Retrieve the next more specific prefixes of an iterator,
+ * in the same order as rte_rib_get_nxt().
+ *
+ * @param iter
+ *  iterator initialized by rte_rib_iter_init()
+ * @param nodes
+ *  array to store the returned prefixes
+ * @param n
+ *  size of the nodes array
+ * @return
+ *  number of prefixes returned, lower than n once the walk is over
+ */
+__rte_experimental
+unsigned int
+rte_rib_iter_next_bulk(struct rte_rib_iter *iter,
+	struct rte_rib_node **nodes, unsigned int n);
+
 /**
  * Remove prefix from the RIB
  *
@@ -5,12 +5,14 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
+#include <rte_byteorder.h>
 #include <rte_eal.h>
 #include <rte_eal_memconfig.h>
 #include <rte_errno.h>
 #include <rte_malloc.h>
-#include <rte_mempool.h>
+#include <rte_prefetch.h>
 #include <rte_rwlock.h>
 #include <rte_string_fns.h>
 #include <rte_tailq.h>
@@ -42,7 +44,11 @@ struct rte_rib6_node {
 struct rte_rib6 {
 	char		name[RTE_RIB6_NAMESIZE];
 	struct rte_rib6_node	*tree;
-	struct rte_mempool	*node_pool;
+	/* nodes pool, each node in its own cache line sized block */
+	uint8_t			*nodes;
+	struct rte_rib6_node	*free_nodes;
+	uint32_t		node_sz;
+	uint32_t		top_node;
 	uint32_t		cur_nodes;
 	uint32_t		cur_routes;
 	int			max_nodes;
@@ -60,6 +66,60 @@ is_right_node(struct rte_rib6_node *node)
 	return node->parent->right == node;
 }
 
+/*
+ * The addresses are handled as two host order 64-bit words,
+ * the most significant one first.
+ */
+static inline void
+get_ip_words(const uint8_t ip[RTE_RIB6_IPV6_ADDR_SIZE], uint64_t w[2])
+{
+	uint64_t tmp[2];
+
+	memcpy(tmp, ip, sizeof(tmp));
+	w[0] = rte_be_to_cpu_64(tmp[0]);
+	w[1] = rte_be_to_cpu_64(tmp[1]);
+}
+
+static inline void
+set_ip_words(uint8_t ip[RTE_RIB6_IPV6_ADDR_SIZE], const uint64_t w[2])
+{
+	uint64_t tmp[2];
+
+	tmp[0] = rte_cpu_to_be_64(w[0]);
+	tmp[1] = rte_cpu_to_be_64(w[1]);
+	memcpy(ip, tmp, sizeof(tmp));
+}
+
+/*
+ * Get the 64-bit word of a prefix length mask
+ */
+static inline uint64_t
+get_msk_word(uint8_t depth, int word)
+{
+	int bits = RTE_MIN(RTE_MAX((int)depth - 64 * word, 0), 64);
+
+	return (bits == 0) ? 0 : UINT64_MAX << (64 - bits);
+}
+
+static inline void
+mask_ip(uint8_t dst[RTE_RIB6_IPV6_ADDR_SIZE],
+	const uint8_t src[RTE_RIB6_IPV6_ADDR_SIZE], uint8_t depth)
+{
+	uint64_t w[2];
+
+	get_ip_words(src, w);
+	w[0] &= get_msk_word(depth, 0);
+	w[1] &= get_msk_word(depth, 1);
+	set_ip_words(dst, w);
+}
+
+static inline bool
+is_equal(const uint8_t ip1[RTE_RIB6_IPV6_ADDR_SIZE],
+	const uint8_t ip2[RTE_RIB6_IPV6_ADDR_SIZE])
+{
+	return memcmp(ip1, ip2, RTE_RIB6_IPV6_ADDR_SIZE) == 0;
+}
+
 /*
  * Check if ip1 is covered by ip2/depth prefix
  */
@@ -67,13 +127,32 @@ static inline bool
 is_covered(const uint8_t ip1[RTE_RIB6_IPV6_ADDR_SIZE],
 		const uint8_t ip2[RTE_RIB6_IPV6_ADDR_SIZE], uint8_t depth)
 {
-	int i;
+	uint64_t w1[2], w2[2];
 
-	for (i = 0; i < RTE_RIB6_IPV6_ADDR_SIZE; i++)
-		if ((ip1[i] ^ ip2[i]) & get_msk_part(depth, i))
-			return false;
+	get_ip_words(ip1, w1);
+	get_ip_words(ip2, w2);
 
-	return true;
+	return (((w1[0] ^ w2[0]) & get_msk_word(depth, 0)) |
+		((w1[1] ^ w2[1]) & get_msk_word(depth, 1))) == 0;
+}
+
+/*
+ * Get the length of the common prefix of two addresses
+ */
+static inline uint8_t
+get_common_depth(const uint8_t ip1[RTE_RIB6_IPV6_ADDR_SIZE],
+		const uint8_t ip2[RTE_RIB6_IPV6_ADDR_SIZE])
+{
+	uint64_t w1[2], w2[2];
+
+	get_ip_words(ip1, w1);
+	get_ip_words(ip2, w2);
+
+	if (w1[0] != w2[0])
+		return __builtin_clzll(w1[0] ^ w2[0]);
+	if (w1[1] != w2[1])
+		return 64 + __builtin_clzll(w1[1] ^ w2[1]);
+	return RIB6_MAXDEPTH;
 }
 
 static inline int
@@ -113,10 +192,15 @@ static struct rte_rib6_node *
 node_alloc(struct rte_rib6 *rib)
 {
 	struct rte_rib6_node *ent;
-	int ret;
 
-	ret = rte_mempool_get(rib->node_pool, (void *)&ent);
-	if (unlikely(ret != 0))
+	/* freed nodes are chained through their left pointer */
+	if (rib->free_nodes != NULL) {
+		ent = rib->free_nodes;
+		rib->free_nodes = ent->left;
+	} else if (rib->top_node < (uint32_t)rib->max_nodes) {
+		ent = (struct rte_rib6_node *)(rib->nodes +
+			(size_t)rib->top_node++ * rib->node_sz);
+	} else
 		return NULL;
 	++rib->cur_nodes;
 	return ent;
@@ -126,14 +210,15 @@ static void
 node_free(struct rte_rib6 *rib, struct rte_rib6_node *ent)
 {
 	--rib->cur_nodes;
-	rte_mempool_put(rib->node_pool, ent);
+	ent->left = rib->free_nodes;
+	rib->free_nodes = ent;
 }
 
 struct rte_rib6_node *
 rte_rib6_lookup(struct rte_rib6 *rib,
 	const uint8_t ip[RTE_RIB6_IPV6_ADDR_SIZE])
 {
-	struct rte_rib6_node *cur;
+	struct rte_rib6_node *cur, *nxt;
 	struct rte_rib6_node *prev = NULL;
 
 	if (unlikely(rib == NULL)) {
@@ -143,9 +228,12 @@ rte_rib6_lookup(struct rte_rib6 *rib,
 	cur = rib->tree;
 
 	while ((cur != NULL) && is_covered(ip, cur->ip, cur->depth)) {
+		nxt = get_nxt_node(cur, ip);
+		/* fetch the next node while checking the current one */
+		rte_prefetch0(nxt);
 		if (is_valid_node(cur))
 			prev = cur;
-		cur = get_nxt_node(cur, ip);
+		cur = nxt;
 	}
 	return prev;
 }
@@ -171,7 +259,6 @@ rte_rib6_lookup_exact(struct rte_rib6 *rib,
 {
 	struct rte_rib6_node *cur;
 	uint8_t tmp_ip[RTE_RIB6_IPV6_ADDR_SIZE];
-	int i;
 
 	if ((rib == NULL) || (ip == NULL) || (depth > RIB6_MAXDEPTH)) {
 		rte_errno = EINVAL;
@@ -179,11 +266,10 @@ rte_rib6_lookup_exact(struct rte_rib6 *rib,
 	}
 	cur = rib->tree;
 
-	for (i = 0; i < RTE_RIB6_IPV6_ADDR_SIZE; i++)
-		tmp_ip[i] = ip[i] & get_msk_part(depth, i);
+	mask_ip(tmp_ip, ip, depth);
 
 	while (cur != NULL) {
-		if (rte_rib6_is_equal(cur->ip, tmp_ip) &&
+		if (is_equal(cur->ip, tmp_ip) &&
 				(cur->depth == depth) &&
 				is_valid_node(cur))
 			return cur;
@@ -203,22 +289,12 @@ rte_rib6_lookup_exact(struct rte_rib6 *rib,
  *  for a given in args ip/depth prefix
  *  last = NULL means the first invocation
  */
-struct rte_rib6_node *
-rte_rib6_get_nxt(struct rte_rib6 *rib,
-	const uint8_t ip[RTE_RIB6_IPV6_ADDR_SIZE],
+static struct rte_rib6_node *
+__rib6_get_nxt(struct rte_rib6 *rib,
+	const uint8_t tmp_ip[RTE_RIB6_IPV6_ADDR_SIZE],
 	uint8_t depth, struct rte_rib6_node *last, int flag)
 {
 	struct rte_rib6_node *tmp, *prev = NULL;
-	uint8_t tmp_ip[RTE_RIB6_IPV6_ADDR_SIZE];
-	int i;
-
-	if ((rib == NULL) || (ip == NULL) || (depth > RIB6_MAXDEPTH)) {
-		rte_errno = EINVAL;
-		return NULL;
-	}
-
-	for (i = 0; i < RTE_RIB6_IPV6_ADDR_SIZE; i++)
-		tmp_ip[i] = ip[i] & get_msk_part(depth, i);
 
 	if (last == NULL) {
 		tmp = rib->tree;
@@ -249,6 +325,69 @@ rte_rib6_get_nxt(struct rte_rib6 *rib,
 	return prev;
 }
 
+struct rte_rib6_node *
+rte_rib6_get_nxt(struct rte_rib6 *rib,
+	const uint8_t ip[RTE_RIB6_IPV6_ADDR_SIZE],
+	uint8_t depth, struct rte_rib6_node *last, int flag)
+{
+	uint8_t tmp_ip[RTE_RIB6_IPV6_ADDR_SIZE];
+
+	if ((rib == NULL) || (ip == NULL) || (depth > RIB6_MAXDEPTH)) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	mask_ip(tmp_ip, ip, depth);
+
+	return __rib6_get_nxt(rib, tmp_ip, depth, last, flag);
+}
+
+int
+rte_rib6_iter_init(struct rte_rib6_iter *iter, struct rte_rib6 *rib,
+	const uint8_t ip[RTE_RIB6_IPV6_ADDR_SIZE], uint8_t depth, int flag)
+{
+	if ((iter == NULL) || (rib == NULL) || (ip == NULL) ||
+			(depth > RIB6_MAXDEPTH) ||
+			((flag != RTE_RIB6_GET_NXT_ALL) &&
+			(flag != RTE_RIB6_GET_NXT_COVER))) {
+		rte_errno = EINVAL;
+		return -1;
+	}
+
+	iter->rib = rib;
+	iter->last = NULL;
+	mask_ip(iter->ip, ip, depth);
+	iter->depth = depth;
+	iter->flag = flag;
+	iter->done = 0;
+
+	return 0;
+}
+
+unsigned int
+rte_rib6_iter_next_bulk(struct rte_rib6_iter *iter,
+	struct rte_rib6_node **nodes, unsigned int n)
+{
+	struct rte_rib6_node *tmp = iter->last;
+	unsigned int i;
+
+	if (iter->done)
+		return 0;
+
+	for (i = 0; i < n; i++) {
+		tmp = __rib6_get_nxt(iter->rib, iter->ip, iter->depth, tmp,
+			iter->flag);
+		if (tmp == NULL) {
+			iter->done = 1;
+			break;
+		}
+		nodes[i] = tmp;
+	}
+	iter->last = tmp;
+
+	return i;
+}
+
 void
 rte_rib6_remove(struct rte_rib6 *rib,
 	const uint8_t ip[RTE_RIB6_IPV6_ADDR_SIZE], uint8_t depth)
@@ -292,8 +431,7 @@ rte_rib6_insert(struct rte_rib6 *rib,
 	struct rte_rib6_node *common_node = NULL;
 	uint8_t common_prefix[RTE_RIB6_IPV6_ADDR_SIZE];
 	uint8_t tmp_ip[RTE_RIB6_IPV6_ADDR_SIZE];
-	int i, d;
-	uint8_t common_depth, ip_xor;
+	uint8_t common_depth;
 
 	if (unlikely((rib == NULL) || (ip == NULL) ||
 			(depth > RIB6_MAXDEPTH))) {
@@ -303,8 +441,7 @@ rte_rib6_insert(struct rte_rib6 *rib,
 
 	tmp = &rib->tree;
 
-	for (i = 0; i < RTE_RIB6_IPV6_ADDR_SIZE; i++)
-		tmp_ip[i] = ip[i] & get_msk_part(depth, i);
+	mask_ip(tmp_ip, ip, depth);
 
 	new_node = rte_rib6_lookup_exact(rib, tmp_ip, depth);
 	if (new_node != NULL) {
@@ -339,7 +476,7 @@ rte_rib6_insert(struct rte_rib6 *rib,
 		 * but node with proper search criteria is found.
 		 * Validate intermediate node and return.
 		 */
-		if (rte_rib6_is_equal(tmp_ip, (*tmp)->ip) &&
+		if (is_equal(tmp_ip, (*tmp)->ip) &&
 				(depth == (*tmp)->depth)) {
 			node_free(rib, new_node);
 			(*tmp)->flag |= RTE_RIB_VALID_NODE;
@@ -359,22 +496,12 @@ rte_rib6_insert(struct rte_rib6 *rib,
 
 	/* closest node found, new_node should be inserted in the middle */
 	common_depth = RTE_MIN(depth, (*tmp)->depth);
-	for (i = 0, d = 0; i < RTE_RIB6_IPV6_ADDR_SIZE; i++) {
-		ip_xor = tmp_ip[i] ^ (*tmp)->ip[i];
-		if (ip_xor == 0)
-			d += 8;
-		else {
-			d += __builtin_clz(ip_xor << 24);
-			break;
-		}
-	}
+	common_depth = RTE_MIN(get_common_depth(tmp_ip, (*tmp)->ip),
+		common_depth);
 
-	common_depth = RTE_MIN(d, common_depth);
+	mask_ip(common_prefix, tmp_ip, common_depth);
 
-	for (i = 0; i < RTE_RIB6_IPV6_ADDR_SIZE; i++)
-		common_prefix[i] = tmp_ip[i] & get_msk_part(common_depth, i);
-
-	if (rte_rib6_is_equal(common_prefix, tmp_ip) &&
+	if (is_equal(common_prefix, tmp_ip) &&
 			(common_depth == depth)) {
 		/* insert as a parent */
 		if (get_dir((*tmp)->ip, depth))
@@ -470,7 +597,8 @@ rte_rib6_create(const char *name, int socket_id,
 	struct rte_rib6 *rib = NULL;
 	struct rte_tailq_entry *te;
 	struct rte_rib6_list *rib6_list;
-	struct rte_mempool *node_pool;
+	uint8_t *nodes;
+	uint32_t node_sz;
 
 	/* Check user arguments. */
 	if (name == NULL || conf == NULL || conf->max_nodes <= 0) {
@@ -478,14 +606,15 @@ rte_rib6_create(const char *name, int socket_id,
 		return NULL;
 	}
 
-	snprintf(mem_name, sizeof(mem_name), "MP_%s", name);
-	node_pool = rte_mempool_create(mem_name, conf->max_nodes,
-		sizeof(struct rte_rib6_node) + conf->ext_sz, 0, 0,
-		NULL, NULL, NULL, NULL, socket_id, 0);
-
-	if (node_pool == NULL) {
+	node_sz = RTE_ALIGN_CEIL(sizeof(struct rte_rib6_node) + conf->ext_sz,
+		RTE_CACHE_LINE_SIZE);
+	snprintf(mem_name, sizeof(mem_name), "RIBN6_%s", name);
+	nodes = rte_malloc_socket(mem_name, (size_t)conf->max_nodes * node_sz,
+		RTE_CACHE_LINE_SIZE, socket_id);
+	if (nodes == NULL) {
 		RTE_LOG(ERR, LPM,
-			"Can not allocate mempool for RIB6 %s\n", name);
+			"Can not allocate nodes for RIB6 %s\n", name);
+		rte_errno = ENOMEM;
 		return NULL;
 	}
 
@@ -527,7 +656,8 @@ rte_rib6_create(const char *name, int socket_id,
 	rte_strlcpy(rib->name, name, sizeof(rib->name));
 	rib->tree = NULL;
 	rib->max_nodes = conf->max_nodes;
-	rib->node_pool = node_pool;
+	rib->nodes = nodes;
+	rib->node_sz = node_sz;
 
 	te->data = (void *)rib;
 	TAILQ_INSERT_TAIL(rib6_list, te, next);
@@ -540,7 +670,7 @@ rte_rib6_create(const char *name, int socket_id,
 	rte_free(te);
 exit:
 	rte_mcfg_tailq_write_unlock();
-	rte_mempool_free(node_pool);
+	rte_free(nodes);
 
 	return NULL;
 }
@@ -580,7 +710,6 @@ rte_rib6_free(struct rte_rib6 *rib)
 {
 	struct rte_tailq_entry *te;
 	struct rte_rib6_list *rib6_list;
-	struct rte_rib6_node *tmp = NULL;
 
 	if (unlikely(rib == NULL)) {
 		rte_errno = EINVAL;
@@ -601,12 +730,7 @@ rte_rib6_free(struct rte_rib6 *rib)
 
 	rte_mcfg_tailq_write_unlock();
 
-	while ((tmp = rte_rib6_get_nxt(rib, 0, 0, tmp,
-			RTE_RIB6_GET_NXT_ALL)) != NULL)
-		rte_rib6_remove(rib, tmp->ip, tmp->depth);
-
-	rte_mempool_free(rib->node_pool);
-
+	rte_free(rib->nodes);
 	rte_free(rib);
 	rte_free(te);
 }
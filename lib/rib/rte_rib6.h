@@ -49,6 +49,19 @@ struct rte_rib6_conf {
 	int	max_nodes;
 };
 
+/**
+ * Iterator over the more specific routes of a prefix,
+ * initialized by rte_rib6_iter_init().
+ */
+struct rte_rib6_iter {
+	struct rte_rib6		*rib;	/**< RIB walked through */
+	struct rte_rib6_node	*last;	/**< Last returned route */
+	uint8_t	ip[RTE_RIB6_IPV6_ADDR_SIZE];	/**< Supernet prefix */
+	uint8_t			depth;	/**< Supernet prefix length */
+	uint8_t			done;	/**< All the routes were returned */
+	int			flag;	/**< rte_rib6_get_nxt() flag */
+};
+
 /**
  * Copy IPv6 address from one location to another
  *
@@ -185,6 +198,56 @@ rte_rib6_get_nxt(struct rte_rib6 *rib,
 	const uint8_t ip[RTE_RIB6_IPV6_ADDR_SIZE],
 	uint8_t depth, struct rte_rib6_node *last, int flag);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Initialize an iterator over the more specific prefixes
+ * covered by ip/depth supernet, see rte_rib6_get_nxt().
+ * The RIB must not be modified while it is walked through.
+ *
+ * @param iter
+ *  iterator to initialize
+ * @param rib
+ *  RIB object handle
+ * @param ip
+ *  net address of supernet prefix that covers returned more specific prefixes
+ * @param depth
+ *  supernet prefix length
+ * @param flag
+ *  -RTE_RIB6_GET_NXT_ALL
+ *   get all prefixes from subtrie
+ *  -RTE_RIB6_GET_NXT_COVER
+ *   get only first more specific prefix even if it have more specifics
+ * @return
+ *  0 on success, -1 with rte_errno set to EINVAL otherwise
+ */
+__rte_experimental
+int
+rte_rib6_iter_init(struct rte_rib6_iter *iter, struct rte_rib6 *rib,
+	const uint8_t ip[RTE_RIB6_IPV6_ADDR_SIZE], uint8_t depth, int flag);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Retrieve the next more specific prefixes of an iterator,
+ * in the same order as rte_rib6_get_nxt().
+ *
+ * @param iter
+ *  iterator initialized by rte_rib6_iter_init()
+ * @param nodes
+ *  array to store the returned prefixes
+ * @param n
+ *  size of the nodes array
+ * @return
+ *  number of prefixes returned, lower than n once the walk is over
+ */
+__rte_experimental
+unsigned int
+rte_rib6_iter_next_bulk(struct rte_rib6_iter *iter,
+	struct rte_rib6_node **nodes, unsigned int n);
+
 /**
  * Remove prefix from the RIB
  *
@@ -26,6 +26,11 @@
 #include <rte_atomic.h>
 #include <rte_per_lcore.h>
 #include <rte_lcore.h>
+#include <rte_cycles.h>
+#include <rte_pause.h>
+#include <rte_power_intrinsics.h>
+#include <rte_prefetch.h>
+#include <rte_bitops.h>
 #include <rte_branch_prediction.h>
 #include <rte_errno.h>
 #include <rte_string_fns.h>
@@ -45,7 +50,8 @@ EAL_REGISTER_TAILQ(rte_ring_tailq)
 /* mask of all valid flag values to ring_create() */
 #define RING_F_MASK (RING_F_SP_ENQ | RING_F_SC_DEQ | RING_F_EXACT_SZ | \
 		     RING_F_MP_RTS_ENQ | RING_F_MC_RTS_DEQ |	       \
-		     RING_F_MP_HTS_ENQ | RING_F_MC_HTS_DEQ)
+		     RING_F_MP_HTS_ENQ | RING_F_MC_HTS_DEQ |	       \
+		     RING_F_MP_ORD_ENQ)
 
 /* true if x is a power of 2 */
 #define POWEROF2(x) ((((x)-1) & (x)) == 0)
@@ -87,6 +93,33 @@ rte_ring_get_memsize(unsigned int count)
 	return rte_ring_get_memsize_elem(sizeof(void *), count);
 }
 
+/* return the size of memory occupied by a ring with ordered producers */
+static ssize_t
+get_memsize_ord(unsigned int esize, unsigned int count)
+{
+	ssize_t sz;
+
+	sz = rte_ring_get_memsize_elem(esize, count);
+	if (sz < 0)
+		return sz;
+
+	/* sequence array of the ordered producers after the elements */
+	return sz + RTE_ALIGN(count * sizeof(uint32_t), RTE_CACHE_LINE_SIZE);
+}
+
+/*
+ * internal helper function to mark all the slots of an ordered ring
+ * as finished one lap before their first position.
+ */
+static void
+reset_ord_seq(struct rte_ring *r)
+{
+	uint32_t i;
+
+	for (i = 0; i != r->size; i++)
+		r->ord_prod.seq[i] = i + 1 - r->size;
+}
+
 /*
  * internal helper function to reset prod/cons head-tail values.
  */
@@ -104,6 +137,7 @@ reset_headtail(void *p)
 	switch (ht->sync_type) {
 	case RTE_RING_SYNC_MT:
 	case RTE_RING_SYNC_ST:
+	case RTE_RING_SYNC_MT_ORD:
 		ht->head = 0;
 		ht->tail = 0;
 		break;
@@ -125,6 +159,8 @@ rte_ring_reset(struct rte_ring *r)
 {
 	reset_headtail(&r->prod);
 	reset_headtail(&r->cons);
+	if (r->prod.sync_type == RTE_RING_SYNC_MT_ORD)
+		reset_ord_seq(r);
 }
 
 /*
@@ -137,7 +173,8 @@ get_sync_type(uint32_t flags, enum rte_ring_sync_type *prod_st,
 	enum rte_ring_sync_type *cons_st)
 {
 	static const uint32_t prod_st_flags =
-		(RING_F_SP_ENQ | RING_F_MP_RTS_ENQ | RING_F_MP_HTS_ENQ);
+		(RING_F_SP_ENQ | RING_F_MP_RTS_ENQ | RING_F_MP_HTS_ENQ |
+		 RING_F_MP_ORD_ENQ);
 	static const uint32_t cons_st_flags =
 		(RING_F_SC_DEQ | RING_F_MC_RTS_DEQ | RING_F_MC_HTS_DEQ);
 
@@ -154,6 +191,9 @@ get_sync_type(uint32_t flags, enum rte_ring_sync_type *prod_st,
 	case RING_F_MP_HTS_ENQ:
 		*prod_st = RTE_RING_SYNC_MT_HTS;
 		break;
+	case RING_F_MP_ORD_ENQ:
+		*prod_st = RTE_RING_SYNC_MT_ORD;
+		break;
 	default:
 		return -EINVAL;
 	}
@@ -178,8 +218,8 @@ get_sync_type(uint32_t flags, enum rte_ring_sync_type *prod_st,
 	return 0;
 }
 
-int
-rte_ring_init(struct rte_ring *r, const char *name, unsigned int count,
+static int
+ring_init(struct rte_ring *r, const char *name, unsigned int count,
 	unsigned int flags)
 {
 	int ret;
@@ -202,6 +242,11 @@ rte_ring_init(struct rte_ring *r, const char *name, unsigned int count,
 	RTE_BUILD_BUG_ON(offsetof(struct rte_ring_headtail, tail) !=
 		offsetof(struct rte_ring_rts_headtail, tail.val.pos));
 
+	RTE_BUILD_BUG_ON(offsetof(struct rte_ring_headtail, sync_type) !=
+		offsetof(struct rte_ring_ord_headtail, sync_type));
+	RTE_BUILD_BUG_ON(offsetof(struct rte_ring_headtail, tail) !=
+		offsetof(struct rte_ring_ord_headtail, tail));
+
 	/* future proof flags, only allow supported values */
 	if (flags & ~RING_F_MASK) {
 		RTE_LOG(ERR, RING,
@@ -244,6 +289,22 @@ rte_ring_init(struct rte_ring *r, const char *name, unsigned int count,
 	return 0;
 }
 
+int
+rte_ring_init(struct rte_ring *r, const char *name, unsigned int count,
+	unsigned int flags)
+{
+	/* the sequence array of the ordered producers is after the elements,
+	 * whose size is unknown here
+	 */
+	if (flags & RING_F_MP_ORD_ENQ) {
+		RTE_LOG(ERR, RING,
+			"Ordered producers require rte_ring_create()\n");
+		return -EINVAL;
+	}
+
+	return ring_init(r, name, count, flags);
+}
+
 /* create the ring for a given element size */
 struct rte_ring *
 rte_ring_create_elem(const char *name, unsigned int esize, unsigned int count,
@@ -265,7 +326,10 @@ rte_ring_create_elem(const char *name, unsigned int esize, unsigned int count,
 	if (flags & RING_F_EXACT_SZ)
 		count = rte_align32pow2(count + 1);
 
-	ring_size = rte_ring_get_memsize_elem(esize, count);
+	if (flags & RING_F_MP_ORD_ENQ)
+		ring_size = get_memsize_ord(esize, count);
+	else
+		ring_size = rte_ring_get_memsize_elem(esize, count);
 	if (ring_size < 0) {
 		rte_errno = ring_size;
 		return NULL;
@@ -296,7 +360,12 @@ rte_ring_create_elem(const char *name, unsigned int esize, unsigned int count,
 		r = mz->addr;
 		/* no need to check return value here, we already checked the
 		 * arguments above */
-		rte_ring_init(r, name, requested_count, flags);
+		ring_init(r, name, requested_count, flags);
+		if (flags & RING_F_MP_ORD_ENQ) {
+			r->ord_prod.seq = RTE_PTR_ADD(r,
+				rte_ring_get_memsize_elem(esize, count));
+			reset_ord_seq(r);
+		}
 
 		te->data = (void *) r;
 		r->memzone = mz;
@@ -367,6 +436,157 @@ rte_ring_free(struct rte_ring *r)
 	rte_free(te);
 }
 
+/* abort the monitor wait if the producer tail moved */
+static int
+prod_tail_monitor_clb(const uint64_t val,
+	const uint64_t opaque[RTE_POWER_MONITOR_OPAQUE_SZ])
+{
+	return (uint32_t)val != (uint32_t)opaque[0] ? -1 : 0;
+}
+
+/*
+ * Wait until the producer tail moves or tsc_timestamp is reached.
+ * The tail position is at the same offset for all the sync modes.
+ */
+static void
+ring_wait_prod_tail(const struct rte_ring *r, uint64_t tsc_timestamp)
+{
+	struct rte_power_monitor_cond pmc;
+	uint32_t tail;
+
+	tail = __atomic_load_n(&r->prod.tail, __ATOMIC_ACQUIRE);
+
+	/* objects enqueued or being dequeued by another consumer */
+	if (tail != __atomic_load_n(&r->cons.tail, __ATOMIC_RELAXED)) {
+		rte_pause();
+		return;
+	}
+
+	pmc.addr = (volatile void *)(uintptr_t)&r->prod.tail;
+	pmc.size = sizeof(r->prod.tail);
+	pmc.fn = prod_tail_monitor_clb;
+	pmc.opaque[0] = tail;
+
+	/* no monitor on this CPU or thread, poll instead */
+	if (rte_power_monitor(&pmc, tsc_timestamp) != 0)
+		rte_pause();
+}
+
+unsigned int
+rte_ring_dequeue_burst_elem_wait(struct rte_ring *r, void *obj_table,
+		unsigned int esize, unsigned int n, unsigned int *available,
+		uint64_t timeout)
+{
+	uint64_t end;
+	unsigned int k;
+
+	k = rte_ring_dequeue_burst_elem(r, obj_table, esize, n, available);
+	if (k != 0 || n == 0 || timeout == 0)
+		return k;
+
+	end = rte_get_tsc_cycles() + timeout;
+	do {
+		ring_wait_prod_tail(r, end);
+		k = rte_ring_dequeue_burst_elem(r, obj_table, esize, n,
+				available);
+	} while (k == 0 && rte_get_tsc_cycles() < end);
+
+	return k;
+}
+
+unsigned int
+rte_ring_dequeue_burst_wait(struct rte_ring *r, void **obj_table,
+		unsigned int n, unsigned int *available, uint64_t timeout)
+{
+	return rte_ring_dequeue_burst_elem_wait(r, obj_table, sizeof(void *),
+			n, available, timeout);
+}
+
+/* prefetch the head and tail lines used by the enqueue on a ring */
+static inline void
+ring_prefetch_enqueue(const struct rte_ring *r)
+{
+	rte_prefetch0(&r->prod);
+	rte_prefetch0(&r->cons);
+}
+
+/* enqueue up to RTE_RING_MULTI_BURST_MAX objects on their rings */
+static unsigned int
+ring_enqueue_burst_multi_chunk(struct rte_ring * const rings[],
+		void * const *obj_table, const uint16_t ring_idx[],
+		unsigned int n, void **unsent, unsigned int *nb_unsent)
+{
+	void *grp[RTE_RING_MULTI_BURST_MAX];
+	uint64_t pending, left;
+	unsigned int i, k, m, nb;
+	uint16_t idx;
+
+	RTE_BUILD_BUG_ON(RTE_RING_MULTI_BURST_MAX > 64);
+
+	pending = RTE_LEN2MASK(n, uint64_t);
+	left = 0;
+	nb = 0;
+
+	ring_prefetch_enqueue(rings[ring_idx[0]]);
+
+	while (pending != 0) {
+		/*
+		 * gather the objects for the ring of the first pending one,
+		 * none of them was gathered before
+		 */
+		i = rte_bsf64(pending);
+		idx = ring_idx[i];
+		k = 0;
+		for (; i != n; i++) {
+			if (ring_idx[i] == idx) {
+				grp[k++] = obj_table[i];
+				pending &= ~RTE_BIT64(i);
+			}
+		}
+
+		/* prefetch the ring of the next group */
+		if (pending != 0)
+			ring_prefetch_enqueue(
+				rings[ring_idx[rte_bsf64(pending)]]);
+
+		m = rte_ring_enqueue_burst(rings[idx], grp, k, NULL);
+		nb += m;
+
+		/* the objects which didn't fit are the last of the group */
+		for (i = n; k != m; i--) {
+			if (ring_idx[i - 1] == idx) {
+				left |= RTE_BIT64(i - 1);
+				k--;
+			}
+		}
+	}
+
+	if (unsent != NULL) {
+		for (; left != 0; left &= left - 1)
+			unsent[(*nb_unsent)++] = obj_table[rte_bsf64(left)];
+	}
+
+	return nb;
+}
+
+unsigned int
+rte_ring_enqueue_burst_multi(struct rte_ring * const rings[],
+		void * const *obj_table, const uint16_t ring_idx[],
+		unsigned int n, void **unsent)
+{
+	unsigned int i, k, nb, nb_unsent;
+
+	nb = 0;
+	nb_unsent = 0;
+	for (i = 0; i != n; i += k) {
+		k = RTE_MIN(n - i, (unsigned int)RTE_RING_MULTI_BURST_MAX);
+		nb += ring_enqueue_burst_multi_chunk(rings, obj_table + i,
+				ring_idx + i, k, unsent, &nb_unsent);
+	}
+
+	return nb;
+}
+
 /* dump the status of the ring on the console */
 void
 rte_ring_dump(FILE *f, const struct rte_ring *r)
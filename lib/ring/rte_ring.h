@@ -107,6 +107,8 @@ ssize_t rte_ring_get_memsize(unsigned int count);
  *        is "multi-consumer HTS mode".
  *     If none of these flags is set, then default "multi-consumer"
  *     behavior is selected.
+ *   RING_F_MP_ORD_ENQ is not supported, as the size of the elements is
+ *   needed to locate the sequence values which follow them.
  * @return
  *   0 on success, or a negative value on error.
  */
@@ -146,6 +148,9 @@ int rte_ring_init(struct rte_ring *r, const char *name, unsigned int count,
  *      - RING_F_MP_HTS_ENQ: If this flag is set, the default behavior when
  *        using ``rte_ring_enqueue()`` or ``rte_ring_enqueue_bulk()``
  *        is "multi-producer HTS mode".
+ *      - RING_F_MP_ORD_ENQ: If this flag is set, the default behavior when
+ *        using ``rte_ring_enqueue()`` or ``rte_ring_enqueue_bulk()``
+ *        is "multi-producer ordered mode", see rte_ring_ord.h.
  *     If none of these flags is set, then default "multi-producer"
  *     behavior is selected.
  *   - One of mutually exclusive flags that define consumer behavior:
@@ -802,6 +807,72 @@ rte_ring_dequeue_burst(struct rte_ring *r, void **obj_table,
 			n, available);
 }
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Dequeue multiple objects from a ring up to a maximum number, waiting
+ * for objects to be enqueued when the ring is empty.
+ *
+ * See rte_ring_dequeue_burst_elem_wait().
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects) that will be filled.
+ * @param n
+ *   The number of objects to dequeue from the ring to the obj_table.
+ * @param available
+ *   If non-NULL, returns the number of remaining ring entries after the
+ *   dequeue has finished.
+ * @param timeout
+ *   The maximum time to wait for objects, in TSC cycles.
+ *   With 0, the function doesn't wait.
+ * @return
+ *   - Number of objects dequeued, 0 if the ring stayed empty until the
+ *     timeout expired.
+ */
+__rte_experimental
+unsigned int
+rte_ring_dequeue_burst_wait(struct rte_ring *r, void **obj_table,
+		unsigned int n, unsigned int *available, uint64_t timeout);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Enqueue a burst of objects on several rings, each object going to the
+ * ring selected by its index.
+ *
+ * The objects are grouped by destination ring, in chunks of
+ * RTE_RING_MULTI_BURST_MAX objects, and each group is enqueued with a
+ * single call to rte_ring_enqueue_burst(), hence a single head move on
+ * its ring. The rings of the next groups are prefetched while a group
+ * is gathered. The objects enqueued on a ring keep their relative order.
+ *
+ * @param rings
+ *   A table of pointers to the destination rings. Their default enqueue
+ *   mode is used.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param ring_idx
+ *   A table of n indexes in the rings table, the destination of each
+ *   object.
+ * @param n
+ *   The number of objects to add in the rings from the obj_table.
+ * @param unsent
+ *   If non-NULL, a table of at least n void * pointers filled with the
+ *   objects not enqueued because their ring was full, in the obj_table
+ *   order.
+ * @return
+ *   - Number of objects enqueued, the remaining objects are in unsent.
+ */
+__rte_experimental
+unsigned int
+rte_ring_enqueue_burst_multi(struct rte_ring * const rings[],
+		void * const *obj_table, const uint16_t ring_idx[],
+		unsigned int n, void **unsent);
+
 #ifdef __cplusplus
 }
 #endif
@@ -52,12 +52,19 @@ enum rte_ring_queue_behavior {
 #define RTE_RING_NAMESIZE (RTE_MEMZONE_NAMESIZE - \
 			   sizeof(RTE_RING_MZ_PREFIX) + 1)
 
+/**
+ * Number of objects grouped by destination at once by
+ * rte_ring_enqueue_burst_multi().
+ */
+#define RTE_RING_MULTI_BURST_MAX 64
+
 /** prod/cons sync types */
 enum rte_ring_sync_type {
 	RTE_RING_SYNC_MT,     /**< multi-thread safe (default mode) */
 	RTE_RING_SYNC_ST,     /**< single thread only */
 	RTE_RING_SYNC_MT_RTS, /**< multi-thread relaxed tail sync */
 	RTE_RING_SYNC_MT_HTS, /**< multi-thread head/tail sync */
+	RTE_RING_SYNC_MT_ORD, /**< multi-thread ordered completion (prod only) */
 };
 
 /**
@@ -107,6 +114,14 @@ struct rte_ring_hts_headtail {
 	enum rte_ring_sync_type sync_type;  /**< sync type of prod/cons */
 };
 
+struct rte_ring_ord_headtail {
+	volatile uint32_t head;      /**< producer head. */
+	volatile uint32_t tail;      /**< producer tail. */
+	enum rte_ring_sync_type sync_type;  /**< sync type of prod */
+	/** per slot position + 1 of the last finished enqueue */
+	uint32_t *seq;
+};
+
 /**
  * An RTE ring structure.
  *
@@ -135,6 +150,7 @@ struct rte_ring {
 		struct rte_ring_headtail prod;
 		struct rte_ring_hts_headtail hts_prod;
 		struct rte_ring_rts_headtail rts_prod;
+		struct rte_ring_ord_headtail ord_prod;
 	}  __rte_cache_aligned;
 
 	char pad1 __rte_cache_aligned; /**< empty cache line */
@@ -169,6 +185,14 @@ struct rte_ring {
 #define RING_F_MP_HTS_ENQ 0x0020 /**< The default enqueue is "MP HTS". */
 #define RING_F_MC_HTS_DEQ 0x0040 /**< The default dequeue is "MC HTS". */
 
+/**
+ * The default enqueue is "MP ordered": producers may finish their
+ * enqueues in any order, consumers only see the objects up to the first
+ * unfinished one. Only supported by rings created with rte_ring_create()
+ * or rte_ring_create_elem(). See rte_ring_ord.h.
+ */
+#define RING_F_MP_ORD_ENQ 0x0080
+
 #ifdef __cplusplus
 }
 #endif
@@ -78,6 +78,9 @@ ssize_t rte_ring_get_memsize_elem(unsigned int esize, unsigned int count);
  *      - RING_F_MP_HTS_ENQ: If this flag is set, the default behavior when
  *        using ``rte_ring_enqueue()`` or ``rte_ring_enqueue_bulk()``
  *        is "multi-producer HTS mode".
+ *      - RING_F_MP_ORD_ENQ: If this flag is set, the default behavior when
+ *        using ``rte_ring_enqueue()`` or ``rte_ring_enqueue_bulk()``
+ *        is "multi-producer ordered mode", see rte_ring_ord.h.
  *     If none of these flags is set, then default "multi-producer"
  *     behavior is selected.
  *   - One of mutually exclusive flags that define consumer behavior:
@@ -166,6 +169,7 @@ rte_ring_sp_enqueue_bulk_elem(struct rte_ring *r, const void *obj_table,
 }
 
 #include <rte_ring_hts.h>
+#include <rte_ring_ord.h>
 #include <rte_ring_rts.h>
 
 /**
@@ -208,6 +212,9 @@ rte_ring_enqueue_bulk_elem(struct rte_ring *r, const void *obj_table,
 	case RTE_RING_SYNC_MT_HTS:
 		return rte_ring_mp_hts_enqueue_bulk_elem(r, obj_table, esize, n,
 			free_space);
+	case RTE_RING_SYNC_MT_ORD:
+		return __rte_ring_do_ord_enqueue_elem(r, obj_table, esize, n,
+			RTE_RING_QUEUE_FIXED, free_space);
 	}
 
 	/* valid ring should never reach this point */
@@ -390,6 +397,9 @@ rte_ring_dequeue_bulk_elem(struct rte_ring *r, void *obj_table,
 	case RTE_RING_SYNC_MT_HTS:
 		return rte_ring_mc_hts_dequeue_bulk_elem(r, obj_table, esize,
 			n, available);
+	case RTE_RING_SYNC_MT_ORD:
+		/* ordered mode is for producers only */
+		break;
 	}
 
 	/* valid ring should never reach this point */
@@ -576,6 +586,9 @@ rte_ring_enqueue_burst_elem(struct rte_ring *r, const void *obj_table,
 	case RTE_RING_SYNC_MT_HTS:
 		return rte_ring_mp_hts_enqueue_burst_elem(r, obj_table, esize,
 			n, free_space);
+	case RTE_RING_SYNC_MT_ORD:
+		return __rte_ring_do_ord_enqueue_elem(r, obj_table, esize, n,
+			RTE_RING_QUEUE_VARIABLE, free_space);
 	}
 
 	/* valid ring should never reach this point */
@@ -686,6 +699,9 @@ rte_ring_dequeue_burst_elem(struct rte_ring *r, void *obj_table,
 	case RTE_RING_SYNC_MT_HTS:
 		return rte_ring_mc_hts_dequeue_burst_elem(r, obj_table, esize,
 			n, available);
+	case RTE_RING_SYNC_MT_ORD:
+		/* ordered mode is for producers only */
+		break;
 	}
 
 	/* valid ring should never reach this point */
@@ -695,6 +711,46 @@ rte_ring_dequeue_burst_elem(struct rte_ring *r, void *obj_table,
 	return 0;
 }
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Dequeue multiple objects from a ring up to a maximum number, waiting
+ * for objects to be enqueued when the ring is empty.
+ *
+ * This function calls rte_ring_dequeue_burst_elem() and, while no object
+ * is dequeued, waits on the producer tail of the ring with
+ * rte_power_monitor() until another thread enqueues objects or the
+ * timeout expires. When the monitor is not supported by the CPU or the
+ * calling thread, it polls the ring with rte_pause() instead.
+ * It returns as soon as at least one object is dequeued.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of objects that will be filled.
+ * @param esize
+ *   The size of ring element, in bytes. It must be a multiple of 4.
+ *   This must be the same value used while creating the ring. Otherwise
+ *   the results are undefined.
+ * @param n
+ *   The number of objects to dequeue from the ring to the obj_table.
+ * @param available
+ *   If non-NULL, returns the number of remaining ring entries after the
+ *   dequeue has finished.
+ * @param timeout
+ *   The maximum time to wait for objects, in TSC cycles.
+ *   With 0, the function doesn't wait.
+ * @return
+ *   - Number of objects dequeued, 0 if the ring stayed empty until the
+ *     timeout expired.
+ */
+__rte_experimental
+unsigned int
+rte_ring_dequeue_burst_elem_wait(struct rte_ring *r, void *obj_table,
+		unsigned int esize, unsigned int n, unsigned int *available,
+		uint64_t timeout);
+
 #include <rte_ring_peek.h>
 #include <rte_ring_peek_zc.h>
 
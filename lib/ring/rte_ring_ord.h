@@ -0,0 +1,304 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 agent <agent@local>
+ */
+
+#ifndef _RTE_RING_ORD_H_
+#define _RTE_RING_ORD_H_
+
+/**
+ * @file rte_ring_ord.h
+ * It is not recommended to include this file directly.
+ * Please include <rte_ring.h> instead.
+ *
+ * Contains functions for the ordered producer ring mode (RING_F_MP_ORD_ENQ).
+ * In that mode an enqueue is split into two phases:
+ * - enqueue start: reserve slots, in order, like the MP enqueue does,
+ * - enqueue finish: copy the objects in the reserved slots.
+ * Several producers may fill their slots concurrently and finish in any
+ * order, the consumers only see the objects up to the first slot not
+ * finished yet. The objects are then dequeued in the reservation order,
+ * whatever the finish order was.
+ *
+ * A typical use is a pipeline of workers which must keep the packet
+ * order: the distributing stage reserves the output slots of a burst,
+ * the worker processing it finishes the enqueue once done.
+ *
+ * As an example:
+ * // reserve 32 slots for a burst of packets:
+ * n = rte_ring_ord_enqueue_bulk_start(ring, 32, &pos, NULL);
+ * if (n != 0) {
+ *    // hand the burst and pos to a worker, which finally calls:
+ *    rte_ring_ord_enqueue_finish(ring, pos, pkts, n);
+ * }
+ *
+ * Every reserved slot must be finished eventually: the consumers are
+ * stalled at the first unfinished slot. The slots of a reservation may be
+ * finished in several parts, the position of a part being the reservation
+ * position plus the index of its first slot.
+ * Only the producer side is ordered, any consumer sync mode may be used.
+ * Such a ring must be created with rte_ring_create() or
+ * rte_ring_create_elem(), as its memory includes a sequence value per
+ * slot.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <rte_compat.h>
+#include <rte_ring_ord_elem_pvt.h>
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Reserve slots on the ordered ring (multi-producers safe).
+ * No object is put in the ring by this function, the enqueue has to be
+ * completed with rte_ring_ord_enqueue_finish_elem() or
+ * rte_ring_ord_enqueue_finish().
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param n
+ *   The number of slots to reserve in the ring.
+ * @param pos
+ *   Returns the position of the first reserved slot.
+ * @param free_space
+ *   if non-NULL, returns the amount of space in the ring after the
+ *   reservation.
+ * @return
+ *   The number of reserved slots, either 0 or n
+ */
+__rte_experimental
+static __rte_always_inline unsigned int
+rte_ring_ord_enqueue_bulk_start(struct rte_ring *r, unsigned int n,
+	uint32_t *pos, unsigned int *free_space)
+{
+	uint32_t free;
+
+	n = __rte_ring_ord_move_prod_head(r, n, RTE_RING_QUEUE_FIXED, pos,
+			&free);
+	if (free_space != NULL)
+		*free_space = free - n;
+	return n;
+}
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Reserve up to n slots on the ordered ring (multi-producers safe).
+ * No object is put in the ring by this function, the enqueue has to be
+ * completed with rte_ring_ord_enqueue_finish_elem() or
+ * rte_ring_ord_enqueue_finish().
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param n
+ *   The maximum number of slots to reserve in the ring.
+ * @param pos
+ *   Returns the position of the first reserved slot.
+ * @param free_space
+ *   if non-NULL, returns the amount of space in the ring after the
+ *   reservation.
+ * @return
+ *   The actual number of reserved slots.
+ */
+__rte_experimental
+static __rte_always_inline unsigned int
+rte_ring_ord_enqueue_burst_start(struct rte_ring *r, unsigned int n,
+	uint32_t *pos, unsigned int *free_space)
+{
+	uint32_t free;
+
+	n = __rte_ring_ord_move_prod_head(r, n, RTE_RING_QUEUE_VARIABLE, pos,
+			&free);
+	if (free_space != NULL)
+		*free_space = free - n;
+	return n;
+}
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Complete an enqueue on the ordered ring: copy the objects in slots
+ * reserved with rte_ring_ord_enqueue_bulk_start() or
+ * rte_ring_ord_enqueue_burst_start() and make them visible to the
+ * consumers once all the slots before them are finished too.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param pos
+ *   The position of the first slot to fill.
+ * @param obj_table
+ *   A pointer to a table of objects.
+ * @param esize
+ *   The size of ring element, in bytes. It must be a multiple of 4.
+ *   This must be the same value used while creating the ring. Otherwise
+ *   the results are undefined.
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ */
+__rte_experimental
+static __rte_always_inline void
+rte_ring_ord_enqueue_finish_elem(struct rte_ring *r, uint32_t pos,
+	const void *obj_table, unsigned int esize, unsigned int n)
+{
+	if (n != 0) {
+		__rte_ring_enqueue_elems(r, pos, obj_table, esize, n);
+		__rte_ring_ord_update_tail(r, pos, n);
+	}
+}
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Complete an enqueue on the ordered ring: copy the objects in slots
+ * reserved with rte_ring_ord_enqueue_bulk_start() or
+ * rte_ring_ord_enqueue_burst_start() and make them visible to the
+ * consumers once all the slots before them are finished too.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param pos
+ *   The position of the first slot to fill.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ */
+__rte_experimental
+static __rte_always_inline void
+rte_ring_ord_enqueue_finish(struct rte_ring *r, uint32_t pos,
+	void * const *obj_table, unsigned int n)
+{
+	if (n != 0) {
+		__rte_ring_enqueue_elems(r, pos, obj_table, sizeof(uintptr_t),
+				n);
+		__rte_ring_ord_update_tail(r, pos, n);
+	}
+}
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Enqueue several objects on the ordered ring (multi-producers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of objects.
+ * @param esize
+ *   The size of ring element, in bytes. It must be a multiple of 4.
+ *   This must be the same value used while creating the ring. Otherwise
+ *   the results are undefined.
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @param free_space
+ *   if non-NULL, returns the amount of space in the ring after the
+ *   enqueue operation has finished.
+ * @return
+ *   The number of objects enqueued, either 0 or n
+ */
+__rte_experimental
+static __rte_always_inline unsigned int
+rte_ring_mp_ord_enqueue_bulk_elem(struct rte_ring *r, const void *obj_table,
+	unsigned int esize, unsigned int n, unsigned int *free_space)
+{
+	return __rte_ring_do_ord_enqueue_elem(r, obj_table, esize, n,
+			RTE_RING_QUEUE_FIXED, free_space);
+}
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Enqueue several objects on the ordered ring (multi-producers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of objects.
+ * @param esize
+ *   The size of ring element, in bytes. It must be a multiple of 4.
+ *   This must be the same value used while creating the ring. Otherwise
+ *   the results are undefined.
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @param free_space
+ *   if non-NULL, returns the amount of space in the ring after the
+ *   enqueue operation has finished.
+ * @return
+ *   - n: Actual number of objects enqueued.
+ */
+__rte_experimental
+static __rte_always_inline unsigned int
+rte_ring_mp_ord_enqueue_burst_elem(struct rte_ring *r, const void *obj_table,
+	unsigned int esize, unsigned int n, unsigned int *free_space)
+{
+	return __rte_ring_do_ord_enqueue_elem(r, obj_table, esize, n,
+			RTE_RING_QUEUE_VARIABLE, free_space);
+}
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Enqueue several objects on the ordered ring (multi-producers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @param free_space
+ *   if non-NULL, returns the amount of space in the ring after the
+ *   enqueue operation has finished.
+ * @return
+ *   The number of objects enqueued, either 0 or n
+ */
+__rte_experimental
+static __rte_always_inline unsigned int
+rte_ring_mp_ord_enqueue_bulk(struct rte_ring *r, void * const *obj_table,
+	unsigned int n, unsigned int *free_space)
+{
+	return __rte_ring_do_ord_enqueue_elem(r, obj_table, sizeof(uintptr_t),
+			n, RTE_RING_QUEUE_FIXED, free_space);
+}
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Enqueue several objects on the ordered ring (multi-producers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @param free_space
+ *   if non-NULL, returns the amount of space in the ring after the
+ *   enqueue operation has finished.
+ * @return
+ *   - n: Actual number of objects enqueued.
+ */
+__rte_experimental
+static __rte_always_inline unsigned int
+rte_ring_mp_ord_enqueue_burst(struct rte_ring *r, void * const *obj_table,
+	unsigned int n, unsigned int *free_space)
+{
+	return __rte_ring_do_ord_enqueue_elem(r, obj_table, sizeof(uintptr_t),
+			n, RTE_RING_QUEUE_VARIABLE, free_space);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_RING_ORD_H_ */
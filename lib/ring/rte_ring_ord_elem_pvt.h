@@ -0,0 +1,118 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 agent <agent@local>
+ */
+
+#ifndef _RTE_RING_ORD_ELEM_PVT_H_
+#define _RTE_RING_ORD_ELEM_PVT_H_
+
+/**
+ * @file rte_ring_ord_elem_pvt.h
+ * It is not recommended to include this file directly,
+ * include <rte_ring.h> instead.
+ * Contains internal helper functions for ordered producer ring mode.
+ * For more information please refer to <rte_ring_ord.h>.
+ */
+
+/**
+ * @internal This function reserves the slots of an ordered enqueue.
+ * The slots are reserved in order like for the MP ring.
+ */
+static __rte_always_inline unsigned int
+__rte_ring_ord_move_prod_head(struct rte_ring *r, unsigned int num,
+	enum rte_ring_queue_behavior behavior, uint32_t *old_head,
+	uint32_t *free_entries)
+{
+	uint32_t new_head;
+
+	return __rte_ring_move_prod_head(r, 0, num, behavior, old_head,
+			&new_head, free_entries);
+}
+
+/**
+ * @internal Mark slots as finished and move the tail over all the
+ * finished slots following it.
+ * A slot at position pos is finished when its sequence value is pos + 1,
+ * the unfinished ones keep the value of the previous lap.
+ */
+static __rte_always_inline void
+__rte_ring_ord_update_tail(struct rte_ring *r, uint32_t pos, uint32_t num)
+{
+	struct rte_ring_ord_headtail *ht = &r->ord_prod;
+	uint32_t *seq = ht->seq;
+	const uint32_t mask = r->mask;
+	uint32_t i, tail, next;
+
+	/* objects written before their slots are marked as finished */
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	for (i = 0; i != num; i++)
+		__atomic_store_n(&seq[(pos + i) & mask], pos + i + 1,
+				__ATOMIC_RELAXED);
+
+	/*
+	 * Order the marks above with the loads below: of two producers
+	 * finishing concurrently, at least one sees the slots marked by
+	 * the other one and moves the tail over them.
+	 */
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+	tail = __atomic_load_n(&ht->tail, __ATOMIC_RELAXED);
+	do {
+		next = tail;
+		while (__atomic_load_n(&seq[next & mask], __ATOMIC_RELAXED) ==
+				next + 1)
+			next++;
+
+		/* first slot unfinished, its producer will move the tail */
+		if (next == tail)
+			return;
+
+		/* synchronize with the producers of the finished slots */
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+		/* on failure, tail is updated and the slots scanned again */
+	} while (__atomic_compare_exchange_n(&ht->tail, &tail, next, 0,
+			__ATOMIC_RELEASE, __ATOMIC_RELAXED) == 0);
+}
+
+/**
+ * @internal Enqueue several objects on the ordered ring.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of objects.
+ * @param esize
+ *   The size of ring element, in bytes. It must be a multiple of 4.
+ *   This must be the same value used while creating the ring. Otherwise
+ *   the results are undefined.
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @param behavior
+ *   RTE_RING_QUEUE_FIXED:    Enqueue a fixed number of items from a ring
+ *   RTE_RING_QUEUE_VARIABLE: Enqueue as many items as possible from ring
+ * @param free_space
+ *   returns the amount of space after the enqueue operation has finished
+ * @return
+ *   Actual number of objects enqueued.
+ *   If behavior == RTE_RING_QUEUE_FIXED, this will be 0 or n only.
+ */
+static __rte_always_inline unsigned int
+__rte_ring_do_ord_enqueue_elem(struct rte_ring *r, const void *obj_table,
+	uint32_t esize, uint32_t n, enum rte_ring_queue_behavior behavior,
+	uint32_t *free_space)
+{
+	uint32_t free, head;
+
+	n = __rte_ring_ord_move_prod_head(r, n, behavior, &head, &free);
+
+	if (n != 0) {
+		__rte_ring_enqueue_elems(r, head, obj_table, esize, n);
+		__rte_ring_ord_update_tail(r, head, n);
+	}
+
+	if (free_space != NULL)
+		*free_space = free - n;
+	return n;
+}
+
+#endif /* _RTE_RING_ORD_ELEM_PVT_H_ */
@@ -0,0 +1,518 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 agent <agent@local>
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_byteorder.h>
+#include <rte_prefetch.h>
+#include <rte_malloc.h>
+#include <rte_fib.h>
+#include <rte_fib6.h>
+#include <rte_rib.h>
+#include <rte_rib6.h>
+
+#include "rte_swx_table_lpm.h"
+
+#define CHECK(condition, err_code)                                             \
+do {                                                                           \
+	if (!(condition))                                                      \
+		return -(err_code);                                            \
+} while (0)
+
+#define KEY_SIZE_IPV4 4
+#define KEY_SIZE_IPV6 RTE_FIB6_IPV6_ADDR_SIZE
+
+/* Default number of tbl8 groups, with IPv6 routes typically needing several
+ * tbl8 groups each.
+ */
+#define N_TBL8_IPV4(n_keys) RTE_MIN((n_keys), 1U << 16)
+#define N_TBL8_IPV6(n_keys) RTE_MIN((n_keys) * 4, 1U << 18)
+
+/* The FIB next hop is the table entry ID plus one, with the zero value
+ * reserved for the lookup miss.
+ */
+#define NH_MISS 0
+
+struct table {
+	/* Input parameters */
+	struct rte_swx_table_params params;
+
+	/* Internal. */
+	struct rte_fib *fib;
+	struct rte_fib6 *fib6;
+	uint32_t data_size;
+	uint32_t data_size_shl;
+	uint32_t entry_stack_tos;
+
+	/* Memory arrays. */
+	uint32_t *entry_stack;
+	uint8_t *data;
+};
+
+struct route {
+	uint32_t ip;
+	uint8_t ip6[KEY_SIZE_IPV6];
+	uint8_t depth;
+};
+
+static inline uint64_t *
+table_entry_data(struct table *t, uint32_t entry_id)
+{
+	return (uint64_t *)&t->data[(uint64_t)entry_id << t->data_size_shl];
+}
+
+static int
+args_parse(const char *args, uint32_t *n_tbl8)
+{
+	char c;
+
+	if (!args || !args[0])
+		return 0;
+
+	CHECK(sscanf(args, "num_tbl8=%u%c", n_tbl8, &c) == 1, EINVAL);
+	CHECK(*n_tbl8, EINVAL);
+
+	return 0;
+}
+
+static int
+mask_to_depth(uint8_t *mask, uint32_t n_bytes, uint8_t *depth)
+{
+	uint32_t n_bits = 0, i;
+	int prefix_end = 0;
+
+	for (i = 0; i < n_bytes; i++) {
+		uint8_t m = mask ? mask[i] : 0xFF;
+		uint32_t j;
+
+		for (j = 0; j < 8; j++) {
+			if (m & (0x80 >> j)) {
+				CHECK(!prefix_end, EINVAL);
+				n_bits++;
+			} else {
+				prefix_end = 1;
+			}
+		}
+	}
+
+	*depth = (uint8_t)n_bits;
+	return 0;
+}
+
+static int
+route_get(struct table *t, struct rte_swx_table_entry *entry, struct route *r)
+{
+	uint32_t i;
+	int status;
+
+	status = mask_to_depth(entry->key_mask, t->params.key_size, &r->depth);
+	if (status)
+		return status;
+
+	if (t->params.key_size == KEY_SIZE_IPV4) {
+		uint32_t ip = rte_be_to_cpu_32(*(unaligned_uint32_t *)entry->key);
+
+		r->ip = ip & rte_rib_depth_to_mask(r->depth);
+		return 0;
+	}
+
+	for (i = 0; i < KEY_SIZE_IPV6; i++) {
+		uint32_t n_bits = RTE_MIN(r->depth - RTE_MIN(r->depth, i * 8), 8U);
+		uint8_t m = (uint8_t)(0xFF00 >> n_bits);
+
+		r->ip6[i] = entry->key[i] & m;
+	}
+
+	return 0;
+}
+
+static int
+route_find(struct table *t, struct route *r, uint32_t *entry_id)
+{
+	uint64_t nh;
+
+	if (t->fib) {
+		struct rte_rib_node *node;
+
+		node = rte_rib_lookup_exact(rte_fib_get_rib(t->fib),
+					    r->ip,
+					    r->depth);
+		if (!node || rte_rib_get_nh(node, &nh))
+			return 0;
+	} else {
+		struct rte_rib6_node *node;
+
+		node = rte_rib6_lookup_exact(rte_fib6_get_rib(t->fib6),
+					     r->ip6,
+					     r->depth);
+		if (!node || rte_rib6_get_nh(node, &nh))
+			return 0;
+	}
+
+	if (nh == NH_MISS)
+		return 0;
+
+	*entry_id = (uint32_t)(nh - 1);
+	return 1;
+}
+
+static inline void
+entry_data_update(struct table *t,
+		  struct rte_swx_table_entry *input,
+		  uint32_t entry_id)
+{
+	uint64_t *data = table_entry_data(t, entry_id);
+
+	data[0] = input->action_id;
+	if (t->params.action_data_size && input->action_data)
+		memcpy(&data[1],
+		       input->action_data,
+		       t->params.action_data_size);
+}
+
+static void
+table_free(void *table)
+{
+	struct table *t = table;
+
+	if (!t)
+		return;
+
+	rte_fib_free(t->fib);
+	rte_fib6_free(t->fib6);
+	rte_free(t);
+}
+
+static int
+table_add(void *table, struct rte_swx_table_entry *entry)
+{
+	struct table *t = table;
+	struct route r;
+	uint32_t entry_id;
+	int status;
+
+	CHECK(t, EINVAL);
+	CHECK(entry, EINVAL);
+	CHECK(entry->key, EINVAL);
+
+	status = route_get(t, entry, &r);
+	if (status)
+		return status;
+
+	/* Route is present in the table: update its data in place. */
+	if (route_find(t, &r, &entry_id)) {
+		entry_data_update(t, entry, entry_id);
+		return 0;
+	}
+
+	/* Route is not present in the table: allocate new entry & install. The
+	 * entry data is written before the route is made visible to lookup.
+	 */
+	CHECK(t->entry_stack_tos, ENOSPC);
+	entry_id = t->entry_stack[t->entry_stack_tos - 1];
+	entry_data_update(t, entry, entry_id);
+
+	if (t->fib)
+		status = rte_fib_add(t->fib, r.ip, r.depth, entry_id + 1);
+	else
+		status = rte_fib6_add(t->fib6, r.ip6, r.depth, entry_id + 1);
+	if (status)
+		return status;
+
+	t->entry_stack_tos--;
+	return 0;
+}
+
+static int
+table_del(void *table, struct rte_swx_table_entry *entry)
+{
+	struct table *t = table;
+	struct route r;
+	uint32_t entry_id;
+	int status;
+
+	CHECK(t, EINVAL);
+	CHECK(entry, EINVAL);
+	CHECK(entry->key, EINVAL);
+
+	status = route_get(t, entry, &r);
+	if (status)
+		return status;
+
+	/* Route is not present in the table. */
+	if (!route_find(t, &r, &entry_id))
+		return 0;
+
+	if (t->fib)
+		status = rte_fib_delete(t->fib, r.ip, r.depth);
+	else
+		status = rte_fib6_delete(t->fib6, r.ip6, r.depth);
+	if (status)
+		return status;
+
+	/* Entry free. */
+	t->entry_stack[t->entry_stack_tos++] = entry_id;
+	return 0;
+}
+
+struct mailbox {
+	uint64_t nh;
+	int state;
+};
+
+static uint64_t
+table_mailbox_size_get(void)
+{
+	return sizeof(struct mailbox);
+}
+
+/*
+ * The lookup is split into two steps in order to hide the latency of the read
+ * of the entry data, which is typically not in the CPU cache for large tables:
+ * the FIB lookup and entry data prefetch in the first step, followed by the
+ * lookup result retrieval in the second step.
+ */
+static int
+table_lookup(void *table,
+	     void *mailbox,
+	     uint8_t **key,
+	     uint64_t *action_id,
+	     uint8_t **action_data,
+	     int *hit)
+{
+	struct table *t = table;
+	struct mailbox *m = mailbox;
+
+	switch (m->state) {
+	case 0: {
+		uint8_t *input_key = &(*key)[t->params.key_offset];
+		uint64_t nh;
+
+		if (t->fib) {
+			uint32_t ip;
+
+			ip = rte_be_to_cpu_32(*(unaligned_uint32_t *)input_key);
+			rte_fib_lookup_bulk(t->fib, &ip, &nh, 1);
+		} else {
+			rte_fib6_lookup_bulk(t->fib6,
+				(uint8_t (*)[KEY_SIZE_IPV6])input_key,
+				&nh,
+				1);
+		}
+
+		if (nh != NH_MISS)
+			rte_prefetch0(table_entry_data(t, (uint32_t)(nh - 1)));
+
+		m->nh = nh;
+		m->state++;
+		return 0;
+	}
+
+	case 1: {
+		uint64_t nh = m->nh;
+		uint64_t *data;
+
+		m->state = 0;
+
+		if (nh == NH_MISS) {
+			*hit = 0;
+			return 1;
+		}
+
+		data = table_entry_data(t, (uint32_t)(nh - 1));
+		*action_id = data[0];
+		*action_data = (uint8_t *)&data[1];
+		*hit = 1;
+		return 1;
+	}
+
+	default:
+		return 0;
+	}
+}
+
+#define CL RTE_CACHE_LINE_ROUNDUP
+
+/* Both the IPv4 and the IPv6 FIB consist of a tbl24 plus the tbl8 groups, all
+ * with 4-byte next hops. The RIB nodes are not accounted for.
+ */
+static uint64_t
+fib_footprint(uint32_t n_tbl8)
+{
+	return (1ULL << 24) * sizeof(uint32_t) +
+	       (uint64_t)n_tbl8 * 256 * sizeof(uint32_t);
+}
+
+static int
+__table_create(struct table **table,
+	       uint64_t *memory_footprint,
+	       struct rte_swx_table_params *params,
+	       const char *args,
+	       int numa_node)
+{
+	struct table *t;
+	uint8_t *memory;
+	size_t table_meta_sz, entry_stack_sz, data_sz, total_size;
+	size_t entry_stack_offset, data_offset;
+	uint32_t data_size, n_tbl8, i;
+	char name[64];
+	int status;
+
+	/* Check input arguments. */
+	CHECK(params, EINVAL);
+	CHECK((params->key_size == KEY_SIZE_IPV4) ||
+	      (params->key_size == KEY_SIZE_IPV6), EINVAL);
+	CHECK(params->n_keys_max, EINVAL);
+	CHECK(params->n_keys_max < INT32_MAX, EINVAL);
+
+	if (params->key_mask0)
+		for (i = 0; i < params->key_size; i++)
+			CHECK(params->key_mask0[i] == 0xFF, EINVAL);
+
+	n_tbl8 = (params->key_size == KEY_SIZE_IPV4) ?
+		N_TBL8_IPV4(params->n_keys_max) :
+		N_TBL8_IPV6(params->n_keys_max);
+	status = args_parse(args, &n_tbl8);
+	if (status)
+		return status;
+
+	/* Memory allocation. */
+	data_size = rte_align64pow2(params->action_data_size + 8);
+
+	table_meta_sz = CL(sizeof(struct table));
+	entry_stack_sz = CL(params->n_keys_max * sizeof(uint32_t));
+	data_sz = CL((size_t)params->n_keys_max * data_size);
+	total_size = table_meta_sz + entry_stack_sz + data_sz;
+
+	entry_stack_offset = table_meta_sz;
+	data_offset = entry_stack_offset + entry_stack_sz;
+
+	if (!table) {
+		if (memory_footprint)
+			*memory_footprint = total_size +
+				fib_footprint(n_tbl8);
+		return 0;
+	}
+
+	memory = rte_zmalloc_socket(NULL,
+				    total_size,
+				    RTE_CACHE_LINE_SIZE,
+				    numa_node);
+	CHECK(memory, ENOMEM);
+
+	/* Initialization. */
+	t = (struct table *)memory;
+	memcpy(&t->params, params, sizeof(*params));
+	t->params.key_mask0 = NULL;
+
+	t->data_size = data_size;
+	t->data_size_shl = __builtin_ctzl(data_size);
+
+	t->entry_stack = (uint32_t *)&memory[entry_stack_offset];
+	t->data = &memory[data_offset];
+
+	for (i = 0; i < t->params.n_keys_max; i++)
+		t->entry_stack[i] = t->params.n_keys_max - 1 - i;
+	t->entry_stack_tos = t->params.n_keys_max;
+
+	/* The table memory address is unique amongst the existing tables. */
+	snprintf(name, sizeof(name), "swx_lpm_%p", (void *)t);
+
+	if (params->key_size == KEY_SIZE_IPV4) {
+		struct rte_fib_conf cfg = {
+			.type = RTE_FIB_DIR24_8,
+			.default_nh = NH_MISS,
+			.max_routes = params->n_keys_max,
+			.dir24_8 = {
+				.nh_sz = RTE_FIB_DIR24_8_4B,
+				.num_tbl8 = n_tbl8,
+			},
+		};
+
+		t->fib = rte_fib_create(name, numa_node, &cfg);
+		if (!t->fib) {
+			table_free(t);
+			return -ENOMEM;
+		}
+	} else {
+		struct rte_fib6_conf cfg = {
+			.type = RTE_FIB6_TRIE,
+			.default_nh = NH_MISS,
+			.max_routes = params->n_keys_max,
+			.trie = {
+				.nh_sz = RTE_FIB6_TRIE_4B,
+				.num_tbl8 = n_tbl8,
+			},
+		};
+
+		t->fib6 = rte_fib6_create(name, numa_node, &cfg);
+		if (!t->fib6) {
+			table_free(t);
+			return -ENOMEM;
+		}
+	}
+
+	*table = t;
+	return 0;
+}
+
+static void *
+table_create(struct rte_swx_table_params *params,
+	     struct rte_swx_table_entry_list *entries,
+	     const char *args,
+	     int numa_node)
+{
+	struct table *t;
+	struct rte_swx_table_entry *entry;
+	int status;
+
+	/* Table create. */
+	status = __table_create(&t, NULL, params, args, numa_node);
+	if (status)
+		return NULL;
+
+	/* Table add entries. */
+	if (!entries)
+		return t;
+
+	TAILQ_FOREACH(entry, entries, node) {
+		int status;
+
+		status = table_add(t, entry);
+		if (status) {
+			table_free(t);
+			return NULL;
+		}
+	}
+
+	return t;
+}
+
+static uint64_t
+table_footprint(struct rte_swx_table_params *params,
+		struct rte_swx_table_entry_list *entries __rte_unused,
+		const char *args)
+{
+	uint64_t memory_footprint;
+	int status;
+
+	status = __table_create(NULL, &memory_footprint, params, args, 0);
+	if (status)
+		return 0;
+
+	return memory_footprint;
+}
+
+struct rte_swx_table_ops rte_swx_table_lpm_ops = {
+	.footprint_get = table_footprint,
+	.mailbox_size_get = table_mailbox_size_get,
+	.create = table_create,
+	.add = table_add,
+	.del = table_del,
+	.lkp = table_lookup,
+	.free = table_free,
+};
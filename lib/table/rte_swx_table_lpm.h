@@ -0,0 +1,35 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 agent <agent@local>
+ */
+#ifndef __INCLUDE_RTE_SWX_TABLE_LPM_H__
+#define __INCLUDE_RTE_SWX_TABLE_LPM_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * RTE SWX Longest Prefix Match Table
+ *
+ * The table key is an IPv4 (4 bytes) or IPv6 (16 bytes) address stored in
+ * network byte order, with the prefix length of each table entry given by its
+ * key mask, which must be a contiguous prefix mask. The table is built on top
+ * of the FIB library and it supports incremental entry add and delete.
+ *
+ * The table create arguments string is optional, its only accepted format is
+ * "num_tbl8=<N>" in order to set the number of FIB tbl8 groups.
+ */
+
+#include <stdint.h>
+
+#include <rte_swx_table.h>
+
+/** Longest prefix match table operations. */
+extern struct rte_swx_table_ops rte_swx_table_lpm_ops;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __INCLUDE_RTE_SWX_TABLE_LPM_H__ */